@@ -0,0 +1,74 @@
+#pragma once
+
+/** @file bench/bench_common.hpp
+ *  Inputs shared by the micro-benchmarks.
+ *
+ *  Every generator is seeded, so a run is reproducible and two JSON
+ *  reports (--benchmark_out=<file> --benchmark_out_format=json) of
+ *  different releases measure the same work.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace bench {
+
+/**
+ * @brief `n` distinct pseudo-random keys
+ *
+ * @param[in] n
+ * @param[in] seed
+ * @return std::vector<int64_t>
+ */
+inline auto distinct_keys(size_t n, uint64_t seed = 42)
+    -> std::vector<int64_t> {
+  auto gen = std::mt19937_64{seed};
+  auto keys = std::vector<int64_t>(n);
+  for (size_t i = 0; i != n; ++i) {
+    // odd multiplier: a bijection of i, scrambled by the high bits
+    keys[i] = static_cast<int64_t>(i * 0x9e3779b97f4a7c15ULL >> 1);
+  }
+  std::shuffle(keys.begin(), keys.end(), gen);
+  return keys;
+}
+
+/**
+ * @brief `n` queries into `keys`, a fraction `hit_rate` of which hit
+ *
+ * @param[in] keys
+ * @param[in] n
+ * @param[in] hit_rate
+ * @return std::vector<int64_t>
+ */
+inline auto queries(const std::vector<int64_t> &keys, size_t n,
+                    double hit_rate = 0.5) -> std::vector<int64_t> {
+  auto gen = std::mt19937_64{7};
+  auto coin = std::bernoulli_distribution{hit_rate};
+  auto pick = std::uniform_int_distribution<size_t>{0, keys.size() - 1};
+  auto q = std::vector<int64_t>(n);
+  for (auto &x : q) {
+    // distinct_keys() are all non-negative, so a negative key misses
+    x = coin(gen) ? keys[pick(gen)] : -1 - static_cast<int64_t>(pick(gen));
+  }
+  return q;
+}
+
+/**
+ * @brief `n` pseudo-random integers in [lo, hi]
+ */
+template <typename T>
+inline auto uniform(size_t n, T lo, T hi, uint64_t seed = 1)
+    -> std::vector<T> {
+  auto gen = std::mt19937_64{seed};
+  auto dist = std::uniform_int_distribution<T>{lo, hi};
+  auto v = std::vector<T>(n);
+  for (auto &x : v) {
+    x = dist(gen);
+  }
+  return v;
+}
+
+} // namespace bench
@@ -0,0 +1,251 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <py2cpp/arena.hpp>
+#include <py2cpp/concurrent_dict.hpp>
+#include <py2cpp/dict.hpp>
+#include <py2cpp/flat_dict.hpp>
+#include <py2cpp/frozen_dict.hpp>
+#include <py2cpp/hash.hpp>
+#include <py2cpp/ordered_dict.hpp>
+#include <py2cpp/small_dict.hpp>
+#include <py2cpp/sorted_dict.hpp>
+#include <py2cpp/static_dict.hpp>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "bench_common.hpp"
+
+// dict::get and friends against std::unordered_map / std::map
+
+namespace {
+
+using K = int64_t;
+using V = int64_t;
+
+template <typename M> struct Maker {
+  static auto make(const std::vector<K> &keys) -> M {
+    auto m = M{};
+    for (const auto &k : keys) {
+      m[k] = k;
+    }
+    return m;
+  }
+};
+
+template <typename M> auto bulk_make(const std::vector<K> &keys) -> M {
+  auto items = std::vector<std::pair<K, V>>{};
+  for (const auto &k : keys) {
+    items.emplace_back(k, k);
+  }
+  return M(items.begin(), items.end());
+}
+
+// one sort instead of n O(n) insertions
+template <typename Compare, typename Layout, typename Allocator>
+struct Maker<py::sorted_dict<K, V, Compare, Layout, Allocator>> {
+  static auto make(const std::vector<K> &keys)
+      -> py::sorted_dict<K, V, Compare, Layout, Allocator> {
+    return bulk_make<py::sorted_dict<K, V, Compare, Layout, Allocator>>(keys);
+  }
+};
+
+template <> struct Maker<py::frozen_dict<K, V>> {
+  static auto make(const std::vector<K> &keys) -> py::frozen_dict<K, V> {
+    return bulk_make<py::frozen_dict<K, V>>(keys);
+  }
+};
+
+template <typename M> auto lookup(const M &m, K k) -> V {
+  const auto *v = m.get(k);
+  return v != nullptr ? *v : 0;
+}
+
+template <typename... A>
+auto lookup(const std::unordered_map<K, V, A...> &m, K k) -> V {
+  const auto it = m.find(k);
+  return it != m.end() ? it->second : 0;
+}
+
+template <typename... A> auto lookup(const std::map<K, V, A...> &m, K k) -> V {
+  const auto it = m.find(k);
+  return it != m.end() ? it->second : 0;
+}
+
+auto lookup(const py::concurrent_dict<K, V> &m, K k) -> V {
+  return m.get(k, 0);
+}
+
+} // namespace
+
+template <typename M> static void BM_dict_get(benchmark::State &state) {
+  const auto keys = bench::distinct_keys(static_cast<size_t>(state.range(0)));
+  const auto q = bench::queries(keys, 4096);
+  const auto m = Maker<M>::make(keys);
+  for (auto _ : state) {
+    auto sum = V(0);
+    for (const auto &k : q) {
+      sum ^= lookup(m, k);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(q.size()));
+}
+BENCHMARK_TEMPLATE(BM_dict_get, std::unordered_map<K, V>)
+    ->Arg(1 << 10)
+    ->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_dict_get, std::map<K, V>)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_dict_get, py::dict<K, V>)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_dict_get, py::flat_dict<K, V>)
+    ->Arg(1 << 10)
+    ->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_dict_get, py::ordered_dict<K, V>)
+    ->Arg(1 << 10)
+    ->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_dict_get, py::sorted_dict<K, V>)
+    ->Arg(1 << 10)
+    ->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_dict_get,
+                   py::sorted_dict<K, V, std::less<K>, py::eytzinger_layout>)
+    ->Arg(1 << 10)
+    ->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_dict_get, py::frozen_dict<K, V>)
+    ->Arg(1 << 10)
+    ->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_dict_get, std::unordered_map<K, V>)->Arg(8);
+BENCHMARK_TEMPLATE(BM_dict_get, py::flat_dict<K, V>)->Arg(8);
+BENCHMARK_TEMPLATE(BM_dict_get, py::small_dict<K, V>)->Arg(8);
+
+// single-threaded, to price the shard lock against py::dict
+static void BM_concurrent_dict_get(benchmark::State &state) {
+  const auto keys = bench::distinct_keys(static_cast<size_t>(state.range(0)));
+  const auto q = bench::queries(keys, 4096);
+  py::concurrent_dict<K, V> m;
+  for (const auto &k : keys) {
+    m.set(k, k);
+  }
+  for (auto _ : state) {
+    auto sum = V(0);
+    for (const auto &k : q) {
+      sum ^= lookup(m, k);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(q.size()));
+}
+BENCHMARK(BM_concurrent_dict_get)->Arg(1 << 10)->Arg(1 << 20);
+
+template <typename M> static void BM_dict_build(benchmark::State &state) {
+  const auto keys = bench::distinct_keys(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    auto m = Maker<M>::make(keys);
+    benchmark::DoNotOptimize(m);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_dict_build, std::unordered_map<K, V>)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_dict_build, py::dict<K, V>)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_dict_build, py::flat_dict<K, V>)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_dict_build, py::ordered_dict<K, V>)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_dict_build, py::frozen_dict<K, V>)->Arg(1 << 16);
+
+static void BM_sorted_dict_bulk_build(benchmark::State &state) {
+  const auto keys = bench::distinct_keys(static_cast<size_t>(state.range(0)));
+  auto items = std::vector<std::pair<K, V>>{};
+  for (const auto &k : keys) {
+    items.emplace_back(k, k);
+  }
+  for (auto _ : state) {
+    auto m = py::sorted_dict<K, V>(items.begin(), items.end());
+    benchmark::DoNotOptimize(m);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_sorted_dict_bulk_build)->Arg(1 << 16);
+
+static void BM_arena_dict_build(benchmark::State &state) {
+  const auto keys = bench::distinct_keys(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    py::arena a;
+    auto m = py::arena_dict<K, V>(py::arena_allocator<std::pair<const K, V>>(a));
+    for (const auto &k : keys) {
+      m[k] = k;
+    }
+    benchmark::DoNotOptimize(m);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_arena_dict_build)->Arg(1 << 16);
+
+// keyword-table lookups: compile-time perfect hash against string maps
+
+namespace {
+
+const char *const kWords[] = {"and",   "as",     "assert", "break", "class",
+                              "def",   "del",    "elif",   "else",  "except",
+                              "for",   "from",   "global", "if",    "import",
+                              "in",    "is",     "lambda", "not",   "or",
+                              "pass",  "raise",  "return", "try",   "while",
+                              "with",  "yield",  "print",  "self",  "value",
+                              "x",     "result"}; // the last five miss
+
+constexpr auto kKeywords = py::make_static_dict<const char *, int>(
+    {{"and", 0},     {"as", 1},    {"assert", 2}, {"break", 3},
+     {"class", 4},   {"def", 5},   {"del", 6},    {"elif", 7},
+     {"else", 8},    {"except", 9}, {"for", 10},  {"from", 11},
+     {"global", 12}, {"if", 13},   {"import", 14}, {"in", 15},
+     {"is", 16},     {"lambda", 17}, {"not", 18}, {"or", 19},
+     {"pass", 20},   {"raise", 21}, {"return", 22}, {"try", 23},
+     {"while", 24},  {"with", 25}, {"yield", 26}});
+
+template <typename M> auto keyword_map() -> M {
+  auto m = M{};
+  for (const auto &kv : kKeywords.items()) {
+    m[kv.first] = kv.second;
+  }
+  return m;
+}
+
+} // namespace
+
+static void BM_keywords_unordered_map(benchmark::State &state) {
+  const auto m = keyword_map<std::unordered_map<std::string, int>>();
+  for (auto _ : state) {
+    auto sum = 0;
+    for (const auto *w : kWords) {
+      const auto it = m.find(w);
+      sum += it != m.end() ? it->second : -1;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+BENCHMARK(BM_keywords_unordered_map);
+
+static void BM_keywords_flat_dict(benchmark::State &state) {
+  const auto m = keyword_map<
+      py::flat_dict<std::string, int, py::string_hash, std::equal_to<>>>();
+  for (auto _ : state) {
+    auto sum = 0;
+    for (const auto *w : kWords) {
+      sum += m.get(w, -1); // heterogeneous: no std::string temporary
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+BENCHMARK(BM_keywords_flat_dict);
+
+static void BM_keywords_static_dict(benchmark::State &state) {
+  for (auto _ : state) {
+    auto sum = 0;
+    for (const auto *w : kWords) {
+      sum += kKeywords.get(w, -1);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+BENCHMARK(BM_keywords_static_dict);
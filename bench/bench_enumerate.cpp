@@ -0,0 +1,65 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <py2cpp/enumerate.hpp>
+#include <py2cpp/zip.hpp>
+#include <tuple>
+#include <vector>
+
+// py::enumerate and py::zip against index loops
+
+static void BM_index_loop(benchmark::State &state) {
+  const auto v = std::vector<double>(static_cast<size_t>(state.range(0)), 1.5);
+  for (auto _ : state) {
+    auto sum = 0.0;
+    for (size_t i = 0; i != v.size(); ++i) {
+      sum += static_cast<double>(i) * v[i];
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_index_loop)->Arg(1 << 16);
+
+static void BM_enumerate(benchmark::State &state) {
+  const auto v = std::vector<double>(static_cast<size_t>(state.range(0)), 1.5);
+  for (auto _ : state) {
+    auto sum = 0.0;
+    for (const auto &e : py::const_enumerate(v)) {
+      sum += static_cast<double>(e.first) * e.second;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_enumerate)->Arg(1 << 16);
+
+static void BM_index_loop2(benchmark::State &state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto a = std::vector<double>(n, 1.5);
+  const auto b = std::vector<double>(n, 2.5);
+  for (auto _ : state) {
+    auto dot = 0.0;
+    for (size_t i = 0; i != n; ++i) {
+      dot += a[i] * b[i];
+    }
+    benchmark::DoNotOptimize(dot);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_index_loop2)->Arg(1 << 16);
+
+static void BM_zip(benchmark::State &state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto a = std::vector<double>(n, 1.5);
+  const auto b = std::vector<double>(n, 2.5);
+  for (auto _ : state) {
+    auto dot = 0.0;
+    for (const auto &t : py::zip(a, b)) {
+      dot += std::get<0>(t) * std::get<1>(t);
+    }
+    benchmark::DoNotOptimize(dot);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_zip)->Arg(1 << 16);
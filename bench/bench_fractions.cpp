@@ -0,0 +1,276 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <py2cpp/fraction_array.hpp>
+#include <py2cpp/fraction_io.hpp>
+#include <py2cpp/fractions.hpp>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "bench_common.hpp"
+
+#if defined(__has_include)
+#if __has_include(<boost/rational.hpp>)
+#include <boost/rational.hpp>
+#define PY2CPP_BENCH_HAS_BOOST 1
+#endif
+#endif
+
+// Fraction add / compare / gcd, against recursive Euclid and
+// boost::rational when it is available; to_chars / from_chars against
+// iostream formatting and parsing
+
+namespace {
+
+template <typename Z> struct GcdInput {
+  std::vector<Z> a = bench::uniform<Z>(1024, 1, Z(1) << (sizeof(Z) * 8 - 2));
+  std::vector<Z> b = bench::uniform<Z>(1024, 1, Z(1) << (sizeof(Z) * 8 - 2), 2);
+};
+
+template <typename Z>
+auto fractions(size_t n, uint64_t seed) -> std::vector<fun::Fraction<Z>> {
+  const auto nums = bench::uniform<Z>(n, -1000, 1000, seed);
+  const auto dens = bench::uniform<Z>(n, 1, 1000, seed + 1);
+  auto v = std::vector<fun::Fraction<Z>>{};
+  for (size_t i = 0; i != n; ++i) {
+    v.emplace_back(nums[i], dens[i]);
+  }
+  return v;
+}
+
+} // namespace
+
+// fun::gcd (Euclid on the unsigned magnitudes) against Stein's binary
+// GCD and the recursive Euclid of generic types
+template <typename Z> static void BM_gcd(benchmark::State &state) {
+  const auto in = GcdInput<Z>{};
+  for (auto _ : state) {
+    auto acc = Z(0);
+    for (size_t i = 0; i != in.a.size(); ++i) {
+      acc ^= fun::gcd(in.a[i], in.b[i]);
+    }
+    benchmark::DoNotOptimize(acc);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(in.a.size()));
+}
+BENCHMARK_TEMPLATE(BM_gcd, int32_t);
+BENCHMARK_TEMPLATE(BM_gcd, int64_t);
+
+template <typename Z> static void BM_gcd_binary(benchmark::State &state) {
+  using U = typename std::make_unsigned<Z>::type;
+  const auto in = GcdInput<Z>{};
+  for (auto _ : state) {
+    auto acc = U(0);
+    for (size_t i = 0; i != in.a.size(); ++i) {
+      acc ^= fun::detail::gcd_binary(static_cast<U>(in.a[i]),
+                                     static_cast<U>(in.b[i]));
+    }
+    benchmark::DoNotOptimize(acc);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(in.a.size()));
+}
+BENCHMARK_TEMPLATE(BM_gcd_binary, int32_t);
+BENCHMARK_TEMPLATE(BM_gcd_binary, int64_t);
+
+template <typename Z> static void BM_gcd_euclid(benchmark::State &state) {
+  const auto in = GcdInput<Z>{};
+  for (auto _ : state) {
+    auto acc = Z(0);
+    for (size_t i = 0; i != in.a.size(); ++i) {
+      acc ^= fun::gcd_recur(in.a[i], in.b[i]);
+    }
+    benchmark::DoNotOptimize(acc);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(in.a.size()));
+}
+BENCHMARK_TEMPLATE(BM_gcd_euclid, int32_t);
+BENCHMARK_TEMPLATE(BM_gcd_euclid, int64_t);
+
+template <typename Policy> static void BM_fraction_add(benchmark::State &state) {
+  using F = fun::Fraction<int64_t, Policy>;
+  const auto v = fractions<int64_t>(256, 3);
+  auto xs = std::vector<F>{};
+  for (const auto &f : v) {
+    xs.emplace_back(f.num(), f.den());
+  }
+  for (auto _ : state) {
+    // pairwise sums keep the terms small, so none of them overflows
+    auto acc = int64_t(0);
+    for (size_t i = 0; i + 1 < xs.size(); ++i) {
+      const auto s = xs[i] + xs[i + 1];
+      acc += s.num();
+    }
+    benchmark::DoNotOptimize(acc);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(xs.size() - 1));
+}
+BENCHMARK_TEMPLATE(BM_fraction_add, fun::EagerNormalize);
+BENCHMARK_TEMPLATE(BM_fraction_add, fun::LazyNormalize);
+
+static void BM_fraction_compare(benchmark::State &state) {
+  const auto xs = fractions<int64_t>(256, 5);
+  for (auto _ : state) {
+    auto n = 0;
+    for (size_t i = 0; i + 1 < xs.size(); ++i) {
+      n += xs[i] < xs[i + 1] ? 1 : 0;
+    }
+    benchmark::DoNotOptimize(n);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(xs.size() - 1));
+}
+BENCHMARK(BM_fraction_compare);
+
+// amounts on a shared scale (like cents): the running sum stays small
+static auto amounts(size_t n) -> std::vector<fun::Fraction<int64_t>> {
+  const auto nums = bench::uniform<int64_t>(n, -100000, 100000, 7);
+  auto v = std::vector<fun::Fraction<int64_t>>{};
+  for (const auto &x : nums) {
+    v.emplace_back(x, int64_t(1000));
+  }
+  return v;
+}
+
+static void BM_fraction_sum_loop(benchmark::State &state) {
+  const auto xs = amounts(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    auto acc = fun::Fraction<int64_t>(0);
+    for (const auto &f : xs) {
+      acc += f;
+    }
+    benchmark::DoNotOptimize(acc);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_fraction_sum_loop)->Arg(1 << 10);
+
+static void BM_fraction_array_sum(benchmark::State &state) {
+  const auto xs = amounts(static_cast<size_t>(state.range(0)));
+  const auto a = fun::FractionArray<int64_t>(xs.begin(), xs.end());
+  for (auto _ : state) {
+    auto acc = fun::sum(a);
+    benchmark::DoNotOptimize(acc);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_fraction_array_sum)->Arg(1 << 10);
+
+// formatting: operator<< into a stream against to_chars into a buffer
+static void BM_fraction_ostream(benchmark::State &state) {
+  const auto xs = fractions<int64_t>(1024, 9);
+  for (auto _ : state) {
+    auto os = std::ostringstream{};
+    for (const auto &f : xs) {
+      os << f << '\n';
+    }
+    benchmark::DoNotOptimize(os.str().size());
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(xs.size()));
+}
+BENCHMARK(BM_fraction_ostream);
+
+static void BM_fraction_to_chars(benchmark::State &state) {
+  const auto xs = fractions<int64_t>(1024, 9);
+  auto buf = std::vector<char>(xs.size() * fun::fraction_chars_max<int64_t>());
+  for (auto _ : state) {
+    auto *p = buf.data();
+    for (const auto &f : xs) {
+      p = fun::to_chars(p, buf.data() + buf.size(), f).ptr;
+      *p++ = '\n';
+    }
+    benchmark::DoNotOptimize(p);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(xs.size()));
+}
+BENCHMARK(BM_fraction_to_chars);
+
+// parsing "n/d" tokens: istream extraction against from_chars
+static auto fraction_text(size_t n) -> std::string {
+  auto os = std::ostringstream{};
+  for (const auto &f : fractions<int64_t>(n, 11)) {
+    os << f.num() << '/' << f.den() << '\n';
+  }
+  return os.str();
+}
+
+static void BM_fraction_istream(benchmark::State &state) {
+  const auto text = fraction_text(1024);
+  for (auto _ : state) {
+    auto is = std::istringstream{text};
+    auto acc = int64_t(0);
+    auto n = int64_t(0);
+    auto d = int64_t(0);
+    auto slash = char{};
+    while (is >> n >> slash >> d) {
+      acc += fun::Fraction<int64_t>(n, d).num();
+    }
+    benchmark::DoNotOptimize(acc);
+  }
+  state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK(BM_fraction_istream);
+
+static void BM_fraction_from_chars(benchmark::State &state) {
+  const auto text = fraction_text(1024);
+  for (auto _ : state) {
+    const auto *p = text.data();
+    const auto *last = text.data() + text.size();
+    auto acc = int64_t(0);
+    auto f = fun::Fraction<int64_t>{};
+    while (p != last) {
+      p = fun::from_chars(p, last, f).ptr + 1; // skip the '\n'
+      acc += f.num();
+    }
+    benchmark::DoNotOptimize(acc);
+  }
+  state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK(BM_fraction_from_chars);
+
+#if defined(PY2CPP_BENCH_HAS_BOOST)
+static void BM_boost_rational_add(benchmark::State &state) {
+  const auto v = fractions<int64_t>(256, 3);
+  auto xs = std::vector<boost::rational<int64_t>>{};
+  for (const auto &f : v) {
+    xs.emplace_back(f.num(), f.den());
+  }
+  for (auto _ : state) {
+    auto acc = int64_t(0);
+    for (size_t i = 0; i + 1 < xs.size(); ++i) {
+      const auto s = xs[i] + xs[i + 1];
+      acc += s.numerator();
+    }
+    benchmark::DoNotOptimize(acc);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(xs.size() - 1));
+}
+BENCHMARK(BM_boost_rational_add);
+
+static void BM_boost_rational_compare(benchmark::State &state) {
+  const auto v = fractions<int64_t>(256, 5);
+  auto xs = std::vector<boost::rational<int64_t>>{};
+  for (const auto &f : v) {
+    xs.emplace_back(f.num(), f.den());
+  }
+  for (auto _ : state) {
+    auto n = 0;
+    for (size_t i = 0; i + 1 < xs.size(); ++i) {
+      n += xs[i] < xs[i + 1] ? 1 : 0;
+    }
+    benchmark::DoNotOptimize(n);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(xs.size() - 1));
+}
+BENCHMARK(BM_boost_rational_compare);
+#endif
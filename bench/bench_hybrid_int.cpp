@@ -0,0 +1,85 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <py2cpp/fractions.hpp>
+#include <py2cpp/hybrid_int.hpp>
+#include <vector>
+
+#include "bench_common.hpp"
+
+#if defined(__has_include)
+#if __has_include(<boost/multiprecision/cpp_int.hpp>)
+#include <boost/multiprecision/cpp_int.hpp>
+#define PY2CPP_BENCH_HAS_CPP_INT 1
+#endif
+#endif
+
+// hybrid_int on its inline path against plain int64_t. Big is cpp_int
+// when Boost is available; __int128 (not arbitrary precision, but never
+// reached by these inputs) stands in otherwise.
+
+#if defined(PY2CPP_BENCH_HAS_CPP_INT) || defined(PY2CPP_HAS_INT128)
+
+namespace {
+#if defined(PY2CPP_BENCH_HAS_CPP_INT)
+using H = fun::hybrid_int<boost::multiprecision::cpp_int>;
+#else
+__extension__ typedef __int128 int128;
+using H = fun::hybrid_int<int128>;
+#endif
+} // namespace
+
+static void BM_int64_mul_add(benchmark::State &state) {
+  const auto v = bench::uniform<int64_t>(1024, -1000, 1000);
+  for (auto _ : state) {
+    auto acc = int64_t(0);
+    for (size_t i = 0; i + 1 < v.size(); ++i) {
+      acc += v[i] * v[i + 1];
+    }
+    benchmark::DoNotOptimize(acc);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(v.size() - 1));
+}
+BENCHMARK(BM_int64_mul_add);
+
+static void BM_hybrid_int_mul_add(benchmark::State &state) {
+  const auto raw = bench::uniform<int64_t>(1024, -1000, 1000);
+  auto v = std::vector<H>{};
+  for (const auto &x : raw) {
+    v.emplace_back(x);
+  }
+  for (auto _ : state) {
+    auto acc = H{0};
+    for (size_t i = 0; i + 1 < v.size(); ++i) {
+      acc += v[i] * v[i + 1];
+    }
+    benchmark::DoNotOptimize(acc);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(v.size() - 1));
+}
+BENCHMARK(BM_hybrid_int_mul_add);
+
+static void BM_hybrid_fraction_add(benchmark::State &state) {
+  const auto nums = bench::uniform<int64_t>(256, -1000, 1000);
+  const auto dens = bench::uniform<int64_t>(256, 1, 1000, 2);
+  auto xs = std::vector<fun::Fraction<H>>{};
+  for (size_t i = 0; i != nums.size(); ++i) {
+    xs.emplace_back(H{nums[i]}, H{dens[i]});
+  }
+  for (auto _ : state) {
+    auto n = 0;
+    for (size_t i = 0; i + 1 < xs.size(); ++i) {
+      const auto s = xs[i] + xs[i + 1];
+      n += s.num().is_small() ? 1 : 0;
+    }
+    benchmark::DoNotOptimize(n);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(xs.size() - 1));
+}
+BENCHMARK(BM_hybrid_fraction_add);
+
+#endif
@@ -0,0 +1,118 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <py2cpp/generator.hpp>
+#include <py2cpp/itertools.hpp>
+#include <vector>
+
+#include "bench_common.hpp"
+
+// sum(f(x) for x in xs if p(x)): fused adaptors against a raw loop and
+// against the temporary vectors they replace
+
+namespace {
+
+const auto is_odd = [](int64_t x) { return (x & 1) != 0; };
+const auto cube = [](int64_t x) { return x * x * x; };
+
+} // namespace
+
+static void BM_sum_loop(benchmark::State &state) {
+  const auto xs = bench::uniform<int64_t>(static_cast<size_t>(state.range(0)),
+                                         -1000, 1000);
+  for (auto _ : state) {
+    auto total = int64_t(0);
+    for (auto x : xs) {
+      if (is_odd(x)) {
+        total += cube(x);
+      }
+    }
+    benchmark::DoNotOptimize(total);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_sum_loop)->Arg(1 << 16);
+
+static void BM_sum_temporaries(benchmark::State &state) {
+  const auto xs = bench::uniform<int64_t>(static_cast<size_t>(state.range(0)),
+                                         -1000, 1000);
+  for (auto _ : state) {
+    auto odd = std::vector<int64_t>{};
+    for (auto x : xs) {
+      if (is_odd(x)) {
+        odd.push_back(x);
+      }
+    }
+    auto cubes = std::vector<int64_t>{};
+    cubes.reserve(odd.size());
+    for (auto x : odd) {
+      cubes.push_back(cube(x));
+    }
+    auto total = int64_t(0);
+    for (auto y : cubes) {
+      total += y;
+    }
+    benchmark::DoNotOptimize(total);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_sum_temporaries)->Arg(1 << 16);
+
+static void BM_sum_map_filter(benchmark::State &state) {
+  const auto xs = bench::uniform<int64_t>(static_cast<size_t>(state.range(0)),
+                                         -1000, 1000);
+  for (auto _ : state) {
+    auto total = py::sum(py::map(cube, py::filter(is_odd, xs)));
+    benchmark::DoNotOptimize(total);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_sum_map_filter)->Arg(1 << 16);
+
+static void BM_chain_islice(benchmark::State &state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto a = bench::uniform<int64_t>(n, -1000, 1000, 1);
+  const auto b = bench::uniform<int64_t>(n, -1000, 1000, 2);
+  for (auto _ : state) {
+    auto total = py::sum(py::islice(py::chain(a, b), n / 2, n + n / 2, 3));
+    benchmark::DoNotOptimize(total);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_chain_islice)->Arg(1 << 16);
+
+#if defined(PY2CPP_HAS_COROUTINE)
+namespace {
+
+auto odd_cubes(const std::vector<int64_t> &xs) -> py::generator<int64_t> {
+  for (auto x : xs) {
+    if (is_odd(x)) {
+      co_yield cube(x);
+    }
+  }
+}
+
+} // namespace
+
+static void BM_sum_generator(benchmark::State &state) {
+  const auto xs = bench::uniform<int64_t>(static_cast<size_t>(state.range(0)),
+                                         -1000, 1000);
+  for (auto _ : state) {
+    auto total = py::sum(odd_cubes(xs));
+    benchmark::DoNotOptimize(total);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_sum_generator)->Arg(1 << 16);
+
+// creating a short generator: the pooled frame against the allocator
+static void BM_generator_create(benchmark::State &state) {
+  const auto xs = std::vector<int64_t>{1, 2, 3};
+  for (auto _ : state) {
+    auto total = py::sum(odd_cubes(xs));
+    benchmark::DoNotOptimize(total);
+  }
+}
+BENCHMARK(BM_generator_create);
+#endif
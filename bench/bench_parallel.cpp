@@ -0,0 +1,61 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <py2cpp/parallel.hpp>
+#include <py2cpp/range.hpp>
+#include <vector>
+
+// parallel_reduce / parallel_for against the serial loop
+
+static void BM_serial_reduce(benchmark::State &state) {
+  const auto n = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    auto sum = 0.0;
+    for (auto i : py::range(n)) {
+      sum += std::sqrt(static_cast<double>(i));
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_serial_reduce)->Arg(1 << 20)->UseRealTime();
+
+static void BM_parallel_reduce(benchmark::State &state) {
+  const auto n = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    const auto sum = py::parallel_reduce(
+        py::range(n), 0.0,
+        [](int i) { return std::sqrt(static_cast<double>(i)); },
+        std::plus<double>{});
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_parallel_reduce)->Arg(1 << 20)->UseRealTime();
+
+static void BM_parallel_for(benchmark::State &state) {
+  const auto n = static_cast<int>(state.range(0));
+  auto out = std::vector<double>(static_cast<size_t>(n));
+  for (auto _ : state) {
+    py::parallel_for(py::range(n), [&out](int i) {
+      out[static_cast<size_t>(i)] = std::sqrt(static_cast<double>(i));
+    });
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_parallel_for)->Arg(1 << 20)->UseRealTime();
+
+// the fixed cost of one dispatch to the pool
+static void BM_parallel_for_tiny(benchmark::State &state) {
+  auto out = std::vector<int>(64);
+  for (auto _ : state) {
+    py::parallel_for(py::range(64), [&out](int i) {
+      out[static_cast<size_t>(i)] = i;
+    });
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_parallel_for_tiny)->UseRealTime();
@@ -0,0 +1,128 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <numeric>
+#include <py2cpp/chunks.hpp>
+#include <py2cpp/range.hpp>
+#include <py2cpp/reversed.hpp>
+#include <vector>
+
+// py::range against the hand-written loop it should compile down to
+
+static void BM_raw_loop(benchmark::State &state) {
+  const auto n = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    auto sum = int64_t(0);
+    for (int i = 0; i < n; ++i) {
+      sum += i;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_raw_loop)->Arg(1 << 16);
+
+static void BM_range(benchmark::State &state) {
+  const auto n = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    auto sum = int64_t(0);
+    for (auto i : py::range(n)) {
+      sum += i;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_range)->Arg(1 << 16);
+
+static void BM_raw_step_loop(benchmark::State &state) {
+  const auto n = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    auto sum = int64_t(0);
+    for (int i = n; i > 0; i -= 3) {
+      sum += i;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * (n / 3));
+}
+BENCHMARK(BM_raw_step_loop)->Arg(1 << 16);
+
+static void BM_range_step(benchmark::State &state) {
+  const auto n = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    auto sum = int64_t(0);
+    for (auto i : py::range(n, 0, -3)) {
+      sum += i;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * (n / 3));
+}
+BENCHMARK(BM_range_step)->Arg(1 << 16);
+
+static void BM_raw_reverse_loop(benchmark::State &state) {
+  auto v = std::vector<int>(static_cast<size_t>(state.range(0)));
+  std::iota(v.begin(), v.end(), 0);
+  for (auto _ : state) {
+    auto sum = int64_t(0);
+    for (auto i = v.size(); i-- != 0;) {
+      sum += v[i];
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_raw_reverse_loop)->Arg(1 << 16);
+
+static void BM_reversed(benchmark::State &state) {
+  auto v = std::vector<int>(static_cast<size_t>(state.range(0)));
+  std::iota(v.begin(), v.end(), 0);
+  for (auto _ : state) {
+    auto sum = int64_t(0);
+    for (const auto &x : py::reversed(v)) {
+      sum += x;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_reversed)->Arg(1 << 16);
+
+static void BM_raw_blocked_loop(benchmark::State &state) {
+  auto v = std::vector<int>(static_cast<size_t>(state.range(0)));
+  std::iota(v.begin(), v.end(), 0);
+  const auto block = size_t(64);
+  for (auto _ : state) {
+    auto best = int64_t(0);
+    for (size_t lo = 0; lo < v.size(); lo += block) {
+      auto sum = int64_t(0);
+      const auto hi = lo + block < v.size() ? lo + block : v.size();
+      for (auto i = lo; i != hi; ++i) {
+        sum += v[i];
+      }
+      best = sum > best ? sum : best;
+    }
+    benchmark::DoNotOptimize(best);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_raw_blocked_loop)->Arg(1 << 16);
+
+static void BM_chunks(benchmark::State &state) {
+  auto v = std::vector<int>(static_cast<size_t>(state.range(0)));
+  std::iota(v.begin(), v.end(), 0);
+  for (auto _ : state) {
+    auto best = int64_t(0);
+    for (const auto &chunk : py::chunks(v, 64)) {
+      auto sum = int64_t(0);
+      for (const auto &x : chunk) {
+        sum += x;
+      }
+      best = sum > best ? sum : best;
+    }
+    benchmark::DoNotOptimize(best);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_chunks)->Arg(1 << 16);
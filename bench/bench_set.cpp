@@ -0,0 +1,137 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <py2cpp/flat_set.hpp>
+#include <py2cpp/frozen_set.hpp>
+#include <py2cpp/set.hpp>
+#include <py2cpp/small_set.hpp>
+#include <py2cpp/sorted_set.hpp>
+#include <py2cpp/static_set.hpp>
+#include <set>
+#include <unordered_set>
+#include <vector>
+
+#include "bench_common.hpp"
+
+// set::contains and set algebra against std::unordered_set / std::set
+
+namespace {
+
+using K = int64_t;
+
+template <typename S> auto make_set(const std::vector<K> &keys) -> S {
+  return S(keys.begin(), keys.end());
+}
+
+template <typename S> auto contains(const S &s, K k) -> bool {
+  return s.contains(k);
+}
+
+template <typename... A>
+auto contains(const std::unordered_set<K, A...> &s, K k) -> bool {
+  return s.find(k) != s.end();
+}
+
+template <typename... A> auto contains(const std::set<K, A...> &s, K k) -> bool {
+  return s.find(k) != s.end();
+}
+
+} // namespace
+
+template <typename S> static void BM_set_contains(benchmark::State &state) {
+  const auto keys = bench::distinct_keys(static_cast<size_t>(state.range(0)));
+  const auto q = bench::queries(keys, 4096);
+  const auto s = make_set<S>(keys);
+  for (auto _ : state) {
+    auto hits = 0;
+    for (const auto &k : q) {
+      hits += contains(s, k) ? 1 : 0;
+    }
+    benchmark::DoNotOptimize(hits);
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(q.size()));
+}
+BENCHMARK_TEMPLATE(BM_set_contains, std::unordered_set<K>)
+    ->Arg(1 << 10)
+    ->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_set_contains, std::set<K>)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_set_contains, py::set<K>)->Arg(1 << 10)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_set_contains, py::flat_set<K>)
+    ->Arg(1 << 10)
+    ->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_set_contains, py::sorted_set<K>)
+    ->Arg(1 << 10)
+    ->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_set_contains,
+                   py::sorted_set<K, std::less<K>, py::eytzinger_layout>)
+    ->Arg(1 << 10)
+    ->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_set_contains, py::frozen_set<K>)
+    ->Arg(1 << 10)
+    ->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_set_contains, std::unordered_set<K>)->Arg(8);
+BENCHMARK_TEMPLATE(BM_set_contains, py::flat_set<K>)->Arg(8);
+BENCHMARK_TEMPLATE(BM_set_contains, py::small_set<K>)->Arg(8);
+
+static void BM_static_set_contains(benchmark::State &state) {
+  static constexpr auto s = py::make_static_set<K>(
+      {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53});
+  const auto q = bench::uniform<K>(4096, 0, 63);
+  for (auto _ : state) {
+    auto hits = 0;
+    for (const auto &k : q) {
+      hits += s.contains(k) ? 1 : 0;
+    }
+    benchmark::DoNotOptimize(hits);
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(q.size()));
+}
+BENCHMARK(BM_static_set_contains);
+
+static void BM_flat_set_contains16(benchmark::State &state) {
+  const auto s = py::flat_set<K>{2,  3,  5,  7,  11, 13, 17, 19,
+                                 23, 29, 31, 37, 41, 43, 47, 53};
+  const auto q = bench::uniform<K>(4096, 0, 63);
+  for (auto _ : state) {
+    auto hits = 0;
+    for (const auto &k : q) {
+      hits += s.contains(k) ? 1 : 0;
+    }
+    benchmark::DoNotOptimize(hits);
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(q.size()));
+}
+BENCHMARK(BM_flat_set_contains16);
+
+// two half-overlapping sets of range(0) keys each
+template <typename S> static void BM_set_intersection(benchmark::State &state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto keys = bench::distinct_keys(n + n / 2);
+  const auto a = S(keys.begin(), keys.begin() + static_cast<ptrdiff_t>(n));
+  const auto b = S(keys.begin() + static_cast<ptrdiff_t>(n / 2), keys.end());
+  for (auto _ : state) {
+    auto c = a & b;
+    benchmark::DoNotOptimize(c);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_set_intersection, py::set<K>)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_set_intersection, py::flat_set<K>)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_set_intersection, py::sorted_set<K>)->Arg(1 << 16);
+
+template <typename S> static void BM_set_union(benchmark::State &state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto keys = bench::distinct_keys(n + n / 2);
+  const auto a = S(keys.begin(), keys.begin() + static_cast<ptrdiff_t>(n));
+  const auto b = S(keys.begin() + static_cast<ptrdiff_t>(n / 2), keys.end());
+  for (auto _ : state) {
+    auto c = a | b;
+    benchmark::DoNotOptimize(c);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_set_union, py::set<K>)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_set_union, py::flat_set<K>)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_set_union, py::sorted_set<K>)->Arg(1 << 16);
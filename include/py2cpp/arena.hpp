@@ -0,0 +1,211 @@
+#pragma once
+
+/** @file include/py2cpp/arena.hpp
+ *  Monotonic arena and the allocator that draws from it.
+ *
+ *  An arena hands out memory by bumping a pointer and never frees single
+ *  allocations; all of it is returned at once by release() or by the
+ *  destructor. Containers built on it (py::arena_dict, py::arena_set, ...)
+ *  cost no malloc per node, and dropping a whole request's worth of them
+ *  is O(number of blocks).
+ *
+ *  With C++17 <memory_resource>, py::arena is also a
+ *  std::pmr::memory_resource and can back the py::pmr::* aliases.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+#if defined(__has_include)
+#if __has_include(<memory_resource>) &&                                       \
+    (__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L))
+#include <memory_resource>
+#if defined(__cpp_lib_memory_resource)
+#define PY2CPP_HAS_PMR 1
+#endif
+#endif
+#endif
+
+namespace py {
+
+/**
+ * @brief Monotonic (bump-pointer) memory arena
+ *
+ */
+class arena
+#if defined(PY2CPP_HAS_PMR)
+    : public std::pmr::memory_resource
+#endif
+{
+  struct Block {
+    Block *next;
+    size_t size;
+  };
+
+  char *_cur{nullptr};
+  char *_end{nullptr};
+  Block *_blocks{nullptr};
+  char *_buffer{nullptr};
+  size_t _buffer_size{0};
+  size_t _block_size;
+
+public:
+  /**
+   * @brief Construct a new arena object
+   *
+   * @param[in] block_size size of the first heap block (grows geometrically)
+   */
+  explicit arena(size_t block_size = 1024) : _block_size{block_size} {}
+
+  /**
+   * @brief Construct a new arena object that starts in a caller buffer
+   *
+   * The buffer (e.g. on the stack) is used first; heap blocks are only
+   * requested once it is exhausted.
+   *
+   * @param[in] buffer
+   * @param[in] size
+   */
+  arena(void *buffer, size_t size)
+      : _cur{static_cast<char *>(buffer)},
+        _end{static_cast<char *>(buffer) + size},
+        _buffer{static_cast<char *>(buffer)}, _buffer_size{size},
+        _block_size{size < 1024 ? 1024 : size} {}
+
+  arena(const arena &) = delete;
+  auto operator=(const arena &) -> arena & = delete;
+
+  ~arena() { this->release(); }
+
+  /**
+   * @brief Allocate `bytes` aligned to `alignment` (a power of two)
+   *
+   * @param[in] bytes
+   * @param[in] alignment
+   * @return void*
+   */
+  auto allocate(size_t bytes, size_t alignment = alignof(std::max_align_t))
+      -> void * {
+    auto *p = align_up(this->_cur, alignment);
+    if (p == nullptr || p > this->_end ||
+        bytes > static_cast<size_t>(this->_end - p)) {
+      this->grow(bytes + alignment);
+      p = align_up(this->_cur, alignment);
+    }
+    this->_cur = p + bytes;
+    return p;
+  }
+
+  /**
+   * @brief No-op: memory is reclaimed by release()
+   *
+   */
+  void deallocate(void * /* p */, size_t /* bytes */,
+                  size_t /* alignment */ = alignof(std::max_align_t)) noexcept {
+  }
+
+  /**
+   * @brief Return every heap block and rewind to the initial buffer
+   *
+   * All objects allocated from the arena must be dead (or trivially
+   * destructible and no longer used).
+   */
+  void release() noexcept {
+    while (this->_blocks != nullptr) {
+      auto *next = this->_blocks->next;
+      ::operator delete(this->_blocks);
+      this->_blocks = next;
+    }
+    this->_cur = this->_buffer;
+    this->_end = this->_buffer + this->_buffer_size;
+  }
+
+private:
+  static auto align_up(char *p, size_t alignment) -> char * {
+    if (p == nullptr) {
+      return nullptr;
+    }
+    const auto addr = reinterpret_cast<uintptr_t>(p);
+    const auto aligned = (addr + alignment - 1) & ~(uintptr_t(alignment) - 1);
+    return p + (aligned - addr);
+  }
+
+  void grow(size_t at_least) {
+    // no doubling loop: block_size may be 0
+    const auto need = at_least + sizeof(Block);
+    const auto size = this->_block_size < need ? need : this->_block_size;
+    auto *block = static_cast<Block *>(::operator new(size));
+    block->next = this->_blocks;
+    block->size = size;
+    this->_blocks = block;
+    this->_cur = reinterpret_cast<char *>(block) + sizeof(Block);
+    this->_end = reinterpret_cast<char *>(block) + size;
+    this->_block_size = size * 2;
+  }
+
+#if defined(PY2CPP_HAS_PMR)
+  auto do_allocate(size_t bytes, size_t alignment) -> void * override {
+    return this->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void * /* p */, size_t /* bytes */,
+                     size_t /* alignment */) override {}
+
+  auto do_is_equal(const std::pmr::memory_resource &other) const noexcept
+      -> bool override {
+    return this == &other;
+  }
+#endif
+};
+
+/**
+ * @brief Allocator drawing from a py::arena
+ *
+ * Propagates on move assignment and swap so that moving containers between
+ * variables never falls back to element-wise copies.
+ *
+ * @tparam T
+ */
+template <typename T> class arena_allocator {
+  template <typename> friend class arena_allocator;
+
+  arena *_arena;
+
+public:
+  using value_type = T;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  /**
+   * @brief Construct a new arena allocator object
+   *
+   * @param[in] a
+   */
+  explicit arena_allocator(arena &a) noexcept : _arena{&a} {}
+
+  template <typename U>
+  arena_allocator(const arena_allocator<U> &other) noexcept
+      : _arena{other._arena} {}
+
+  auto allocate(size_t n) -> T * {
+    return static_cast<T *>(this->_arena->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T * /* p */, size_t /* n */) noexcept {}
+
+  auto resource() const noexcept -> arena * { return this->_arena; }
+
+  template <typename U>
+  auto operator==(const arena_allocator<U> &other) const noexcept -> bool {
+    return this->_arena == other._arena;
+  }
+
+  template <typename U>
+  auto operator!=(const arena_allocator<U> &other) const noexcept -> bool {
+    return this->_arena != other._arena;
+  }
+};
+
+} // namespace py
@@ -0,0 +1,159 @@
+#pragma once
+
+/** @file include/py2cpp/bulk.hpp
+ *  Iteration helpers shared by the containers and the lazy adaptors.
+ *
+ *  Filling a hash container from a range one element at a time rehashes
+ *  O(log n) times. When the length of the input is cheap to know (a
+ *  forward iterator pair, or anything with size(), such as py::range or
+ *  py::enumerate over a vector) the containers reserve once up front.
+ */
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace py {
+
+namespace detail {
+
+template <typename It, typename = void> struct iterator_category_of {
+  using type = std::input_iterator_tag;
+};
+
+/**
+ * @brief The iterator category of `It`, or input_iterator_tag when unknown
+ *
+ * Lets hand-written iterators without traits (py::range, py::enumerate)
+ * pass through the same code path as the standard ones.
+ */
+template <typename It>
+struct iterator_category_of<
+    It, typename std::conditional<
+            true, void,
+            typename std::iterator_traits<It>::iterator_category>::type> {
+  using type = typename std::iterator_traits<It>::iterator_category;
+};
+
+template <typename C, typename FwdIt>
+void reserve_for(C &c, FwdIt first, FwdIt last, std::forward_iterator_tag) {
+  c.reserve(c.size() + static_cast<size_t>(std::distance(first, last)));
+}
+
+template <typename C, typename InputIt>
+void reserve_for(C & /* c */, InputIt /* first */, InputIt /* last */,
+                 std::input_iterator_tag) {}
+
+/**
+ * @brief Reserve room for [first, last) when its length is cheap to know
+ */
+template <typename C, typename InputIt>
+void reserve_for(C &c, InputIt first, InputIt last) {
+  reserve_for(c, first, last, typename iterator_category_of<InputIt>::type{});
+}
+
+template <typename R, typename = void> struct has_size : std::false_type {};
+
+template <typename R>
+struct has_size<R, typename std::conditional<
+                       true, void,
+                       decltype(std::declval<const R &>().size())>::type>
+    : std::true_type {};
+
+template <typename C, typename R>
+void reserve_for_range(C &c, const R &r, std::true_type /* has_size */) {
+  c.reserve(c.size() + static_cast<size_t>(r.size()));
+}
+
+template <typename C, typename R>
+void reserve_for_range(C &c, const R &r, std::false_type /* has_size */) {
+  reserve_for(c, std::begin(r), std::end(r));
+}
+
+/**
+ * @brief Reserve room for the elements of `r` when its length is cheap to
+ * know
+ */
+template <typename C, typename R> void reserve_for_range(C &c, const R &r) {
+  reserve_for_range(c, r, has_size<R>{});
+}
+
+template <typename R, typename = void>
+struct is_iterable : std::false_type {};
+
+template <typename R>
+struct is_iterable<
+    R, typename std::conditional<
+           true, void, decltype(std::begin(std::declval<const R &>()))>::type>
+    : std::true_type {};
+
+/**
+ * @brief Enabled for an iterable `R` that is neither the container `Self`
+ * itself nor its allocator (keeps copy and allocator construction intact)
+ */
+template <typename R, typename Self, typename Allocator>
+using enable_iterable_t = typename std::enable_if<
+    is_iterable<R>::value &&
+    !std::is_base_of<Self, typename std::decay<R>::type>::value &&
+    !std::is_convertible<const R &, Allocator>::value>::type;
+
+/**
+ * @brief How a lazy adaptor sees the iterable it stores
+ *
+ * Adaptors (enumerate, zip, reversed) are instantiated with `T` deduced
+ * from a forwarding reference: lvalues are kept by reference (`T` is
+ * `X &`), rvalues such as `py::range(10)` are moved into the adaptor. Seen
+ * from a const adaptor, a stored value is const while a stored reference
+ * keeps its constness, so `enumerate(v)` can still write through to `v`.
+ */
+template <typename T>
+using view_t = typename std::conditional<std::is_reference<T>::value, T,
+                                         const T &>::type;
+
+template <typename T>
+using view_iterator_t = decltype(std::begin(std::declval<view_t<T>>()));
+
+/**
+ * @brief The category of `It`, capped at random access: an adaptor that
+ * yields proxies by value can never be contiguous
+ */
+template <typename It>
+using capped_category_t = typename std::conditional<
+    std::is_base_of<std::random_access_iterator_tag,
+                    typename iterator_category_of<It>::type>::value,
+    std::random_access_iterator_tag,
+    typename iterator_category_of<It>::type>::type;
+
+template <typename It, typename = void> struct iterator_difference_of {
+  using type = std::ptrdiff_t;
+};
+
+template <typename It>
+struct iterator_difference_of<
+    It, typename std::conditional<
+            true, void,
+            typename std::iterator_traits<It>::difference_type>::type> {
+  using type = typename std::iterator_traits<It>::difference_type;
+};
+
+/**
+ * @brief The difference type of `It`, or ptrdiff_t when unknown
+ */
+template <typename It>
+using iterator_difference_t = typename iterator_difference_of<It>::type;
+
+template <typename It>
+using is_random_access = std::is_same<capped_category_t<It>,
+                                      std::random_access_iterator_tag>;
+
+/**
+ * @brief The element type produced by iterating over `R`
+ */
+template <typename R>
+using range_value_t =
+    typename std::decay<decltype(*std::begin(std::declval<const R &>()))>::type;
+
+} // namespace detail
+
+} // namespace py
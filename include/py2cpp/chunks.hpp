@@ -0,0 +1,174 @@
+#pragma once
+
+/** @file include/py2cpp/chunks.hpp
+ *  Index-aligned slices and chunks of random-access iterables.
+ *
+ *      for (auto chunk : py::enumerate(rows).chunks(1024)) {
+ *        for (auto p : chunk) { use(p.first, p.second); } // global index
+ *      }
+ *
+ *  A chunk is just an iterator pair, and the chunks view has size() and
+ *  operator[], so it can be handed to py::parallel_for directly: every
+ *  worker sees the right global indices without sharing a counter.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "bulk.hpp" // import detail::view_t, detail::is_random_access
+
+namespace py {
+
+namespace detail {
+
+/**
+ * @brief A view of [first, last)
+ *
+ * @tparam Iter a random-access iterator
+ */
+template <typename Iter> struct Subrange {
+  using iterator = Iter;
+  using const_iterator = Iter;
+
+  Iter first;
+  Iter last;
+
+  auto begin() const -> Iter { return this->first; }
+  auto end() const -> Iter { return this->last; }
+  auto empty() const -> bool { return this->first == this->last; }
+  auto size() const -> size_t {
+    return static_cast<size_t>(this->last - this->first);
+  }
+  auto operator[](size_t n) const -> decltype(*std::declval<const Iter &>()) {
+    return *(this->first + static_cast<iterator_difference_t<Iter>>(n));
+  }
+};
+
+/**
+ * @brief Subrange of `seq` covering [first, last) (clamped to its size)
+ */
+template <typename Seq>
+inline auto make_slice(Seq &seq, size_t first, size_t last)
+    -> Subrange<decltype(std::begin(seq))> {
+  using Iter = decltype(std::begin(seq));
+  static_assert(is_random_access<Iter>::value,
+                "slicing needs a random-access iterable");
+  const auto n = static_cast<size_t>(std::end(seq) - std::begin(seq));
+  last = std::min(last, n);
+  first = std::min(first, last);
+  const auto b = std::begin(seq);
+  return Subrange<Iter>{b + static_cast<iterator_difference_t<Iter>>(first),
+                        b + static_cast<iterator_difference_t<Iter>>(last)};
+}
+
+template <typename View> struct ChunkIterator {
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = decltype(std::declval<const View &>()[0]);
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = value_type;
+
+  const View *view{nullptr};
+  size_t k{0};
+
+  auto operator*() const -> reference { return (*this->view)[this->k]; }
+  auto operator++() -> ChunkIterator & {
+    ++this->k;
+    return *this;
+  }
+  auto operator++(int) -> ChunkIterator {
+    auto temp = *this;
+    ++*this;
+    return temp;
+  }
+  friend auto operator==(const ChunkIterator &a, const ChunkIterator &b)
+      -> bool {
+    return a.k == b.k;
+  }
+  friend auto operator!=(const ChunkIterator &a, const ChunkIterator &b)
+      -> bool {
+    return a.k != b.k;
+  }
+};
+
+/**
+ * @brief Consecutive chunks of `n` elements (the last one may be shorter)
+ *
+ * @tparam S `X &` for an lvalue iterable, `X` for a moved-in rvalue
+ */
+template <typename S> struct ChunksView {
+  using Iter = view_iterator_t<S>;
+  static_assert(is_random_access<Iter>::value,
+                "chunks() needs a random-access iterable");
+  using iterator = ChunkIterator<ChunksView>;
+  using const_iterator = iterator;
+
+  S seq;
+  size_t n;
+
+  auto begin() const -> iterator { return iterator{this, 0}; }
+  auto end() const -> iterator { return iterator{this, this->size()}; }
+  auto empty() const -> bool { return this->size() == 0; }
+  auto size() const -> size_t {
+    const auto len = this->length(); // no len + n - 1: n may be huge
+    return len / this->n + (len % this->n != 0 ? 1U : 0U);
+  }
+  /// The k-th chunk (no bounds checking)
+  auto operator[](size_t k) const -> Subrange<Iter> {
+    view_t<S> r = this->seq;
+    return make_slice(r, k * this->n, (k + 1) * this->n);
+  }
+
+private:
+  auto length() const -> size_t {
+    view_t<S> r = this->seq;
+    return static_cast<size_t>(std::end(r) - std::begin(r));
+  }
+};
+
+template <typename S>
+inline auto make_chunks(S &&seq, size_t n) -> ChunksView<S> {
+  if (n == 0) {
+    throw std::invalid_argument("chunk size must be positive");
+  }
+  return ChunksView<S>{std::forward<S>(seq), n};
+}
+
+} // namespace detail
+
+/**
+ * @brief Split a random-access iterable into chunks of `n` elements
+ *
+ * @tparam T
+ * @param[in] iterable lvalues are referenced, rvalues moved in
+ * @param[in] n chunk size
+ * @return detail::ChunksView<T>
+ * @exception std::invalid_argument if `n` is zero
+ */
+template <typename T>
+inline auto chunks(T &&iterable, size_t n) -> detail::ChunksView<T> {
+  return detail::make_chunks(std::forward<T>(iterable), n);
+}
+
+/**
+ * @brief The elements [first, last) of a random-access iterable
+ *
+ * A view, like std::span: `iterable` must outlive the result.
+ *
+ * @tparam T
+ * @param[in] iterable
+ * @param[in] first
+ * @param[in] last clamped to the size of `iterable`
+ * @return detail::Subrange<iterator of T>
+ */
+template <typename T>
+inline auto slice(T &iterable, size_t first, size_t last)
+    -> decltype(detail::make_slice(iterable, first, last)) {
+  return detail::make_slice(iterable, first, last);
+}
+
+} // namespace py
@@ -0,0 +1,329 @@
+#pragma once
+
+/** @file include/py2cpp/concurrent_dict.hpp
+ *  A dict that many threads can update at once.
+ *
+ *      py::concurrent_dict<std::string, long> totals{};
+ *      py::parallel_for(rows, [&](const Row &r) {
+ *        totals.upsert(r.key, [&](long &v) { v += r.amount; });
+ *      });
+ *
+ *  The table is split into shards, each a py::dict behind its own mutex,
+ *  and a key's hash picks its shard, so threads touching different keys
+ *  rarely meet on a lock. For write-heavy aggregation, counting into a
+ *  per-thread py::dict and combining with merge() at the end takes each
+ *  shard lock once per merge instead of once per element.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "dict.hpp"
+
+namespace py {
+
+/**
+ * @brief Hash map with one lock per shard
+ *
+ * Every member function is safe to call concurrently. Values are handed
+ * out by copy, or to a callback that runs under the shard lock; there
+ * are no iterators or references into the table.
+ *
+ * @tparam Key
+ * @tparam T
+ * @tparam Hash
+ * @tparam KeyEqual
+ */
+template <typename Key, typename T, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class concurrent_dict {
+  using Map = dict<Key, T, Hash, KeyEqual>;
+
+  struct Shard {
+    mutable std::mutex mtx;
+    Map map;
+    char pad[64]; // keep neighbouring locks off one cache line
+  };
+
+  std::vector<std::unique_ptr<Shard>> _shards;
+  Hash _hash;
+  int _shift; // a shard index is the top bits of the mixed hash
+
+public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<Key, T>;
+
+  /**
+   * @brief Construct a new concurrent dict object
+   *
+   * @param[in] num_shards rounded up to a power of two (0: 4 per hardware
+   *                       thread)
+   * @param[in] hash
+   */
+  explicit concurrent_dict(size_t num_shards = 0, const Hash &hash = Hash())
+      : _hash(hash), _shift{64} {
+    if (num_shards == 0) {
+      num_shards = 4 * std::max(1U, std::thread::hardware_concurrency());
+    }
+    auto n = size_t(1);
+    for (; n < num_shards; n <<= 1) {
+      --this->_shift;
+    }
+    this->_shards.reserve(n);
+    for (size_t i = 0; i != n; ++i) {
+      this->_shards.emplace_back(new Shard{});
+    }
+  }
+
+  concurrent_dict(const concurrent_dict &) = delete;
+  auto operator=(const concurrent_dict &) -> concurrent_dict & = delete;
+
+  /// Number of shards
+  auto num_shards() const noexcept -> size_t { return this->_shards.size(); }
+
+  /**
+   * @brief
+   *
+   * @param[in] key
+   * @return true
+   * @return false
+   */
+  auto contains(const Key &key) const -> bool {
+    const auto &s = this->shard(key);
+    std::lock_guard<std::mutex> lock(s.mtx);
+    return s.map.contains(key);
+  }
+
+  /**
+   * @brief A copy of the value for `key`, or `default_value` when missing
+   *
+   * @param[in] key
+   * @param[in] default_value
+   * @return T
+   */
+  auto get(const Key &key, const T &default_value) const -> T {
+    const auto &s = this->shard(key);
+    std::lock_guard<std::mutex> lock(s.mtx);
+    return s.map.get(key, default_value);
+  }
+
+  /**
+   * @brief Copy the value for `key` into `out`
+   *
+   * @param[in] key
+   * @param[out] out untouched when the key is missing
+   * @return true if the key was found
+   */
+  auto try_get(const Key &key, T &out) const -> bool {
+    const auto &s = this->shard(key);
+    std::lock_guard<std::mutex> lock(s.mtx);
+    const auto *p = s.map.get(key);
+    if (p == nullptr) {
+      return false;
+    }
+    out = *p;
+    return true;
+  }
+
+  /**
+   * @brief Run `fn(value)` on the value for `key` under the shard lock,
+   * default-constructing it first if missing (like `d[key] op= ...`)
+   *
+   *     counts.upsert(word, [](size_t &n) { ++n; });
+   *
+   * `fn` must not call back into this dict.
+   *
+   * @param[in] key
+   * @param[in] fn
+   */
+  template <typename Fn> void upsert(const Key &key, Fn &&fn) {
+    auto &s = this->shard(key);
+    std::lock_guard<std::mutex> lock(s.mtx);
+    fn(s.map[key]);
+  }
+
+  /**
+   * @brief d[key] = value
+   *
+   * @param[in] key
+   * @param[in] value
+   */
+  void set(const Key &key, T value) {
+    this->upsert(key, [&value](T &v) { v = std::move(value); });
+  }
+
+  /**
+   * @brief Python's setdefault(): insert `value` if `key` is missing
+   *
+   * @param[in] key
+   * @param[in] value
+   * @return T a copy of the value now stored for `key`
+   */
+  auto setdefault(const Key &key, const T &value) -> T {
+    auto &s = this->shard(key);
+    std::lock_guard<std::mutex> lock(s.mtx);
+    return s.map.setdefault(key, value);
+  }
+
+  /**
+   * @brief Remove `key` and return its value, or `default_value`
+   *
+   * @param[in] key
+   * @param[in] default_value
+   * @return T
+   */
+  auto pop(const Key &key, const T &default_value) -> T {
+    auto &s = this->shard(key);
+    std::lock_guard<std::mutex> lock(s.mtx);
+    return s.map.pop(key, default_value);
+  }
+
+  /**
+   * @brief Remove `key`
+   *
+   * @param[in] key
+   * @return true if it was present
+   */
+  auto erase(const Key &key) -> bool {
+    auto &s = this->shard(key);
+    std::lock_guard<std::mutex> lock(s.mtx);
+    return s.map.erase(key) != 0;
+  }
+
+  /**
+   * @brief Number of items (each shard counted under its lock, so with
+   * concurrent writers it is a moving target)
+   *
+   * @return size_t
+   */
+  auto size() const -> size_t {
+    auto n = size_t(0);
+    for (const auto &s : this->_shards) {
+      std::lock_guard<std::mutex> lock(s->mtx);
+      n += s->map.size();
+    }
+    return n;
+  }
+
+  auto empty() const -> bool { return this->size() == 0; }
+
+  void clear() {
+    for (auto &s : this->_shards) {
+      std::lock_guard<std::mutex> lock(s->mtx);
+      s->map.clear();
+    }
+  }
+
+  /**
+   * @brief A snapshot of the (key, value) pairs, one shard at a time
+   *
+   * @return std::vector<value_type>
+   */
+  auto items() const -> std::vector<value_type> {
+    auto res = std::vector<value_type>{};
+    for (const auto &s : this->_shards) {
+      std::lock_guard<std::mutex> lock(s->mtx);
+      for (const auto &kv : s->map.items()) {
+        res.emplace_back(kv.first, kv.second);
+      }
+    }
+    return res;
+  }
+
+  /**
+   * @brief Copy everything into a plain py::dict
+   *
+   * @return dict<Key, T, Hash, KeyEqual>
+   */
+  auto snapshot() const -> Map {
+    auto res = Map{};
+    for (const auto &s : this->_shards) {
+      std::lock_guard<std::mutex> lock(s->mtx);
+      res.update(s->map);
+    }
+    return res;
+  }
+
+  /**
+   * @brief Python's update(): later values win
+   *
+   * @param[in] other a py::dict (anything with items())
+   */
+  template <typename Mapping> void update(const Mapping &other) {
+    this->merge(other, [](T &dst, const T &src) { dst = src; });
+  }
+
+  /**
+   * @brief Fold a (thread-local) mapping in with `combine(dst, src)`
+   *
+   *     local_counts ... // per thread, no locking
+   *     shared.merge(local_counts, [](long &a, long b) { a += b; });
+   *
+   * The items are bucketed by shard first, so each shard lock is taken
+   * once. A missing key starts from a default-constructed T.
+   *
+   * @param[in] other a py::dict (anything with items())
+   * @param[in] combine
+   */
+  template <typename Mapping, typename Combine>
+  void merge(const Mapping &other, Combine &&combine) {
+    // bound so that a by-value items() (concurrent_dict's snapshot) lives
+    // until the buckets below are consumed
+    const auto &items = other.items();
+    using Item = typename std::decay_t<decltype(items)>::value_type;
+    auto buckets = std::vector<std::vector<const Item *>>(this->_shards.size());
+    for (const auto &kv : items) {
+      buckets[this->shard_index(kv.first)].push_back(&kv);
+    }
+    for (size_t i = 0; i != buckets.size(); ++i) {
+      if (buckets[i].empty()) {
+        continue;
+      }
+      auto &s = *this->_shards[i];
+      std::lock_guard<std::mutex> lock(s.mtx);
+      for (const auto *kv : buckets[i]) {
+        combine(s.map[kv->first], kv->second);
+      }
+    }
+  }
+
+private:
+  auto shard_index(const Key &key) const -> size_t {
+    // Fibonacci hashing: identity hashes of small ints spread too
+    const auto h = static_cast<uint64_t>(this->_hash(key));
+    return this->_shift == 64
+               ? 0
+               : static_cast<size_t>((h * 0x9e3779b97f4a7c15ULL) >>
+                                     this->_shift);
+  }
+
+  auto shard(const Key &key) const -> Shard & {
+    return *this->_shards[this->shard_index(key)];
+  }
+};
+
+/**
+ * @brief
+ *
+ * @tparam Key
+ * @tparam T
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @param[in] m
+ * @return size_t
+ */
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+inline auto len(const concurrent_dict<Key, T, Hash, KeyEqual> &m) -> size_t {
+  return m.size();
+}
+
+} // namespace py
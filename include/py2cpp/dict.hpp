@@ -1,11 +1,19 @@
 #pragma once
 
 #include <cstddef>
+#include <functional>
 #include <initializer_list>
+#include <memory>
+#include <stdexcept>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
 
+#include "arena.hpp" // import arena_allocator, PY2CPP_HAS_PMR
+#include "bulk.hpp"  // import detail::reserve_for
+#include "hash.hpp"  // import detail::enable_transparent_t
+#include "stats.hpp" // import detail::TableStatsRecorder
+
 // template <typename T> using Value_type = typename T::value_type;
 
 namespace py {
@@ -30,11 +38,17 @@ template <typename Iter> struct key_iterator : Iter {
  *
  * @tparam Key
  * @tparam T
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @tparam Allocator
  */
-template <typename Key, typename T>
-class dict : public std::unordered_map<Key, T> {
-  using Self = dict<Key, T>;
-  using Base = std::unordered_map<Key, T>;
+template <typename Key, typename T, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>,
+          typename Allocator = std::allocator<std::pair<const Key, T>>>
+class dict : public std::unordered_map<Key, T, Hash, KeyEqual, Allocator>,
+             private detail::TableStatsRecorder {
+  using Self = dict<Key, T, Hash, KeyEqual, Allocator>;
+  using Base = std::unordered_map<Key, T, Hash, KeyEqual, Allocator>;
 
 public:
   using value_type = std::pair<const Key, T>;
@@ -45,6 +59,13 @@ public:
    */
   dict() : Base{} {}
 
+  /**
+   * @brief Construct a new dict object
+   *
+   * @param[in] alloc
+   */
+  explicit dict(const Allocator &alloc) : Base(alloc) {}
+
   /**
    * @brief Construct a new dict object
    *
@@ -52,6 +73,65 @@ public:
    */
   dict(std::initializer_list<value_type> init) : Base{init} {}
 
+  /**
+   * @brief Construct a new dict object
+   *
+   * @param[in] init
+   * @param[in] alloc
+   */
+  dict(std::initializer_list<value_type> init, const Allocator &alloc)
+      : Base(init, 0, Hash(), KeyEqual(), alloc) {}
+
+  /**
+   * @brief Construct a new dict object from (key, value) pairs
+   *
+   * Reserves up front for forward iterators; later duplicates win, as in
+   * Python.
+   *
+   * @param[in] first
+   * @param[in] last
+   * @param[in] alloc
+   */
+  template <typename InputIt>
+  dict(InputIt first, InputIt last, const Allocator &alloc = Allocator())
+      : Base(alloc) {
+    this->update(first, last);
+  }
+
+  /**
+   * @brief Construct a new dict object from an iterable of (key, value)
+   * pairs, e.g. `py::dict<size_t, T>(py::enumerate(v))`
+   *
+   * @param[in] pairs
+   * @param[in] alloc
+   */
+  template <typename Iterable,
+            typename = detail::enable_iterable_t<Iterable, Self, Allocator>>
+  explicit dict(const Iterable &pairs, const Allocator &alloc = Allocator())
+      : Base(alloc) {
+    detail::reserve_for_range(*this, pairs);
+    for (const auto &kv : pairs) {
+      this->insert_or_assign_(kv.first, kv.second);
+    }
+  }
+
+  /**
+   * @brief New dict mapping every key of `keys` to `value`
+   *
+   * @param[in] keys
+   * @param[in] value
+   * @return Self
+   */
+  template <typename Iterable>
+  static auto fromkeys(const Iterable &keys, const T &value = T()) -> Self {
+    auto res = Self{};
+    detail::reserve_for_range(res, keys);
+    for (const auto &key : keys) {
+      res.emplace(key, value);
+    }
+    return res;
+  }
+
   /**
    * @brief
    *
@@ -60,21 +140,209 @@ public:
    * @return false
    */
   auto contains(const Key &key) const -> bool {
+    this->record_node_lookup(this->items(), key);
     return this->find(key) != this->end();
   }
 
   /**
-   * @brief
+   * @brief Heterogeneous contains (transparent Hash and KeyEqual only)
+   *
+   * Allocation-free with C++20; before that `key` is converted to Key.
+   *
+   * @param[in] key
+   * @return true
+   * @return false
+   */
+  template <typename K, typename H = Hash,
+            typename = detail::enable_transparent_t<H, KeyEqual>>
+  auto contains(const K &key) const -> bool {
+    return this->find_as(key) != Base::end();
+  }
+
+  /**
+   * @brief Look up `key` (one probe)
+   *
+   * @param[in] key
+   * @return T* pointer to the value, or nullptr (Python None)
+   */
+  auto get(const Key &key) -> T * {
+    this->record_node_lookup(this->items(), key);
+    auto it = Base::find(key);
+    return it == Base::end() ? nullptr : &it->second;
+  }
+
+  /**
+   * @brief Look up `key` (one probe)
+   *
+   * @param[in] key
+   * @return const T* pointer to the value, or nullptr (Python None)
+   */
+  auto get(const Key &key) const -> const T * {
+    this->record_node_lookup(this->items(), key);
+    auto it = Base::find(key);
+    return it == Base::end() ? nullptr : &it->second;
+  }
+
+  /**
+   * @brief Look up `key` (one probe, no copy)
+   *
+   * Like std::max, the result may refer to `default_value`: do not bind it
+   * to a reference that outlives a temporary default.
+   *
+   * @param[in] key
+   * @param[in] default_value
+   * @return const T&
+   */
+  auto get(const Key &key, const T &default_value) const -> const T & {
+    this->record_node_lookup(this->items(), key);
+    auto it = Base::find(key);
+    return it == Base::end() ? default_value : it->second;
+  }
+
+  /**
+   * @brief Heterogeneous get (transparent Hash and KeyEqual only)
+   *
+   * @param[in] key
+   * @param[in] default_value
+   * @return const T&
+   */
+  template <typename K, typename H = Hash,
+            typename = detail::enable_transparent_t<H, KeyEqual>>
+  auto get(const K &key, const T &default_value) const -> const T & {
+    auto it = this->find_as(key);
+    return it == Base::end() ? default_value : it->second;
+  }
+
+  /**
+   * @brief Insert `key` with `default_value` unless present (one probe)
+   *
+   * @param[in] key
+   * @param[in] default_value
+   * @return T& the stored value
+   */
+  auto setdefault(const Key &key, const T &default_value = T()) -> T & {
+    this->record_node_lookup(this->items(), key);
+#if defined(__cpp_lib_unordered_map_try_emplace)
+    return Base::try_emplace(key, default_value).first->second;
+#else
+    auto it = Base::find(key);
+    if (it != Base::end()) {
+      return it->second;
+    }
+    return Base::emplace(key, default_value).first->second;
+#endif
+  }
+
+  /**
+   * @brief Remove `key` and move its value out
+   *
+   * @param[in] key
+   * @return T
+   * @exception std::out_of_range if `key` is absent (Python KeyError)
+   */
+  auto pop(const Key &key) -> T {
+    this->record_node_lookup(this->items(), key);
+    auto it = Base::find(key);
+    if (it == Base::end()) {
+      throw std::out_of_range("dict::pop");
+    }
+    auto value = std::move(it->second);
+    Base::erase(it);
+    return value;
+  }
+
+  /**
+   * @brief Remove `key` and move its value out, or return `default_value`
    *
    * @param[in] key
    * @param[in] default_value
    * @return T
    */
-  auto get(const Key &key, const T &default_value) -> T {
-    if (!contains(key)) {
+  auto pop(const Key &key, T default_value) -> T {
+    this->record_node_lookup(this->items(), key);
+    auto it = Base::find(key);
+    if (it == Base::end()) {
       return default_value;
     }
-    return (*this)[key];
+    auto value = std::move(it->second);
+    Base::erase(it);
+    return value;
+  }
+
+  /**
+   * @brief Remove and return an arbitrary (key, value) pair
+   *
+   * @return std::pair<Key, T>
+   * @exception std::out_of_range if the dict is empty (Python KeyError)
+   */
+  auto popitem() -> std::pair<Key, T> {
+    if (this->empty()) {
+      throw std::out_of_range("dict::popitem");
+    }
+#if defined(__cpp_lib_node_extract)
+    auto node = Base::extract(Base::begin());
+    return {std::move(node.key()), std::move(node.mapped())};
+#else
+    auto it = Base::begin();
+    auto item = std::pair<Key, T>{it->first, std::move(it->second)};
+    Base::erase(it);
+    return item;
+#endif
+  }
+
+  /**
+   * @brief Insert or overwrite every item of `other`
+   *
+   * @param[in] other
+   */
+  void update(const Self &other) {
+    if (this == &other) {
+      return;
+    }
+    this->reserve(this->size() + other.size());
+    for (const auto &kv : other.items()) {
+      this->insert_or_assign_(kv.first, kv.second);
+    }
+  }
+
+  /**
+   * @brief Insert or overwrite every item of `other`, moving the values
+   *
+   * @param[in] other
+   */
+  void update(Self &&other) {
+    if (this == &other) {
+      return;
+    }
+    this->reserve(this->size() + other.size());
+    for (auto &kv : other.items()) {
+      this->insert_or_assign_(kv.first, std::move(kv.second));
+    }
+  }
+
+  /**
+   * @brief Insert or overwrite the (key, value) pairs of [first, last)
+   *
+   * Reserves up front for forward iterators.
+   *
+   * @param[in] first
+   * @param[in] last
+   */
+  template <typename InputIt> void update(InputIt first, InputIt last) {
+    detail::reserve_for(*this, first, last);
+    for (; first != last; ++first) {
+      const auto &kv = *first;
+      this->insert_or_assign_(kv.first, kv.second);
+    }
+  }
+
+  /**
+   * @brief Insert or overwrite the given (key, value) pairs
+   *
+   * @param[in] init
+   */
+  void update(std::initializer_list<value_type> init) {
+    this->update(init.begin(), init.end());
   }
 
   /**
@@ -98,14 +366,14 @@ public:
   /**
    * @brief
    *
-   * @return std::unordered_map<Key, T>&
+   * @return std::unordered_map<Key, T, Hash, KeyEqual, Allocator>&
    */
   auto items() -> Base & { return *this; }
 
   /**
    * @brief
    *
-   * @return const std::unordered_map<Key, T>&
+   * @return const std::unordered_map<Key, T, Hash, KeyEqual, Allocator>&
    */
   auto items() const -> const Base & { return *this; }
 
@@ -116,12 +384,34 @@ public:
    */
   auto copy() const -> Self { return *this; }
 
+#if defined(PY2CPP_STATS)
+  /**
+   * @brief Counters of this dict (PY2CPP_STATS only)
+   *
+   * Counts the lookups made through contains, get, [], setdefault and pop;
+   * the probe length is the bucket chain walked. Node allocations and
+   * rehashes are inferred from size() and bucket_count().
+   *
+   * @return table_stats
+   */
+  auto stats() const -> table_stats {
+    this->record_node_table(Base::size(), Base::bucket_count());
+    return this->stats_snapshot();
+  }
+
+  /**
+   * @brief Zero the counters (PY2CPP_STATS only)
+   */
+  void reset_stats() { this->stats_reset(); }
+#endif
+
   /**
    * @brief
    *
    * @return _Self&
    */
   auto operator[](const Key &k) const -> const T & {
+    this->record_node_lookup(this->items(), k);
     return this->at(k); // luk: a bug in std::unordered_map?
   }
 
@@ -130,7 +420,42 @@ public:
    *
    * @return _Self&
    */
-  auto operator[](const Key &k) -> T & { return Base::operator[](k); }
+  auto operator[](const Key &k) -> T & {
+    this->record_node_lookup(this->items(), k);
+    return Base::operator[](k);
+  }
+
+  /**
+   * @brief Heterogeneous lookup (transparent Hash and KeyEqual only)
+   *
+   * @return const T&
+   */
+  template <typename K, typename H = Hash,
+            typename = detail::enable_transparent_t<H, KeyEqual>>
+  auto operator[](const K &k) const -> const T & {
+    auto it = this->find_as(k);
+    if (it == Base::end()) {
+      throw std::out_of_range("dict::operator[]");
+    }
+    return it->second;
+  }
+
+  /**
+   * @brief Heterogeneous upsert (transparent Hash and KeyEqual only)
+   *
+   * A Key is only constructed from `k` when it is absent (with C++20).
+   *
+   * @return T&
+   */
+  template <typename K, typename H = Hash,
+            typename = detail::enable_transparent_t<H, KeyEqual>>
+  auto operator[](const K &k) -> T & {
+    auto it = this->find_as(k);
+    if (it != Base::end()) {
+      return const_cast<T &>(it->second);
+    }
+    return Base::operator[](Key(k));
+  }
 
   /**
    * @brief
@@ -150,7 +475,7 @@ public:
    * @brief Move Constructor (default)
    *
    */
-  dict(dict<Key, T> &&) noexcept = default;
+  dict(Self &&) noexcept = default;
 
   ~dict() = default;
 
@@ -160,7 +485,26 @@ public:
    *
    * Copy through explicitly the public copy() function!!!
    */
-  dict(const dict<Key, T> &) = default;
+  dict(const Self &) = default;
+
+private:
+  template <typename V> void insert_or_assign_(const Key &key, V &&value) {
+#if defined(__cpp_lib_unordered_map_try_emplace)
+    Base::insert_or_assign(key, std::forward<V>(value));
+#else
+    Base::operator[](key) = std::forward<V>(value);
+#endif
+    this->record_node_table(Base::size(), Base::bucket_count());
+  }
+
+  template <typename K>
+  auto find_as(const K &key) const -> typename Base::const_iterator {
+#if defined(PY2CPP_HAS_GENERIC_UNORDERED_LOOKUP)
+    return Base::find(key);
+#else
+    return Base::find(Key(key));
+#endif
+  }
 };
 
 /**
@@ -168,13 +512,19 @@ public:
  *
  * @tparam Key
  * @tparam T
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @tparam Allocator
  * @param[in] key
  * @param[in] m
  * @return true
  * @return false
  */
-template <typename Key, typename T>
-inline auto operator<(const Key &key, const dict<Key, T> &m) -> bool {
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Allocator>
+inline auto operator<(const Key &key,
+                      const dict<Key, T, Hash, KeyEqual, Allocator> &m)
+    -> bool {
   return m.contains(key);
 }
 
@@ -183,14 +533,72 @@ inline auto operator<(const Key &key, const dict<Key, T> &m) -> bool {
  *
  * @tparam Key
  * @tparam T
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @tparam Allocator
  * @param[in] m
  * @return size_t
  */
-template <typename Key, typename T>
-inline auto len(const dict<Key, T> &m) -> size_t {
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Allocator>
+inline auto len(const dict<Key, T, Hash, KeyEqual, Allocator> &m) -> size_t {
   return m.size();
 }
 
+/**
+ * @brief dict whose nodes are carved out of a py::arena
+ *
+ *     auto a = py::arena{};
+ *     auto d = py::arena_dict<int, double>(
+ *         py::arena_allocator<std::pair<const int, double>>(a));
+ *
+ * @tparam Key
+ * @tparam T
+ */
+template <typename Key, typename T, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+using arena_dict =
+    dict<Key, T, Hash, KeyEqual, arena_allocator<std::pair<const Key, T>>>;
+
+/**
+ * @brief Count the occurrences of each element (Python collections.Counter)
+ *
+ *     auto c = py::counter(std::string("abracadabra"));
+ *     c['a']; // 5
+ *
+ * @tparam Iterable
+ * @param[in] iterable
+ * @return dict<element type, size_t>
+ */
+template <typename Iterable>
+inline auto counter(const Iterable &iterable)
+    -> dict<detail::range_value_t<Iterable>, size_t> {
+  auto res = dict<detail::range_value_t<Iterable>, size_t>{};
+  detail::reserve_for_range(res, iterable);
+  for (const auto &key : iterable) {
+    ++res[key];
+  }
+  return res;
+}
+
+#if defined(PY2CPP_HAS_PMR)
+namespace pmr {
+
+/**
+ * @brief dict using a std::pmr::polymorphic_allocator
+ *
+ * @tparam Key
+ * @tparam T
+ */
+template <typename Key, typename T, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+using dict =
+    py::dict<Key, T, Hash, KeyEqual,
+             std::pmr::polymorphic_allocator<std::pair<const Key, T>>>;
+
+} // namespace pmr
+#endif
+
 /**
  * @brief Template Deduction Guide
  *
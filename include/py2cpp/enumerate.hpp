@@ -5,71 +5,232 @@
 #include <type_traits>
 #include <utility>
 
+#include "bulk.hpp"   // import detail::view_t, detail::capped_category_t
+#include "chunks.hpp" // import detail::make_chunks, detail::make_slice
+
 namespace py {
 
 namespace detail {
 
-template <typename T> struct EnumerateIterator {
-  typedef decltype(std::begin(std::declval<T>())) TIter;
-  using iter_ref = typename std::iterator_traits<TIter>::reference;
+/**
+ * @brief What enumerate yields: the index and a reference to the element
+ *
+ * A plain aggregate, so `for (auto [i, x] : py::enumerate(v))` unpacks it
+ * and the optimizer sees through it. `first`/`second` keep code written
+ * against the former std::pair working.
+ *
+ * @tparam Ref
+ */
+template <typename Ref> struct EnumerateProxy {
+  size_t first;
+  Ref second;
+};
 
-  size_t i;
-  TIter iter;
+template <typename Iter> struct EnumerateIterator {
+  using iterator_category = capped_category_t<Iter>;
+#if defined(__cpp_lib_ranges)
+  using iterator_concept = iterator_category;
+#endif
+  using iter_ref = decltype(*std::declval<Iter &>());
+  using value_type = EnumerateProxy<iter_ref>;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = value_type;
 
-  auto operator!=(const EnumerateIterator &other) const -> bool {
-    return iter != other.iter;
-  }
+  size_t i{};
+  Iter iter{};
 
-  EnumerateIterator &operator++() {
+  EnumerateIterator() = default;
+  EnumerateIterator(size_t i, Iter iter) : i{i}, iter{std::move(iter)} {}
+
+  auto operator*() const -> reference { return reference{i, *iter}; }
+
+  auto operator++() -> EnumerateIterator & {
     ++i;
     ++iter;
     return *this;
   }
+  auto operator++(int) -> EnumerateIterator {
+    auto temp = *this;
+    ++*this;
+    return temp;
+  }
+  auto operator--() -> EnumerateIterator & {
+    --i;
+    --iter;
+    return *this;
+  }
+  auto operator--(int) -> EnumerateIterator {
+    auto temp = *this;
+    --*this;
+    return temp;
+  }
 
-  auto operator*() const -> std::pair<size_t, iter_ref> {
-    return std::make_pair(i, *iter);
+  // random access, when Iter has it
+  auto operator+=(difference_type n) -> EnumerateIterator & {
+    i = static_cast<size_t>(static_cast<difference_type>(i) + n);
+    iter += static_cast<iterator_difference_t<Iter>>(n);
+    return *this;
+  }
+  auto operator-=(difference_type n) -> EnumerateIterator & {
+    return *this += -n;
+  }
+  auto operator[](difference_type n) const -> reference {
+    return *(*this + n);
+  }
+  friend auto operator+(EnumerateIterator it, difference_type n)
+      -> EnumerateIterator {
+    return it += n;
+  }
+  friend auto operator+(difference_type n, EnumerateIterator it)
+      -> EnumerateIterator {
+    return it += n;
+  }
+  friend auto operator-(EnumerateIterator it, difference_type n)
+      -> EnumerateIterator {
+    return it -= n;
+  }
+  friend auto operator-(const EnumerateIterator &a,
+                        const EnumerateIterator &b) -> difference_type {
+    return static_cast<difference_type>(a.iter - b.iter);
+  }
+
+  friend auto operator==(const EnumerateIterator &a,
+                         const EnumerateIterator &b) -> bool {
+    return a.iter == b.iter;
+  }
+  friend auto operator!=(const EnumerateIterator &a,
+                         const EnumerateIterator &b) -> bool {
+    return !(a.iter == b.iter);
+  }
+  friend auto operator<(const EnumerateIterator &a, const EnumerateIterator &b)
+      -> bool {
+    return a.iter < b.iter;
+  }
+  friend auto operator>(const EnumerateIterator &a, const EnumerateIterator &b)
+      -> bool {
+    return b < a;
+  }
+  friend auto operator<=(const EnumerateIterator &a,
+                         const EnumerateIterator &b) -> bool {
+    return !(b < a);
+  }
+  friend auto operator>=(const EnumerateIterator &a,
+                         const EnumerateIterator &b) -> bool {
+    return !(a < b);
   }
 };
 
+/**
+ * @brief
+ *
+ * @tparam T `X &` for an lvalue iterable, `X` for a moved-in rvalue
+ */
 template <typename T> struct EnumerateIterableWrapper {
-  T &iterable;
-  auto begin() const -> EnumerateIterator<T> {
-    return EnumerateIterator<T>{0, std::begin(iterable)};
+  using iterator = EnumerateIterator<view_iterator_t<T>>;
+  using const_iterator = iterator;
+
+  T iterable;
+  size_t start;
+
+  auto begin() const -> iterator {
+    view_t<T> r = this->iterable;
+    return iterator{this->start, std::begin(r)};
+  }
+  auto end() const -> iterator {
+    view_t<T> r = this->iterable;
+    return this->end_(std::begin(r), std::end(r),
+                      is_random_access<view_iterator_t<T>>{});
+  }
+
+  /// Available when the underlying iterable knows its size
+  template <typename U = T>
+  auto size() const -> decltype(std::declval<view_t<U>>().size()) {
+    return this->iterable.size();
   }
-  auto end() const -> EnumerateIterator<T> {
-    return EnumerateIterator<T>{0, std::end(iterable)};
+
+  /// Available when the underlying iterator is random access
+  auto operator[](size_t n) const -> typename iterator::reference {
+    return this->begin()[static_cast<std::ptrdiff_t>(n)];
+  }
+
+  /**
+   * @brief Chunks of `n` (index, element) pairs with global indices
+   *
+   * Random-access iterables only; the chunks view can be passed to
+   * parallel_for as is.
+   *
+   * @param[in] n chunk size
+   * @return ChunksView<EnumerateIterableWrapper>
+   */
+  auto chunks(size_t n) const & -> ChunksView<EnumerateIterableWrapper> {
+    return make_chunks(EnumerateIterableWrapper{*this}, n);
+  }
+
+  auto chunks(size_t n) && -> ChunksView<EnumerateIterableWrapper> {
+    return make_chunks(EnumerateIterableWrapper{std::move(*this)}, n);
+  }
+
+  /**
+   * @brief The pairs [first, last), keeping their global indices
+   *
+   * A view: the enumerate object must outlive it.
+   *
+   * @param[in] first
+   * @param[in] last clamped to size()
+   * @return Subrange<iterator>
+   */
+  auto slice(size_t first, size_t last) const -> Subrange<iterator> {
+    return make_slice(*this, first, last);
+  }
+
+private:
+  // the end index only matters when the iterator can walk back from end()
+  template <typename It>
+  auto end_(It first, It last, std::true_type) const -> iterator {
+    return iterator{this->start + static_cast<size_t>(last - first), last};
+  }
+  template <typename It>
+  auto end_(It /* first */, It last, std::false_type) const -> iterator {
+    return iterator{this->start, last};
   }
 };
 
 } // namespace detail
 
 /**
- * @brief
+ * @brief Python enumerate(iterable, start=0)
+ *
+ *     for (auto &&p : py::enumerate(v)) { p.second += p.first; }
+ *
+ * Lvalues are referenced, rvalues (e.g. `py::range(10)`) are moved in.
+ * The result is random access (with size() and operator[]) when the
+ * iterable is, so it can be handed to std algorithms and parallel_for.
  *
  * @tparam T
- * @tparam decltype(std::begin(std::declval<T>()))
- * @tparam decltype(std::end(std::declval<T>()))
  * @param[in] iterable
- * @return constexpr auto
+ * @param[in] start first index
+ * @return detail::EnumerateIterableWrapper<T>
  */
 template <typename T>
-inline auto enumerate(T &iterable) -> detail::EnumerateIterableWrapper<T> {
-  return detail::EnumerateIterableWrapper<T>{iterable};
+inline auto enumerate(T &&iterable, size_t start = 0)
+    -> detail::EnumerateIterableWrapper<T> {
+  return detail::EnumerateIterableWrapper<T>{std::forward<T>(iterable),
+                                             start};
 }
 
 /**
- * @brief
+ * @brief enumerate() with read-only access to the elements
  *
  * @tparam T
- * @tparam decltype(std::begin(std::declval<T>()))
- * @tparam decltype(std::end(std::declval<T>()))
  * @param[in] iterable
- * @return constexpr auto
+ * @param[in] start first index
+ * @return detail::EnumerateIterableWrapper<const T &>
  */
 template <typename T>
-inline auto const_enumerate(const T &iterable)
-    -> detail::EnumerateIterableWrapper<const T> {
-  return detail::EnumerateIterableWrapper<const T>{iterable};
+inline auto const_enumerate(const T &iterable, size_t start = 0)
+    -> detail::EnumerateIterableWrapper<const T &> {
+  return detail::EnumerateIterableWrapper<const T &>{iterable, start};
 }
 
 } // namespace py
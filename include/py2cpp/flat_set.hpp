@@ -0,0 +1,269 @@
+#pragma once
+
+#include <cstddef> // import size_t
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+
+#include "arena.hpp"      // import PY2CPP_HAS_PMR
+#include "flat_table.hpp" // import detail::FlatTable
+#include "set.hpp"        // import set operators
+
+namespace py {
+
+/**
+ * @brief Cache-friendly set backed by an open-addressing table
+ *
+ * Drop-in alternative to py::set: keys are stored inline (a set<int> costs
+ * 4 bytes plus one control byte per slot) and a membership test compares a
+ * whole group of 16 control bytes with one SSE2/NEON instruction before
+ * touching any key.
+ *
+ * @tparam Key
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @tparam Allocator
+ */
+template <typename Key, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>,
+          typename Allocator = std::allocator<Key>>
+class flat_set : public detail::FlatTable<detail::FlatSetPolicy<Key>, Hash,
+                                          KeyEqual, Allocator> {
+  using Self = flat_set<Key, Hash, KeyEqual, Allocator>;
+  using Base =
+      detail::FlatTable<detail::FlatSetPolicy<Key>, Hash, KeyEqual, Allocator>;
+
+public:
+  /**
+   * @brief Construct a new flat_set object
+   *
+   */
+  flat_set() : Base{} {}
+
+  /**
+   * @brief Construct a new flat_set object
+   *
+   * @param[in] alloc
+   */
+  explicit flat_set(const Allocator &alloc) : Base(alloc) {}
+
+  /**
+   * @brief Construct a new flat_set object
+   *
+   * Reserves up front for forward iterators.
+   *
+   * @param[in] start
+   * @param[in] stop
+   * @param[in] alloc
+   */
+  template <typename FwdIter>
+  flat_set(const FwdIter &start, const FwdIter &stop,
+           const Allocator &alloc = Allocator())
+      : Base(alloc) {
+    detail::reserve_for(*this, start, stop);
+    this->insert(start, stop);
+  }
+
+  /**
+   * @brief Construct a new flat_set object from an iterable, e.g.
+   * `py::flat_set<int>(py::range(10))`
+   *
+   * @param[in] iterable
+   * @param[in] alloc
+   */
+  template <typename Iterable,
+            typename = detail::enable_iterable_t<Iterable, Self, Allocator>>
+  explicit flat_set(const Iterable &iterable,
+                    const Allocator &alloc = Allocator())
+      : Base(alloc) {
+    detail::reserve_for_range(*this, iterable);
+    for (const auto &key : iterable) {
+      this->insert(key);
+    }
+  }
+
+  /**
+   * @brief Construct a new flat_set object
+   *
+   * @param[in] init
+   */
+  flat_set(std::initializer_list<Key> init) : Base{init} {}
+
+  /**
+   * @brief Construct a new flat_set object
+   *
+   * @param[in] init
+   * @param[in] alloc
+   */
+  flat_set(std::initializer_list<Key> init, const Allocator &alloc)
+      : Base(init, alloc) {}
+
+  /**
+   * @brief
+   *
+   * @param[in] key
+   * @return true
+   * @return false
+   */
+  auto contains(const Key &key) const -> bool {
+    return this->find(key) != this->end();
+  }
+
+  /**
+   * @brief Heterogeneous contains (transparent Hash and KeyEqual only)
+   *
+   * @param[in] key
+   * @return true
+   * @return false
+   */
+  template <typename K, typename H = Hash,
+            typename = detail::enable_transparent_t<H, KeyEqual>>
+  auto contains(const K &key) const -> bool {
+    return this->find(key) != this->end();
+  }
+
+  /**
+   * @brief
+   *
+   * @return Self
+   */
+  auto copy() const -> Self { return *this; }
+
+  /**
+   * @brief Test whether every element is in `other`
+   *
+   * @param[in] other
+   * @return true
+   * @return false
+   */
+  auto issubset(const Self &other) const -> bool {
+    return detail::issubset(*this, other);
+  }
+
+  /**
+   * @brief Test whether every element of `other` is in this set
+   *
+   * @param[in] other
+   * @return true
+   * @return false
+   */
+  auto issuperset(const Self &other) const -> bool {
+    return detail::issubset(other, *this);
+  }
+
+  /**
+   * @brief Test whether the two sets have no element in common
+   *
+   * @param[in] other
+   * @return true
+   * @return false
+   */
+  auto isdisjoint(const Self &other) const -> bool {
+    return detail::isdisjoint(*this, other);
+  }
+
+  /**
+   * @brief Same elements (Python set equality)
+   *
+   * @param[in] lhs
+   * @param[in] rhs
+   * @return true
+   * @return false
+   */
+  friend auto operator==(const Self &lhs, const Self &rhs) -> bool {
+    return lhs.size() == rhs.size() && detail::issubset(lhs, rhs);
+  }
+
+  friend auto operator!=(const Self &lhs, const Self &rhs) -> bool {
+    return !(lhs == rhs);
+  }
+
+  /**
+   * @brief
+   *
+   * @return Self&
+   */
+  auto operator=(const Self &) -> Self & = delete;
+
+  /**
+   * @brief
+   *
+   * @return Self&
+   */
+  auto operator=(Self &&) noexcept -> Self & = default;
+
+  /**
+   * @brief Move Constructor (default)
+   *
+   */
+  flat_set(Self &&) noexcept = default;
+
+  // private:
+  /**
+   * @brief Copy Constructor (deleted)
+   *
+   * Copy through explicitly the public copy() function!!!
+   */
+  flat_set(const Self &) = default;
+};
+
+namespace detail {
+
+template <typename Key, typename Hash, typename KeyEqual, typename Allocator>
+struct is_set_algebra<flat_set<Key, Hash, KeyEqual, Allocator>>
+    : std::true_type {};
+
+} // namespace detail
+
+/**
+ * @brief
+ *
+ * @tparam Key
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @tparam Allocator
+ * @param[in] key
+ * @param[in] m
+ * @return true
+ * @return false
+ */
+template <typename Key, typename Hash, typename KeyEqual, typename Allocator>
+inline auto operator<(const Key &key,
+                      const flat_set<Key, Hash, KeyEqual, Allocator> &m)
+    -> bool {
+  return m.contains(key);
+}
+
+/**
+ * @brief
+ *
+ * @tparam Key
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @tparam Allocator
+ * @param[in] m
+ * @return size_t
+ */
+template <typename Key, typename Hash, typename KeyEqual, typename Allocator>
+inline auto len(const flat_set<Key, Hash, KeyEqual, Allocator> &m) -> size_t {
+  return m.size();
+}
+
+#if defined(PY2CPP_HAS_PMR)
+namespace pmr {
+
+/**
+ * @brief flat_set using a std::pmr::polymorphic_allocator
+ *
+ * @tparam Key
+ */
+template <typename Key, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+using flat_set =
+    py::flat_set<Key, Hash, KeyEqual, std::pmr::polymorphic_allocator<Key>>;
+
+} // namespace pmr
+#endif
+
+} // namespace py
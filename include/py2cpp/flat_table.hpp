@@ -0,0 +1,1107 @@
+#pragma once
+
+/** @file include/py2cpp/flat_table.hpp
+ *  Open-addressing hash table shared by the flat containers.
+ *
+ *  Slots are stored inline in one contiguous array and every slot has a
+ *  one-byte control word next to it: the control bytes either mark the slot
+ *  as empty/deleted or hold 7 bits of the key's hash. Lookups scan a whole
+ *  group of control bytes at a time and only touch a slot when its byte
+ *  matches, so a successful probe usually costs a single cache miss.
+ *
+ *  With SSE2 (x86-64) or NEON (AArch64) a group is 16 control bytes checked
+ *  by a single compare; otherwise 8 bytes are checked with SWAR arithmetic.
+ *  Define PY2CPP_FLAT_NO_SIMD to force the portable group.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "bulk.hpp"  // import detail::reserve_for
+#include "hash.hpp"  // import detail::enable_transparent_t
+#include "stats.hpp" // import detail::TableStatsRecorder
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if !defined(PY2CPP_FLAT_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) ||                                   \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PY2CPP_FLAT_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define PY2CPP_FLAT_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+namespace py {
+
+namespace detail {
+
+using ctrl_t = signed char;
+
+constexpr ctrl_t kEmpty = -128;   // 0b10000000
+constexpr ctrl_t kDeleted = -2;   // 0b11111110
+constexpr ctrl_t kSentinel = -1;  // 0b11111111
+
+inline auto is_full(ctrl_t c) -> bool { return c >= 0; }
+inline auto is_empty_or_deleted(ctrl_t c) -> bool { return c < kSentinel; }
+
+inline auto countr_zero64(uint64_t x) -> int {
+#if defined(_MSC_VER)
+  unsigned long idx;
+#if defined(_M_X64) || defined(_M_ARM64)
+  _BitScanForward64(&idx, x);
+#else
+  if (static_cast<uint32_t>(x) != 0) {
+    _BitScanForward(&idx, static_cast<uint32_t>(x));
+  } else {
+    _BitScanForward(&idx, static_cast<uint32_t>(x >> 32));
+    idx += 32;
+  }
+#endif
+  return static_cast<int>(idx);
+#else
+  return __builtin_ctzll(x);
+#endif
+}
+
+/**
+ * @brief Mask of matching slots inside one group
+ *
+ * Each slot owns `1 << Shift` bits of the mask; iterating yields the slot
+ * offsets within the group in increasing order.
+ *
+ * @tparam T
+ * @tparam Shift
+ */
+template <typename T, int Shift> class BitMask {
+  T _mask;
+
+public:
+  explicit BitMask(T mask) : _mask{mask} {}
+
+  explicit operator bool() const { return this->_mask != 0; }
+
+  auto lowest_bit_set() const -> size_t {
+    return static_cast<size_t>(countr_zero64(this->_mask) >> Shift);
+  }
+
+  auto operator*() const -> size_t { return this->lowest_bit_set(); }
+
+  auto operator++() -> BitMask & {
+    this->_mask &= static_cast<T>(this->_mask - 1);
+    return *this;
+  }
+
+  auto begin() const -> BitMask { return *this; }
+  auto end() const -> BitMask { return BitMask(0); }
+
+  auto operator!=(const BitMask &other) const -> bool {
+    return this->_mask != other._mask;
+  }
+};
+
+/**
+ * @brief Portable group of 8 control bytes (SWAR on a 64-bit word)
+ *
+ * `match()` may report a false positive on the byte right after a real
+ * match; callers always confirm with a key comparison.
+ */
+struct GroupPortable {
+  static constexpr size_t kWidth = 8;
+  using mask_type = BitMask<uint64_t, 3>;
+
+  uint64_t ctrl;
+
+  explicit GroupPortable(const ctrl_t *pos) {
+    std::memcpy(&this->ctrl, pos, sizeof(this->ctrl));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    this->ctrl = __builtin_bswap64(this->ctrl);
+#endif
+  }
+
+  auto match(uint8_t h2) const -> mask_type {
+    constexpr uint64_t msbs = 0x8080808080808080ULL;
+    constexpr uint64_t lsbs = 0x0101010101010101ULL;
+    const auto x = this->ctrl ^ (lsbs * h2);
+    return mask_type((x - lsbs) & ~x & msbs);
+  }
+
+  auto match_empty() const -> mask_type {
+    constexpr uint64_t msbs = 0x8080808080808080ULL;
+    return mask_type((this->ctrl & (~this->ctrl << 6)) & msbs);
+  }
+
+  auto match_empty_or_deleted() const -> mask_type {
+    constexpr uint64_t msbs = 0x8080808080808080ULL;
+    return mask_type((this->ctrl & (~this->ctrl << 7)) & msbs);
+  }
+};
+
+#if defined(PY2CPP_FLAT_SSE2)
+
+/**
+ * @brief Group of 16 control bytes matched with SSE2
+ */
+struct GroupSse2 {
+  static constexpr size_t kWidth = 16;
+  using mask_type = BitMask<uint32_t, 0>;
+
+  __m128i ctrl;
+
+  explicit GroupSse2(const ctrl_t *pos)
+      : ctrl{_mm_loadu_si128(reinterpret_cast<const __m128i *>(pos))} {}
+
+  auto match(uint8_t h2) const -> mask_type {
+    const auto x = _mm_set1_epi8(static_cast<char>(h2));
+    return to_mask(_mm_cmpeq_epi8(x, this->ctrl));
+  }
+
+  auto match_empty() const -> mask_type {
+    const auto x = _mm_set1_epi8(static_cast<char>(kEmpty));
+    return to_mask(_mm_cmpeq_epi8(x, this->ctrl));
+  }
+
+  auto match_empty_or_deleted() const -> mask_type {
+    const auto x = _mm_set1_epi8(static_cast<char>(kSentinel));
+    return to_mask(_mm_cmpgt_epi8(x, this->ctrl));
+  }
+
+private:
+  static auto to_mask(__m128i cmp) -> mask_type {
+    return mask_type(static_cast<uint32_t>(_mm_movemask_epi8(cmp)));
+  }
+};
+
+using Group = GroupSse2;
+
+#elif defined(PY2CPP_FLAT_NEON)
+
+/**
+ * @brief Group of 16 control bytes matched with NEON
+ *
+ * The byte-wise compare result is narrowed to one nibble per slot, of which
+ * only the top bit is kept, hence a shift of 2 in the mask.
+ */
+struct GroupNeon {
+  static constexpr size_t kWidth = 16;
+  using mask_type = BitMask<uint64_t, 2>;
+
+  int8x16_t ctrl;
+
+  explicit GroupNeon(const ctrl_t *pos) : ctrl{vld1q_s8(pos)} {}
+
+  auto match(uint8_t h2) const -> mask_type {
+    return to_mask(vceqq_s8(vdupq_n_s8(static_cast<int8_t>(h2)), this->ctrl));
+  }
+
+  auto match_empty() const -> mask_type {
+    return to_mask(vceqq_s8(vdupq_n_s8(kEmpty), this->ctrl));
+  }
+
+  auto match_empty_or_deleted() const -> mask_type {
+    return to_mask(vcltq_s8(this->ctrl, vdupq_n_s8(kSentinel)));
+  }
+
+private:
+  static auto to_mask(uint8x16_t cmp) -> mask_type {
+    const auto nibbles = vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4);
+    const auto bits = vget_lane_u64(vreinterpret_u64_u8(nibbles), 0);
+    return mask_type(bits & 0x8888888888888888ULL);
+  }
+};
+
+using Group = GroupNeon;
+
+#else
+
+using Group = GroupPortable;
+
+#endif
+
+/**
+ * @brief Control bytes of a table without any slot
+ *
+ * Lookups on it stop at the first group and iteration starts at the
+ * sentinel, so an empty table needs no allocation.
+ */
+inline auto empty_group() -> ctrl_t * {
+  alignas(16) static ctrl_t group[16] = {
+      kSentinel, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty,
+      kEmpty,    kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty, kEmpty};
+  return group;
+}
+
+/**
+ * @brief Spread the bits of a (possibly identity) std::hash value
+ *
+ * @param[in] h
+ * @return size_t
+ */
+inline auto flat_hash_mix(size_t h) -> size_t {
+#if SIZE_MAX > 0xFFFFFFFFU
+  auto x = static_cast<uint64_t>(h);
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return static_cast<size_t>(x);
+#else
+  auto x = static_cast<uint32_t>(h);
+  x ^= x >> 16;
+  x *= 0x85ebca6bU;
+  x ^= x >> 13;
+  x *= 0xc2b2ae35U;
+  x ^= x >> 16;
+  return static_cast<size_t>(x);
+#endif
+}
+
+inline auto h1(size_t hash) -> size_t { return hash >> 7; }
+inline auto h2(size_t hash) -> uint8_t {
+  return static_cast<uint8_t>(hash & 0x7F);
+}
+
+/**
+ * @brief Triangular probing over groups
+ *
+ * Visits every group exactly once when (capacity + 1) is a power of two.
+ */
+class ProbeSeq {
+  size_t _mask;
+  size_t _offset;
+  size_t _index{0};
+
+public:
+  ProbeSeq(size_t hash, size_t mask) : _mask{mask}, _offset{hash & mask} {}
+
+  auto offset() const -> size_t { return this->_offset; }
+  auto offset(size_t i) const -> size_t {
+    return (this->_offset + i) & this->_mask;
+  }
+
+  void next() {
+    this->_index += Group::kWidth;
+    this->_offset = (this->_offset + this->_index) & this->_mask;
+  }
+
+  /// groups visited so far
+  auto length() const -> size_t { return this->_index / Group::kWidth + 1; }
+};
+
+/**
+ * @brief Round up to a valid capacity (2^k - 1)
+ *
+ * @param[in] n
+ * @return size_t
+ */
+inline auto normalize_capacity(size_t n) -> size_t {
+  size_t cap = 1;
+  while (cap < n) {
+    cap = cap * 2 + 1;
+  }
+  return cap;
+}
+
+/**
+ * @brief Maximum number of elements for a capacity (load factor 7/8)
+ *
+ * @param[in] cap
+ * @return size_t
+ */
+inline auto capacity_to_growth(size_t cap) -> size_t {
+  if (Group::kWidth == 8 && cap == 7) {
+    return 6; // a full group of 8 would never see an empty slot
+  }
+  return cap - cap / 8;
+}
+
+/**
+ * @brief Minimum capacity that holds `n` elements without rehashing
+ *
+ * @param[in] n
+ * @return size_t
+ */
+inline auto growth_to_lower_bound_capacity(size_t n) -> size_t {
+  if (Group::kWidth == 8 && n == 7) {
+    return 8;
+  }
+  return n + static_cast<size_t>((static_cast<int64_t>(n) - 1) / 7);
+}
+
+/**
+ * @brief Policy of a map-like flat table: slots are key/value pairs
+ *
+ * @tparam Key
+ * @tparam T
+ */
+template <typename Key, typename T> struct FlatMapPolicy {
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const Key, T>;
+  static constexpr bool constant_iterators = false;
+
+  static auto key(const value_type &v) -> const Key & { return v.first; }
+};
+
+/**
+ * @brief Policy of a set-like flat table: slots are the keys themselves
+ *
+ * @tparam Key
+ */
+template <typename Key> struct FlatSetPolicy {
+  using key_type = Key;
+  using value_type = Key;
+  static constexpr bool constant_iterators = true;
+
+  static auto key(const value_type &v) -> const Key & { return v; }
+};
+
+/**
+ * @brief Iterator over the full slots of a flat table
+ *
+ * @tparam Value value_type (const-qualified for const_iterator)
+ */
+template <typename Value> class FlatTableIterator {
+  template <typename, typename, typename, typename> friend class FlatTable;
+  template <typename> friend class FlatTableIterator;
+
+  ctrl_t *_ctrl{nullptr};
+  Value *_slot{nullptr};
+
+  FlatTableIterator(ctrl_t *ctrl, Value *slot) : _ctrl{ctrl}, _slot{slot} {}
+
+  void skip_empty_or_deleted() {
+    while (is_empty_or_deleted(*this->_ctrl)) {
+      ++this->_ctrl;
+      ++this->_slot;
+    }
+  }
+
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = typename std::remove_const<Value>::type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = Value *;
+  using reference = Value &;
+
+  FlatTableIterator() = default;
+
+  /**
+   * @brief iterator -> const_iterator conversion
+   */
+  template <typename Other,
+            typename = typename std::enable_if<
+                std::is_same<const Other, Value>::value &&
+                !std::is_same<Other, Value>::value>::type>
+  FlatTableIterator(const FlatTableIterator<Other> &other)
+      : _ctrl{other._ctrl}, _slot{other._slot} {}
+
+  auto operator*() const -> reference { return *this->_slot; }
+  auto operator->() const -> pointer { return this->_slot; }
+
+  auto operator++() -> FlatTableIterator & {
+    ++this->_ctrl;
+    ++this->_slot;
+    this->skip_empty_or_deleted();
+    return *this;
+  }
+
+  auto operator++(int) -> FlatTableIterator {
+    auto old = *this;
+    ++*this;
+    return old;
+  }
+
+  auto operator==(const FlatTableIterator &other) const -> bool {
+    return this->_ctrl == other._ctrl;
+  }
+
+  auto operator!=(const FlatTableIterator &other) const -> bool {
+    return this->_ctrl != other._ctrl;
+  }
+};
+
+/**
+ * @brief Open-addressing hash table with inline slots and control bytes
+ *
+ * The table owns `capacity` slots (capacity is always 2^k - 1), followed in
+ * the control array by a sentinel and a copy of the first `Group::kWidth - 1`
+ * control bytes, so that a group can be loaded at any offset without wrapping.
+ *
+ * Both arrays are obtained from `Allocator` (rebound to the slot and to the
+ * control byte types), so the table can live in an arena or a std::pmr
+ * memory resource.
+ *
+ * @tparam Policy FlatMapPolicy or FlatSetPolicy
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @tparam Allocator
+ */
+template <typename Policy, typename Hash, typename KeyEqual,
+          typename Allocator = std::allocator<typename Policy::value_type>>
+class FlatTable : private TableStatsRecorder {
+public:
+  using key_type = typename Policy::key_type;
+  using value_type = typename Policy::value_type;
+  using size_type = size_t;
+  using difference_type = std::ptrdiff_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using allocator_type = Allocator;
+  using reference = value_type &;
+  using const_reference = const value_type &;
+  using const_iterator = FlatTableIterator<const value_type>;
+  using iterator =
+      typename std::conditional<Policy::constant_iterators, const_iterator,
+                                FlatTableIterator<value_type>>::type;
+
+private:
+  using alloc_traits = std::allocator_traits<Allocator>;
+  using slot_alloc =
+      typename alloc_traits::template rebind_alloc<value_type>;
+  using slot_traits = std::allocator_traits<slot_alloc>;
+  using ctrl_alloc = typename alloc_traits::template rebind_alloc<ctrl_t>;
+  using ctrl_traits = std::allocator_traits<ctrl_alloc>;
+
+  ctrl_t *_ctrl{empty_group()};
+  value_type *_slots{nullptr};
+  size_t _size{0};
+  size_t _capacity{0};
+  size_t _growth_left{0};
+  size_t _full_end{0}; // no slot at or after it is full (see last())
+  Hash _hash{};
+  KeyEqual _eq{};
+  slot_alloc _alloc{};
+
+public:
+  /**
+   * @brief Construct a new empty table (no allocation)
+   *
+   */
+  FlatTable() = default;
+
+  /**
+   * @brief Construct a new empty table using `alloc` (no allocation)
+   *
+   * @param[in] alloc
+   */
+  explicit FlatTable(const allocator_type &alloc) : _alloc(alloc) {}
+
+  /**
+   * @brief Construct a new table from an initializer list
+   *
+   * @param[in] init
+   * @param[in] alloc
+   */
+  FlatTable(std::initializer_list<value_type> init,
+            const allocator_type &alloc = allocator_type())
+      : _alloc(alloc) {
+    this->reserve(init.size());
+    for (const auto &v : init) {
+      this->insert(v);
+    }
+  }
+
+  FlatTable(const FlatTable &other)
+      : FlatTable(other,
+                  slot_traits::select_on_container_copy_construction(
+                      other._alloc)) {}
+
+  FlatTable(const FlatTable &other, const allocator_type &alloc)
+      : _hash{other._hash}, _eq{other._eq}, _alloc(alloc) {
+    this->reserve(other._size);
+    for (const auto &v : other) {
+      this->insert_unique_unchecked(v);
+    }
+  }
+
+  FlatTable(FlatTable &&other) noexcept
+      : _ctrl{other._ctrl}, _slots{other._slots}, _size{other._size},
+        _capacity{other._capacity}, _growth_left{other._growth_left},
+        _full_end{other._full_end}, _hash{std::move(other._hash)}, _eq{std::move(other._eq)},
+        _alloc{std::move(other._alloc)} {
+    other.reset_to_empty();
+  }
+
+  auto operator=(const FlatTable &other) -> FlatTable & {
+    if (this != &other) {
+      auto tmp = FlatTable(other, this->copy_assign_alloc(other));
+      this->steal(
+          tmp,
+          typename slot_traits::propagate_on_container_copy_assignment{});
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Move assignment
+   *
+   * Steals the slots unless the allocators are unequal and do not
+   * propagate, in which case the elements are moved one by one.
+   */
+  auto operator=(FlatTable &&other) noexcept(
+      slot_traits::propagate_on_container_move_assignment::value)
+      -> FlatTable & {
+    if (this != &other) {
+      if (slot_traits::propagate_on_container_move_assignment::value ||
+          this->_alloc == other._alloc) {
+        this->steal(
+            other,
+            typename slot_traits::propagate_on_container_move_assignment{});
+      } else {
+        this->clear();
+        this->_hash = other._hash;
+        this->_eq = other._eq;
+        this->reserve(other._size);
+        for (auto &v : other) {
+          this->insert_unique_unchecked(std::move(v));
+        }
+        other.clear();
+      }
+    }
+    return *this;
+  }
+
+  ~FlatTable() { this->destroy_and_deallocate(); }
+
+  void swap(FlatTable &other) noexcept {
+    using std::swap;
+    swap(this->_ctrl, other._ctrl);
+    swap(this->_slots, other._slots);
+    swap(this->_size, other._size);
+    swap(this->_capacity, other._capacity);
+    swap(this->_growth_left, other._growth_left);
+    swap(this->_full_end, other._full_end);
+    swap(this->_hash, other._hash);
+    swap(this->_eq, other._eq);
+    swap_alloc(this->_alloc, other._alloc,
+               typename slot_traits::propagate_on_container_swap{});
+  }
+
+  auto get_allocator() const -> allocator_type {
+    return allocator_type(this->_alloc);
+  }
+
+  auto begin() -> iterator {
+    auto it = iterator{this->_ctrl, this->_slots};
+    it.skip_empty_or_deleted();
+    return it;
+  }
+  auto end() -> iterator {
+    return iterator{this->_ctrl + this->_capacity,
+                    this->_slots + this->_capacity};
+  }
+  auto begin() const -> const_iterator {
+    return const_cast<FlatTable *>(this)->begin();
+  }
+  auto end() const -> const_iterator {
+    return const_cast<FlatTable *>(this)->end();
+  }
+  auto cbegin() const -> const_iterator { return this->begin(); }
+  auto cend() const -> const_iterator { return this->end(); }
+
+  auto size() const -> size_t { return this->_size; }
+  auto empty() const -> bool { return this->_size == 0; }
+  auto capacity() const -> size_t { return this->_capacity; }
+  auto max_size() const -> size_t {
+    return slot_traits::max_size(this->_alloc);
+  }
+  auto load_factor() const -> float {
+    return this->_capacity == 0 ? 0.0F
+                                : static_cast<float>(this->_size) /
+                                      static_cast<float>(this->_capacity);
+  }
+  auto hash_function() const -> hasher { return this->_hash; }
+  auto key_eq() const -> key_equal { return this->_eq; }
+
+#if defined(PY2CPP_STATS)
+  /**
+   * @brief Counters of this table (PY2CPP_STATS only)
+   *
+   * Every probe counts as a lookup, inserts included; the probe length is
+   * the number of groups scanned.
+   *
+   * @return table_stats
+   */
+  auto stats() const -> table_stats { return this->stats_snapshot(); }
+
+  /**
+   * @brief Zero the counters (PY2CPP_STATS only)
+   */
+  void reset_stats() { this->stats_reset(); }
+#endif
+
+  /**
+   * @brief Destroy all elements, keeping the allocated slots
+   *
+   */
+  void clear() {
+    if (this->_capacity == 0) {
+      return;
+    }
+    this->destroy_slots();
+    this->reset_ctrl();
+    this->_size = 0;
+    this->_growth_left = capacity_to_growth(this->_capacity);
+  }
+
+  /**
+   * @brief Make room for at least `n` elements without rehashing
+   *
+   * @param[in] n
+   */
+  void reserve(size_t n) {
+    if (n > this->_size + this->_growth_left) {
+      this->resize(normalize_capacity(growth_to_lower_bound_capacity(n)));
+    }
+  }
+
+  /**
+   * @brief Rehash so that the capacity holds at least `n` elements
+   *
+   * @param[in] n
+   */
+  void rehash(size_t n) {
+    if (n == 0 && this->_capacity == 0) {
+      return;
+    }
+    if (n == 0 && this->_size == 0) {
+      this->destroy_and_deallocate();
+      this->reset_to_empty();
+      return;
+    }
+    auto m = normalize_capacity(
+        std::max(n, growth_to_lower_bound_capacity(this->_size)));
+    if (n == 0 || m > this->_capacity) {
+      this->resize(m);
+    }
+  }
+
+  auto find(const key_type &key) -> iterator {
+    return this->find_impl(key, this->hash_of(key));
+  }
+
+  auto find(const key_type &key) const -> const_iterator {
+    return const_cast<FlatTable *>(this)->find(key);
+  }
+
+  /**
+   * @brief Heterogeneous lookup (transparent Hash and KeyEqual only)
+   *
+   * @param[in] key any type the hash and the equality accept
+   */
+  template <typename K, typename H = Hash,
+            typename = enable_transparent_t<H, KeyEqual>>
+  auto find(const K &key) -> iterator {
+    return this->find_impl(key, this->hash_of(key));
+  }
+
+  template <typename K, typename H = Hash,
+            typename = enable_transparent_t<H, KeyEqual>>
+  auto find(const K &key) const -> const_iterator {
+    return const_cast<FlatTable *>(this)->find(key);
+  }
+
+  auto count(const key_type &key) const -> size_t {
+    return this->find(key) == this->end() ? 0U : 1U;
+  }
+
+  template <typename K, typename H = Hash,
+            typename = enable_transparent_t<H, KeyEqual>>
+  auto count(const K &key) const -> size_t {
+    return this->find(key) == this->end() ? 0U : 1U;
+  }
+
+  auto insert(const value_type &value) -> std::pair<iterator, bool> {
+    return this->emplace_key(Policy::key(value), value);
+  }
+
+  auto insert(value_type &&value) -> std::pair<iterator, bool> {
+    const auto &key = Policy::key(value);
+    return this->emplace_key(key, std::move(value));
+  }
+
+  template <typename InputIt> void insert(InputIt first, InputIt last) {
+    reserve_for(*this, first, last);
+    for (; first != last; ++first) {
+      this->insert(*first);
+    }
+  }
+
+  void insert(std::initializer_list<value_type> init) {
+    this->insert(init.begin(), init.end());
+  }
+
+  /**
+   * @brief Construct an element in place if its key is not present
+   *
+   * The element is built on the stack first to learn its key, so prefer
+   * try_emplace() for maps.
+   */
+  template <typename... Args>
+  auto emplace(Args &&...args) -> std::pair<iterator, bool> {
+    value_type value(std::forward<Args>(args)...);
+    return this->insert(std::move(value));
+  }
+
+  /**
+   * @brief Insert `{key, T(args...)}` if `key` is not present (maps only)
+   *
+   * Nothing is constructed when the key already exists.
+   */
+  template <typename... Args>
+  auto try_emplace(const key_type &key, Args &&...args)
+      -> std::pair<iterator, bool> {
+    return this->emplace_key(key, std::piecewise_construct,
+                             std::forward_as_tuple(key),
+                             std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  /**
+   * @brief try_emplace() with a heterogeneous key
+   *
+   * The stored key is only constructed from `key` when it is absent.
+   */
+  template <typename K, typename... Args, typename H = Hash,
+            typename = enable_transparent_t<H, KeyEqual>,
+            typename = typename std::enable_if<
+                !std::is_same<typename std::decay<K>::type,
+                              key_type>::value>::type>
+  auto try_emplace(const K &key, Args &&...args) -> std::pair<iterator, bool> {
+    return this->emplace_key(key, std::piecewise_construct,
+                             std::forward_as_tuple(key),
+                             std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  template <typename... Args>
+  auto try_emplace(key_type &&key, Args &&...args)
+      -> std::pair<iterator, bool> {
+    const auto hash = this->hash_of(key);
+    auto res = this->find_or_prepare_insert(key, hash);
+    if (res.second) {
+      this->construct_at(res.first, std::piecewise_construct,
+                         std::forward_as_tuple(std::move(key)),
+                         std::forward_as_tuple(std::forward<Args>(args)...));
+      this->set_ctrl(res.first, h2(hash));
+      ++this->_size;
+    }
+    return {this->iterator_at(res.first), res.second};
+  }
+
+  /**
+   * @brief Erase the element at `pos`
+   *
+   * @param[in] pos
+   * @return iterator following the removed element
+   */
+  auto erase(const_iterator pos) -> iterator {
+    const auto i = static_cast<size_t>(pos._ctrl - this->_ctrl);
+    this->erase_at(i);
+    auto it = this->iterator_at(i);
+    it.skip_empty_or_deleted();
+    return it;
+  }
+
+  /**
+   * @brief Erase the element at `pos`, without looking for the next one
+   *
+   * @param[in] pos
+   */
+  void discard(const_iterator pos) {
+    this->erase_at(static_cast<size_t>(pos._ctrl - this->_ctrl));
+  }
+
+  auto erase(const key_type &key) -> size_t {
+    auto it = this->find(key);
+    if (it == this->end()) {
+      return 0;
+    }
+    this->erase_at(static_cast<size_t>(it._ctrl - this->_ctrl));
+    return 1;
+  }
+
+  /**
+   * @brief The element in the highest full slot, or end() if empty
+   *
+   * Unlike begin(), it does not rescan the slots emptied by previous
+   * erasures of the last element, so draining a table with
+   * `discard(last())` is O(capacity) overall (popitem()).
+   *
+   * @return iterator
+   */
+  auto last() -> iterator {
+    while (this->_full_end != 0 &&
+           !is_full(this->_ctrl[this->_full_end - 1])) {
+      --this->_full_end;
+    }
+    return this->_full_end == 0 ? this->end()
+                                : this->iterator_at(this->_full_end - 1);
+  }
+
+protected:
+  template <typename K> auto hash_of(const K &key) const -> size_t {
+    return flat_hash_mix(this->_hash(key));
+  }
+
+  auto iterator_at(size_t i) -> iterator {
+    return iterator{this->_ctrl + i, this->_slots + i};
+  }
+
+  template <typename K> auto find_impl(const K &key, size_t hash) -> iterator {
+    auto seq = ProbeSeq{h1(hash), this->_capacity};
+    while (true) {
+      const auto g = Group{this->_ctrl + seq.offset()};
+      for (auto i : g.match(h2(hash))) {
+        const auto idx = seq.offset(i);
+        if (this->_eq(Policy::key(this->_slots[idx]), key)) {
+          this->record_lookup(seq.length());
+          return this->iterator_at(idx);
+        }
+      }
+      if (g.match_empty()) {
+        this->record_lookup(seq.length());
+        return this->end();
+      }
+      seq.next();
+    }
+  }
+
+  /**
+   * @brief Locate `key`, or reserve a slot for it
+   *
+   * @return {slot index, true if the slot is free and must be constructed}
+   */
+  template <typename K>
+  auto find_or_prepare_insert(const K &key, size_t hash)
+      -> std::pair<size_t, bool> {
+    auto seq = ProbeSeq{h1(hash), this->_capacity};
+    while (true) {
+      const auto g = Group{this->_ctrl + seq.offset()};
+      for (auto i : g.match(h2(hash))) {
+        const auto idx = seq.offset(i);
+        if (this->_eq(Policy::key(this->_slots[idx]), key)) {
+          this->record_lookup(seq.length());
+          return {idx, false};
+        }
+      }
+      if (g.match_empty()) {
+        break;
+      }
+      seq.next();
+    }
+    this->record_lookup(seq.length());
+    return {this->prepare_insert(hash), true};
+  }
+
+  auto find_first_non_full(size_t hash) const -> size_t {
+    auto seq = ProbeSeq{h1(hash), this->_capacity};
+    while (true) {
+      const auto g = Group{this->_ctrl + seq.offset()};
+      const auto mask = g.match_empty_or_deleted();
+      if (mask) {
+        return seq.offset(mask.lowest_bit_set());
+      }
+      seq.next();
+    }
+  }
+
+  auto prepare_insert(size_t hash) -> size_t {
+    auto target = this->find_first_non_full(hash);
+    if (this->_growth_left == 0 && this->_ctrl[target] != kDeleted) {
+      this->rehash_and_grow_if_necessary();
+      target = this->find_first_non_full(hash);
+    }
+    if (this->_ctrl[target] == kEmpty) {
+      --this->_growth_left;
+    }
+    return target;
+  }
+
+  template <typename K, typename... Args>
+  auto emplace_key(const K &key, Args &&...args)
+      -> std::pair<iterator, bool> {
+    const auto hash = this->hash_of(key);
+    auto res = this->find_or_prepare_insert(key, hash);
+    if (res.second) {
+      this->construct_at(res.first, std::forward<Args>(args)...);
+      this->set_ctrl(res.first, h2(hash));
+      ++this->_size;
+    }
+    return {this->iterator_at(res.first), res.second};
+  }
+
+  /**
+   * @brief Insert a value known to be absent (copy, rehash)
+   */
+  template <typename V> void insert_unique_unchecked(V &&value) {
+    const auto hash = this->hash_of(Policy::key(value));
+    const auto target = this->prepare_insert(hash);
+    this->construct_at(target, std::forward<V>(value));
+    this->set_ctrl(target, h2(hash));
+    ++this->_size;
+  }
+
+  template <typename... Args> void construct_at(size_t i, Args &&...args) {
+    slot_traits::construct(this->_alloc, this->_slots + i,
+                           std::forward<Args>(args)...);
+  }
+
+  void set_ctrl(size_t i, ctrl_t h) {
+    if (is_full(h) && i >= this->_full_end) {
+      this->_full_end = i + 1;
+    }
+    this->_ctrl[i] = h;
+    this->_ctrl[((i - (Group::kWidth - 1)) & this->_capacity) +
+                ((Group::kWidth - 1) & this->_capacity)] = h;
+  }
+
+  void set_ctrl(size_t i, uint8_t h) { this->set_ctrl(i, static_cast<ctrl_t>(h)); }
+
+  void erase_at(size_t i) {
+    slot_traits::destroy(this->_alloc, this->_slots + i);
+    this->set_ctrl(i, kDeleted);
+    --this->_size;
+  }
+
+  void rehash_and_grow_if_necessary() {
+    if (this->_capacity == 0) {
+      this->resize(1);
+    } else if (this->_size * 32 <= this->_capacity * 25) {
+      // mostly tombstones: rebuild in place instead of growing
+      this->resize(this->_capacity);
+    } else {
+      this->resize(this->_capacity * 2 + 1);
+    }
+  }
+
+  void resize(size_t new_capacity) {
+    auto *old_ctrl = this->_ctrl;
+    auto *old_slots = this->_slots;
+    const auto old_capacity = this->_capacity;
+
+    if (old_capacity != 0) {
+      this->record_rehash();
+    }
+    this->_size = 0;
+    this->allocate(new_capacity);
+    for (size_t i = 0; i != old_capacity; ++i) {
+      if (is_full(old_ctrl[i])) {
+        this->insert_unique_unchecked(std::move(old_slots[i]));
+        slot_traits::destroy(this->_alloc, old_slots + i);
+      }
+    }
+    if (old_capacity != 0) {
+      this->deallocate(old_ctrl, old_slots, old_capacity);
+    }
+  }
+
+  static auto ctrl_bytes(size_t capacity) -> size_t {
+    return capacity + 1 + Group::kWidth - 1;
+  }
+
+  void allocate(size_t capacity) {
+    auto calloc = ctrl_alloc(this->_alloc);
+    this->_ctrl = ctrl_traits::allocate(calloc, ctrl_bytes(capacity));
+    this->_slots = slot_traits::allocate(this->_alloc, capacity);
+    this->record_allocation(2);
+    this->_capacity = capacity;
+    this->reset_ctrl();
+    this->_growth_left = capacity_to_growth(capacity) - this->_size;
+  }
+
+  void reset_ctrl() {
+    std::memset(this->_ctrl, kEmpty, ctrl_bytes(this->_capacity));
+    this->_ctrl[this->_capacity] = kSentinel;
+    this->_full_end = 0;
+  }
+
+  void deallocate(ctrl_t *ctrl, value_type *slots, size_t capacity) {
+    auto calloc = ctrl_alloc(this->_alloc);
+    ctrl_traits::deallocate(calloc, ctrl, ctrl_bytes(capacity));
+    slot_traits::deallocate(this->_alloc, slots, capacity);
+  }
+
+  void destroy_slots() {
+    for (size_t i = 0; i != this->_capacity; ++i) {
+      if (is_full(this->_ctrl[i])) {
+        slot_traits::destroy(this->_alloc, this->_slots + i);
+      }
+    }
+  }
+
+  void destroy_and_deallocate() {
+    if (this->_capacity == 0) {
+      return;
+    }
+    this->destroy_slots();
+    this->deallocate(this->_ctrl, this->_slots, this->_capacity);
+  }
+
+  auto copy_assign_alloc(const FlatTable &other) const -> slot_alloc {
+    return slot_traits::propagate_on_container_copy_assignment::value
+               ? other._alloc
+               : this->_alloc;
+  }
+
+  /**
+   * @brief Release our storage and take over the storage of `other`
+   *
+   * The allocator is only replaced when it propagates; otherwise the caller
+   * guarantees that both allocators compare equal.
+   */
+  template <typename Propagate> void steal(FlatTable &other, Propagate) {
+    this->destroy_and_deallocate();
+    this->_ctrl = other._ctrl;
+    this->_slots = other._slots;
+    this->_size = other._size;
+    this->_capacity = other._capacity;
+    this->_growth_left = other._growth_left;
+    this->_full_end = other._full_end;
+    this->_hash = std::move(other._hash);
+    this->_eq = std::move(other._eq);
+    assign_alloc(this->_alloc, other._alloc, Propagate{});
+    other.reset_to_empty();
+  }
+
+  static void assign_alloc(slot_alloc &a, const slot_alloc &b,
+                           std::true_type) {
+    a = b;
+  }
+
+  static void assign_alloc(slot_alloc &, const slot_alloc &, std::false_type) {
+  }
+
+  static void swap_alloc(slot_alloc &a, slot_alloc &b, std::true_type) {
+    using std::swap;
+    swap(a, b);
+  }
+
+  static void swap_alloc(slot_alloc &, slot_alloc &, std::false_type) {}
+
+  void reset_to_empty() {
+    this->_ctrl = empty_group();
+    this->_slots = nullptr;
+    this->_size = 0;
+    this->_capacity = 0;
+    this->_growth_left = 0;
+    this->_full_end = 0;
+  }
+};
+
+} // namespace detail
+
+} // namespace py
@@ -0,0 +1,415 @@
+#pragma once
+
+/** @file include/py2cpp/fraction_array.hpp
+ *  Struct-of-arrays storage for fractions, and batch kernels over it.
+ *
+ *      auto xs = fun::FractionArray<int64_t>{{1, 3}, {1, 6}, {1, 2}};
+ *      auto total = fun::sum(xs);  // 1, with one gcd instead of three
+ *
+ *  Elements are stored normalized, numerators and denominators in two
+ *  contiguous vectors. The reductions (sum, dot) keep an unreduced
+ *  accumulator in the double-width type of Z and only reduce (with gcds
+ *  on Z) when it is about to leave the range of Z, and once at the end;
+ *  when all denominators are equal (a shared scale, or integers) the
+ *  numerators are summed in a plain loop the compiler can vectorize.
+ *  Elementwise results are stored normalized, so those kernels still cost
+ *  a gcd per element.
+ */
+
+#include <cstddef>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "fractions.hpp" // import fun::Fraction, fun::detail::Wider
+
+namespace fun {
+
+/**
+ * @brief A sequence of Fraction<Z>, stored as numerators and denominators
+ *
+ * @tparam Z
+ */
+template <typename Z> struct FractionArray {
+  using value_type = Fraction<Z>;
+
+  std::vector<Z> _nums;
+  std::vector<Z> _dens;
+
+  FractionArray() = default;
+
+  /**
+   * @brief Construct `n` zeros
+   *
+   * @param[in] n
+   */
+  explicit FractionArray(size_t n) : _nums(n, Z(0)), _dens(n, Z(1)) {}
+
+  FractionArray(std::initializer_list<Fraction<Z>> init) {
+    this->reserve(init.size());
+    for (const auto &f : init) {
+      this->push_back(f);
+    }
+  }
+
+  template <typename FwdIter> FractionArray(FwdIter first, FwdIter last) {
+    for (; first != last; ++first) {
+      this->push_back(*first);
+    }
+  }
+
+  auto size() const noexcept -> size_t { return this->_nums.size(); }
+  auto empty() const noexcept -> bool { return this->_nums.empty(); }
+
+  void reserve(size_t n) {
+    this->_nums.reserve(n);
+    this->_dens.reserve(n);
+  }
+
+  void push_back(const Fraction<Z> &f) {
+    this->_nums.push_back(f._num);
+    this->_dens.push_back(f._den);
+  }
+
+  /// Appends num/den, normalized
+  void push_back(Z num, Z den) {
+    this->push_back(Fraction<Z>(std::move(num), std::move(den)));
+  }
+
+  /// The i-th element, by value
+  auto operator[](size_t i) const -> Fraction<Z> {
+    auto f = Fraction<Z>{};
+    f._num = this->_nums[i];
+    f._den = this->_dens[i];
+    return f;
+  }
+
+  void set(size_t i, const Fraction<Z> &f) {
+    this->_nums[i] = f._num;
+    this->_dens[i] = f._den;
+  }
+};
+
+namespace detail {
+
+inline void check_same_size(size_t m, size_t n) {
+  if (m != n) {
+    throw std::invalid_argument("FractionArray: size mismatch");
+  }
+}
+
+template <typename Z> inline auto all_equal(const std::vector<Z> &v) -> bool {
+  const auto n = v.size();
+  auto same = true; // no early exit, so the loop vectorizes
+  for (size_t i = 1; i < n; ++i) {
+    same &= (v[i] == v[0]);
+  }
+  return same;
+}
+
+/**
+ * @brief Running sum of fractions, reduced only when it must be
+ *
+ * With a double-width type W the accumulator n/d stays unreduced as
+ * long as both fit in Z, so the next cross multiplication cannot
+ * overflow W. A sum that would not fit is redone as a reduced Fraction<Z>
+ * addition, so every gcd runs on Z. Infinities and nans are summed apart
+ * and added last.
+ */
+template <typename Z, int Guard = overflow_guard<Z>::value> struct LazySum {
+  using W = typename Wider<Z>::type;
+
+  W n{0};
+  W d{1};
+  Fraction<Z> special{};
+
+  void add(const Z &num, const Z &den) {
+    if (den == Z(0)) {
+      this->special += Fraction<Z>(num, den);
+      return;
+    }
+    const auto n2 = W(den) == this->d
+                        ? this->n + W(num)
+                        : this->n * W(den) + W(num) * this->d;
+    const auto d2 = W(den) == this->d ? this->d : this->d * W(den);
+    if (fits(n2) && fits(d2)) {
+      this->n = n2;
+      this->d = d2;
+      return;
+    }
+    // throws if even the reduced sum leaves Z
+    auto rhs = Fraction<Z>{};
+    rhs._num = num;
+    rhs._den = den;
+    const auto acc = this->reduced() + rhs;
+    this->n = W(acc._num);
+    this->d = W(acc._den);
+  }
+
+  /// Adds (sum of nums) / den, den > 0
+  void add_wide(W num, const Z &den) {
+    // gcd(num, den) = gcd(num mod den, den), which is on Z
+    const auto g = fun::gcd(static_cast<Z>(num % W(den)), den);
+    if (g > Z(1)) {
+      num /= W(g);
+    }
+    this->add(narrow<Z>(num), g > Z(1) ? Z(den / g) : den);
+  }
+
+  auto result() -> Fraction<Z> { return this->reduced() + this->special; }
+
+private:
+  static auto fits(const W &x) -> bool {
+    return W(-std::numeric_limits<Z>::max()) <= x &&
+           x <= W(std::numeric_limits<Z>::max());
+  }
+
+  // n and d fit in Z, so this reduces on Z
+  auto reduced() const -> Fraction<Z> {
+    return Fraction<Z>(static_cast<Z>(this->n), static_cast<Z>(this->d));
+  }
+};
+
+/// Without a double-width type: plain Fraction additions
+template <typename Z> struct LazySumFallback {
+  Fraction<Z> acc{};
+
+  void add(const Z &num, const Z &den) {
+    auto f = Fraction<Z>{};
+    f._num = num;
+    f._den = den;
+    this->acc += f;
+  }
+
+  auto result() -> Fraction<Z> { return this->acc; }
+};
+
+template <typename Z> struct LazySum<Z, 1> : LazySumFallback<Z> {};
+template <typename Z> struct LazySum<Z, 0> : LazySumFallback<Z> {};
+
+template <typename Z>
+inline auto sum(const FractionArray<Z> &a, std::integral_constant<int, 2>)
+    -> Fraction<Z> {
+  using W = typename Wider<Z>::type;
+  auto acc = LazySum<Z>{};
+  if (!a.empty() && a.size() <= size_t(std::numeric_limits<Z>::max()) &&
+      a._dens[0] != Z(0) && all_equal(a._dens)) {
+    // a shared denominator: m numerators sum to at most m * 2^(bits-1),
+    // which fits in W for m <= max()
+    auto total = W(0);
+    for (const auto &num : a._nums) {
+      total += W(num);
+    }
+    acc.add_wide(total, a._dens[0]);
+    return acc.result();
+  }
+  for (size_t i = 0; i != a.size(); ++i) {
+    acc.add(a._nums[i], a._dens[i]);
+  }
+  return acc.result();
+}
+
+template <typename Z, int Guard>
+inline auto sum(const FractionArray<Z> &a, std::integral_constant<int, Guard>)
+    -> Fraction<Z> {
+  auto acc = LazySum<Z>{};
+  for (size_t i = 0; i != a.size(); ++i) {
+    acc.add(a._nums[i], a._dens[i]);
+  }
+  return acc.result();
+}
+
+template <typename Z, int Guard>
+inline auto dot(const FractionArray<Z> &a, const FractionArray<Z> &b,
+                std::integral_constant<int, Guard>) -> Fraction<Z> {
+  auto acc = LazySum<Z>{};
+  for (size_t i = 0; i != a.size(); ++i) {
+    const auto prod = a[i] * b[i];
+    acc.add(prod._num, prod._den);
+  }
+  return acc.result();
+}
+
+template <typename Z>
+inline auto dot(const FractionArray<Z> &a, const FractionArray<Z> &b,
+                std::integral_constant<int, 2>) -> Fraction<Z> {
+  using W = typename Wider<Z>::type;
+  if (a.empty() || a._dens[0] == Z(0) || b._dens[0] == Z(0) ||
+      !all_equal(a._dens) || !all_equal(b._dens)) {
+    return dot(a, b, std::integral_constant<int, 1>{});
+  }
+  // shared denominators: sum the numerator products, reduce once
+  auto total = W(0);
+  for (size_t i = 0; i != a.size(); ++i) {
+    if (!checked_add(total, W(a._nums[i]) * W(b._nums[i]), total)) {
+      return dot(a, b, std::integral_constant<int, 1>{});
+    }
+  }
+  // total / (da db) in lowest terms with gcds on Z only: once the
+  // common factors with da are gone, none are left to share with it
+  auto da = a._dens[0];
+  auto db = b._dens[0];
+  const auto g1 = fun::gcd(static_cast<Z>(total % W(da)), da);
+  total /= W(g1);
+  da /= g1;
+  const auto g2 = fun::gcd(static_cast<Z>(total % W(db)), db);
+  total /= W(g2);
+  db /= g2;
+  auto f = Fraction<Z>{};
+  f._num = narrow<Z>(total);
+  f._den = narrow<Z>(W(da) * W(db));
+  return f;
+}
+
+template <typename Z>
+inline auto compare(const FractionArray<Z> &a, const FractionArray<Z> &b,
+                    std::integral_constant<int, 2>) -> std::vector<int> {
+  using W = typename Wider<Z>::type;
+  const auto n = a.size();
+  auto res = std::vector<int>(n);
+  for (size_t i = 0; i != n; ++i) { // branch-free
+    const auto lhs = W(a._nums[i]) * W(b._dens[i]);
+    const auto rhs = W(a._dens[i]) * W(b._nums[i]);
+    res[i] = int(rhs < lhs) - int(lhs < rhs);
+  }
+  return res;
+}
+
+template <typename Z, int Guard>
+inline auto compare(const FractionArray<Z> &a, const FractionArray<Z> &b,
+                    std::integral_constant<int, Guard>) -> std::vector<int> {
+  const auto n = a.size();
+  auto res = std::vector<int>(n);
+  for (size_t i = 0; i != n; ++i) {
+    const auto lhs = a[i];
+    const auto rhs = b[i];
+    res[i] = int(rhs < lhs) - int(lhs < rhs);
+  }
+  return res;
+}
+
+} // namespace detail
+
+/**
+ * @brief Sum of the elements
+ *
+ * @tparam Z
+ * @param[in] a
+ * @return Fraction<Z>
+ * @exception std::overflow_error if a partial sum does not fit in Z, even
+ *            reduced
+ */
+template <typename Z>
+inline auto sum(const FractionArray<Z> &a) -> Fraction<Z> {
+  return detail::sum(a, detail::overflow_guard<Z>{});
+}
+
+/**
+ * @brief Sum of a[i] * b[i]
+ *
+ * @tparam Z
+ * @param[in] a
+ * @param[in] b same size as `a`
+ * @return Fraction<Z>
+ * @exception std::invalid_argument if the sizes differ
+ * @exception std::overflow_error as for sum()
+ */
+template <typename Z>
+inline auto dot(const FractionArray<Z> &a, const FractionArray<Z> &b)
+    -> Fraction<Z> {
+  detail::check_same_size(a.size(), b.size());
+  return detail::dot(a, b, detail::overflow_guard<Z>{});
+}
+
+/**
+ * @brief k * a
+ *
+ * @tparam Z
+ * @param[in] a
+ * @param[in] k
+ * @return FractionArray<Z>
+ */
+template <typename Z>
+inline auto scale(const FractionArray<Z> &a, const Fraction<Z> &k)
+    -> FractionArray<Z> {
+  auto res = FractionArray<Z>{};
+  res.reserve(a.size());
+  for (size_t i = 0; i != a.size(); ++i) {
+    res.push_back(a[i] * k);
+  }
+  return res;
+}
+
+/**
+ * @brief y += alpha * x
+ *
+ * @tparam Z
+ * @param[in] alpha
+ * @param[in] x
+ * @param[in,out] y same size as `x`
+ * @exception std::invalid_argument if the sizes differ
+ */
+template <typename Z>
+inline void axpy(const Fraction<Z> &alpha, const FractionArray<Z> &x,
+                 FractionArray<Z> &y) {
+  detail::check_same_size(x.size(), y.size());
+  for (size_t i = 0; i != x.size(); ++i) {
+    y.set(i, y[i] + alpha * x[i]);
+  }
+}
+
+/**
+ * @brief Elementwise a[i] + b[i]
+ *
+ * @exception std::invalid_argument if the sizes differ
+ */
+template <typename Z>
+inline auto add(const FractionArray<Z> &a, const FractionArray<Z> &b)
+    -> FractionArray<Z> {
+  detail::check_same_size(a.size(), b.size());
+  auto res = FractionArray<Z>{};
+  res.reserve(a.size());
+  for (size_t i = 0; i != a.size(); ++i) {
+    res.push_back(a[i] + b[i]);
+  }
+  return res;
+}
+
+/**
+ * @brief Elementwise a[i] * b[i]
+ *
+ * @exception std::invalid_argument if the sizes differ
+ */
+template <typename Z>
+inline auto mul(const FractionArray<Z> &a, const FractionArray<Z> &b)
+    -> FractionArray<Z> {
+  detail::check_same_size(a.size(), b.size());
+  auto res = FractionArray<Z>{};
+  res.reserve(a.size());
+  for (size_t i = 0; i != a.size(); ++i) {
+    res.push_back(a[i] * b[i]);
+  }
+  return res;
+}
+
+/**
+ * @brief Elementwise three-way comparison
+ *
+ * Cross-multiplies in the double-width type when there is one, so no
+ * element needs a gcd.
+ *
+ * @tparam Z
+ * @param[in] a
+ * @param[in] b same size as `a`
+ * @return std::vector<int> -1, 0 or 1 for a[i] <, == or > b[i]
+ * @exception std::invalid_argument if the sizes differ
+ */
+template <typename Z>
+inline auto compare(const FractionArray<Z> &a, const FractionArray<Z> &b)
+    -> std::vector<int> {
+  detail::check_same_size(a.size(), b.size());
+  return detail::compare(a, b, detail::overflow_guard<Z>{});
+}
+
+} // namespace fun
@@ -0,0 +1,663 @@
+#pragma once
+
+/** @file include/py2cpp/fraction_io.hpp
+ *  Allocation-free formatting and parsing of fractions, and buffered bulk
+ *  readers and writers on top of them.
+ *
+ *      char buf[fun::fraction_chars_max<int64_t>()];
+ *      auto res = fun::to_chars(buf, buf + sizeof buf, f); // "3/4"
+ *
+ *      auto g = fun::Fraction<int64_t>{};
+ *      fun::from_chars(s.data(), s.data() + s.size(), g);  // "-1.25e-3"
+ *
+ *      auto xs = fun::FractionArray<int64_t>{};
+ *      fun::FractionReader(std::fopen("in.csv", "rb")).read_all(xs);
+ *
+ *  to_chars() writes Python's str(): "n/d", or just "n" for an integer.
+ *  from_chars() reads what Python's Fraction(str) accepts, without the
+ *  surrounding whitespace: "n/d", integers and decimals with an optional
+ *  exponent ("-3/4", "7", "1.5", "-.5e-3", "1_000/3"), plus the "(n/d)"
+ *  printed by operator<<. "n/0" gives the Fraction infinities (and "0/0"
+ *  nan) rather than an error, so every printed value reads back.
+ *
+ *  Only builtin integer Z are supported.
+ */
+
+#include <cctype>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include "fraction_array.hpp" // import fun::FractionArray
+#include "fractions.hpp"      // import fun::Fraction, fun::checked_mul
+
+namespace fun {
+
+/**
+ * @brief Result of to_chars(), as std::to_chars_result
+ */
+struct to_chars_result {
+  char *ptr;
+  std::errc ec;
+};
+
+/**
+ * @brief Result of from_chars(), as std::from_chars_result
+ */
+struct from_chars_result {
+  const char *ptr;
+  std::errc ec;
+};
+
+/**
+ * @brief Buffer size that fits any Fraction<Z> written by to_chars()
+ *
+ * @tparam Z
+ * @return size_t
+ */
+template <typename Z> constexpr auto fraction_chars_max() -> size_t {
+  return 2 * (std::numeric_limits<Z>::digits10 + 2) + 1; // -n/d
+}
+
+namespace detail {
+
+template <typename Z>
+using io_unsigned_t = typename std::make_unsigned<Z>::type;
+
+template <typename Z> struct check_io_integer {
+  static_assert(std::is_integral<Z>::value,
+                "fraction I/O needs a builtin integer type");
+};
+
+/// Writes x in decimal, two digits at a time; nullptr if it does not fit
+template <typename U>
+inline auto write_unsigned(char *first, char *last, U x) -> char * {
+  static const char pairs[] = "00010203040506070809"
+                              "10111213141516171819"
+                              "20212223242526272829"
+                              "30313233343536373839"
+                              "40414243444546474849"
+                              "50515253545556575859"
+                              "60616263646566676869"
+                              "70717273747576777879"
+                              "80818283848586878889"
+                              "90919293949596979899";
+  char buf[std::numeric_limits<U>::digits10 + 1];
+  auto *p = buf + sizeof buf;
+  while (x >= 100) {
+    const auto i = static_cast<size_t>(x % 100) * 2;
+    x = static_cast<U>(x / 100);
+    *--p = pairs[i + 1];
+    *--p = pairs[i];
+  }
+  if (x >= 10) {
+    const auto i = static_cast<size_t>(x) * 2;
+    *--p = pairs[i + 1];
+    *--p = pairs[i];
+  } else {
+    *--p = static_cast<char>('0' + x);
+  }
+  const auto n = static_cast<size_t>(buf + sizeof buf - p);
+  if (static_cast<size_t>(last - first) < n) {
+    return nullptr;
+  }
+  std::memcpy(first, p, n);
+  return first + n;
+}
+
+template <typename Z>
+inline auto write_integer(char *first, char *last, Z x) -> char * {
+  using U = io_unsigned_t<Z>;
+  auto mag = static_cast<U>(x);
+  if (x < Z(0)) {
+    if (first == last) {
+      return nullptr;
+    }
+    *first++ = '-';
+    mag = static_cast<U>(U(0) - mag);
+  }
+  return write_unsigned(first, last, mag);
+}
+
+/// Writes num/den (den == 1 prints just num); nullptr if it does not fit
+template <typename Z>
+inline auto write_fraction(char *first, char *last, const Z &num, const Z &den)
+    -> char * {
+  auto *p = write_integer(first, last, num);
+  if (p == nullptr || den == Z(1)) {
+    return p;
+  }
+  if (p == last) {
+    return nullptr;
+  }
+  *p++ = '/';
+  return write_integer(p, last, den);
+}
+
+inline auto is_digit(char c) -> bool { return c >= '0' && c <= '9'; }
+
+/**
+ * @brief Decimal digits, Python style (single `_` between digits allowed)
+ *
+ * Zeros after the last non-zero digit are only counted in `zeros`, so
+ * "1.5000" does not overflow where "15" fits.
+ */
+template <typename U> struct DigitScanner {
+  U acc{0};
+  size_t zeros{0};
+  bool overflow{false};
+
+  /// Scan from `p`; returns the number of digits (p is left after them)
+  auto scan(const char *&p, const char *last) -> size_t {
+    size_t n = 0;
+    while (p != last) {
+      if (*p == '_' && n != 0 && p + 1 != last && is_digit(p[1])) {
+        ++p;
+      } else if (!is_digit(*p)) {
+        break;
+      }
+      this->push(static_cast<U>(*p - '0'));
+      ++p;
+      ++n;
+    }
+    return n;
+  }
+
+  /// acc * 10^zeros
+  auto value() -> U {
+    auto v = this->acc;
+    this->scale(v, this->zeros);
+    return v;
+  }
+
+  /// v *= 10^k, or set overflow
+  void scale(U &v, size_t k) {
+    for (; k != 0 && v != U(0) && !this->overflow; --k) {
+      const auto x = v; // checked_mul must not alias its result
+      this->overflow = !checked_mul(x, U(10), v);
+    }
+  }
+
+private:
+  void push(U d) {
+    if (d == U(0)) {
+      ++this->zeros;
+      return;
+    }
+    this->scale(this->acc, this->zeros + 1);
+    this->zeros = 0;
+    const auto x = this->acc;
+    this->overflow = this->overflow || !checked_add(x, d, this->acc);
+  }
+};
+
+/// The magnitude `mag` (negated if `negative`) as a Z, if it fits
+template <typename Z>
+inline auto to_signed(io_unsigned_t<Z> mag, bool negative, Z &res) -> bool {
+  using U = io_unsigned_t<Z>;
+  const auto max = static_cast<U>(std::numeric_limits<Z>::max());
+  if (!negative) {
+    res = static_cast<Z>(mag);
+    return mag <= max;
+  }
+  if (!std::is_signed<Z>::value) {
+    res = Z(0);
+    return mag == U(0);
+  }
+  if (mag > max + U(1)) {
+    return false;
+  }
+  res = mag == max + U(1) ? std::numeric_limits<Z>::min()
+                          : static_cast<Z>(-static_cast<Z>(mag));
+  return true;
+}
+
+inline auto is_separator(char c) -> bool {
+  return c == ',' || c == ';' || c == ' ' || c == '\t' || c == '\n' ||
+         c == '\r' || c == '\f' || c == '\v';
+}
+
+} // namespace detail
+
+/**
+ * @brief Write `frac` into [first, last) as Python's str(): "n/d" or "n"
+ *
+ * No allocation, no locale; the buffer is not null-terminated. A buffer
+ * of fraction_chars_max<Z>() always suffices.
+ *
+ * @tparam Z
+ * @tparam Policy
+ * @param[in] first
+ * @param[in] last
+ * @param[in] frac
+ * @return to_chars_result {one past the last char written, errc{}}, or
+ *         {last, errc::value_too_large}
+ */
+template <typename Z, typename Policy>
+inline auto to_chars(char *first, char *last, const Fraction<Z, Policy> &frac)
+    -> to_chars_result {
+  (void)detail::check_io_integer<Z>{};
+  auto reduced = frac;
+  if (Policy::lazy) {
+    reduced.normalize2();
+  }
+  auto *p = detail::write_fraction(first, last, reduced._num, reduced._den);
+  if (p == nullptr) {
+    return {last, std::errc::value_too_large};
+  }
+  return {p, std::errc{}};
+}
+
+/**
+ * @brief Parse a fraction at the start of [first, last)
+ *
+ * Accepts the forms listed in the file comment and, like
+ * std::from_chars, stops at the first character that does not belong to
+ * the number (no leading whitespace is skipped).
+ *
+ * @tparam Z
+ * @tparam Policy
+ * @param[in] first
+ * @param[in] last
+ * @param[out] value left unchanged on error
+ * @return from_chars_result {one past the parsed text, errc{}},
+ *         {first, errc::invalid_argument} if there is no number, or
+ *         {end of the number, errc::result_out_of_range} if it does not
+ *         fit in Fraction<Z>
+ */
+template <typename Z, typename Policy>
+inline auto from_chars(const char *first, const char *last,
+                       Fraction<Z, Policy> &value) -> from_chars_result {
+  (void)detail::check_io_integer<Z>{};
+  using U = detail::io_unsigned_t<Z>;
+  const auto invalid = from_chars_result{first, std::errc::invalid_argument};
+
+  auto p = first;
+  const auto paren = p != last && *p == '(';
+  if (paren) {
+    ++p;
+  }
+  auto negative = false;
+  if (p != last && (*p == '+' || *p == '-')) {
+    negative = *p == '-';
+    ++p;
+  }
+
+  auto num = detail::DigitScanner<U>{};
+  const auto int_digits = num.scan(p, last);
+  auto n = U(0);
+  auto d = U(1);
+  auto overflow = false;
+
+  auto q = p;
+  auto den = detail::DigitScanner<U>{};
+  if (int_digits != 0 && q != last && *q == '/' && ++q != last &&
+      den.scan(q, last) != 0) {
+    p = q; // n/d
+    n = num.value();
+    d = den.value();
+    overflow = num.overflow || den.overflow;
+  } else {
+    // decimal: digits [. digits] [e [+-] digits]
+    size_t frac_digits = 0;
+    q = p;
+    if (q != last && *q == '.') {
+      ++q;
+      frac_digits = num.scan(q, last);
+      if (int_digits + frac_digits != 0) {
+        p = q;
+      }
+    }
+    if (int_digits + frac_digits == 0) {
+      return invalid;
+    }
+    auto exp = 0L;
+    q = p;
+    if (q != last && (*q == 'e' || *q == 'E')) {
+      ++q;
+      auto exp_negative = false;
+      if (q != last && (*q == '+' || *q == '-')) {
+        exp_negative = *q == '-';
+        ++q;
+      }
+      auto e = detail::DigitScanner<unsigned long>{};
+      if (e.scan(q, last) != 0) {
+        p = q;
+        const auto limit = 100000UL; // far beyond any Z, and no overflow
+        const auto mag = e.overflow ? limit : e.value();
+        exp = static_cast<long>(e.overflow || mag > limit ? limit : mag);
+        exp = exp_negative ? -exp : exp;
+      }
+    }
+    // value = acc * 10^(zeros - frac_digits + exp)
+    n = num.acc;
+    overflow = num.overflow;
+    if (n != U(0)) {
+      const auto e10 = static_cast<long>(num.zeros) -
+                       static_cast<long>(frac_digits) + exp;
+      if (e10 >= 0) {
+        num.scale(n, static_cast<size_t>(e10));
+      } else {
+        num.scale(d, static_cast<size_t>(-e10));
+      }
+      overflow = overflow || num.overflow;
+    }
+  }
+
+  if (paren) {
+    if (p == last || *p != ')') {
+      return invalid;
+    }
+    ++p;
+  }
+  auto zn = Z(0);
+  auto zd = Z(0);
+  if (overflow || !detail::to_signed<Z>(n, negative, zn) ||
+      !detail::to_signed<Z>(d, false, zd)) {
+    return {p, std::errc::result_out_of_range};
+  }
+  value = Fraction<Z, Policy>(zn, zd);
+  return {p, std::errc{}};
+}
+
+/**
+ * @brief Python Fraction(str): the whole string, whitespace around it
+ *
+ *     fun::parse_fraction<int>(" 3/4 "); // 3/4
+ *
+ * @tparam Z
+ * @tparam Policy
+ * @param[in] s
+ * @return Fraction<Z, Policy>
+ * @exception std::invalid_argument if `s` is not a fraction (Python
+ *            ValueError)
+ * @exception std::overflow_error if it does not fit in Z
+ */
+template <typename Z, typename Policy = EagerNormalize>
+inline auto parse_fraction(const std::string &s) -> Fraction<Z, Policy> {
+  auto first = s.data();
+  auto last = s.data() + s.size();
+  while (first != last && std::isspace(static_cast<unsigned char>(*first))) {
+    ++first;
+  }
+  while (last != first &&
+         std::isspace(static_cast<unsigned char>(last[-1]))) {
+    --last;
+  }
+  auto value = Fraction<Z, Policy>{};
+  const auto res = from_chars(first, last, value);
+  if (res.ec == std::errc::result_out_of_range) {
+    throw std::overflow_error("parse_fraction: out of range: " + s);
+  }
+  if (res.ec != std::errc{} || res.ptr != last) {
+    throw std::invalid_argument("parse_fraction: invalid literal: " + s);
+  }
+  return value;
+}
+
+/**
+ * @brief Buffered writer of fractions to a FILE *, one per separator
+ *
+ *     fun::FractionWriter w(out, ',');
+ *     w.write_all(xs); // xs: FractionArray<Z> or any range of Fraction
+ *     w.flush();       // errors surface here
+ *
+ * Formats straight into its buffer with to_chars(). The destructor
+ * flushes too but swallows errors; the FILE is not closed.
+ */
+class FractionWriter {
+  std::FILE *_out;
+  std::vector<char> _buf;
+  size_t _len{0};
+  char _sep;
+
+public:
+  /**
+   * @brief Construct a new FractionWriter object
+   *
+   * @param[in] out
+   * @param[in] sep written after every fraction
+   * @param[in] buffer_size
+   */
+  explicit FractionWriter(std::FILE *out, char sep = '\n',
+                          size_t buffer_size = size_t(1) << 16)
+      : _out{out}, _buf(buffer_size < 256 ? 256 : buffer_size), _sep{sep} {}
+
+  FractionWriter(const FractionWriter &) = delete;
+  auto operator=(const FractionWriter &) -> FractionWriter & = delete;
+
+  ~FractionWriter() {
+    try {
+      this->flush();
+    } catch (...) { // call flush() first to see write errors
+    }
+  }
+
+  /**
+   * @brief Append `frac` and the separator
+   *
+   * @param[in] frac
+   */
+  template <typename Z, typename Policy>
+  void write(const Fraction<Z, Policy> &frac) {
+    auto reduced = frac;
+    if (Policy::lazy) {
+      reduced.normalize2();
+    }
+    this->write_raw(reduced._num, reduced._den);
+  }
+
+  /**
+   * @brief Append every element of a FractionArray (stored normalized)
+   *
+   * @param[in] xs
+   */
+  template <typename Z> void write_all(const FractionArray<Z> &xs) {
+    for (size_t i = 0; i != xs.size(); ++i) {
+      this->write_raw(xs._nums[i], xs._dens[i]);
+    }
+  }
+
+  /**
+   * @brief Append every Fraction of a range
+   *
+   * @param[in] xs
+   */
+  template <typename Iterable> void write_all(const Iterable &xs) {
+    for (const auto &frac : xs) {
+      this->write(frac);
+    }
+  }
+
+  /**
+   * @brief Hand the buffered text to the FILE
+   *
+   * @exception std::system_error on a write error
+   */
+  void flush() {
+    if (this->_len == 0) {
+      return;
+    }
+    const auto n = std::fwrite(this->_buf.data(), 1, this->_len, this->_out);
+    const auto len = this->_len;
+    this->_len = 0;
+    if (n != len) {
+      throw std::system_error(errno, std::generic_category(),
+                              "FractionWriter");
+    }
+  }
+
+private:
+  template <typename Z> void write_raw(const Z &num, const Z &den) {
+    (void)detail::check_io_integer<Z>{};
+    if (this->_buf.size() - this->_len < fraction_chars_max<Z>() + 1) {
+      this->flush();
+    }
+    auto *first = this->_buf.data() + this->_len;
+    auto *p = detail::write_fraction(
+        first, this->_buf.data() + this->_buf.size(), num, den);
+    *p++ = this->_sep;
+    this->_len += static_cast<size_t>(p - first);
+  }
+};
+
+/**
+ * @brief Buffered reader of fractions from a FILE *
+ *
+ *     fun::FractionReader r(in);
+ *     auto f = fun::Fraction<int64_t>{};
+ *     while (r.read(f)) { ... }
+ *
+ * Fractions are separated by any run of whitespace, ',' or ';'. Each
+ * token must be a whole from_chars() number. The FILE is not closed.
+ */
+class FractionReader {
+  std::FILE *_in;
+  std::vector<char> _buf;
+  size_t _pos{0};
+  size_t _end{0};
+  bool _eof{false};
+
+public:
+  /**
+   * @brief Construct a new FractionReader object
+   *
+   * @param[in] in
+   * @param[in] buffer_size grows when a single token is longer
+   */
+  explicit FractionReader(std::FILE *in, size_t buffer_size = size_t(1) << 16)
+      : _in{in}, _buf(buffer_size < 256 ? 256 : buffer_size) {}
+
+  FractionReader(const FractionReader &) = delete;
+  auto operator=(const FractionReader &) -> FractionReader & = delete;
+
+  /**
+   * @brief Read the next fraction
+   *
+   * @param[out] value
+   * @return true if a fraction was read, false at the end of the input
+   * @exception std::invalid_argument on a malformed token
+   * @exception std::overflow_error if it does not fit in Z
+   * @exception std::system_error on a read error
+   */
+  template <typename Z, typename Policy>
+  auto read(Fraction<Z, Policy> &value) -> bool {
+    const char *first = nullptr;
+    const char *last = nullptr;
+    if (!this->next_token(first, last)) {
+      return false;
+    }
+    const auto res = from_chars(first, last, value);
+    if (res.ec == std::errc{} && res.ptr == last) {
+      return true;
+    }
+    const auto token = std::string(first, last);
+    if (res.ec == std::errc::result_out_of_range) {
+      throw std::overflow_error("FractionReader: out of range: " + token);
+    }
+    throw std::invalid_argument("FractionReader: invalid fraction: " + token);
+  }
+
+  /**
+   * @brief Append every remaining fraction to `xs`
+   *
+   * @param[in,out] xs
+   * @return size_t the number of fractions read
+   */
+  template <typename Z> auto read_all(FractionArray<Z> &xs) -> size_t {
+    auto f = Fraction<Z>{};
+    size_t n = 0;
+    for (; this->read(f); ++n) {
+      xs.push_back(f);
+    }
+    return n;
+  }
+
+  /**
+   * @brief Append every remaining fraction to `xs`
+   *
+   * @param[in,out] xs
+   * @return size_t the number of fractions read
+   */
+  template <typename Z, typename Policy>
+  auto read_all(std::vector<Fraction<Z, Policy>> &xs) -> size_t {
+    auto f = Fraction<Z, Policy>{};
+    size_t n = 0;
+    for (; this->read(f); ++n) {
+      xs.push_back(f);
+    }
+    return n;
+  }
+
+private:
+  // [first, last) of the next token, refilling the buffer as needed
+  auto next_token(const char *&first, const char *&last) -> bool {
+    while (true) {
+      while (this->_pos != this->_end &&
+             detail::is_separator(this->_buf[this->_pos])) {
+        ++this->_pos;
+      }
+      if (this->_pos != this->_end || !this->fill()) {
+        break;
+      }
+    }
+    if (this->_pos == this->_end) {
+      return false;
+    }
+    auto stop = this->_pos;
+    while (true) {
+      while (stop != this->_end && !detail::is_separator(this->_buf[stop])) {
+        ++stop;
+      }
+      if (stop != this->_end || this->_eof) {
+        break;
+      }
+      const auto done = stop - this->_pos;
+      this->fill(); // moves the partial token to the front
+      stop = this->_pos + done;
+      if (stop == this->_end) {
+        break; // end of input
+      }
+    }
+    first = this->_buf.data() + this->_pos;
+    last = this->_buf.data() + stop;
+    this->_pos = stop;
+    return true;
+  }
+
+  // keep [_pos, _end), read more after it; false once nothing is left
+  auto fill() -> bool {
+    if (this->_eof) {
+      return false;
+    }
+    const auto kept = this->_end - this->_pos;
+    if (this->_pos != 0) {
+      std::memmove(this->_buf.data(), this->_buf.data() + this->_pos, kept);
+    }
+    this->_pos = 0;
+    this->_end = kept;
+    if (kept == this->_buf.size()) {
+      this->_buf.resize(2 * this->_buf.size());
+    }
+    const auto n = std::fread(this->_buf.data() + kept, 1,
+                              this->_buf.size() - kept, this->_in);
+    this->_end += n;
+    if (n == 0) {
+      if (std::ferror(this->_in) != 0) {
+        throw std::system_error(errno, std::generic_category(),
+                                "FractionReader");
+      }
+      this->_eof = true;
+    }
+    return n != 0;
+  }
+};
+
+} // namespace fun
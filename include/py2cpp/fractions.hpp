@@ -6,10 +6,21 @@
 
 // #include <boost/operators.hpp>
 // #include <cmath>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional> // import std::hash
+#include <limits>
 #include <numeric>
+#include <stdexcept>
 #include <type_traits>
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+#include <bit> // import std::countr_zero
+#endif
 #include <utility>
 
+#include "stats.hpp" // import py::fraction_stats
+
 // #include "common_concepts.h"
 
 #if __cpp_constexpr >= 201304
@@ -18,6 +29,10 @@
 #define CONSTEXPR14 inline
 #endif
 
+#if defined(__SIZEOF_INT128__)
+#define PY2CPP_HAS_INT128 1
+#endif
+
 namespace fun {
 
 /**
@@ -60,9 +75,153 @@ CONSTEXPR14 auto gcd_recur(const _Mn &__m, const _Mn &__n) -> _Mn {
   return gcd_recur(__n, __m % __n);
 }
 
+namespace detail {
+
+template <typename U>
+CONSTEXPR14 auto countr_zero(U x, std::false_type) -> int {
+#if defined(__cpp_lib_bitops)
+  return std::countr_zero(x);
+#elif defined(__GNUC__) || defined(__clang__)
+  if (sizeof(U) <= sizeof(unsigned)) {
+    return __builtin_ctz(static_cast<unsigned>(x));
+  }
+  if (sizeof(U) <= sizeof(unsigned long)) {
+    return __builtin_ctzl(static_cast<unsigned long>(x));
+  }
+  return __builtin_ctzll(static_cast<unsigned long long>(x));
+#else
+  auto n = 0;
+  for (; (x & U(1)) == U(0); x >>= 1) {
+    ++n;
+  }
+  return n;
+#endif
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+// unsigned __int128: one ctz per 64-bit half
+template <typename U>
+CONSTEXPR14 auto countr_zero(U x, std::true_type) -> int {
+  constexpr auto half = std::numeric_limits<unsigned long long>::digits;
+  const auto lo = static_cast<unsigned long long>(x);
+  return lo != 0ULL ? __builtin_ctzll(lo)
+                    : half + __builtin_ctzll(
+                                 static_cast<unsigned long long>(x >> half));
+}
+#endif
+
+/**
+ * @brief Number of trailing zero bits (x != 0)
+ *
+ * @tparam U an unsigned integer type, up to unsigned __int128
+ */
+template <typename U> CONSTEXPR14 auto countr_zero(U x) -> int {
+  using wide = std::integral_constant<bool, (sizeof(U) > sizeof(long long))>;
+  return countr_zero(x, wide{});
+}
+
+/**
+ * @brief Binary (Stein's) GCD: shifts and subtractions, no division
+ *
+ * @tparam U
+ * @param[in] u
+ * @param[in] v
+ * @return U
+ */
+template <typename U> CONSTEXPR14 auto gcd_binary(U u, U v) -> U {
+  if (u == 0) {
+    return v;
+  }
+  if (v == 0) {
+    return u;
+  }
+  const auto shift = countr_zero(static_cast<U>(u | v));
+  u >>= countr_zero(u);
+  do {
+    v >>= countr_zero(v);
+    if (u > v) {
+      const auto t = u;
+      u = v;
+      v = t;
+    }
+    v -= u;
+  } while (v != 0);
+  return static_cast<U>(u << shift);
+}
+
+/**
+ * @brief Euclid's GCD on unsigned magnitudes
+ *
+ * @tparam U
+ * @param[in] u
+ * @param[in] v
+ * @return U
+ */
+template <typename U> CONSTEXPR14 auto gcd_euclid(U u, U v) -> U {
+  while (v != 0) {
+    const auto r = static_cast<U>(u % v);
+    u = v;
+    v = r;
+  }
+  return u;
+}
+
+/**
+ * @brief Whether gcd() on the unsigned type U uses Stein's algorithm
+ *
+ * Off for every builtin type: with hardware division Euclid is faster
+ * on x86-64, even for 128 bits (BM_gcd_binary against BM_gcd in
+ * bench/bench_fractions.cpp). Specialize it for a type where the bench
+ * shows the opposite.
+ */
+template <typename U> struct use_binary_gcd : std::false_type {};
+
+template <typename _Mn>
+using is_builtin_integer =
+    std::integral_constant<bool, std::is_integral<_Mn>::value &&
+                                     !std::is_same<_Mn, bool>::value>;
+
+template <typename U>
+CONSTEXPR14 auto gcd_unsigned(U u, U v, std::true_type) -> U {
+  return gcd_binary(u, v);
+}
+
+template <typename U>
+CONSTEXPR14 auto gcd_unsigned(U u, U v, std::false_type) -> U {
+  return gcd_euclid(u, v);
+}
+
+template <typename _Mn>
+CONSTEXPR14 auto gcd(const _Mn &__m, const _Mn &__n, std::true_type) -> _Mn {
+  // |x| as the unsigned type, at least as wide as unsigned int; min() is
+  // not negated in _Mn, so it cannot overflow
+  using U = typename std::conditional<
+      sizeof(_Mn) <= sizeof(unsigned), unsigned,
+      typename std::make_unsigned<_Mn>::type>::type;
+  const auto um =
+      __m < _Mn(0) ? U(0) - static_cast<U>(__m) : static_cast<U>(__m);
+  const auto un =
+      __n < _Mn(0) ? U(0) - static_cast<U>(__n) : static_cast<U>(__n);
+  return static_cast<_Mn>(gcd_unsigned(um, un, use_binary_gcd<U>{}));
+}
+
+template <typename _Mn>
+CONSTEXPR14 auto gcd(const _Mn &__m, const _Mn &__n, std::false_type) -> _Mn {
+  if (__m == 0) {
+    return abs(__n);
+  }
+  return gcd_recur(__m, __n);
+}
+
+} // namespace detail
+
 /**
  * @brief Greatest common divider
  *
+ * Builtin integers run Euclid's algorithm on their unsigned magnitudes
+ * (safe for min()); other types (big integers, ...) use gcd_recur, which
+ * only needs `%`.
+ *
  * @tparam _Mn
  * @param[in] __m
  * @param[in] __n
@@ -70,10 +229,7 @@ CONSTEXPR14 auto gcd_recur(const _Mn &__m, const _Mn &__n) -> _Mn {
  */
 template <typename _Mn>
 CONSTEXPR14 auto gcd(const _Mn &__m, const _Mn &__n) -> _Mn {
-  if (__m == 0) {
-    return abs(__n);
-  }
-  return gcd_recur(__m, __n);
+  return detail::gcd(__m, __n, detail::is_builtin_integer<_Mn>{});
 }
 
 /**
@@ -92,12 +248,304 @@ CONSTEXPR14 auto lcm(const _Mn &__m, const _Mn &__n) -> _Mn {
   return (abs(__m) / gcd(__m, __n)) * abs(__n);
 }
 
+/** @name Checked integer arithmetic
+ *  Store `a op b` in `res` and return true, or return false (leaving `res`
+ *  unspecified) if the exact result does not fit in Z.
+ */
+///@{
+
+template <typename Z>
+inline auto checked_add(const Z &a, const Z &b, Z &res) -> bool {
+#if defined(__GNUC__) || defined(__clang__)
+  return !__builtin_add_overflow(a, b, &res);
+#else
+  using L = std::numeric_limits<Z>;
+  if (b > Z(0) ? a > L::max() - b : a < L::min() - b) {
+    return false;
+  }
+  res = static_cast<Z>(a + b);
+  return true;
+#endif
+}
+
+template <typename Z>
+inline auto checked_sub(const Z &a, const Z &b, Z &res) -> bool {
+#if defined(__GNUC__) || defined(__clang__)
+  return !__builtin_sub_overflow(a, b, &res);
+#else
+  using L = std::numeric_limits<Z>;
+  if (b > Z(0) ? a < L::min() + b : a > L::max() + b) {
+    return false;
+  }
+  res = static_cast<Z>(a - b);
+  return true;
+#endif
+}
+
+template <typename Z>
+inline auto checked_mul(const Z &a, const Z &b, Z &res) -> bool {
+#if defined(__GNUC__) || defined(__clang__)
+  return !__builtin_mul_overflow(a, b, &res);
+#else
+  using L = std::numeric_limits<Z>;
+  if (a == Z(0) || b == Z(0)) {
+    res = Z(0);
+    return true;
+  }
+  if (a > Z(0) ? (b > Z(0) ? a > L::max() / b : b < L::min() / a)
+               : (b > Z(0) ? a < L::min() / b : a < L::max() / b)) {
+    return false;
+  }
+  res = static_cast<Z>(a * b);
+  return true;
+#endif
+}
+
+/// Fails on division by zero and on min() / -1
+template <typename Z>
+inline auto checked_div(const Z &a, const Z &b, Z &res) -> bool {
+  if (b == Z(0) || (std::is_signed<Z>::value &&
+                    a == std::numeric_limits<Z>::min() && b == Z(-1))) {
+    return false;
+  }
+  res = static_cast<Z>(a / b);
+  return true;
+}
+
+///@}
+
+namespace detail {
+
+/**
+ * @brief The signed type of twice the width of a signed integer Z, if any
+ *
+ * Fraction<Z> adds in it so that the intermediate products cannot
+ * overflow, and only narrows back after reducing.
+ */
+template <std::size_t N> struct WiderBySize {};
+template <> struct WiderBySize<1> {
+  using type = int16_t;
+};
+template <> struct WiderBySize<2> {
+  using type = int32_t;
+};
+template <> struct WiderBySize<4> {
+  using type = int64_t;
+};
+#if defined(PY2CPP_HAS_INT128)
+template <> struct WiderBySize<8> {
+  __extension__ typedef __int128 type;
+};
+#endif
+
+template <typename Z,
+          bool = std::is_integral<Z>::value && std::is_signed<Z>::value>
+struct Wider {};
+template <typename Z> struct Wider<Z, true> : WiderBySize<sizeof(Z)> {};
+
+template <typename Z, typename = void> struct has_wider : std::false_type {};
+template <typename Z>
+struct has_wider<Z, typename std::conditional<true, void,
+                                              typename Wider<Z>::type>::type>
+    : std::true_type {};
+
+/**
+ * @brief How Fraction<Z> guards its arithmetic against overflow
+ *
+ * 2: widened intermediates, 1: checked builtin arithmetic (signed Z with
+ * no wider type, e.g. int64_t without __int128), 0: none (unsigned and
+ * arbitrary-precision Z)
+ */
+template <typename Z>
+using overflow_guard = std::integral_constant<
+    int, has_wider<Z>::value
+             ? 2
+             : (std::is_integral<Z>::value && std::is_signed<Z>::value ? 1
+                                                                       : 0)>;
+
+[[noreturn]] inline void throw_overflow() {
+  throw std::overflow_error("Fraction: result does not fit");
+}
+
+// accepts [-max(), max()]: a numerator of min() could not be negated
+template <typename Z>
+CONSTEXPR14 auto narrow(const typename Wider<Z>::type &x) -> Z {
+  using W = typename Wider<Z>::type;
+  const auto zmax = W(std::numeric_limits<Z>::max());
+  if (x < -zmax || x > zmax) {
+    throw_overflow();
+  }
+  return static_cast<Z>(x);
+}
+
+template <typename Z>
+CONSTEXPR14 auto mul(const Z &a, const Z &b, std::integral_constant<int, 2>)
+    -> Z {
+  using W = typename Wider<Z>::type;
+  return narrow<Z>(W(a) * W(b));
+}
+
+template <typename Z>
+inline auto mul(const Z &a, const Z &b, std::integral_constant<int, 1>) -> Z {
+  auto res = Z(0);
+  if (!checked_mul(a, b, res) || res == std::numeric_limits<Z>::min()) {
+    throw_overflow();
+  }
+  return res;
+}
+
+template <typename Z>
+CONSTEXPR14 auto mul(const Z &a, const Z &b, std::integral_constant<int, 0>)
+    -> Z {
+  return a * b;
+}
+
+/**
+ * @brief a * b, throwing std::overflow_error instead of wrapping for
+ * builtin signed Z
+ */
+template <typename Z> CONSTEXPR14 auto mul(const Z &a, const Z &b) -> Z {
+  return mul(a, b, overflow_guard<Z>{});
+}
+
+/**
+ * @brief a/b < c/d for b, d > 0, by comparing continued fractions
+ *
+ * Only divisions and remainders of the operands, so nothing can
+ * overflow: the integer parts decide, or the comparison moves on to the
+ * reciprocals of the remainders (one Euclid step each).
+ */
+template <typename Z>
+CONSTEXPR14 auto cf_less(Z a, Z b, Z c, Z d) -> bool {
+  for (;;) {
+    auto q1 = a / b;
+    auto r1 = a % b;
+    if (r1 < Z(0)) { // floor
+      r1 += b;
+      --q1;
+    }
+    auto q2 = c / d;
+    auto r2 = c % d;
+    if (r2 < Z(0)) {
+      r2 += d;
+      --q2;
+    }
+    if (q1 != q2) {
+      return q1 < q2;
+    }
+    if (r1 == Z(0) || r2 == Z(0)) {
+      return r1 == Z(0) && r2 != Z(0);
+    }
+    // r1/b < r2/d  <=>  d/r2 < b/r1
+    a = d;
+    c = b;
+    b = r2;
+    d = r1;
+  }
+}
+
+/// Number of significant bits of x
+CONSTEXPR14 auto bit_width(uint64_t x) -> int {
+#if defined(__GNUC__) || defined(__clang__)
+  return x == 0 ? 0 : 64 - __builtin_clzll(x);
+#else
+  auto n = 0;
+  for (; x != 0; x >>= 1) {
+    ++n;
+  }
+  return n;
+#endif
+}
+
+/// |x| of a builtin integer of at most 64 bits
+template <typename Z> CONSTEXPR14 auto magnitude64(const Z &x) -> uint64_t {
+  return x < Z(0) ? uint64_t(0) - static_cast<uint64_t>(x)
+                  : static_cast<uint64_t>(x);
+}
+
+/// floor(a / b) for b > 0
+template <typename Z> CONSTEXPR14 auto floor_div(const Z &a, const Z &b) -> Z {
+  auto q = a / b;
+  if (a % b < Z(0)) {
+    q -= Z(1);
+  }
+  return q;
+}
+
+/**
+ * @brief n / d correctly rounded to double, for d > 0
+ *
+ * Exact integer division extended to 55 significant bits, with the
+ * remainder folded into the lowest bit as a sticky bit, so the single
+ * uint64_t -> double conversion rounds to nearest even exactly once.
+ */
+inline auto ratio_to_double(uint64_t n, uint64_t d) -> double {
+  auto q = n / d;
+  auto r = n % d;
+  auto e = 0;
+  auto sticky = uint64_t(0);
+  const auto width = bit_width(q);
+  if (width > 55) {
+    const auto k = width - 55;
+    sticky = (q & ((uint64_t(1) << k) - 1)) != 0 || r != 0;
+    q >>= k;
+    e = k;
+  } else {
+    for (; q < (uint64_t(1) << 54); --e) { // one quotient bit per step
+      const auto carry = r >= d - r;        // 2 * r >= d, without overflow
+      r = carry ? r - (d - r) : 2 * r;
+      q = 2 * q + (carry ? 1U : 0U);
+    }
+    sticky = r != 0;
+  }
+  return std::ldexp(static_cast<double>(q | sticky), e);
+}
+
+template <typename Z> CONSTEXPR14 auto pow2(int k) -> Z {
+  auto base = Z(2);
+  auto res = Z(1);
+  for (; k != 0; k >>= 1) {
+    if ((k & 1) != 0) {
+      res *= base;
+    }
+    base *= base;
+  }
+  return res;
+}
+
+} // namespace detail
+
+/**
+ * @brief Normalization policy: reduce after every operation (the default)
+ */
+struct EagerNormalize {
+  static constexpr bool lazy = false;
+};
+
+/**
+ * @brief Normalization policy: reduce only when a result would not fit
+ *
+ * The denominator is still kept non-negative, and ==, < and friends stay
+ * exact by cross multiplication, so only the representation is not
+ * canonical; printing shows the reduced value, and normalize() reduces
+ * on demand. For builtin Z a result is reduced only when it does not fit
+ * in Z; arbitrary-precision Z never reduces by itself.
+ */
+struct LazyNormalize {
+  static constexpr bool lazy = true;
+};
+
 /**
  * @brief Fraction
  *
+ * For builtin signed Z, +, - and * never wrap silently: + and - work in
+ * a double-width type (e.g. __int128 for int64_t), reduce, then narrow,
+ * and any result that does not fit in Z throws std::overflow_error.
+ *
  * @tparam Z
+ * @tparam Policy EagerNormalize or LazyNormalize
  */
-template <typename Z> struct Fraction {
+template <typename Z, typename Policy = EagerNormalize> struct Fraction {
   Z _num;
   Z _den;
 
@@ -109,7 +557,11 @@ template <typename Z> struct Fraction {
    */
   CONSTEXPR14 Fraction(Z num, Z den)
       : _num{std::move(num)}, _den{std::move(den)} {
-    this->normalize();
+    if (Policy::lazy) {
+      this->normalize_lazy();
+    } else {
+      this->normalize();
+    }
   }
 
   /**
@@ -140,6 +592,11 @@ template <typename Z> struct Fraction {
    * denominator is always co-prime with numerator
    */
   CONSTEXPR14 auto normalize2() -> Z {
+#if defined(PY2CPP_STATS)
+    if (!py::detail::stats_constant_evaluated()) {
+      py::detail::fraction_recorder<Fraction>().normalize_calls.add();
+    }
+#endif
     Z common = gcd(this->_num, this->_den);
     if (common == Z(1) || common == Z(0)) {
       return common;
@@ -149,6 +606,38 @@ template <typename Z> struct Fraction {
     return common;
   }
 
+#if defined(PY2CPP_STATS)
+  /**
+   * @brief Counters shared by every Fraction<Z, Policy> (PY2CPP_STATS only)
+   *
+   * @return py::fraction_stats
+   */
+  static auto stats() -> py::fraction_stats {
+    return py::detail::fraction_recorder<Fraction>().snapshot();
+  }
+
+  /**
+   * @brief Zero the counters of Fraction<Z, Policy> (PY2CPP_STATS only)
+   */
+  static void reset_stats() { py::detail::fraction_recorder<Fraction>().reset(); }
+
+  /**
+   * @brief Counting fun::gcd; the members find it before the free one
+   *
+   * @param[in] m
+   * @param[in] n
+   * @return U
+   */
+  template <typename U>
+  static CONSTEXPR14 auto gcd(const U &m, const U &n) -> U {
+    if (!py::detail::stats_constant_evaluated()) {
+      py::detail::fraction_recorder<Fraction>().gcd_calls.add();
+    }
+    using fun::gcd; // and hybrid_int's own by ADL
+    return gcd(m, n);
+  }
+#endif
+
   /**
    * @brief Construct a new Fraction object
    *
@@ -184,6 +673,107 @@ template <typename Z> struct Fraction {
    */
   CONSTEXPR14 auto den() const noexcept -> const Z & { return _den; }
 
+  /**
+   * @brief The exact value of a double (Python's Fraction.from_float)
+   *
+   * Read off the mantissa and exponent; +-inf and nan map to 1/0, -1/0
+   * and 0/0.
+   *
+   * @param[in] x
+   * @return Fraction
+   * @exception std::overflow_error if the numerator or the denominator
+   *            does not fit in Z
+   */
+  static auto from_float(double x) -> Fraction {
+    auto res = Fraction{};
+    if (std::isnan(x) || std::isinf(x)) {
+      res._num = std::isnan(x) ? Z(0) : (x < 0 ? -Z(1) : Z(1));
+      res._den = Z(0);
+      return res;
+    }
+    if (x == 0.0) {
+      return res;
+    }
+    auto e = 0;
+    const auto m = std::frexp(std::fabs(x), &e); // |x| = m * 2^e
+    auto mant = static_cast<uint64_t>(std::ldexp(m, 53));
+    e -= 53;
+    const auto tz = detail::countr_zero(mant); // odd mantissa: coprime
+    mant >>= tz;
+    e += tz;
+    res.from_float_(mant, e, x < 0, std::is_integral<Z>{});
+    return res;
+  }
+
+  /**
+   * @brief The closest fraction with a denominator of at most `max_den`
+   *
+   * Python's Fraction.limit_denominator(): walk the convergents of the
+   * continued fraction, then pick the better of the last convergent and
+   * the best semiconvergent.
+   *
+   * @param[in] max_den
+   * @return Fraction
+   * @exception std::invalid_argument if `max_den` is less than 1
+   */
+  CONSTEXPR14 auto limit_denominator(const Z &max_den) const -> Fraction {
+    if (max_den < Z(1)) {
+      throw std::invalid_argument("max_den should be at least 1");
+    }
+    auto self = *this;
+    if (Policy::lazy) {
+      self.normalize2();
+    }
+    if (self._den <= max_den) {
+      return self;
+    }
+    auto p0 = Z(0);
+    auto q0 = Z(1);
+    auto p1 = Z(1);
+    auto q1 = Z(0);
+    auto n = self._num;
+    auto d = self._den;
+    for (;;) {
+      const auto a = detail::floor_div(n, d);
+      // q0 + a * q1 > max_den, without computing it
+      if (q1 != Z(0) && a > (max_den - q0) / q1) {
+        break;
+      }
+      const auto q2 = q0 + a * q1;
+      const auto p2 = p0 + a * p1;
+      p0 = p1;
+      q0 = q1;
+      p1 = p2;
+      q1 = q2;
+      const auto rem = n - a * d;
+      n = d;
+      d = rem;
+    }
+    const auto k = (max_den - q0) / q1;
+    // 2 * d * (q0 + k * q1) <= den, with integer division only
+    auto res = Fraction{};
+    if (q0 + k * q1 <= self._den / d / Z(2)) {
+      res._num = p1;
+      res._den = q1;
+    } else {
+      res._num = p0 + k * p1;
+      res._den = q0 + k * q1;
+    }
+    return res;
+  }
+
+  /**
+   * @brief The value correctly rounded to double
+   *
+   * One conversion for integers, one division when both parts are exact
+   * in a double, and an exact integer division otherwise.
+   *
+   * @return double
+   */
+  auto to_double() const -> double {
+    return this->to_double_(std::is_integral<Z>{});
+  }
+
   /**
    * @brief cross product
    *
@@ -212,11 +802,10 @@ template <typename Z> struct Fraction {
     if (lhs._den == Z(1) || rhs == Z(0)) {
       return lhs._num == rhs;
     }
-    auto lhs2{lhs};
-    auto rhs2{rhs};
-    std::swap(lhs2._den, rhs2);
-    lhs2.normalize2();
-    return lhs2._num < lhs2._den * rhs2;
+    if (!Policy::lazy) {
+      return false; // reduced with a denominator other than 1
+    }
+    return lhs._den != Z(0) && lhs._num == lhs._den * rhs;
   }
 
   /**
@@ -231,11 +820,7 @@ template <typename Z> struct Fraction {
     if (lhs._den == Z(1) || rhs == Z(0)) {
       return lhs._num < rhs;
     }
-    auto lhs2{lhs};
-    auto rhs2{rhs};
-    std::swap(lhs2._den, rhs2);
-    lhs2.normalize2();
-    return lhs2._num < lhs2._den * rhs2;
+    return less(lhs._num, lhs._den, rhs, Z(1), detail::overflow_guard<Z>{});
   }
 
   /**
@@ -250,11 +835,7 @@ template <typename Z> struct Fraction {
     if (rhs._den == Z(1) || lhs == Z(0)) {
       return lhs < rhs._num;
     }
-    auto lhs2{lhs};
-    auto rhs2{rhs};
-    std::swap(rhs2._den, lhs2);
-    rhs2.normalize2();
-    return rhs2._den * lhs2 < rhs2._num;
+    return less(lhs, Z(1), rhs._num, rhs._den, detail::overflow_guard<Z>{});
   }
 
   /**
@@ -288,9 +869,16 @@ template <typename Z> struct Fraction {
    */
   friend CONSTEXPR14 auto operator==(const Fraction &lhs, const Fraction &rhs)
       -> bool {
+    if (!Policy::lazy) {
+      // both are reduced, so equal values have equal representations
+      return lhs._num == rhs._num && lhs._den == rhs._den;
+    }
     if (lhs._den == rhs._den) {
       return lhs._num == rhs._num;
     }
+    if (detail::has_wider<Z>::value) {
+      return equal_wide(lhs, rhs, detail::has_wider<Z>{});
+    }
     auto lhs2{lhs};
     auto rhs2{rhs};
     std::swap(lhs2._den, rhs2._num);
@@ -309,15 +897,8 @@ template <typename Z> struct Fraction {
    */
   friend CONSTEXPR14 auto operator<(const Fraction &lhs, const Fraction &rhs)
       -> bool {
-    if (lhs._den == rhs._den) {
-      return lhs._num < rhs._num;
-    }
-    auto lhs2{lhs};
-    auto rhs2{rhs};
-    std::swap(lhs2._den, rhs2._num);
-    lhs2.normalize2();
-    rhs2.normalize2();
-    return lhs2._num * rhs2._den < lhs2._den * rhs2._num;
+    return less(lhs._num, lhs._den, rhs._num, rhs._den,
+                detail::overflow_guard<Z>{});
   }
 
   /**
@@ -451,12 +1032,10 @@ template <typename Z> struct Fraction {
    * @return Fraction&
    */
   CONSTEXPR14 auto operator*=(Fraction rhs) -> Fraction & {
-    std::swap(this->_num, rhs._num);
-    this->normalize2();
-    rhs.normalize2();
-    this->_num *= rhs._num;
-    this->_den *= rhs._den;
-    return *this;
+    if (Policy::lazy) {
+      return this->mul_lazy(rhs, false, detail::overflow_guard<Z>{});
+    }
+    return this->mul_eager(std::move(rhs));
   }
 
   /**
@@ -478,9 +1057,12 @@ template <typename Z> struct Fraction {
    * @return Fraction&
    */
   CONSTEXPR14 auto operator*=(Z rhs) -> Fraction & {
+    if (Policy::lazy) {
+      return *this *= Fraction(std::move(rhs));
+    }
     std::swap(this->_num, rhs);
     this->normalize2();
-    this->_num *= rhs;
+    this->_num = detail::mul(this->_num, rhs);
     return *this;
   }
 
@@ -513,12 +1095,10 @@ template <typename Z> struct Fraction {
    * @return Fraction&
    */
   CONSTEXPR14 auto operator/=(Fraction rhs) -> Fraction & {
-    std::swap(this->_den, rhs._num);
-    this->normalize();
-    rhs.normalize2();
-    this->_num *= rhs._den;
-    this->_den *= rhs._num;
-    return *this;
+    if (Policy::lazy) {
+      return this->mul_lazy(rhs, true, detail::overflow_guard<Z>{});
+    }
+    return this->div_eager(std::move(rhs));
   }
 
   /**
@@ -540,9 +1120,12 @@ template <typename Z> struct Fraction {
    * @return Fraction&
    */
   CONSTEXPR14 auto operator/=(Z rhs) -> Fraction & {
+    if (Policy::lazy) {
+      return *this /= Fraction(std::move(rhs));
+    }
     std::swap(this->_den, rhs);
     this->normalize();
-    this->_den *= rhs;
+    this->_den = detail::mul(this->_den, rhs);
     return *this;
   }
 
@@ -587,18 +1170,9 @@ template <typename Z> struct Fraction {
    * @return Fraction
    */
   CONSTEXPR14 auto operator+(const Fraction &rhs) const -> Fraction {
-    if (this->_den == rhs._den) {
-      return Fraction(this->_num + rhs._num, this->_den);
-    }
-    const auto common = gcd(this->_den, rhs._den);
-    if (common == Z(0)) {
-      return Fraction(rhs._den * this->_num + this->_den * rhs._num, Z(0));
-    }
-    const auto l = this->_den / common;
-    const auto r = rhs._den / common;
-    auto d = this->_den * r;
-    auto n = r * this->_num + l * rhs._num;
-    return Fraction(std::move(n), std::move(d));
+    return Policy::lazy
+               ? this->add_lazy(rhs, false, detail::overflow_guard<Z>{})
+               : this->add(rhs, false, detail::overflow_guard<Z>{});
   }
 
   /**
@@ -608,7 +1182,9 @@ template <typename Z> struct Fraction {
    * @return Fraction
    */
   CONSTEXPR14 auto operator-(const Fraction &frac) const -> Fraction {
-    return *this + (-frac);
+    return Policy::lazy
+               ? this->add_lazy(frac, true, detail::overflow_guard<Z>{})
+               : this->add(frac, true, detail::overflow_guard<Z>{});
   }
 
   /**
@@ -660,25 +1236,13 @@ template <typename Z> struct Fraction {
    * @return Fraction
    */
   CONSTEXPR14 auto operator-=(const Fraction &rhs) -> Fraction & {
-    if (this->_den == rhs._den) {
-      this->_num -= rhs._num;
-      this->normalize2();
+    if (Policy::lazy) {
+      *this = this->add_lazy(rhs, true, detail::overflow_guard<Z>{});
       return *this;
     }
-
-    auto other{rhs};
-    std::swap(this->_den, other._num);
-    auto common_n = this->normalize2();
-    auto common_d = other.normalize2();
-    std::swap(this->_den, other._num);
-    this->_num = this->cross(other);
-    this->_den *= other._den;
-    std::swap(this->_den, common_d);
-    this->normalize2();
-    this->_num *= common_n;
-    this->_den *= common_d;
-    this->normalize2();
-    return *this;
+    return this->sub_assign(
+        rhs, std::integral_constant<bool,
+                                    (detail::overflow_guard<Z>::value > 0)>{});
   }
 
   /**
@@ -698,6 +1262,9 @@ template <typename Z> struct Fraction {
    * @return Fraction
    */
   CONSTEXPR14 auto operator-=(const Z &rhs) -> Fraction & {
+    if (Policy::lazy || detail::overflow_guard<Z>::value > 0) {
+      return *this -= Fraction(rhs);
+    }
     if (this->_den == Z(1)) {
       this->_num -= rhs;
       return *this;
@@ -769,12 +1336,528 @@ template <typename Z> struct Fraction {
    */
   template <typename _Stream>
   friend auto operator<<(_Stream &os, const Fraction &frac) -> _Stream & {
-    os << "(" << frac.num() << "/" << frac.den() << ")";
+    if (Policy::lazy) {
+      auto reduced = frac;
+      reduced.normalize2();
+      os << "(" << reduced.num() << "/" << reduced.den() << ")";
+    } else {
+      os << "(" << frac.num() << "/" << frac.den() << ")";
+    }
     return os;
   }
+
+private:
+  void from_float_(uint64_t mant, int e, bool negative, std::true_type) {
+    const auto digits = std::numeric_limits<Z>::digits;
+    const auto width = detail::bit_width(mant);
+    if ((negative && !std::is_signed<Z>::value) ||
+        (e >= 0 ? width + e > digits : (width > digits || -e >= digits))) {
+      detail::throw_overflow();
+    }
+    const auto m = static_cast<Z>(mant);
+    this->_num = e >= 0 ? static_cast<Z>(m << e) : m;
+    this->_den = e >= 0 ? Z(1) : static_cast<Z>(Z(1) << -e);
+    if (negative) {
+      this->_num = -this->_num;
+    }
+  }
+
+  // arbitrary-precision Z
+  void from_float_(uint64_t mant, int e, bool negative, std::false_type) {
+    const auto m = Z(static_cast<int64_t>(mant));
+    this->_num = e >= 0 ? m * detail::pow2<Z>(e) : m;
+    this->_den = e >= 0 ? Z(1) : detail::pow2<Z>(-e);
+    if (negative) {
+      this->_num = -this->_num;
+    }
+  }
+
+  auto to_double_(std::true_type) const -> double {
+    if (this->_den == Z(0)) {
+      return this->_num == Z(0) ? std::numeric_limits<double>::quiet_NaN()
+             : this->_num > Z(0) ? std::numeric_limits<double>::infinity()
+                                 : -std::numeric_limits<double>::infinity();
+    }
+    if (this->_den == Z(1)) {
+      return static_cast<double>(this->_num);
+    }
+    const auto exact = uint64_t(1) << 53;
+    const auto n = detail::magnitude64(this->_num);
+    const auto d = static_cast<uint64_t>(this->_den);
+    if (n <= exact && d <= exact) {
+      return static_cast<double>(this->_num) / static_cast<double>(this->_den);
+    }
+    const auto q = detail::ratio_to_double(n, d);
+    return this->_num < Z(0) ? -q : q;
+  }
+
+  auto to_double_(std::false_type) const -> double {
+    return static_cast<double>(this->_num) / static_cast<double>(this->_den);
+  }
+
+  static CONSTEXPR14 auto equal_wide(const Fraction &lhs, const Fraction &rhs,
+                                     std::true_type) -> bool {
+    using W = typename detail::Wider<Z>::type;
+    return W(lhs._num) * W(rhs._den) == W(lhs._den) * W(rhs._num);
+  }
+
+  static CONSTEXPR14 auto equal_wide(const Fraction &, const Fraction &,
+                                     std::false_type) -> bool {
+    return false;
+  }
+
+  // sign of a/b, for b >= 0 and a/b not nan
+  static CONSTEXPR14 auto sign(const Z &a) -> int {
+    return a > Z(0) ? 1 : (a < Z(0) ? -1 : 0);
+  }
+
+  /*
+   * a/b < c/d for b, d >= 0; nan is unordered. For builtin signed Z no
+   * gcd is needed: different signs decide at once, otherwise the cross
+   * products are compared in the double-width type, or, without one, the
+   * continued fractions.
+   */
+  static CONSTEXPR14 auto less(const Z &a, const Z &b, const Z &c, const Z &d,
+                               std::integral_constant<int, 2>) -> bool {
+    using W = typename detail::Wider<Z>::type;
+    if ((a == Z(0) && b == Z(0)) || (c == Z(0) && d == Z(0))) {
+      return false;
+    }
+    const auto sa = sign(a);
+    const auto sc = sign(c);
+    if (sa != sc) {
+      return sa < sc;
+    }
+    return sa != 0 && W(a) * W(d) < W(b) * W(c);
+  }
+
+  static CONSTEXPR14 auto less(const Z &a, const Z &b, const Z &c, const Z &d,
+                               std::integral_constant<int, 1>) -> bool {
+    if ((a == Z(0) && b == Z(0)) || (c == Z(0) && d == Z(0))) {
+      return false;
+    }
+    const auto sa = sign(a);
+    const auto sc = sign(c);
+    if (sa != sc) {
+      return sa < sc;
+    }
+    if (sa == 0) {
+      return false;
+    }
+    if (b == Z(0) || d == Z(0)) { // an infinity against the same sign
+      return sa > 0 ? (d == Z(0) && b != Z(0)) : (b == Z(0) && d != Z(0));
+    }
+    return detail::cf_less(a, b, c, d);
+  }
+
+  // other Z: cancel crosswise (two gcds), then cross-multiply
+  static CONSTEXPR14 auto less(const Z &a, const Z &b, const Z &c, const Z &d,
+                               std::integral_constant<int, 0>) -> bool {
+    if (b == d) {
+      return a < c;
+    }
+    auto lhs = Fraction{};
+    lhs._num = a;
+    lhs._den = c;
+    auto rhs = Fraction{};
+    rhs._num = b;
+    rhs._den = d;
+    lhs.normalize2();
+    rhs.normalize2();
+    return lhs._num * rhs._den < lhs._den * rhs._num;
+  }
+
+  // the reducing *=, /= (cross-cancel first, so the products stay small)
+  CONSTEXPR14 auto mul_eager(Fraction rhs) -> Fraction & {
+    std::swap(this->_num, rhs._num);
+    this->normalize2();
+    rhs.normalize2();
+    this->_num = detail::mul(this->_num, rhs._num);
+    this->_den = detail::mul(this->_den, rhs._den);
+    return *this;
+  }
+
+  CONSTEXPR14 auto div_eager(Fraction rhs) -> Fraction & {
+    std::swap(this->_den, rhs._num);
+    this->normalize();
+    rhs.normalize2();
+    this->_num = detail::mul(this->_num, rhs._den);
+    this->_den = detail::mul(this->_den, rhs._num);
+    return *this;
+  }
+
+  /*
+   * *this + rhs (or - rhs) for operands in lowest terms, Knuth's way
+   * (TAOCP 4.5.1): with g = gcd(b, d) and t = a (d/g) + c (b/g), the sum
+   * is (t/g2) / ((b/g) (d/g2)) where g2 = gcd(t mod g, g). Both gcds run
+   * on Z; only the products are double-width, then narrowed.
+   */
+  CONSTEXPR14 auto add(const Fraction &rhs, bool subtract,
+                       std::integral_constant<int, 2>) const -> Fraction {
+    using W = typename detail::Wider<Z>::type;
+    const auto rnum = subtract ? -W(rhs._num) : W(rhs._num);
+    auto res = Fraction{};
+    const auto g = gcd(this->_den, rhs._den);
+    if (g == Z(0)) { // both infinite or nan
+      const auto n = W(this->_num) + rnum;
+      res._num = n > W(0) ? Z(1) : (n < W(0) ? Z(-1) : Z(0));
+      res._den = Z(0);
+      return res;
+    }
+    const auto l = this->_den / g;
+    const auto r = rhs._den / g;
+    auto t = W(this->_num) * W(r) + rnum * W(l);
+    auto g2 = Z(1);
+    if (g != Z(1)) {
+      const auto zmax = W(std::numeric_limits<Z>::max());
+      const auto tmod = -zmax <= t && t <= zmax
+                            ? static_cast<Z>(static_cast<Z>(t) % g)
+                            : static_cast<Z>(t % W(g));
+      g2 = gcd(tmod, g);
+    }
+    if (g2 != Z(1)) {
+      t /= W(g2);
+    }
+    res._num = detail::narrow<Z>(t);
+    res._den = detail::narrow<Z>(W(l) * W(rhs._den / g2));
+    return res;
+  }
+
+  // *this + rhs (or - rhs) with every step checked
+  auto add(const Fraction &rhs, bool subtract,
+           std::integral_constant<int, 1>) const -> Fraction {
+    const auto step = [](bool ok) {
+      if (!ok) {
+        detail::throw_overflow();
+      }
+    };
+    // a numerator of min() (nothing cancelled) could not be negated later
+    const auto result = [&step](const Z &n, const Z &d) {
+      const auto res = Fraction(n, d);
+      step(res._num != std::numeric_limits<Z>::min());
+      return res;
+    };
+    auto n = Z(0);
+    if (this->_den == rhs._den) {
+      step(subtract ? checked_sub(this->_num, rhs._num, n)
+                    : checked_add(this->_num, rhs._num, n));
+      return result(n, this->_den);
+    }
+    const auto common = gcd(this->_den, rhs._den);
+    const auto l = this->_den / common;
+    const auto r = rhs._den / common;
+    auto d = Z(0);
+    auto t1 = Z(0);
+    auto t2 = Z(0);
+    step(checked_mul(this->_den, r, d));
+    step(checked_mul(r, this->_num, t1));
+    step(checked_mul(l, rhs._num, t2));
+    step(subtract ? checked_sub(t1, t2, n) : checked_add(t1, t2, n));
+    return result(n, d);
+  }
+
+  CONSTEXPR14 auto add(const Fraction &rhs, bool subtract,
+                       std::integral_constant<int, 0>) const -> Fraction {
+    if (subtract) {
+      return this->add(-rhs, false, std::integral_constant<int, 0>{});
+    }
+    if (this->_den == rhs._den) {
+      return Fraction(this->_num + rhs._num, this->_den);
+    }
+    const auto common = gcd(this->_den, rhs._den);
+    if (common == Z(0)) {
+      return Fraction(rhs._den * this->_num + this->_den * rhs._num, Z(0));
+    }
+    const auto l = this->_den / common;
+    const auto r = rhs._den / common;
+    auto d = this->_den * r;
+    auto n = r * this->_num + l * rhs._num;
+    return Fraction(std::move(n), std::move(d));
+  }
+
+  CONSTEXPR14 auto sub_assign(const Fraction &rhs, std::true_type)
+      -> Fraction & {
+    *this = this->add(rhs, true, detail::overflow_guard<Z>{});
+    return *this;
+  }
+
+  CONSTEXPR14 auto sub_assign(const Fraction &rhs, std::false_type)
+      -> Fraction & {
+    if (this->_den == rhs._den) {
+      this->_num -= rhs._num;
+      this->normalize2();
+      return *this;
+    }
+
+    auto other{rhs};
+    std::swap(this->_den, other._num);
+    auto common_n = this->normalize2();
+    auto common_d = other.normalize2();
+    std::swap(this->_den, other._num);
+    this->_num = this->cross(other);
+    this->_den *= other._den;
+    std::swap(this->_den, common_d);
+    this->normalize2();
+    this->_num *= common_n;
+    this->_den *= common_d;
+    this->normalize2();
+    return *this;
+  }
+
+  // the lazy invariant: den >= 0, and +-inf and nan as in the eager form
+  CONSTEXPR14 void normalize_lazy() {
+    this->normalize1();
+    if (this->_den == Z(0)) {
+      this->_num = this->_num > Z(0)   ? Z(1)
+                   : this->_num < Z(0) ? -Z(1)
+                                       : Z(0);
+    }
+  }
+
+  // lazy: *this = n/d if it fits in Z; false (and *this untouched) if not
+  template <typename W> CONSTEXPR14 auto assign_wide(W n, W d) -> bool {
+    if (d < W(0)) {
+      n = -n;
+      d = -d;
+    }
+    const auto zmax = W(std::numeric_limits<Z>::max());
+    if (n > zmax || -n > zmax || d > zmax) {
+      return false;
+    }
+    this->_num = static_cast<Z>(n);
+    this->_den = static_cast<Z>(d);
+    this->normalize_lazy();
+    return true;
+  }
+
+  // reduces the operands in Z only when the product does not fit
+  CONSTEXPR14 auto mul_lazy(const Fraction &rhs, bool divide,
+                            std::integral_constant<int, 2>) -> Fraction & {
+    using W = typename detail::Wider<Z>::type;
+    if (this->assign_wide(W(this->_num) * W(divide ? rhs._den : rhs._num),
+                          W(this->_den) * W(divide ? rhs._num : rhs._den))) {
+      return *this;
+    }
+    auto other = rhs;
+    this->normalize();
+    other.normalize();
+    return divide ? this->div_eager(other) : this->mul_eager(other);
+  }
+
+  // falls back to the reducing code when a product overflows
+  auto mul_lazy(const Fraction &rhs, bool divide,
+                std::integral_constant<int, 1>) -> Fraction & {
+    auto n = Z(0);
+    auto d = Z(0);
+    if (checked_mul(this->_num, divide ? rhs._den : rhs._num, n) &&
+        checked_mul(this->_den, divide ? rhs._num : rhs._den, d) &&
+        n != std::numeric_limits<Z>::min() &&
+        d != std::numeric_limits<Z>::min()) {
+      this->_num = n;
+      this->_den = d;
+      this->normalize_lazy();
+      return *this;
+    }
+    auto other = rhs;
+    this->normalize();
+    other.normalize();
+    return divide ? this->div_eager(other) : this->mul_eager(other);
+  }
+
+  CONSTEXPR14 auto mul_lazy(const Fraction &rhs, bool divide,
+                            std::integral_constant<int, 0>) -> Fraction & {
+    auto n = this->_num * (divide ? rhs._den : rhs._num);
+    this->_den = this->_den * (divide ? rhs._num : rhs._den);
+    this->_num = std::move(n);
+    this->normalize_lazy();
+    return *this;
+  }
+
+  CONSTEXPR14 auto add_lazy(const Fraction &rhs, bool subtract,
+                            std::integral_constant<int, 2>) const
+      -> Fraction {
+    using W = typename detail::Wider<Z>::type;
+    const auto rnum = subtract ? -W(rhs._num) : W(rhs._num);
+    auto res = Fraction{};
+    if (this->_den == rhs._den
+            ? res.assign_wide(W(this->_num) + rnum, W(this->_den))
+            : res.assign_wide(W(this->_num) * W(rhs._den) +
+                                  rnum * W(this->_den),
+                              W(this->_den) * W(rhs._den))) {
+      return res;
+    }
+    auto lhs = *this;
+    auto other = rhs;
+    lhs.normalize();
+    other.normalize();
+    return lhs.add(other, subtract, std::integral_constant<int, 2>{});
+  }
+
+  auto add_lazy(const Fraction &rhs, bool subtract,
+                std::integral_constant<int, 1> guard) const -> Fraction {
+    auto res = Fraction{};
+    if (this->_den == rhs._den) {
+      if ((subtract ? checked_sub(this->_num, rhs._num, res._num)
+                    : checked_add(this->_num, rhs._num, res._num)) &&
+          res._num != std::numeric_limits<Z>::min()) {
+        res._den = this->_den;
+        res.normalize_lazy();
+        return res;
+      }
+    } else {
+      auto t1 = Z(0);
+      auto t2 = Z(0);
+      if (checked_mul(this->_num, rhs._den, t1) &&
+          checked_mul(rhs._num, this->_den, t2) &&
+          checked_mul(this->_den, rhs._den, res._den) &&
+          (subtract ? checked_sub(t1, t2, res._num)
+                    : checked_add(t1, t2, res._num)) &&
+          res._num != std::numeric_limits<Z>::min()) {
+        res.normalize_lazy();
+        return res;
+      }
+    }
+    auto lhs = *this;
+    auto other = rhs;
+    lhs.normalize();
+    other.normalize();
+    return lhs.add(other, subtract, guard);
+  }
+
+  CONSTEXPR14 auto add_lazy(const Fraction &rhs, bool subtract,
+                            std::integral_constant<int, 0>) const
+      -> Fraction {
+    auto res = Fraction{};
+    if (this->_den == rhs._den) {
+      res._num = subtract ? this->_num - rhs._num : this->_num + rhs._num;
+      res._den = this->_den;
+    } else {
+      const auto t1 = this->_num * rhs._den;
+      const auto t2 = rhs._num * this->_den;
+      res._num = subtract ? t1 - t2 : t1 + t2;
+      res._den = this->_den * rhs._den;
+    }
+    res.normalize_lazy();
+    return res;
+  }
 };
 
+/**
+ * @brief Fraction that reduces only when it has to
+ *
+ * @tparam Z
+ */
+template <typename Z> using LazyFraction = Fraction<Z, LazyNormalize>;
+
 // For template deduction
 // typename{Z} Fraction(const Z &, const Z &) noexcept -> Fraction<Z>;
 
+namespace detail {
+
+/// Python's hash modulus, the Mersenne prime 2^61 - 1
+constexpr uint64_t hash_modulus = (uint64_t(1) << 61) - 1;
+
+/// x mod 2^61 - 1
+CONSTEXPR14 auto mod61(uint64_t x) -> uint64_t {
+  x = (x & hash_modulus) + (x >> 61);
+  return x >= hash_modulus ? x - hash_modulus : x;
+}
+
+/// a * b mod 2^61 - 1, for a, b < 2^61 - 1
+CONSTEXPR14 auto mulmod61(uint64_t a, uint64_t b) -> uint64_t {
+#if defined(PY2CPP_HAS_INT128)
+  __extension__ typedef unsigned __int128 U128;
+  const auto p = U128(a) * U128(b);
+  return mod61(static_cast<uint64_t>(p & hash_modulus) +
+               static_cast<uint64_t>(p >> 61));
+#else
+  // 31-bit halves; 2^62 == 2 and 2^61 == 1 (mod 2^61 - 1)
+  const auto a1 = a >> 31;
+  const auto a0 = a & 0x7fffffffU;
+  const auto b1 = b >> 31;
+  const auto b0 = b & 0x7fffffffU;
+  const auto mid = a1 * b0 + a0 * b1;
+  const auto hi = mod61(2 * (a1 * b1));
+  const auto m = mod61((mid >> 30) + ((mid & 0x3fffffffU) << 31));
+  return mod61(hi + m + mod61(a0 * b0));
+#endif
+}
+
+CONSTEXPR14 auto powmod61(uint64_t base, uint64_t e) -> uint64_t {
+  auto res = uint64_t(1);
+  for (; e != 0; e >>= 1) {
+    if ((e & 1U) != 0) {
+      res = mulmod61(res, base);
+    }
+    base = mulmod61(base, base);
+  }
+  return res;
+}
+
+} // namespace detail
+
+/**
+ * @brief Python's hash() of the rational num/den (num/den reduced)
+ *
+ * hash(Fraction(2, 1)) == hash(2) == 2, and integers hash without any
+ * modular inverse.
+ *
+ * @tparam Z a builtin integer of at most 64 bits
+ * @param[in] num
+ * @param[in] den non-negative
+ * @return int64_t the value CPython computes
+ */
+template <typename Z>
+CONSTEXPR14 auto py_hash(const Z &num, const Z &den) -> int64_t {
+  static_assert(std::is_integral<Z>::value && sizeof(Z) <= 8,
+                "py_hash needs a builtin integer of at most 64 bits");
+  const auto n = detail::mod61(detail::magnitude64(num));
+  auto h = uint64_t(314159); // the hash of infinity
+  if (den == Z(1)) {
+    h = n;
+  } else {
+    const auto d = detail::mod61(detail::magnitude64(den));
+    if (d != 0) {
+      h = detail::mulmod61(
+          n, detail::powmod61(d, detail::hash_modulus - 2)); // 1 / d
+    }
+  }
+  const auto res = num < Z(0) ? -static_cast<int64_t>(h)
+                              : static_cast<int64_t>(h);
+  return res == -1 ? -2 : res;
+}
+
+/**
+ * @brief Python's hash() of a Fraction
+ *
+ * @tparam Z
+ * @tparam Policy
+ * @param[in] frac
+ * @return int64_t
+ */
+template <typename Z, typename Policy>
+CONSTEXPR14 auto py_hash(const Fraction<Z, Policy> &frac) -> int64_t {
+  if (Policy::lazy && frac._den != Z(1)) {
+    auto reduced = frac;
+    reduced.normalize2();
+    return py_hash(reduced._num, reduced._den);
+  }
+  return py_hash(frac._num, frac._den);
+}
+
 } // namespace fun
+
+namespace std {
+
+/**
+ * @brief Hash for fun::Fraction, equal to Python's hash of the value
+ *
+ * So fractions can key std::unordered_* and py::dict / py::set.
+ */
+template <typename Z, typename Policy> struct hash<fun::Fraction<Z, Policy>> {
+  auto operator()(const fun::Fraction<Z, Policy> &frac) const -> size_t {
+    return static_cast<size_t>(fun::py_hash(frac));
+  }
+};
+
+} // namespace std
@@ -0,0 +1,318 @@
+#pragma once
+
+#include <cstddef> // import size_t
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bulk.hpp"         // import detail::enable_iterable_t
+#include "dict.hpp"         // import key_iterator
+#include "frozen_table.hpp" // import detail::FrozenTable
+
+namespace py {
+
+/**
+ * @brief Immutable dict of trivially copyable keys and values that can be
+ * saved to a file and mapped back without deserialization
+ *
+ * Lookup tables that take seconds to insert into a py::dict at startup can
+ * be built offline and opened in O(1):
+ *
+ *     py::frozen_dict<uint64_t, double>(prices.items()).save("prices.bin");
+ *     const auto D = py::frozen_dict<uint64_t, double>::open("prices.bin");
+ *     D.get(42, 0.0);
+ *
+ * The file is mapped read-only and shared, so processes opening the same
+ * file share its pages. Iteration is over keys; items() yields
+ * (first, second) entries. Copies share the same image.
+ *
+ * @tparam Key
+ * @tparam T
+ * @tparam Hash
+ * @tparam KeyEqual
+ */
+template <typename Key, typename T, typename Hash = frozen_hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class frozen_dict : public detail::FrozenTable<detail::FrozenMapPolicy<Key, T>,
+                                               Hash, KeyEqual> {
+  using Self = frozen_dict<Key, T, Hash, KeyEqual>;
+  using Base =
+      detail::FrozenTable<detail::FrozenMapPolicy<Key, T>, Hash, KeyEqual>;
+  using Entry = detail::FrozenEntry<Key, T>;
+
+public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = Entry;
+
+  /**
+   * @brief Construct a new empty frozen_dict object
+   *
+   */
+  frozen_dict() : Base{} {}
+
+  /**
+   * @brief Construct a new frozen_dict object; a later duplicate key wins
+   *
+   * @param[in] init
+   */
+  frozen_dict(std::initializer_list<std::pair<Key, T>> init)
+      : Base(entries_of(init)) {}
+
+  /**
+   * @brief Construct a new frozen_dict object from (key, value) pairs
+   *
+   * @param[in] first
+   * @param[in] last
+   */
+  template <typename InputIt>
+  frozen_dict(InputIt first, InputIt last)
+      : Base(entries_of(first, last)) {}
+
+  /**
+   * @brief Construct a new frozen_dict object from an iterable of
+   * (key, value) pairs, e.g. `py::frozen_dict<size_t, T>(py::enumerate(v))`
+   * or `py::frozen_dict<K, T>(d.items())`
+   *
+   * @param[in] pairs
+   */
+  template <typename Iterable,
+            typename = detail::enable_iterable_t<Iterable, Self,
+                                                 std::allocator<Entry>>>
+  explicit frozen_dict(const Iterable &pairs)
+      : Base(entries_of(std::begin(pairs), std::end(pairs))) {}
+
+  /**
+   * @brief New frozen_dict mapping every key of `keys` to `value`
+   *
+   * @param[in] keys
+   * @param[in] value
+   * @return Self
+   */
+  template <typename Iterable>
+  static auto fromkeys(const Iterable &keys, const T &value = T()) -> Self {
+    auto entries = std::vector<Entry>{};
+    detail::reserve_for_range(entries, keys);
+    for (const auto &key : keys) {
+      entries.push_back(Entry{key, value});
+    }
+    return Self(entries, 0);
+  }
+
+  /**
+   * @brief Map a file written by save(); throws std::runtime_error if it is
+   * missing or was written for other key or value types
+   *
+   * @param[in] path
+   * @return Self
+   */
+  static auto open(const std::string &path) -> Self {
+    auto res = Self{};
+    res.attach_file(path);
+    return res;
+  }
+
+  /**
+   * @brief Use an image already in memory (e.g. another data() or a
+   * section of a larger mapping) without copying or owning it
+   *
+   * @param[in] data must outlive the dict
+   * @param[in] nbytes
+   * @return Self
+   */
+  static auto view(const void *data, size_t nbytes) -> Self {
+    auto res = Self{};
+    res.attach_view(data, nbytes);
+    return res;
+  }
+
+  /**
+   * @brief
+   *
+   * @param[in] key
+   * @return true
+   * @return false
+   */
+  auto contains(const Key &key) const -> bool {
+    return this->find_index(key) != Base::npos;
+  }
+
+  /**
+   * @brief Single-probe lookup
+   *
+   * @param[in] key
+   * @return const T* the value, or nullptr if `key` is absent
+   */
+  auto get(const Key &key) const -> const T * {
+    const auto i = this->find_index(key);
+    return i == Base::npos ? nullptr : &this->_slots[i].second;
+  }
+
+  /**
+   * @brief
+   *
+   * @param[in] key
+   * @param[in] default_value
+   * @return const T&
+   */
+  auto get(const Key &key, const T &default_value) const -> const T & {
+    const auto *v = this->get(key);
+    return v != nullptr ? *v : default_value;
+  }
+
+  /**
+   * @brief
+   *
+   * @return key_iterator<typename Base::const_iterator>
+   */
+  auto begin() const -> key_iterator<typename Base::const_iterator> {
+    return key_iterator<typename Base::const_iterator>{Base::begin()};
+  }
+
+  /**
+   * @brief
+   *
+   * @return key_iterator<typename Base::const_iterator>
+   */
+  auto end() const -> key_iterator<typename Base::const_iterator> {
+    return key_iterator<typename Base::const_iterator>{Base::end()};
+  }
+
+  /**
+   * @brief
+   *
+   * @return const Base& iterable of (first, second) entries
+   */
+  auto items() const -> const Base & { return *this; }
+
+  /**
+   * @brief
+   *
+   * @return Self sharing the same image
+   */
+  auto copy() const -> Self { return *this; }
+
+  /**
+   * @brief
+   *
+   * @param[in] k
+   * @return const T&
+   */
+  auto at(const Key &k) const -> const T & {
+    const auto *v = this->get(k);
+    if (v == nullptr) {
+      throw std::out_of_range("frozen_dict::at");
+    }
+    return *v;
+  }
+
+  /**
+   * @brief
+   *
+   * @param[in] k
+   * @return const T&
+   */
+  auto operator[](const Key &k) const -> const T & { return this->at(k); }
+
+  friend auto operator==(const Self &a, const Self &b) -> bool {
+    if (a.size() != b.size()) {
+      return false;
+    }
+    for (const auto &e : a.items()) {
+      const auto *v = b.get(e.first);
+      if (v == nullptr || !(*v == e.second)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  friend auto operator!=(const Self &a, const Self &b) -> bool {
+    return !(a == b);
+  }
+
+  /**
+   * @brief
+   *
+   * @return Self&
+   */
+  auto operator=(const Self &) -> Self & = delete;
+
+  /**
+   * @brief
+   *
+   * @return Self&
+   */
+  auto operator=(Self &&) noexcept -> Self & = default;
+
+  /**
+   * @brief Move Constructor (default)
+   *
+   */
+  frozen_dict(Self &&) noexcept = default;
+
+  // private:
+  /**
+   * @brief Copy Constructor
+   *
+   * Copy through explicitly the public copy() function!!!
+   */
+  frozen_dict(const Self &) = default;
+
+private:
+  frozen_dict(const std::vector<Entry> &entries, int /* tag */)
+      : Base(entries) {}
+
+  template <typename InputIt>
+  static auto entries_of(InputIt first, InputIt last) -> std::vector<Entry> {
+    auto entries = std::vector<Entry>{};
+    for (; first != last; ++first) {
+      const auto &kv = *first;
+      entries.push_back(Entry{kv.first, kv.second});
+    }
+    return entries;
+  }
+
+  static auto entries_of(std::initializer_list<std::pair<Key, T>> init)
+      -> std::vector<Entry> {
+    return entries_of(init.begin(), init.end());
+  }
+};
+
+/**
+ * @brief
+ *
+ * @tparam Key
+ * @tparam T
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @param[in] key
+ * @param[in] m
+ * @return true
+ * @return false
+ */
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+inline auto operator<(const Key &key,
+                      const frozen_dict<Key, T, Hash, KeyEqual> &m) -> bool {
+  return m.contains(key);
+}
+
+/**
+ * @brief
+ *
+ * @tparam Key
+ * @tparam T
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @param[in] m
+ * @return size_t
+ */
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+inline auto len(const frozen_dict<Key, T, Hash, KeyEqual> &m) -> size_t {
+  return m.size();
+}
+
+} // namespace py
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <cstddef> // import size_t
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bulk.hpp"         // import detail::enable_iterable_t
+#include "frozen_table.hpp" // import detail::FrozenTable
+#include "set.hpp"          // import detail::issubset
+
+namespace py {
+
+/**
+ * @brief Immutable set of trivially copyable keys that can be saved to a
+ * file and mapped back without deserialization
+ *
+ * Build it once, save() it, and open() it at startup instead of
+ * re-inserting every key:
+ *
+ *     py::frozen_set<uint64_t>(ids).save("ids.bin");
+ *     const auto S = py::frozen_set<uint64_t>::open("ids.bin");
+ *     S.contains(42);
+ *
+ * Copies share the same read-only image.
+ *
+ * @tparam Key
+ * @tparam Hash
+ * @tparam KeyEqual
+ */
+template <typename Key, typename Hash = frozen_hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class frozen_set
+    : public detail::FrozenTable<detail::FrozenSetPolicy<Key>, Hash, KeyEqual> {
+  using Self = frozen_set<Key, Hash, KeyEqual>;
+  using Base =
+      detail::FrozenTable<detail::FrozenSetPolicy<Key>, Hash, KeyEqual>;
+
+public:
+  using key_type = Key;
+  using value_type = Key;
+
+  /**
+   * @brief Construct a new empty frozen_set object
+   *
+   */
+  frozen_set() : Base{} {}
+
+  /**
+   * @brief Construct a new frozen_set object
+   *
+   * @param[in] start
+   * @param[in] stop
+   */
+  template <typename FwdIter>
+  frozen_set(const FwdIter &start, const FwdIter &stop)
+      : Base(std::vector<Key>(start, stop)) {}
+
+  /**
+   * @brief Construct a new frozen_set object from an iterable, e.g.
+   * `py::frozen_set<int>(py::range(10))`
+   *
+   * @param[in] iterable
+   */
+  template <typename Iterable, typename = detail::enable_iterable_t<
+                                   Iterable, Self, std::allocator<Key>>>
+  explicit frozen_set(const Iterable &iterable)
+      : Base(std::vector<Key>(std::begin(iterable), std::end(iterable))) {}
+
+  /**
+   * @brief Construct a new frozen_set object
+   *
+   * @param[in] init
+   */
+  frozen_set(std::initializer_list<Key> init)
+      : Base(std::vector<Key>(init)) {}
+
+  /**
+   * @brief Map a file written by save(); throws std::runtime_error if it is
+   * missing or was written for other key types
+   *
+   * @param[in] path
+   * @return Self
+   */
+  static auto open(const std::string &path) -> Self {
+    auto res = Self{};
+    res.attach_file(path);
+    return res;
+  }
+
+  /**
+   * @brief Use an image already in memory (e.g. another data() or a
+   * section of a larger mapping) without copying or owning it
+   *
+   * @param[in] data must outlive the set
+   * @param[in] nbytes
+   * @return Self
+   */
+  static auto view(const void *data, size_t nbytes) -> Self {
+    auto res = Self{};
+    res.attach_view(data, nbytes);
+    return res;
+  }
+
+  /**
+   * @brief
+   *
+   * @param[in] key
+   * @return true
+   * @return false
+   */
+  auto contains(const Key &key) const -> bool {
+    return this->find_index(key) != Base::npos;
+  }
+
+  /**
+   * @brief
+   *
+   * @return Self sharing the same image
+   */
+  auto copy() const -> Self { return *this; }
+
+  /**
+   * @brief Test whether every element is in `other`
+   *
+   * @param[in] other
+   * @return true
+   * @return false
+   */
+  auto issubset(const Self &other) const -> bool {
+    return detail::issubset(*this, other);
+  }
+
+  /**
+   * @brief Test whether every element of `other` is in this set
+   *
+   * @param[in] other
+   * @return true
+   * @return false
+   */
+  auto issuperset(const Self &other) const -> bool {
+    return detail::issubset(other, *this);
+  }
+
+  /**
+   * @brief Test whether the two sets have no element in common
+   *
+   * @param[in] other
+   * @return true
+   * @return false
+   */
+  auto isdisjoint(const Self &other) const -> bool {
+    return detail::isdisjoint(*this, other);
+  }
+
+  friend auto operator==(const Self &a, const Self &b) -> bool {
+    return a.size() == b.size() && detail::issubset(a, b);
+  }
+
+  friend auto operator!=(const Self &a, const Self &b) -> bool {
+    return !(a == b);
+  }
+
+  /**
+   * @brief
+   *
+   * @return Self&
+   */
+  auto operator=(const Self &) -> Self & = delete;
+
+  /**
+   * @brief
+   *
+   * @return Self&
+   */
+  auto operator=(Self &&) noexcept -> Self & = default;
+
+  /**
+   * @brief Move Constructor (default)
+   *
+   */
+  frozen_set(Self &&) noexcept = default;
+
+  // private:
+  /**
+   * @brief Copy Constructor
+   *
+   * Copy through explicitly the public copy() function!!!
+   */
+  frozen_set(const Self &) = default;
+};
+
+/**
+ * @brief
+ *
+ * @tparam Key
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @param[in] key
+ * @param[in] m
+ * @return true
+ * @return false
+ */
+template <typename Key, typename Hash, typename KeyEqual>
+inline auto operator<(const Key &key, const frozen_set<Key, Hash, KeyEqual> &m)
+    -> bool {
+  return m.contains(key);
+}
+
+/**
+ * @brief
+ *
+ * @tparam Key
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @param[in] m
+ * @return size_t
+ */
+template <typename Key, typename Hash, typename KeyEqual>
+inline auto len(const frozen_set<Key, Hash, KeyEqual> &m) -> size_t {
+  return m.size();
+}
+
+} // namespace py
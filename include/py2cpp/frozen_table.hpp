@@ -0,0 +1,610 @@
+#pragma once
+
+/** @file include/py2cpp/frozen_table.hpp
+ *  Immutable open-addressing table shared by frozen_set and frozen_dict.
+ *
+ *  The whole table is one flat, position-independent byte image:
+ *
+ *      FrozenHeader | ctrl[capacity] | padding | slots[capacity]
+ *
+ *  A control byte is 0 for an empty slot, otherwise 0x80 | the top 7 bits
+ *  of the key's hash; lookups probe linearly and only compare keys whose
+ *  control byte matches. The image is built once in memory, can be written
+ *  with save() and is opened again with open(), which maps the file
+ *  read-only instead of reading it: nothing is deserialized or rehashed,
+ *  pages are faulted in on first use and processes opening the same file
+ *  share them through the page cache.
+ *
+ *  Keys and values are stored as raw bytes, so they must be trivially
+ *  copyable and an image can only be opened by a build with the same type
+ *  sizes, alignments, byte order and Hash. The first four are checked by
+ *  open(); the hash is not, so keep the default py::frozen_hash (stable
+ *  across processes and platforms) unless every reader agrees on another.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace py {
+
+namespace detail {
+
+/// splitmix64 finalizer
+inline auto frozen_mix(uint64_t x) -> uint64_t {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+} // namespace detail
+
+/**
+ * @brief Hash of a frozen table key, stable across processes and builds
+ *
+ * Integers and enums hash their value; other trivially copyable keys hash
+ * their object bytes, so they must have no padding and compare equal
+ * exactly when their bytes do.
+ *
+ * @tparam Key
+ */
+template <typename Key, typename = void> struct frozen_hash {
+  static_assert(std::is_trivially_copyable<Key>::value,
+                "frozen_hash: keys must be trivially copyable");
+
+  auto operator()(const Key &key) const noexcept -> uint64_t {
+    unsigned char bytes[sizeof(Key)];
+    std::memcpy(bytes, &key, sizeof(Key));
+    uint64_t h = 0xcbf29ce484222325ULL; // FNV-1a
+    for (const auto b : bytes) {
+      h ^= b;
+      h *= 0x100000001b3ULL;
+    }
+    return h;
+  }
+};
+
+template <typename Key>
+struct frozen_hash<
+    Key, typename std::enable_if<std::is_integral<Key>::value ||
+                                 std::is_enum<Key>::value>::type> {
+  auto operator()(const Key &key) const noexcept -> uint64_t {
+    return static_cast<uint64_t>(key);
+  }
+};
+
+namespace detail {
+
+/**
+ * @brief (key, value) slot of a frozen_dict
+ *
+ * A plain aggregate rather than std::pair, which is not trivially copyable.
+ *
+ * @tparam Key
+ * @tparam T
+ */
+template <typename Key, typename T> struct FrozenEntry {
+  Key first;
+  T second;
+};
+
+/**
+ * @brief Policy of a frozen set: slots are the keys themselves
+ *
+ * @tparam Key
+ */
+template <typename Key> struct FrozenSetPolicy {
+  using key_type = Key;
+  using value_type = Key;
+  static constexpr uint32_t value_size = 0;
+  static constexpr uint32_t value_align = 0;
+
+  static auto key(const value_type &v) -> const Key & { return v; }
+};
+
+/**
+ * @brief Policy of a frozen dict
+ *
+ * @tparam Key
+ * @tparam T
+ */
+template <typename Key, typename T> struct FrozenMapPolicy {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "frozen_dict: values must be trivially copyable");
+
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = FrozenEntry<Key, T>;
+  static constexpr uint32_t value_size = sizeof(T);
+  static constexpr uint32_t value_align = alignof(T);
+
+  static auto key(const value_type &v) -> const Key & { return v.first; }
+};
+
+/**
+ * @brief Fixed-size header at the start of a frozen image
+ */
+struct FrozenHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t key_size;
+  uint32_t key_align;
+  uint32_t value_size;
+  uint32_t value_align;
+  uint64_t size;
+  uint64_t capacity;
+  uint64_t ctrl_offset;
+  uint64_t slots_offset;
+  uint64_t nbytes;
+};
+
+constexpr char kFrozenMagic[8] = {'p', 'y', '2', 'c', 'f', 'r', 'z', '\0'};
+constexpr uint32_t kFrozenVersion = 1;
+constexpr uint32_t kFrozenByteOrder = 0x01020304;
+constexpr uint64_t kFrozenSlotAlign = 64;
+
+/**
+ * @brief Read-only mapping of a whole file
+ */
+class MappedFile {
+  const unsigned char *_data{nullptr};
+  size_t _size{0};
+#if defined(_WIN32)
+  HANDLE _file{INVALID_HANDLE_VALUE};
+  HANDLE _map{nullptr};
+#endif
+
+public:
+  explicit MappedFile(const std::string &path) {
+#if defined(_WIN32)
+    this->_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (this->_file == INVALID_HANDLE_VALUE) {
+      throw_last_error(GetLastError(), "cannot open " + path);
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(this->_file, &size)) {
+      const auto err = GetLastError();
+      this->close();
+      throw_last_error(err, "cannot stat " + path);
+    }
+    this->_size = static_cast<size_t>(size.QuadPart);
+    if (this->_size != 0) {
+      this->_map = CreateFileMappingA(this->_file, nullptr, PAGE_READONLY, 0,
+                                      0, nullptr);
+      const void *p = this->_map == nullptr
+                          ? nullptr
+                          : MapViewOfFile(this->_map, FILE_MAP_READ, 0, 0, 0);
+      if (p == nullptr) {
+        const auto err = GetLastError();
+        this->close();
+        throw_last_error(err, "cannot map " + path);
+      }
+      this->_data = static_cast<const unsigned char *>(p);
+    }
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw_errno("cannot open " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      throw_errno("cannot stat " + path);
+    }
+    this->_size = static_cast<size_t>(st.st_size);
+    if (this->_size != 0) {
+      void *p = ::mmap(nullptr, this->_size, PROT_READ, MAP_SHARED, fd, 0);
+      if (p == MAP_FAILED) {
+        ::close(fd);
+        throw_errno("cannot map " + path);
+      }
+      this->_data = static_cast<const unsigned char *>(p);
+    }
+    ::close(fd); // the mapping keeps the file alive
+#endif
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  auto operator=(const MappedFile &) -> MappedFile & = delete;
+
+  ~MappedFile() { this->close(); }
+
+  auto data() const -> const unsigned char * { return this->_data; }
+  auto size() const -> size_t { return this->_size; }
+
+private:
+  void close() noexcept {
+#if defined(_WIN32)
+    if (this->_data != nullptr) {
+      UnmapViewOfFile(this->_data);
+    }
+    if (this->_map != nullptr) {
+      CloseHandle(this->_map);
+    }
+    if (this->_file != INVALID_HANDLE_VALUE) {
+      CloseHandle(this->_file);
+    }
+    this->_map = nullptr;
+    this->_file = INVALID_HANDLE_VALUE;
+#else
+    if (this->_data != nullptr) {
+      ::munmap(const_cast<unsigned char *>(this->_data), this->_size);
+    }
+#endif
+    this->_data = nullptr;
+  }
+
+#if defined(_WIN32)
+  [[noreturn]] static void throw_last_error(DWORD err,
+                                            const std::string &what) {
+    throw std::system_error(static_cast<int>(err),
+                            std::system_category(), "frozen table: " + what);
+  }
+#else
+  [[noreturn]] static void throw_errno(const std::string &what) {
+    throw std::system_error(errno, std::generic_category(),
+                            "frozen table: " + what);
+  }
+#endif
+};
+
+/**
+ * @brief Iterator over the full slots of a frozen table
+ *
+ * @tparam Value
+ */
+template <typename Value> class FrozenTableIterator {
+  const uint8_t *_ctrl{nullptr};
+  const Value *_slots{nullptr};
+  size_t _i{0};
+  size_t _capacity{0};
+
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = Value;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const Value *;
+  using reference = const Value &;
+
+  FrozenTableIterator() = default;
+  FrozenTableIterator(const uint8_t *ctrl, const Value *slots, size_t i,
+                      size_t capacity)
+      : _ctrl{ctrl}, _slots{slots}, _i{i}, _capacity{capacity} {
+    this->skip_empty();
+  }
+
+  auto operator*() const -> reference { return this->_slots[this->_i]; }
+  auto operator->() const -> pointer { return &**this; }
+
+  auto operator++() -> FrozenTableIterator & {
+    ++this->_i;
+    this->skip_empty();
+    return *this;
+  }
+
+  auto operator++(int) -> FrozenTableIterator {
+    auto old = *this;
+    ++*this;
+    return old;
+  }
+
+  auto operator==(const FrozenTableIterator &other) const -> bool {
+    return this->_i == other._i;
+  }
+
+  auto operator!=(const FrozenTableIterator &other) const -> bool {
+    return this->_i != other._i;
+  }
+
+private:
+  void skip_empty() {
+    while (this->_i != this->_capacity && this->_ctrl[this->_i] == 0) {
+      ++this->_i;
+    }
+  }
+};
+
+/**
+ * @brief Immutable hash table living in one contiguous byte image
+ *
+ * The image is either owned (built in memory) or a read-only file mapping;
+ * copies share it.
+ *
+ * @tparam Policy FrozenSetPolicy or FrozenMapPolicy
+ * @tparam Hash returns a uint64_t; must be the same for writer and readers
+ * @tparam KeyEqual
+ */
+template <typename Policy, typename Hash, typename KeyEqual>
+class FrozenTable {
+public:
+  using key_type = typename Policy::key_type;
+  using value_type = typename Policy::value_type;
+  using size_type = size_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using const_iterator = FrozenTableIterator<value_type>;
+  using iterator = const_iterator;
+
+  static_assert(std::is_trivially_copyable<key_type>::value,
+                "frozen tables store their keys as raw bytes");
+  static_assert(alignof(value_type) <= alignof(std::max_align_t),
+                "frozen tables do not support over-aligned slots");
+
+protected:
+  static constexpr size_t npos = ~size_t(0);
+
+  std::shared_ptr<const unsigned char> _image; // owned buffer or mapping
+  size_t _nbytes{0};
+  const uint8_t *_ctrl{nullptr};
+  const value_type *_slots{nullptr};
+  size_t _size{0};
+  size_t _mask{0};
+  Hash _hash{};
+  KeyEqual _eq{};
+
+public:
+  auto size() const -> size_t { return this->_size; }
+  auto empty() const -> bool { return this->_size == 0; }
+  auto capacity() const -> size_t { return this->_mask + 1; }
+
+  auto hash_function() const -> hasher { return this->_hash; }
+  auto key_eq() const -> key_equal { return this->_eq; }
+
+  auto begin() const -> const_iterator {
+    return const_iterator(this->_ctrl, this->_slots, 0, this->capacity());
+  }
+
+  auto end() const -> const_iterator {
+    return const_iterator(this->_ctrl, this->_slots, this->capacity(),
+                          this->capacity());
+  }
+
+  auto find(const key_type &key) const -> const_iterator {
+    const auto i = this->find_index(key);
+    return i == npos ? this->end()
+                     : const_iterator(this->_ctrl, this->_slots, i,
+                                      this->capacity());
+  }
+
+  auto count(const key_type &key) const -> size_t {
+    return this->find_index(key) == npos ? 0 : 1;
+  }
+
+  /**
+   * @brief The serialized image: write these bytes anywhere and open or
+   * view() them again later
+   *
+   * @return const void*
+   */
+  auto data() const -> const void * { return this->_image.get(); }
+
+  /**
+   * @brief Size in bytes of the serialized image
+   *
+   * @return size_t
+   */
+  auto nbytes() const -> size_t { return this->_nbytes; }
+
+  /**
+   * @brief Write the image to `path`
+   *
+   * @param[in] path
+   */
+  void save(const std::string &path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(this->_image.get()),
+              static_cast<std::streamsize>(this->_nbytes));
+    out.close();
+    if (!out) {
+      throw std::runtime_error("frozen table: cannot write " + path);
+    }
+  }
+
+protected:
+  FrozenTable() { this->build(std::vector<value_type>{}); }
+
+  explicit FrozenTable(const std::vector<value_type> &entries) {
+    this->build(entries);
+  }
+
+  auto find_index(const key_type &key) const -> size_t {
+    const auto h = detail::frozen_mix(this->_hash(key));
+    const auto tag = static_cast<uint8_t>(0x80U | (h >> 57));
+    auto i = static_cast<size_t>(h) & this->_mask;
+    // bounded so that a corrupted image cannot loop forever
+    for (size_t step = 0; step <= this->_mask; ++step) {
+      const auto c = this->_ctrl[i];
+      if (c == 0) {
+        return npos;
+      }
+      if (c == tag && this->_eq(Policy::key(this->_slots[i]), key)) {
+        return i;
+      }
+      i = (i + 1) & this->_mask;
+    }
+    return npos;
+  }
+
+  /**
+   * @brief Build an owned image of `entries`; a later duplicate key
+   * replaces an earlier one
+   *
+   * @param[in] entries
+   */
+  void build(const std::vector<value_type> &entries) {
+    // load factor below 3/4 keeps at least one empty slot
+    size_t capacity = 1;
+    while (capacity - capacity / 4 <= entries.size()) {
+      capacity *= 2;
+    }
+    const auto slots_offset = static_cast<size_t>(
+        align_up(sizeof(FrozenHeader) + capacity, kFrozenSlotAlign));
+    const auto nbytes = slots_offset + capacity * sizeof(value_type);
+
+    // not std::max_align_t itself: copying its long double member may leave
+    // padding bytes uninitialized, and the control bytes must start at zero
+    struct alignas(std::max_align_t) Word {
+      unsigned char bytes[alignof(std::max_align_t)];
+    };
+    auto words = std::make_shared<std::vector<Word>>(
+        (nbytes + sizeof(Word) - 1) / sizeof(Word));
+    auto *base = reinterpret_cast<unsigned char *>(words->data());
+    auto *ctrl = reinterpret_cast<uint8_t *>(base + sizeof(FrozenHeader));
+    auto *slots = reinterpret_cast<value_type *>(base + slots_offset);
+
+    const auto mask = capacity - 1;
+    size_t size = 0;
+    for (const auto &e : entries) {
+      const auto h = detail::frozen_mix(this->_hash(Policy::key(e)));
+      const auto tag = static_cast<uint8_t>(0x80U | (h >> 57));
+      auto i = static_cast<size_t>(h) & mask;
+      while (true) {
+        if (ctrl[i] == 0) {
+          ctrl[i] = tag;
+          ::new (static_cast<void *>(slots + i)) value_type(e);
+          ++size;
+          break;
+        }
+        if (ctrl[i] == tag &&
+            this->_eq(Policy::key(slots[i]), Policy::key(e))) {
+          slots[i] = e;
+          break;
+        }
+        i = (i + 1) & mask;
+      }
+    }
+
+    FrozenHeader header{};
+    std::memcpy(header.magic, kFrozenMagic, sizeof(kFrozenMagic));
+    header.version = kFrozenVersion;
+    header.byte_order = kFrozenByteOrder;
+    header.key_size = static_cast<uint32_t>(sizeof(key_type));
+    header.key_align = static_cast<uint32_t>(alignof(key_type));
+    header.value_size = Policy::value_size;
+    header.value_align = Policy::value_align;
+    header.size = size;
+    header.capacity = capacity;
+    header.ctrl_offset = sizeof(FrozenHeader);
+    header.slots_offset = slots_offset;
+    header.nbytes = nbytes;
+    std::memcpy(base, &header, sizeof(header));
+
+    this->attach(std::shared_ptr<const unsigned char>(words, base), nbytes);
+  }
+
+  /**
+   * @brief Map the image stored in `path`
+   *
+   * @param[in] path
+   */
+  void attach_file(const std::string &path) {
+    auto file = std::make_shared<MappedFile>(path);
+    const auto *p = file->data();
+    const auto n = file->size();
+    this->attach(std::shared_ptr<const unsigned char>(std::move(file), p), n);
+  }
+
+  /**
+   * @brief Use the image at `data` without owning it
+   *
+   * @param[in] data must outlive the table and its copies
+   * @param[in] nbytes
+   */
+  void attach_view(const void *data, size_t nbytes) {
+    // aliasing an empty shared_ptr: get() returns `data`, nothing is owned
+    this->attach(std::shared_ptr<const unsigned char>(
+                     std::shared_ptr<void>(),
+                     static_cast<const unsigned char *>(data)),
+                 nbytes);
+  }
+
+  /**
+   * @brief Point the table at a validated image
+   *
+   * @param[in] image kept alive by the table
+   * @param[in] nbytes bytes available at `image`
+   */
+  void attach(std::shared_ptr<const unsigned char> image, size_t nbytes) {
+    const auto *base = image.get();
+    if (base == nullptr || nbytes < sizeof(FrozenHeader)) {
+      throw std::runtime_error("frozen table: image too small");
+    }
+    FrozenHeader h;
+    std::memcpy(&h, base, sizeof(h));
+    if (std::memcmp(h.magic, kFrozenMagic, sizeof(kFrozenMagic)) != 0) {
+      throw std::runtime_error("frozen table: not a frozen table image");
+    }
+    if (h.version != kFrozenVersion || h.byte_order != kFrozenByteOrder) {
+      throw std::runtime_error("frozen table: unsupported version or byte "
+                               "order");
+    }
+    if (h.key_size != sizeof(key_type) || h.key_align != alignof(key_type) ||
+        h.value_size != Policy::value_size ||
+        h.value_align != Policy::value_align) {
+      throw std::runtime_error("frozen table: key or value type mismatch");
+    }
+    // every slot has a control byte, so capacity <= nbytes bounds the
+    // products below
+    if (h.capacity == 0 || (h.capacity & (h.capacity - 1)) != 0 ||
+        h.capacity > nbytes || h.size >= h.capacity ||
+        h.ctrl_offset != sizeof(FrozenHeader) ||
+        h.slots_offset < h.ctrl_offset + h.capacity ||
+        h.slots_offset % alignof(value_type) != 0 || h.nbytes > nbytes ||
+        h.slots_offset > h.nbytes ||
+        (h.nbytes - h.slots_offset) / sizeof(value_type) < h.capacity) {
+      throw std::runtime_error("frozen table: corrupted header");
+    }
+    const auto *slots = base + h.slots_offset;
+    if (reinterpret_cast<uintptr_t>(slots) % alignof(value_type) != 0) {
+      throw std::runtime_error("frozen table: misaligned image");
+    }
+    this->_ctrl = reinterpret_cast<const uint8_t *>(base + h.ctrl_offset);
+    this->_slots = reinterpret_cast<const value_type *>(slots);
+    this->_size = static_cast<size_t>(h.size);
+    this->_mask = static_cast<size_t>(h.capacity - 1);
+    this->_nbytes = static_cast<size_t>(h.nbytes);
+    this->_image = std::move(image);
+  }
+
+private:
+  static auto align_up(uint64_t n, uint64_t a) -> uint64_t {
+    return (n + a - 1) / a * a;
+  }
+};
+
+} // namespace detail
+
+} // namespace py
@@ -0,0 +1,258 @@
+#pragma once
+
+/** @file include/py2cpp/generator.hpp
+ *  C++20 coroutine generator for arbitrary `yield` code.
+ *
+ *      auto fib() -> py::generator<long> {
+ *        auto a = 0L, b = 1L;
+ *        while (true) {
+ *          co_yield a;
+ *          a = std::exchange(b, a + b);
+ *        }
+ *      }
+ *      auto total = py::sum(py::islice(fib(), 10)); // 88
+ *
+ *  The coroutine frames come from a per-thread pool of recycled blocks, so
+ *  a generator created in a loop does not hit malloc after the first few
+ *  iterations. Before C++20 (or without <coroutine>) this header is empty
+ *  and PY2CPP_HAS_COROUTINE is not defined.
+ */
+
+#if defined(__has_include)
+#if __has_include(<coroutine>) && defined(__cpp_impl_coroutine)
+#include <coroutine>
+#if defined(__cpp_lib_coroutine)
+#define PY2CPP_HAS_COROUTINE 1
+#endif
+#endif
+#endif
+
+#if defined(PY2CPP_HAS_COROUTINE)
+
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace py {
+
+namespace detail {
+
+/**
+ * @brief Free lists of coroutine frames, by 64-byte size class
+ *
+ * Frames up to 1 KiB are recycled; each class keeps at most 32 blocks.
+ * A frame may be freed by another thread than the one that created it:
+ * it then joins that thread's pool.
+ */
+class FramePool {
+  static constexpr size_t kGranule = 64;
+  static constexpr size_t kClasses = 16;
+  static constexpr size_t kKeep = 32;
+
+  struct Free {
+    Free *next;
+  };
+
+  Free *_lists[kClasses]{};
+  size_t _counts[kClasses]{};
+
+public:
+  FramePool() = default;
+  FramePool(const FramePool &) = delete;
+  auto operator=(const FramePool &) -> FramePool & = delete;
+
+  ~FramePool() {
+    closed() = true;
+    for (auto *head : this->_lists) {
+      while (head != nullptr) {
+        ::operator delete(std::exchange(head, head->next));
+      }
+    }
+  }
+
+  static auto instance() -> FramePool & {
+    thread_local FramePool pool;
+    return pool;
+  }
+
+  /// Set once the pool of this thread is gone (thread exit)
+  static auto closed() -> bool & {
+    thread_local bool flag = false;
+    return flag;
+  }
+
+  static auto allocate(size_t n) -> void * {
+    const auto c = size_class(n);
+    if (c < kClasses && !closed()) {
+      auto &pool = instance();
+      if (auto *p = pool._lists[c]) {
+        pool._lists[c] = p->next;
+        --pool._counts[c];
+        return p;
+      }
+      return ::operator new((c + 1) * kGranule);
+    }
+    return ::operator new(n);
+  }
+
+  static void deallocate(void *p, size_t n) noexcept {
+    const auto c = size_class(n);
+    if (c < kClasses && !closed()) {
+      auto &pool = instance();
+      if (pool._counts[c] != kKeep) {
+        pool._lists[c] = ::new (p) Free{pool._lists[c]};
+        ++pool._counts[c];
+        return;
+      }
+    }
+    ::operator delete(p);
+  }
+
+private:
+  static constexpr auto size_class(size_t n) -> size_t {
+    return (n + kGranule - 1) / kGranule - 1;
+  }
+};
+
+} // namespace detail
+
+/**
+ * @brief Python generator: a lazily evaluated, single-pass iterable
+ *
+ * The body runs up to the first `co_yield` when iteration begins and
+ * resumes at every ++; an exception escaping the body is rethrown there.
+ * Composes with py::map, py::filter, py::islice, py::chain and py::sum.
+ *
+ * @tparam T the yielded type
+ */
+template <typename T> class generator {
+public:
+  class promise_type {
+    const T *_value{nullptr};
+    std::exception_ptr _error{};
+
+    friend class generator;
+
+  public:
+    auto get_return_object() -> generator {
+      return generator{
+          std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    auto initial_suspend() noexcept -> std::suspend_always { return {}; }
+    auto final_suspend() noexcept -> std::suspend_always { return {}; }
+
+    /// The yielded object outlives the suspension, so keep its address
+    auto yield_value(const T &value) noexcept -> std::suspend_always {
+      this->_value = std::addressof(value);
+      return {};
+    }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept {
+      this->_error = std::current_exception();
+    }
+
+    /// Disallow co_await inside a generator
+    template <typename U> auto await_transform(U &&) = delete;
+
+    static auto operator new(size_t n) -> void * {
+      return detail::FramePool::allocate(n);
+    }
+    static void operator delete(void *p, size_t n) noexcept {
+      detail::FramePool::deallocate(p, n);
+    }
+  };
+
+  using handle_type = std::coroutine_handle<promise_type>;
+
+  class iterator {
+    handle_type _h{};
+
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T *;
+    using reference = const T &;
+
+    iterator() = default;
+    explicit iterator(handle_type h) : _h{h} { this->resume(); }
+
+    auto operator*() const -> reference { return *this->_h.promise()._value; }
+    auto operator->() const -> pointer { return this->_h.promise()._value; }
+
+    auto operator++() -> iterator & {
+      this->resume();
+      return *this;
+    }
+    void operator++(int) { this->resume(); }
+
+    /// A finished generator compares equal to end()
+    friend auto operator==(const iterator &a, const iterator &b) -> bool {
+      return a.done() == b.done();
+    }
+    friend auto operator!=(const iterator &a, const iterator &b) -> bool {
+      return !(a == b);
+    }
+
+  private:
+    auto done() const -> bool { return !this->_h || this->_h.done(); }
+
+    void resume() {
+      this->_h.resume();
+      if (this->_h.done()) {
+        auto error = std::exchange(this->_h.promise()._error, nullptr);
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      }
+    }
+  };
+
+  using const_iterator = iterator;
+
+  generator() = default;
+  generator(generator &&other) noexcept
+      : _h{std::exchange(other._h, nullptr)} {}
+  auto operator=(generator &&other) noexcept -> generator & {
+    if (this != &other) {
+      this->reset();
+      this->_h = std::exchange(other._h, nullptr);
+    }
+    return *this;
+  }
+  generator(const generator &) = delete;
+  auto operator=(const generator &) -> generator & = delete;
+  ~generator() { this->reset(); }
+
+  /**
+   * @brief Start (the first time) the body and return the first element
+   *
+   * Single pass: iterating again continues where the last loop stopped.
+   * const so that lazy adaptors holding the generator can iterate it.
+   *
+   * @return iterator
+   */
+  auto begin() const -> iterator {
+    return this->_h && !this->_h.done() ? iterator{this->_h} : iterator{};
+  }
+  auto end() const -> iterator { return iterator{}; }
+
+private:
+  handle_type _h{};
+
+  explicit generator(handle_type h) : _h{h} {}
+
+  void reset() {
+    if (this->_h) {
+      this->_h.destroy();
+      this->_h = nullptr;
+    }
+  }
+};
+
+} // namespace py
+
+#endif
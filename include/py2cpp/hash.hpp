@@ -0,0 +1,100 @@
+#pragma once
+
+/** @file include/py2cpp/hash.hpp
+ *  Transparent hashing for heterogeneous lookup.
+ *
+ *  With `py::string_hash` and `std::equal_to<>` a string-keyed table can be
+ *  probed with a `const char *` or `std::string_view` without building a
+ *  temporary std::string:
+ *
+ *      py::flat_dict<std::string, int, py::string_hash, std::equal_to<>> d;
+ *      d.contains("key"); // no allocation
+ *
+ *  The flat containers support this in every language mode. py::dict and
+ *  py::set delegate to std::unordered_*, which only gained heterogeneous
+ *  lookup in C++20; before that they fall back to converting the key.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <type_traits>
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <string_view>
+#define PY2CPP_HAS_STRING_VIEW 1
+#endif
+
+#if defined(__cpp_lib_generic_unordered_lookup) &&                            \
+    __cpp_lib_generic_unordered_lookup >= 201811L
+#define PY2CPP_HAS_GENERIC_UNORDERED_LOOKUP 1
+#endif
+
+namespace py {
+
+/**
+ * @brief Transparent hash for std::string keys
+ *
+ * Hashes std::string, `const char *` and std::string_view to the same
+ * value for the same characters.
+ */
+struct string_hash {
+  using is_transparent = void;
+
+#if defined(PY2CPP_HAS_STRING_VIEW)
+  auto operator()(std::string_view s) const noexcept -> size_t {
+    return std::hash<std::string_view>{}(s);
+  }
+  auto operator()(const std::string &s) const noexcept -> size_t {
+    return (*this)(std::string_view(s));
+  }
+  auto operator()(const char *s) const noexcept -> size_t {
+    return (*this)(std::string_view(s));
+  }
+#else
+  auto operator()(const std::string &s) const noexcept -> size_t {
+    return hash_bytes(s.data(), s.size());
+  }
+  auto operator()(const char *s) const noexcept -> size_t {
+    return hash_bytes(s, std::strlen(s));
+  }
+
+private:
+  // FNV-1a; the flat tables mix the result again before probing
+  static auto hash_bytes(const char *p, size_t n) noexcept -> size_t {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i != n; ++i) {
+      h ^= static_cast<unsigned char>(p[i]);
+      h *= 0x100000001b3ULL;
+    }
+    return static_cast<size_t>(h);
+  }
+#endif
+};
+
+namespace detail {
+
+template <typename T, typename = void>
+struct has_is_transparent : std::false_type {};
+
+template <typename T>
+struct has_is_transparent<
+    T, typename std::conditional<true, void, typename T::is_transparent>::type>
+    : std::true_type {};
+
+/**
+ * @brief Enabled when both the hash and the key equality are transparent
+ *
+ * @tparam Hash
+ * @tparam KeyEqual
+ */
+template <typename Hash, typename KeyEqual>
+using enable_transparent_t =
+    typename std::enable_if<has_is_transparent<Hash>::value &&
+                            has_is_transparent<KeyEqual>::value>::type;
+
+} // namespace detail
+
+} // namespace py
@@ -0,0 +1,271 @@
+#pragma once
+
+/** @file include/py2cpp/hybrid_int.hpp
+ *  An integer that is an inline int64_t until it outgrows it.
+ *
+ *      using Z = fun::hybrid_int<boost::multiprecision::cpp_int>;
+ *      auto f = fun::Fraction<Z>{1, 3}; // no allocation
+ *      f *= f;                          // inline until it outgrows int64_t
+ *
+ *  Like CPython's small ints: values that fit in 64 bits are stored and
+ *  computed inline (with overflow-checked builtins); a result that does
+ *  not fit is redone in `Big` and kept on the heap, and a big result that
+ *  fits again is demoted. The representation is canonical (big if and
+ *  only if it does not fit in int64_t), so equality never has to compare
+ *  a small value with a big one.
+ */
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "fractions.hpp" // import fun::checked_add, fun::detail::gcd_euclid
+
+namespace fun {
+
+/**
+ * @brief int64_t that promotes to `Big` on overflow
+ *
+ * Usable as the `Z` of fun::Fraction<Z>.
+ *
+ * @tparam Big an arbitrary-precision integer (e.g. cpp_int):
+ *             constructible from int64_t, with + - * / % and comparisons,
+ *             and explicitly convertible to int64_t
+ */
+template <typename Big> class hybrid_int {
+  int64_t _small{0};
+  std::unique_ptr<Big> _big{}; // non-null iff the value does not fit
+
+  using Limits = std::numeric_limits<int64_t>;
+
+public:
+  using big_type = Big;
+
+  hybrid_int() = default;
+
+  /**
+   * @brief Construct a new hybrid_int object (implicit, like an integer)
+   *
+   * @param[in] value
+   */
+  hybrid_int(int64_t value) noexcept : _small{value} {}
+
+  hybrid_int(const hybrid_int &other)
+      : _small{other._small},
+        _big{other._big ? std::make_unique<Big>(*other._big) : nullptr} {}
+
+  hybrid_int(hybrid_int &&) noexcept = default;
+
+  auto operator=(const hybrid_int &other) -> hybrid_int & {
+    if (other._big && this->_big) {
+      *this->_big = *other._big;
+    } else {
+      this->_big = other._big ? std::make_unique<Big>(*other._big) : nullptr;
+    }
+    this->_small = other._small;
+    return *this;
+  }
+
+  auto operator=(hybrid_int &&) noexcept -> hybrid_int & = default;
+
+  /**
+   * @brief The canonical hybrid_int holding `value`
+   *
+   * @param[in] value
+   * @return hybrid_int small if `value` fits in int64_t
+   */
+  static auto from_big(Big value) -> hybrid_int {
+    auto res = hybrid_int{};
+    if (Big(Limits::min()) <= value && value <= Big(Limits::max())) {
+      res._small = static_cast<int64_t>(value);
+    } else {
+      res._big = std::make_unique<Big>(std::move(value));
+    }
+    return res;
+  }
+
+  /// Whether the value is stored inline
+  auto is_small() const noexcept -> bool { return !this->_big; }
+
+  /// The value as a Big
+  auto to_big() const -> Big {
+    return this->_big ? *this->_big : Big(this->_small);
+  }
+
+  /** @name Arithmetic
+   *  Inline when both operands and the result fit in int64_t.
+   */
+  ///@{
+
+  friend auto operator+(const hybrid_int &a, const hybrid_int &b)
+      -> hybrid_int {
+    auto res = int64_t{0};
+    if (a.is_small() && b.is_small() && checked_add(a._small, b._small, res)) {
+      return hybrid_int{res};
+    }
+    return from_big(a.to_big() + b.to_big());
+  }
+
+  friend auto operator-(const hybrid_int &a, const hybrid_int &b)
+      -> hybrid_int {
+    auto res = int64_t{0};
+    if (a.is_small() && b.is_small() && checked_sub(a._small, b._small, res)) {
+      return hybrid_int{res};
+    }
+    return from_big(a.to_big() - b.to_big());
+  }
+
+  friend auto operator*(const hybrid_int &a, const hybrid_int &b)
+      -> hybrid_int {
+    auto res = int64_t{0};
+    if (a.is_small() && b.is_small() && checked_mul(a._small, b._small, res)) {
+      return hybrid_int{res};
+    }
+    return from_big(a.to_big() * b.to_big());
+  }
+
+  /// Truncating division
+  /// @exception std::domain_error on division by zero
+  friend auto operator/(const hybrid_int &a, const hybrid_int &b)
+      -> hybrid_int {
+    check_divisor(b);
+    auto res = int64_t{0};
+    if (a.is_small() && b.is_small() && checked_div(a._small, b._small, res)) {
+      return hybrid_int{res};
+    }
+    return from_big(a.to_big() / b.to_big());
+  }
+
+  /// Remainder with the sign of `a`
+  /// @exception std::domain_error on division by zero
+  friend auto operator%(const hybrid_int &a, const hybrid_int &b)
+      -> hybrid_int {
+    check_divisor(b);
+    if (a.is_small() && b.is_small()) {
+      // -1 would trap on min() % -1
+      return hybrid_int{b._small == -1 ? 0 : a._small % b._small};
+    }
+    return from_big(a.to_big() % b.to_big());
+  }
+
+  auto operator-() const -> hybrid_int {
+    if (this->is_small() && this->_small != Limits::min()) {
+      return hybrid_int{-this->_small};
+    }
+    return from_big(-this->to_big());
+  }
+
+  auto operator+=(const hybrid_int &rhs) -> hybrid_int & {
+    return *this = *this + rhs;
+  }
+  auto operator-=(const hybrid_int &rhs) -> hybrid_int & {
+    return *this = *this - rhs;
+  }
+  auto operator*=(const hybrid_int &rhs) -> hybrid_int & {
+    return *this = *this * rhs;
+  }
+  auto operator/=(const hybrid_int &rhs) -> hybrid_int & {
+    return *this = *this / rhs;
+  }
+  auto operator%=(const hybrid_int &rhs) -> hybrid_int & {
+    return *this = *this % rhs;
+  }
+
+  ///@}
+
+  /** @name Comparison operators
+   */
+  ///@{
+
+  friend auto operator==(const hybrid_int &a, const hybrid_int &b) -> bool {
+    if (a.is_small() || b.is_small()) {
+      // canonical form: a small value never equals a big one
+      return a.is_small() && b.is_small() && a._small == b._small;
+    }
+    return *a._big == *b._big;
+  }
+
+  friend auto operator<(const hybrid_int &a, const hybrid_int &b) -> bool {
+    if (a.is_small() && b.is_small()) {
+      return a._small < b._small;
+    }
+    return a.to_big() < b.to_big();
+  }
+
+  friend auto operator!=(const hybrid_int &a, const hybrid_int &b) -> bool {
+    return !(a == b);
+  }
+  friend auto operator>(const hybrid_int &a, const hybrid_int &b) -> bool {
+    return b < a;
+  }
+  friend auto operator<=(const hybrid_int &a, const hybrid_int &b) -> bool {
+    return !(b < a);
+  }
+  friend auto operator>=(const hybrid_int &a, const hybrid_int &b) -> bool {
+    return !(a < b);
+  }
+
+  ///@}
+
+  /**
+   * @brief Greatest common divider (found by ADL, e.g. from Fraction)
+   *
+   * Euclid on the inline magnitudes; Big only when an operand is big.
+   *
+   * @param[in] m
+   * @param[in] n
+   * @return hybrid_int non-negative
+   */
+  friend auto gcd(const hybrid_int &m, const hybrid_int &n) -> hybrid_int {
+    if (m.is_small() && n.is_small()) {
+      const auto g = detail::gcd_euclid(magnitude(m._small),
+                                        magnitude(n._small));
+      if (g <= static_cast<uint64_t>(Limits::max())) {
+        return hybrid_int{static_cast<int64_t>(g)};
+      }
+      return from_big(-Big(Limits::min())); // gcd(min(), 0) == 2^63
+    }
+    // Euclid in Big itself: fun::gcd would recurse on the expression
+    // templates of Big's operators (boost::multiprecision)
+    Big a = m.to_big();
+    Big b = n.to_big();
+    if (a < Big(0)) {
+      a = -a;
+    }
+    if (b < Big(0)) {
+      b = -b;
+    }
+    while (b != Big(0)) {
+      Big r = a % b;
+      a = std::move(b);
+      b = std::move(r);
+    }
+    return from_big(std::move(a));
+  }
+
+  template <typename Stream>
+  friend auto operator<<(Stream &os, const hybrid_int &x) -> Stream & {
+    if (x._big) {
+      os << *x._big;
+    } else {
+      os << x._small;
+    }
+    return os;
+  }
+
+private:
+  static void check_divisor(const hybrid_int &b) {
+    if (b.is_small() && b._small == 0) {
+      throw std::domain_error("hybrid_int: division by zero");
+    }
+  }
+
+  static auto magnitude(int64_t x) -> uint64_t {
+    return x < 0 ? uint64_t(0) - static_cast<uint64_t>(x)
+                 : static_cast<uint64_t>(x);
+  }
+};
+
+} // namespace fun
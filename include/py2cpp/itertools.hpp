@@ -0,0 +1,592 @@
+#pragma once
+
+/** @file include/py2cpp/itertools.hpp
+ *  Lazy map, filter, islice and chain, and the sum/any/all reductions.
+ *
+ *  The adaptors compose like the Python built-ins and never store an
+ *  element: each ++ of the outermost iterator pulls exactly the elements
+ *  it needs through the whole stack.
+ *
+ *      // sum(f(x) for x in xs if p(x))
+ *      auto total = py::sum(py::map(f, py::filter(p, xs)));
+ *
+ *      for (auto x : py::islice(py::chain(xs, ys), 2, 10, 2)) {}
+ *
+ *  As with enumerate and zip, an lvalue iterable is kept by reference and
+ *  an rvalue (a py::range, another adaptor, a py::generator) is moved in.
+ *  The callables are invoked as const, so a capturing lambda should not
+ *  be `mutable`.
+ */
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "bulk.hpp" // import detail::view_t, detail::capped_category_t
+#include "zip.hpp"  // import detail::BoolPack, detail::all_sized
+
+namespace py {
+
+namespace detail {
+
+/**
+ * @brief The category of `It`, capped at forward: map, filter, islice and
+ * chain only step forward
+ */
+template <typename It>
+using forward_category_t =
+    typename std::common_type<capped_category_t<It>,
+                              std::forward_iterator_tag>::type;
+
+template <typename It> using deref_t = decltype(*std::declval<It &>());
+
+template <typename F, typename It> struct MapIterator {
+  using iterator_category = forward_category_t<It>;
+  using reference = decltype(std::declval<const F &>()(*std::declval<It &>()));
+  using value_type = typename std::decay<reference>::type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+
+  It it{};
+  const F *fn{nullptr};
+
+  auto operator*() const -> reference { return (*this->fn)(*this->it); }
+
+  auto operator++() -> MapIterator & {
+    ++this->it;
+    return *this;
+  }
+  auto operator++(int) -> MapIterator {
+    auto temp = *this;
+    ++*this;
+    return temp;
+  }
+
+  friend auto operator==(const MapIterator &a, const MapIterator &b) -> bool {
+    return a.it == b.it;
+  }
+  friend auto operator!=(const MapIterator &a, const MapIterator &b) -> bool {
+    return !(a == b);
+  }
+};
+
+/**
+ * @brief
+ *
+ * @tparam F
+ * @tparam T `X &` for an lvalue iterable, `X` for a moved-in rvalue
+ */
+template <typename F, typename T> struct MapIterableWrapper {
+  using iterator = MapIterator<F, view_iterator_t<T>>;
+  using const_iterator = iterator;
+
+  F fn;
+  T iterable;
+
+  auto begin() const -> iterator {
+    view_t<T> r = this->iterable;
+    return iterator{std::begin(r), &this->fn};
+  }
+  auto end() const -> iterator {
+    view_t<T> r = this->iterable;
+    return iterator{std::end(r), &this->fn};
+  }
+
+  /// Available when the underlying iterable knows its size
+  template <typename U = T>
+  auto size() const -> decltype(std::declval<view_t<U>>().size()) {
+    return this->iterable.size();
+  }
+};
+
+template <typename P, typename It> struct FilterIterator {
+  using iterator_category = forward_category_t<It>;
+  using reference = deref_t<It>;
+  using value_type = typename std::decay<reference>::type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+
+  It it{};
+  It last{};
+  const P *pred{nullptr};
+
+  FilterIterator() = default;
+  FilterIterator(It it, It last, const P *pred)
+      : it{std::move(it)}, last{std::move(last)}, pred{pred} {
+    this->satisfy();
+  }
+
+  auto operator*() const -> reference { return *this->it; }
+
+  auto operator++() -> FilterIterator & {
+    ++this->it;
+    this->satisfy();
+    return *this;
+  }
+  auto operator++(int) -> FilterIterator {
+    auto temp = *this;
+    ++*this;
+    return temp;
+  }
+
+  friend auto operator==(const FilterIterator &a, const FilterIterator &b)
+      -> bool {
+    return a.it == b.it;
+  }
+  friend auto operator!=(const FilterIterator &a, const FilterIterator &b)
+      -> bool {
+    return !(a == b);
+  }
+
+private:
+  void satisfy() {
+    while (this->it != this->last && !(*this->pred)(*this->it)) {
+      ++this->it;
+    }
+  }
+};
+
+/**
+ * @brief
+ *
+ * @tparam P
+ * @tparam T `X &` for an lvalue iterable, `X` for a moved-in rvalue
+ */
+template <typename P, typename T> struct FilterIterableWrapper {
+  using iterator = FilterIterator<P, view_iterator_t<T>>;
+  using const_iterator = iterator;
+
+  P pred;
+  T iterable;
+
+  auto begin() const -> iterator {
+    view_t<T> r = this->iterable;
+    return iterator{std::begin(r), std::end(r), &this->pred};
+  }
+  auto end() const -> iterator {
+    view_t<T> r = this->iterable;
+    return iterator{std::end(r), std::end(r), &this->pred};
+  }
+};
+
+/**
+ * @brief Iterator over positions start, start + step, ... < stop
+ *
+ * Never advances the underlying iterator past `stop`, so islice over a
+ * generator consumes no more than it yields.
+ */
+template <typename It> struct IsliceIterator {
+  using iterator_category = forward_category_t<It>;
+  using reference = deref_t<It>;
+  using value_type = typename std::decay<reference>::type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+
+  It it{};
+  It last{};
+  size_t pos{0};
+  size_t stop{0};
+  size_t step{1};
+
+  IsliceIterator() = default;
+  IsliceIterator(It it, It last, size_t start, size_t stop, size_t step)
+      : it{std::move(it)}, last{std::move(last)}, stop{stop}, step{step} {
+    this->advance(start);
+  }
+
+  auto operator*() const -> reference { return *this->it; }
+
+  auto operator++() -> IsliceIterator & {
+    this->advance(this->step);
+    return *this;
+  }
+  auto operator++(int) -> IsliceIterator {
+    auto temp = *this;
+    ++*this;
+    return temp;
+  }
+
+  /// Every exhausted iterator is equal to the end
+  friend auto operator==(const IsliceIterator &a, const IsliceIterator &b)
+      -> bool {
+    const auto a_done = a.done();
+    return a_done == b.done() && (a_done || a.pos == b.pos);
+  }
+  friend auto operator!=(const IsliceIterator &a, const IsliceIterator &b)
+      -> bool {
+    return !(a == b);
+  }
+
+private:
+  auto done() const -> bool {
+    return this->pos >= this->stop || this->it == this->last;
+  }
+
+  void advance(size_t n) {
+    for (; n != 0 && !this->done(); --n) {
+      if (++this->pos == this->stop) {
+        return; // done: do not step past the last element
+      }
+      ++this->it;
+    }
+  }
+};
+
+/**
+ * @brief
+ *
+ * @tparam T `X &` for an lvalue iterable, `X` for a moved-in rvalue
+ */
+template <typename T> struct IsliceIterableWrapper {
+  using iterator = IsliceIterator<view_iterator_t<T>>;
+  using const_iterator = iterator;
+
+  T iterable;
+  size_t start;
+  size_t stop;
+  size_t step;
+
+  auto begin() const -> iterator {
+    view_t<T> r = this->iterable;
+    return iterator{std::begin(r), std::end(r), this->start, this->stop,
+                    this->step};
+  }
+  auto end() const -> iterator {
+    view_t<T> r = this->iterable;
+    return iterator{std::end(r), std::end(r), 0, 0, this->step};
+  }
+
+  /// Available when the underlying iterable knows its size
+  template <typename U = T>
+  auto size() const
+      -> decltype(static_cast<size_t>(std::declval<view_t<U>>().size())) {
+    const auto n = static_cast<size_t>(this->iterable.size());
+    const auto last = n < this->stop ? n : this->stop;
+    return this->start >= last
+               ? 0
+               : (last - this->start + this->step - 1) / this->step;
+  }
+};
+
+/**
+ * @brief The element type of a chain: the common reference when all the
+ * iterables agree on it, otherwise their common value type
+ */
+template <typename It, typename... Its> struct ChainReference {
+  using same = std::is_same<
+      BoolPack<true, std::is_same<deref_t<Its>, deref_t<It>>::value...>,
+      BoolPack<std::is_same<deref_t<Its>, deref_t<It>>::value..., true>>;
+  using type = typename std::conditional<
+      same::value, deref_t<It>,
+      typename std::common_type<typename std::decay<deref_t<It>>::type,
+                                typename std::decay<deref_t<Its>>::type...>::
+          type>::type;
+};
+
+template <typename... Its> struct ChainIterator {
+  using iterator_category =
+      typename std::common_type<forward_category_t<Its>...>::type;
+  using reference = typename ChainReference<Its...>::type;
+  using value_type = typename std::decay<reference>::type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+
+  static constexpr size_t N = sizeof...(Its);
+  using Last = std::integral_constant<size_t, N - 1>;
+
+  std::tuple<Its...> cur{};
+  std::tuple<Its...> last{};
+  size_t which{N}; // the iterable being walked; N at the end
+
+  ChainIterator() = default;
+  ChainIterator(std::tuple<Its...> cur, std::tuple<Its...> last, size_t which)
+      : cur{std::move(cur)}, last{std::move(last)}, which{which} {
+    this->skip_empty(std::integral_constant<size_t, 0>{});
+  }
+
+  auto operator*() const -> reference {
+    return this->deref(std::integral_constant<size_t, 0>{});
+  }
+
+  auto operator++() -> ChainIterator & {
+    this->increment(std::integral_constant<size_t, 0>{});
+    this->skip_empty(std::integral_constant<size_t, 0>{});
+    return *this;
+  }
+  auto operator++(int) -> ChainIterator {
+    auto temp = *this;
+    ++*this;
+    return temp;
+  }
+
+  friend auto operator==(const ChainIterator &a, const ChainIterator &b)
+      -> bool {
+    return a.which == b.which &&
+           (a.which == N || a.equal(b, std::integral_constant<size_t, 0>{}));
+  }
+  friend auto operator!=(const ChainIterator &a, const ChainIterator &b)
+      -> bool {
+    return !(a == b);
+  }
+
+private:
+  template <size_t I>
+  auto deref(std::integral_constant<size_t, I>) const -> reference {
+    if (this->which == I) {
+      return *std::get<I>(this->cur);
+    }
+    return this->deref(std::integral_constant<size_t, I + 1>{});
+  }
+  auto deref(Last) const -> reference { return *std::get<N - 1>(this->cur); }
+
+  template <size_t I> void increment(std::integral_constant<size_t, I>) {
+    if (this->which == I) {
+      ++std::get<I>(this->cur);
+      return;
+    }
+    this->increment(std::integral_constant<size_t, I + 1>{});
+  }
+  void increment(Last) { ++std::get<N - 1>(this->cur); }
+
+  template <size_t I>
+  auto equal(const ChainIterator &other, std::integral_constant<size_t, I>)
+      const -> bool {
+    if (this->which == I) {
+      return std::get<I>(this->cur) == std::get<I>(other.cur);
+    }
+    return this->equal(other, std::integral_constant<size_t, I + 1>{});
+  }
+  auto equal(const ChainIterator &other, Last) const -> bool {
+    return std::get<N - 1>(this->cur) == std::get<N - 1>(other.cur);
+  }
+
+  // move on to the next non-empty iterable
+  template <size_t I> void skip_empty(std::integral_constant<size_t, I>) {
+    if (this->which == I && std::get<I>(this->cur) == std::get<I>(this->last)) {
+      ++this->which;
+    }
+    this->skip_empty(std::integral_constant<size_t, I + 1>{});
+  }
+  void skip_empty(std::integral_constant<size_t, N>) {}
+};
+
+/**
+ * @brief
+ *
+ * @tparam Ts `X &` for an lvalue iterable, `X` for a moved-in rvalue
+ */
+template <typename... Ts> struct ChainIterableWrapper {
+  using iterator = ChainIterator<view_iterator_t<Ts>...>;
+  using const_iterator = iterator;
+
+  std::tuple<Ts...> iterables;
+
+  auto begin() const -> iterator {
+    return this->make(std::index_sequence_for<Ts...>{}, 0);
+  }
+  auto end() const -> iterator {
+    return this->make(std::index_sequence_for<Ts...>{}, sizeof...(Ts));
+  }
+
+  /// The total length; available when every iterable knows its size
+  template <typename U = std::tuple<Ts...>>
+  auto size() const ->
+      typename std::enable_if<all_sized<U>::value, size_t>::type {
+    return this->size_(std::index_sequence_for<Ts...>{});
+  }
+
+private:
+  template <size_t... I>
+  auto make(std::index_sequence<I...>, size_t which) const -> iterator {
+    using Its = std::tuple<view_iterator_t<Ts>...>;
+    const auto last = Its{
+        std::end(static_cast<view_t<Ts>>(std::get<I>(this->iterables)))...};
+    if (which == sizeof...(Ts)) {
+      return iterator{last, last, which};
+    }
+    return iterator{Its{std::begin(static_cast<view_t<Ts>>(
+                        std::get<I>(this->iterables)))...},
+                    last, which};
+  }
+
+  template <size_t... I>
+  auto size_(std::index_sequence<I...>) const -> size_t {
+    const size_t sizes[] = {
+        0, static_cast<size_t>(std::get<I>(this->iterables).size())...};
+    auto total = size_t(0);
+    for (auto n : sizes) {
+      total += n;
+    }
+    return total;
+  }
+};
+
+} // namespace detail
+
+/**
+ * @brief Python map(function, iterable): lazily yields `fn(x)`
+ *
+ *     for (auto y : py::map([](int x) { return x * x; }, xs)) {}
+ *
+ * @tparam F
+ * @tparam T
+ * @param[in] fn
+ * @param[in] iterable
+ * @return detail::MapIterableWrapper<F, T>
+ */
+template <typename F, typename T>
+inline auto map(F fn, T &&iterable) -> detail::MapIterableWrapper<F, T> {
+  return detail::MapIterableWrapper<F, T>{std::move(fn),
+                                          std::forward<T>(iterable)};
+}
+
+/**
+ * @brief Python filter(function, iterable): lazily skips the elements for
+ * which `pred(x)` is false
+ *
+ *     for (auto &x : py::filter([](int x) { return x % 2 == 0; }, xs)) {}
+ *
+ * Yields references into the iterable, so the elements can be modified.
+ *
+ * @tparam P
+ * @tparam T
+ * @param[in] pred
+ * @param[in] iterable
+ * @return detail::FilterIterableWrapper<P, T>
+ */
+template <typename P, typename T>
+inline auto filter(P pred, T &&iterable)
+    -> detail::FilterIterableWrapper<P, T> {
+  return detail::FilterIterableWrapper<P, T>{std::move(pred),
+                                             std::forward<T>(iterable)};
+}
+
+/**
+ * @brief Python itertools.islice(iterable, start, stop, step)
+ *
+ * Pass std::numeric_limits<size_t>::max() as `stop` for Python's None.
+ *
+ * @tparam T
+ * @param[in] iterable
+ * @param[in] start
+ * @param[in] stop
+ * @param[in] step
+ * @return detail::IsliceIterableWrapper<T>
+ * @exception std::invalid_argument if `step` is 0 (Python ValueError)
+ */
+template <typename T>
+inline auto islice(T &&iterable, size_t start, size_t stop, size_t step = 1)
+    -> detail::IsliceIterableWrapper<T> {
+  if (step == 0) {
+    throw std::invalid_argument("islice: step must be positive");
+  }
+  return detail::IsliceIterableWrapper<T>{std::forward<T>(iterable), start,
+                                          stop, step};
+}
+
+/**
+ * @brief Python itertools.islice(iterable, stop): the first `stop` elements
+ *
+ * @tparam T
+ * @param[in] iterable
+ * @param[in] stop
+ * @return detail::IsliceIterableWrapper<T>
+ */
+template <typename T>
+inline auto islice(T &&iterable, size_t stop)
+    -> detail::IsliceIterableWrapper<T> {
+  return detail::IsliceIterableWrapper<T>{std::forward<T>(iterable), 0, stop,
+                                          1};
+}
+
+/**
+ * @brief Python itertools.chain(*iterables)
+ *
+ *     for (auto &x : py::chain(xs, ys)) { x = 0; } // both vectors
+ *
+ * Yields references when every iterable yields the same reference type,
+ * otherwise values of their common type (e.g. chaining a vector<int> with
+ * py::range(10)).
+ *
+ * @tparam Ts
+ * @param[in] iterables
+ * @return detail::ChainIterableWrapper<Ts...>
+ */
+template <typename... Ts>
+inline auto chain(Ts &&...iterables) -> detail::ChainIterableWrapper<Ts...> {
+  static_assert(sizeof...(Ts) > 0, "chain() needs at least one iterable");
+  return detail::ChainIterableWrapper<Ts...>{
+      std::tuple<Ts...>{std::forward<Ts>(iterables)...}};
+}
+
+/**
+ * @brief Python sum(iterable, start)
+ *
+ * Accumulates with `+=`, so a Fraction total does not normalize twice.
+ *
+ * @tparam Iterable
+ * @tparam T
+ * @param[in] iterable
+ * @param[in] start
+ * @return T
+ */
+template <typename Iterable, typename T>
+inline auto sum(const Iterable &iterable, T start) -> T {
+  for (auto &&x : iterable) {
+    start += x;
+  }
+  return start;
+}
+
+/**
+ * @brief Python sum(iterable), starting from a value-initialized element
+ *
+ * @tparam Iterable
+ * @param[in] iterable
+ * @return the element type
+ */
+template <typename Iterable>
+inline auto sum(const Iterable &iterable) -> detail::range_value_t<Iterable> {
+  return py::sum(iterable, detail::range_value_t<Iterable>{});
+}
+
+/**
+ * @brief Python any(iterable): stops at the first true element
+ *
+ *     py::any(py::map([](int x) { return x < 0; }, xs));
+ *
+ * @tparam Iterable
+ * @param[in] iterable
+ * @return true
+ * @return false
+ */
+template <typename Iterable> inline auto any(const Iterable &iterable) -> bool {
+  for (auto &&x : iterable) {
+    if (x) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Python all(iterable): stops at the first false element
+ *
+ * @tparam Iterable
+ * @param[in] iterable
+ * @return true
+ * @return false
+ */
+template <typename Iterable> inline auto all(const Iterable &iterable) -> bool {
+  for (auto &&x : iterable) {
+    if (!x) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace py
@@ -0,0 +1,947 @@
+#pragma once
+
+/** @file include/py2cpp/ordered_dict.hpp
+ *  Insertion-ordered dict with CPython's compact layout.
+ *
+ *      auto d = py::ordered_dict<std::string, int>{{"b", 1}, {"a", 2}};
+ *      d["c"] = 3;
+ *      for (const auto &kv : d.items()) { ... } // b, a, c: always
+ *
+ *  As in CPython 3.6+, the (key, value) pairs are appended to a dense
+ *  entries array and the hash table proper holds only indices into it,
+ *  each 1, 2, 4 or 8 bytes wide depending on the table size. Iteration
+ *  walks the entries array front to back, so it is deterministic and
+ *  contiguous, and an entry costs the pair, its hash and about 1.5 small
+ *  indices instead of a heap node.
+ *
+ *  Deleting leaves a hole in the entries array that iteration skips. The
+ *  holes are squeezed out when the table grows or once they outnumber the
+ *  live entries, which moves the remaining entries: references and
+ *  iterators are invalidated by any insertion or erasure.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "arena.hpp"      // import PY2CPP_HAS_PMR
+#include "bulk.hpp"       // import detail::reserve_for
+#include "dict.hpp"       // import key_iterator
+#include "flat_table.hpp" // import detail::flat_hash_mix
+#include "hash.hpp"       // import detail::enable_transparent_t
+
+namespace py {
+
+namespace detail {
+
+/// Stored hash of a removed entry (stored hashes are shifted right by one)
+constexpr size_t kDeadEntry = ~size_t(0);
+
+/// Index table slot values; an entry index `ix` is stored as ix + kSlotBase
+constexpr size_t kSlotEmpty = 0;
+constexpr size_t kSlotDummy = 1;
+constexpr size_t kSlotBase = 2;
+
+/**
+ * @brief Iterator over the live entries of an ordered_dict, in order
+ *
+ * @tparam Entry
+ */
+template <typename Entry> class OrderedDictIterator {
+  const Entry *_pos{nullptr};
+  const size_t *_hash{nullptr};
+  const size_t *_end{nullptr};
+
+  void skip_dead() {
+    while (this->_hash != this->_end && *this->_hash == kDeadEntry) {
+      ++this->_pos;
+      ++this->_hash;
+    }
+  }
+
+public:
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = Entry;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const Entry *;
+  using reference = const Entry &;
+
+  OrderedDictIterator() = default;
+
+  OrderedDictIterator(const Entry *pos, const size_t *hash, const size_t *end)
+      : _pos{pos}, _hash{hash}, _end{end} {
+    this->skip_dead();
+  }
+
+  auto operator*() const -> reference { return *this->_pos; }
+  auto operator->() const -> pointer { return this->_pos; }
+
+  auto operator++() -> OrderedDictIterator & {
+    ++this->_pos;
+    ++this->_hash;
+    this->skip_dead();
+    return *this;
+  }
+
+  auto operator++(int) -> OrderedDictIterator {
+    auto old = *this;
+    ++*this;
+    return old;
+  }
+
+  // the first entry is never dead when there is something before us
+  auto operator--() -> OrderedDictIterator & {
+    do {
+      --this->_pos;
+      --this->_hash;
+    } while (*this->_hash == kDeadEntry);
+    return *this;
+  }
+
+  auto operator--(int) -> OrderedDictIterator {
+    auto old = *this;
+    --*this;
+    return old;
+  }
+
+  auto operator==(const OrderedDictIterator &other) const -> bool {
+    return this->_pos == other._pos;
+  }
+
+  auto operator!=(const OrderedDictIterator &other) const -> bool {
+    return this->_pos != other._pos;
+  }
+};
+
+/**
+ * @brief The (key, value) pairs of an ordered_dict, in insertion order
+ *
+ * @tparam Entry
+ */
+template <typename Entry> class OrderedItems {
+  OrderedDictIterator<Entry> _first, _last;
+  size_t _size;
+
+public:
+  using value_type = Entry;
+  using const_iterator = OrderedDictIterator<Entry>;
+  using iterator = const_iterator;
+
+  OrderedItems(const_iterator first, const_iterator last, size_t size)
+      : _first{first}, _last{last}, _size{size} {}
+
+  auto begin() const -> const_iterator { return this->_first; }
+  auto end() const -> const_iterator { return this->_last; }
+  auto size() const -> size_t { return this->_size; }
+  auto empty() const -> bool { return this->_size == 0; }
+};
+
+} // namespace detail
+
+/**
+ * @brief dict that iterates in insertion order (Python 3.7+ semantics)
+ *
+ * Same surface as py::dict. Assigning to an existing key keeps its
+ * position; erasing and re-inserting moves it to the end; popitem()
+ * removes the most recent item. Comparison with == ignores the order,
+ * as in Python.
+ *
+ * The items are read-only through items() and iteration (the keys are
+ * stored unconst so the entries array can be compacted); values are
+ * updated through operator[], get() or setdefault().
+ *
+ * @tparam Key
+ * @tparam T
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @tparam Allocator
+ */
+template <typename Key, typename T, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>,
+          typename Allocator = std::allocator<std::pair<const Key, T>>>
+class ordered_dict {
+  using Self = ordered_dict<Key, T, Hash, KeyEqual, Allocator>;
+  using Entry = std::pair<Key, T>;
+  using alloc_traits = std::allocator_traits<Allocator>;
+  using entry_alloc = typename alloc_traits::template rebind_alloc<Entry>;
+  using hash_alloc = typename alloc_traits::template rebind_alloc<size_t>;
+  using index_alloc =
+      typename alloc_traits::template rebind_alloc<unsigned char>;
+
+  static constexpr size_t npos = ~size_t(0);
+
+  std::vector<Entry, entry_alloc> _entries;
+  std::vector<size_t, hash_alloc> _hashes; // parallel to _entries
+  std::vector<unsigned char, index_alloc> _indices;
+  size_t _size{0};  // live entries
+  size_t _fill{0};  // non-empty slots (live or dummy)
+  size_t _mask{0};  // number of slots - 1 (no slots while _indices is empty)
+  size_t _width{1}; // bytes per slot
+  Hash _hash;
+  KeyEqual _eq;
+
+public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = Entry;
+  using size_type = size_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using allocator_type = Allocator;
+  using const_iterator = detail::OrderedDictIterator<Entry>;
+  using items_type = detail::OrderedItems<Entry>;
+
+  /**
+   * @brief Construct a new ordered_dict object
+   *
+   */
+  ordered_dict() = default;
+
+  /**
+   * @brief Construct a new ordered_dict object
+   *
+   * @param[in] alloc
+   */
+  explicit ordered_dict(const Allocator &alloc)
+      : _entries(entry_alloc(alloc)), _hashes(hash_alloc(alloc)),
+        _indices(index_alloc(alloc)) {}
+
+  /**
+   * @brief Construct a new ordered_dict object
+   *
+   * @param[in] init
+   * @param[in] alloc
+   */
+  ordered_dict(std::initializer_list<std::pair<const Key, T>> init,
+               const Allocator &alloc = Allocator())
+      : ordered_dict(alloc) {
+    this->update(init.begin(), init.end());
+  }
+
+  /**
+   * @brief Construct a new ordered_dict object from (key, value) pairs
+   *
+   * Reserves up front for forward iterators; a later duplicate overwrites
+   * the value but keeps the first position, as in Python.
+   *
+   * @param[in] first
+   * @param[in] last
+   * @param[in] alloc
+   */
+  template <typename InputIt>
+  ordered_dict(InputIt first, InputIt last,
+               const Allocator &alloc = Allocator())
+      : ordered_dict(alloc) {
+    this->update(first, last);
+  }
+
+  /**
+   * @brief Construct a new ordered_dict object from an iterable of
+   * (key, value) pairs, e.g. `py::ordered_dict<size_t, T>(py::enumerate(v))`
+   *
+   * @param[in] pairs
+   * @param[in] alloc
+   */
+  template <typename Iterable,
+            typename = detail::enable_iterable_t<Iterable, Self, Allocator>>
+  explicit ordered_dict(const Iterable &pairs,
+                        const Allocator &alloc = Allocator())
+      : ordered_dict(alloc) {
+    detail::reserve_for_range(*this, pairs);
+    for (const auto &kv : pairs) {
+      this->insert_or_assign_(kv.first, kv.second);
+    }
+  }
+
+  /**
+   * @brief New ordered_dict mapping every key of `keys` to `value`
+   *
+   * @param[in] keys
+   * @param[in] value
+   * @return Self
+   */
+  template <typename Iterable>
+  static auto fromkeys(const Iterable &keys, const T &value = T()) -> Self {
+    auto res = Self{};
+    detail::reserve_for_range(res, keys);
+    for (const auto &key : keys) {
+      res.try_emplace_(key, value);
+    }
+    return res;
+  }
+
+  auto size() const -> size_t { return this->_size; }
+  auto empty() const -> bool { return this->_size == 0; }
+  auto hash_function() const -> hasher { return this->_hash; }
+  auto key_eq() const -> key_equal { return this->_eq; }
+  auto get_allocator() const -> allocator_type {
+    return allocator_type(this->_entries.get_allocator());
+  }
+
+  /**
+   * @brief Remove every item (and release the index table)
+   */
+  void clear() {
+    this->_entries.clear();
+    this->_hashes.clear();
+    this->_indices.clear();
+    this->_size = this->_fill = this->_mask = 0;
+    this->_width = 1;
+  }
+
+  /**
+   * @brief Make room for `n` items without rehashing
+   *
+   * @param[in] n
+   */
+  void reserve(size_t n) {
+    if (usable(this->num_slots()) < n) {
+      this->rebuild(capacity_for(n));
+    }
+    this->_entries.reserve(n);
+    this->_hashes.reserve(n);
+  }
+
+  /**
+   * @brief
+   *
+   * @param[in] key
+   * @return true
+   * @return false
+   */
+  auto contains(const Key &key) const -> bool {
+    return this->find_slot(key) != npos;
+  }
+
+  /**
+   * @brief Heterogeneous contains (transparent Hash and KeyEqual only)
+   *
+   * @param[in] key
+   * @return true
+   * @return false
+   */
+  template <typename K, typename H = Hash,
+            typename = detail::enable_transparent_t<H, KeyEqual>>
+  auto contains(const K &key) const -> bool {
+    return this->find_slot(key) != npos;
+  }
+
+  /**
+   * @brief Look up `key`
+   *
+   * @param[in] key
+   * @return T* pointer to the value, or nullptr (Python None)
+   */
+  auto get(const Key &key) -> T * {
+    const auto s = this->find_slot(key);
+    return s == npos ? nullptr : &this->entry_at(s).second;
+  }
+
+  /**
+   * @brief Look up `key`
+   *
+   * @param[in] key
+   * @return const T* pointer to the value, or nullptr (Python None)
+   */
+  auto get(const Key &key) const -> const T * {
+    const auto s = this->find_slot(key);
+    return s == npos ? nullptr : &this->entry_at(s).second;
+  }
+
+  /**
+   * @brief Look up `key` (no copy)
+   *
+   * Like std::max, the result may refer to `default_value`: do not bind it
+   * to a reference that outlives a temporary default.
+   *
+   * @param[in] key
+   * @param[in] default_value
+   * @return const T&
+   */
+  auto get(const Key &key, const T &default_value) const -> const T & {
+    const auto s = this->find_slot(key);
+    return s == npos ? default_value : this->entry_at(s).second;
+  }
+
+  /**
+   * @brief Heterogeneous get (transparent Hash and KeyEqual only)
+   *
+   * @param[in] key
+   * @param[in] default_value
+   * @return const T&
+   */
+  template <typename K, typename H = Hash,
+            typename = detail::enable_transparent_t<H, KeyEqual>>
+  auto get(const K &key, const T &default_value) const -> const T & {
+    const auto s = this->find_slot(key);
+    return s == npos ? default_value : this->entry_at(s).second;
+  }
+
+  /**
+   * @brief Insert `key` with `default_value` unless present
+   *
+   * @param[in] key
+   * @param[in] default_value
+   * @return T& the stored value
+   */
+  auto setdefault(const Key &key, const T &default_value = T()) -> T & {
+    return this->_entries[this->try_emplace_(key, default_value).first].second;
+  }
+
+  /**
+   * @brief Remove `key` and move its value out
+   *
+   * @param[in] key
+   * @return T
+   * @exception std::out_of_range if `key` is absent (Python KeyError)
+   */
+  auto pop(const Key &key) -> T {
+    const auto s = this->find_slot(key);
+    if (s == npos) {
+      throw std::out_of_range("ordered_dict::pop");
+    }
+    auto value = std::move(this->entry_at(s).second);
+    this->erase_slot(s);
+    return value;
+  }
+
+  /**
+   * @brief Remove `key` and move its value out, or return `default_value`
+   *
+   * @param[in] key
+   * @param[in] default_value
+   * @return T
+   */
+  auto pop(const Key &key, T default_value) -> T {
+    const auto s = this->find_slot(key);
+    if (s == npos) {
+      return default_value;
+    }
+    auto value = std::move(this->entry_at(s).second);
+    this->erase_slot(s);
+    return value;
+  }
+
+  /**
+   * @brief Remove and return the most recently inserted (key, value) pair
+   *
+   * @return std::pair<Key, T>
+   * @exception std::out_of_range if the dict is empty (Python KeyError)
+   */
+  auto popitem() -> std::pair<Key, T> {
+    if (this->empty()) {
+      throw std::out_of_range("ordered_dict::popitem");
+    }
+    // the last entry is always live
+    const auto s = this->slot_of(this->_entries.size() - 1);
+    auto item = std::move(this->_entries.back());
+    this->erase_slot(s);
+    return item;
+  }
+
+  /**
+   * @brief Remove `key`
+   *
+   * @param[in] key
+   * @return size_t the number of items removed (0 or 1)
+   */
+  auto erase(const Key &key) -> size_t {
+    const auto s = this->find_slot(key);
+    if (s == npos) {
+      return 0;
+    }
+    this->erase_slot(s);
+    return 1;
+  }
+
+  /**
+   * @brief Insert or overwrite every item of `other`, in its order
+   *
+   * @param[in] other
+   */
+  void update(const Self &other) {
+    if (this == &other) {
+      return;
+    }
+    this->reserve(this->size() + other.size());
+    for (const auto &kv : other.items()) {
+      this->insert_or_assign_(kv.first, kv.second);
+    }
+  }
+
+  /**
+   * @brief Insert or overwrite every item of `other`, moving the values
+   *
+   * @param[in] other
+   */
+  void update(Self &&other) {
+    if (this == &other) {
+      return;
+    }
+    this->reserve(this->size() + other.size());
+    for (size_t i = 0; i != other._entries.size(); ++i) {
+      if (other._hashes[i] != detail::kDeadEntry) {
+        auto &kv = other._entries[i];
+        this->insert_or_assign_(kv.first, std::move(kv.second));
+      }
+    }
+  }
+
+  /**
+   * @brief Insert or overwrite the (key, value) pairs of [first, last)
+   *
+   * Reserves up front for forward iterators.
+   *
+   * @param[in] first
+   * @param[in] last
+   */
+  template <typename InputIt> void update(InputIt first, InputIt last) {
+    detail::reserve_for(*this, first, last);
+    for (; first != last; ++first) {
+      const auto &kv = *first;
+      this->insert_or_assign_(kv.first, kv.second);
+    }
+  }
+
+  /**
+   * @brief Insert or overwrite the given (key, value) pairs
+   *
+   * @param[in] init
+   */
+  void update(std::initializer_list<std::pair<const Key, T>> init) {
+    this->update(init.begin(), init.end());
+  }
+
+  /**
+   * @brief The keys, in insertion order
+   *
+   * @return auto
+   */
+  auto begin() const -> key_iterator<const_iterator> {
+    return key_iterator<const_iterator>{this->items_begin()};
+  }
+
+  /**
+   * @brief
+   *
+   * @return auto
+   */
+  auto end() const -> key_iterator<const_iterator> {
+    return key_iterator<const_iterator>{this->items_end()};
+  }
+
+  /**
+   * @brief The (key, value) pairs, in insertion order
+   *
+   * @return items_type
+   */
+  auto items() const -> items_type {
+    return items_type{this->items_begin(), this->items_end(), this->_size};
+  }
+
+  /**
+   * @brief
+   *
+   * @return Self
+   */
+  auto copy() const -> Self { return *this; }
+
+  /**
+   * @brief
+   *
+   * @param[in] k
+   * @return const T&
+   */
+  auto at(const Key &k) const -> const T & {
+    const auto s = this->find_slot(k);
+    if (s == npos) {
+      throw std::out_of_range("ordered_dict::at");
+    }
+    return this->entry_at(s).second;
+  }
+
+  /**
+   * @brief
+   *
+   * @param[in] k
+   * @return T&
+   */
+  auto at(const Key &k) -> T & {
+    return const_cast<T &>(static_cast<const Self &>(*this).at(k));
+  }
+
+  /**
+   * @brief
+   *
+   * @param[in] k
+   * @return const T&
+   */
+  auto operator[](const Key &k) const -> const T & { return this->at(k); }
+
+  /**
+   * @brief
+   *
+   * @param[in] k
+   * @return T&
+   */
+  auto operator[](const Key &k) -> T & {
+    return this->_entries[this->try_emplace_(k).first].second;
+  }
+
+  /**
+   * @brief
+   *
+   * @param[in] k
+   * @return T&
+   */
+  auto operator[](Key &&k) -> T & {
+    return this->_entries[this->try_emplace_(std::move(k)).first].second;
+  }
+
+  /**
+   * @brief Same items, in any order (Python dict equality)
+   *
+   * @param[in] lhs
+   * @param[in] rhs
+   * @return true
+   * @return false
+   */
+  friend auto operator==(const Self &lhs, const Self &rhs) -> bool {
+    if (lhs.size() != rhs.size()) {
+      return false;
+    }
+    for (const auto &kv : lhs.items()) {
+      const auto *v = rhs.get(kv.first);
+      if (v == nullptr || !(*v == kv.second)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  friend auto operator!=(const Self &lhs, const Self &rhs) -> bool {
+    return !(lhs == rhs);
+  }
+
+  /**
+   * @brief
+   *
+   * @return Self&
+   */
+  auto operator=(const Self &) -> Self & = delete;
+
+  /**
+   * @brief
+   *
+   * @return Self&
+   */
+  auto operator=(Self &&) noexcept -> Self & = default;
+
+  /**
+   * @brief Move Constructor (default)
+   *
+   */
+  ordered_dict(Self &&) noexcept = default;
+
+  ~ordered_dict() = default;
+
+  // private:
+  /**
+   * @brief Construct a new ordered_dict object
+   *
+   * Copy through explicitly the public copy() function!!!
+   */
+  ordered_dict(const Self &) = default;
+
+private:
+  auto items_begin() const -> const_iterator {
+    const auto *h = this->_hashes.data();
+    return const_iterator{this->_entries.data(), h, h + this->_hashes.size()};
+  }
+
+  auto items_end() const -> const_iterator {
+    const auto n = this->_hashes.size();
+    const auto *h = this->_hashes.data() + n;
+    return const_iterator{this->_entries.data() + n, h, h};
+  }
+
+  auto num_slots() const -> size_t {
+    return this->_indices.empty() ? 0 : this->_mask + 1;
+  }
+
+  // at most 2/3 full, as in CPython (USABLE_FRACTION)
+  static auto usable(size_t slots) -> size_t { return slots * 2 / 3; }
+
+  static auto capacity_for(size_t n) -> size_t {
+    auto slots = size_t(8);
+    while (usable(slots) < n) {
+      slots <<= 1;
+    }
+    return slots;
+  }
+
+  // every stored value is below `slots`: entries <= fill <= usable(slots)
+  static auto index_width(size_t slots) -> size_t {
+    const auto n = static_cast<uint64_t>(slots);
+    return n <= (uint64_t(1) << 8)    ? 1
+           : n <= (uint64_t(1) << 16) ? 2
+           : n <= (uint64_t(1) << 32) ? 4
+                                      : 8;
+  }
+
+  auto slot(size_t i) const -> size_t {
+    const auto *p = this->_indices.data() + i * this->_width;
+    switch (this->_width) {
+    case 1:
+      return *p;
+    case 2: {
+      uint16_t v;
+      std::memcpy(&v, p, sizeof(v));
+      return v;
+    }
+    case 4: {
+      uint32_t v;
+      std::memcpy(&v, p, sizeof(v));
+      return v;
+    }
+    default: {
+      uint64_t v;
+      std::memcpy(&v, p, sizeof(v));
+      return static_cast<size_t>(v);
+    }
+    }
+  }
+
+  void set_slot(size_t i, size_t value) {
+    auto *p = this->_indices.data() + i * this->_width;
+    switch (this->_width) {
+    case 1:
+      *p = static_cast<unsigned char>(value);
+      break;
+    case 2: {
+      const auto v = static_cast<uint16_t>(value);
+      std::memcpy(p, &v, sizeof(v));
+      break;
+    }
+    case 4: {
+      const auto v = static_cast<uint32_t>(value);
+      std::memcpy(p, &v, sizeof(v));
+      break;
+    }
+    default: {
+      const auto v = static_cast<uint64_t>(value);
+      std::memcpy(p, &v, sizeof(v));
+      break;
+    }
+    }
+  }
+
+  auto entry_at(size_t s) -> Entry & {
+    return this->_entries[this->slot(s) - detail::kSlotBase];
+  }
+  auto entry_at(size_t s) const -> const Entry & {
+    return this->_entries[this->slot(s) - detail::kSlotBase];
+  }
+
+  // never kDeadEntry: the top bit is always clear
+  template <typename K> auto hash_of(const K &key) const -> size_t {
+    return detail::flat_hash_mix(this->_hash(key)) >> 1;
+  }
+
+  /// CPython's probe sequence: i = 5 i + perturb + 1, perturb >>= 5
+  template <typename K> auto find_slot(const K &key) const -> size_t {
+    if (this->_indices.empty()) {
+      return npos;
+    }
+    const auto h = this->hash_of(key);
+    auto perturb = h;
+    for (auto i = h & this->_mask;;) {
+      const auto s = this->slot(i);
+      if (s == detail::kSlotEmpty) {
+        return npos;
+      }
+      if (s != detail::kSlotDummy) {
+        const auto ix = s - detail::kSlotBase;
+        if (this->_hashes[ix] == h && this->_eq(this->_entries[ix].first, key)) {
+          return i;
+        }
+      }
+      perturb >>= 5;
+      i = (i * 5 + perturb + 1) & this->_mask;
+    }
+  }
+
+  auto find_empty_slot(size_t h) const -> size_t {
+    auto perturb = h;
+    for (auto i = h & this->_mask;;) {
+      if (this->slot(i) == detail::kSlotEmpty) {
+        return i;
+      }
+      perturb >>= 5;
+      i = (i * 5 + perturb + 1) & this->_mask;
+    }
+  }
+
+  /// The slot that refers to the live entry `ix`
+  auto slot_of(size_t ix) const -> size_t {
+    const auto h = this->_hashes[ix];
+    auto perturb = h;
+    for (auto i = h & this->_mask;;) {
+      if (this->slot(i) == ix + detail::kSlotBase) {
+        return i;
+      }
+      perturb >>= 5;
+      i = (i * 5 + perturb + 1) & this->_mask;
+    }
+  }
+
+  /// Squeeze out dead entries, then rebuild the index table with `slots`
+  void rebuild(size_t slots) {
+    const auto width = index_width(slots);
+    auto indices = decltype(this->_indices)(slots * width, 0,
+                                            this->_indices.get_allocator());
+    if (this->_entries.size() != this->_size) {
+      auto j = size_t(0);
+      for (size_t i = 0; i != this->_entries.size(); ++i) {
+        if (this->_hashes[i] != detail::kDeadEntry) {
+          if (i != j) {
+            this->_entries[j] = std::move(this->_entries[i]);
+            this->_hashes[j] = this->_hashes[i];
+          }
+          ++j;
+        }
+      }
+      this->_entries.erase(this->_entries.begin() +
+                               static_cast<std::ptrdiff_t>(j),
+                           this->_entries.end());
+      this->_hashes.resize(j);
+    }
+    this->_indices.swap(indices);
+    this->_width = width;
+    this->_mask = slots - 1;
+    for (size_t ix = 0; ix != this->_entries.size(); ++ix) {
+      this->set_slot(this->find_empty_slot(this->_hashes[ix]),
+                     ix + detail::kSlotBase);
+    }
+    this->_fill = this->_entries.size();
+  }
+
+  /// Index of the entry for `key`, and whether it was inserted
+  template <typename K, typename... Args>
+  auto try_emplace_(K &&key, Args &&...args) -> std::pair<size_t, bool> {
+    const auto s = this->find_slot(key);
+    if (s != npos) {
+      return {this->slot(s) - detail::kSlotBase, false};
+    }
+    if (this->_fill >= usable(this->num_slots())) {
+      // grow to about 3x the live size (CPython's GROWTH_RATE)
+      this->rebuild(capacity_for(2 * (this->_size + 1)));
+    }
+    const auto h = this->hash_of(key);
+    this->_hashes.push_back(h);
+    try {
+      this->_entries.emplace_back(
+          std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+          std::forward_as_tuple(std::forward<Args>(args)...));
+    } catch (...) {
+      this->_hashes.pop_back();
+      throw;
+    }
+    const auto ix = this->_entries.size() - 1;
+    this->set_slot(this->find_empty_slot(h), ix + detail::kSlotBase);
+    ++this->_fill;
+    ++this->_size;
+    return {ix, true};
+  }
+
+  template <typename V> void insert_or_assign_(const Key &key, V &&value) {
+    auto res = this->try_emplace_(key, std::forward<V>(value));
+    if (!res.second) {
+      this->_entries[res.first].second = std::forward<V>(value);
+    }
+  }
+
+  void erase_slot(size_t s) {
+    const auto ix = this->slot(s) - detail::kSlotBase;
+    this->set_slot(s, detail::kSlotDummy);
+    --this->_size;
+    this->_hashes[ix] = detail::kDeadEntry;
+    // keep the last entry live: trim dead entries off the end
+    while (!this->_hashes.empty() &&
+           this->_hashes.back() == detail::kDeadEntry) {
+      this->_hashes.pop_back();
+      this->_entries.pop_back();
+    }
+    const auto dead = this->_entries.size() - this->_size;
+    if (dead > this->_size && dead >= 8) {
+      this->rebuild(this->num_slots());
+    }
+  }
+};
+
+/**
+ * @brief
+ *
+ * @tparam Key
+ * @tparam T
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @tparam Allocator
+ * @param[in] key
+ * @param[in] m
+ * @return true
+ * @return false
+ */
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Allocator>
+inline auto operator<(const Key &key,
+                      const ordered_dict<Key, T, Hash, KeyEqual, Allocator> &m)
+    -> bool {
+  return m.contains(key);
+}
+
+/**
+ * @brief
+ *
+ * @tparam Key
+ * @tparam T
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @tparam Allocator
+ * @param[in] m
+ * @return size_t
+ */
+template <typename Key, typename T, typename Hash, typename KeyEqual,
+          typename Allocator>
+inline auto len(const ordered_dict<Key, T, Hash, KeyEqual, Allocator> &m)
+    -> size_t {
+  return m.size();
+}
+
+#if defined(PY2CPP_HAS_PMR)
+namespace pmr {
+
+/**
+ * @brief ordered_dict using a std::pmr::polymorphic_allocator
+ *
+ * @tparam Key
+ * @tparam T
+ */
+template <typename Key, typename T, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+using ordered_dict =
+    py::ordered_dict<Key, T, Hash, KeyEqual,
+                     std::pmr::polymorphic_allocator<std::pair<const Key, T>>>;
+
+} // namespace pmr
+#endif
+
+} // namespace py
@@ -0,0 +1,390 @@
+#pragma once
+
+/** @file include/py2cpp/parallel.hpp
+ *  parallel_for / parallel_reduce over anything with size() and
+ *  operator[] (py::range, std::vector, ...).
+ *
+ *      py::parallel_for(py::range(n), [&](int i) { out[i] = f(i); });
+ *      auto total = py::parallel_reduce(
+ *          py::range(n), 0.0, [&](int i) { return g(i); }, std::plus<>{});
+ *
+ *  The work runs on a process-wide py::thread_pool whose threads are
+ *  created once and reused across calls. The index space is cut into
+ *  grain-sized chunks, claimed dynamically, so uneven bodies balance
+ *  themselves. The calling thread works too, and while it waits it runs
+ *  queued tasks, so nested parallel_for calls cannot deadlock.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace py {
+
+/**
+ * @brief Small work-stealing thread pool
+ *
+ * Every worker owns a task queue. It pops its own queue LIFO (hot caches)
+ * and, once that is empty, steals FIFO from the others.
+ */
+class thread_pool {
+  struct Queue {
+    std::mutex mtx;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  std::vector<std::unique_ptr<Queue>> _queues;
+  std::vector<std::thread> _threads;
+  std::mutex _mtx;
+  std::condition_variable _cv;
+  std::atomic<size_t> _pending{0};
+  std::atomic<size_t> _next{0};
+  bool _stop{false};
+
+public:
+  /**
+   * @brief Construct a new thread pool object
+   *
+   * @param[in] num_threads number of worker threads (0: run everything on
+   *                        the calling thread)
+   */
+  explicit thread_pool(size_t num_threads = default_concurrency()) {
+    for (size_t k = 0; k != num_threads; ++k) {
+      this->_queues.emplace_back(new Queue{});
+    }
+    for (size_t k = 0; k != num_threads; ++k) {
+      this->_threads.emplace_back([this, k]() { this->worker_loop(k); });
+    }
+  }
+
+  thread_pool(const thread_pool &) = delete;
+  auto operator=(const thread_pool &) -> thread_pool & = delete;
+
+  /**
+   * @brief Finish the queued tasks and join the workers
+   *
+   */
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock(this->_mtx);
+      this->_stop = true;
+    }
+    this->_cv.notify_all();
+    for (auto &t : this->_threads) {
+      t.join();
+    }
+  }
+
+  /**
+   * @brief The pool shared by parallel_for and parallel_reduce
+   *
+   * @return thread_pool&
+   */
+  static auto instance() -> thread_pool & {
+    static thread_pool pool;
+    return pool;
+  }
+
+  /**
+   * @brief One worker per hardware thread, minus the calling thread
+   *
+   * @return size_t
+   */
+  static auto default_concurrency() -> size_t {
+    const auto hw = std::thread::hardware_concurrency();
+    return hw > 1 ? hw - 1 : 0;
+  }
+
+  /**
+   * @brief Number of worker threads
+   *
+   * @return size_t
+   */
+  auto size() const -> size_t { return this->_threads.size(); }
+
+  /**
+   * @brief Queue `task`; from a worker it goes to that worker's own queue
+   *
+   * @param[in] task
+   */
+  void submit(std::function<void()> task) {
+    if (this->_queues.empty()) {
+      task();
+      return;
+    }
+    const auto self = this->current_worker();
+    auto &q = *this->_queues[self < this->_queues.size()
+                                 ? self
+                                 : this->_next++ % this->_queues.size()];
+    {
+      std::lock_guard<std::mutex> lock(q.mtx);
+      q.tasks.push_back(std::move(task));
+      ++this->_pending;
+    }
+    // a worker is either already waiting or will see _pending on its check
+    { std::lock_guard<std::mutex> lock(this->_mtx); }
+    this->_cv.notify_one();
+  }
+
+  /**
+   * @brief Run one queued task on the calling thread, if there is any
+   *
+   * @return true if a task was run
+   */
+  auto try_run_one() -> bool {
+    auto task = std::function<void()>{};
+    if (!this->pop(this->current_worker(), task)) {
+      return false;
+    }
+    task();
+    return true;
+  }
+
+private:
+  // index of the calling worker of this pool, or size() for other threads
+  auto current_worker() const -> size_t {
+    return worker_owner() == this ? worker_index() : this->_queues.size();
+  }
+
+  static auto worker_owner() -> const thread_pool *& {
+    static thread_local const thread_pool *owner = nullptr;
+    return owner;
+  }
+
+  static auto worker_index() -> size_t & {
+    static thread_local size_t index = 0;
+    return index;
+  }
+
+  auto pop(size_t self, std::function<void()> &task) -> bool {
+    const auto n = this->_queues.size();
+    if (self < n) {
+      auto &q = *this->_queues[self];
+      std::lock_guard<std::mutex> lock(q.mtx);
+      if (!q.tasks.empty()) {
+        task = std::move(q.tasks.back());
+        q.tasks.pop_back();
+        --this->_pending;
+        return true;
+      }
+    }
+    for (size_t k = 1; k <= n; ++k) {
+      auto &q = *this->_queues[(self + k) % n];
+      std::lock_guard<std::mutex> lock(q.mtx);
+      if (!q.tasks.empty()) {
+        task = std::move(q.tasks.front());
+        q.tasks.pop_front();
+        --this->_pending;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void worker_loop(size_t self) {
+    worker_owner() = this;
+    worker_index() = self;
+    for (;;) {
+      auto task = std::function<void()>{};
+      if (this->pop(self, task)) {
+        task();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(this->_mtx);
+      this->_cv.wait(lock, [this]() {
+        return this->_stop || this->_pending.load() != 0;
+      });
+      if (this->_stop && this->_pending.load() == 0) {
+        return;
+      }
+    }
+  }
+};
+
+namespace detail {
+
+/**
+ * @brief Run `body(chunk, first, last)` over [0, n) cut into chunks of
+ * `grain` indices, on `pool` and the calling thread
+ *
+ * The first exception thrown by a body is rethrown here after all helpers
+ * are done; chunks not yet started are skipped.
+ */
+template <typename Body>
+void parallel_chunks(thread_pool &pool, size_t n, size_t grain, Body &body) {
+  if (n == 0) {
+    return;
+  }
+  if (grain == 0) {
+    // ~8 chunks per thread leaves room for balancing without much overhead
+    grain = std::max<size_t>(1, n / (8 * (pool.size() + 1)));
+  }
+  const auto num_chunks = (n + grain - 1) / grain;
+  if (pool.size() == 0 || num_chunks == 1) {
+    for (size_t c = 0; c != num_chunks; ++c) {
+      body(c, c * grain, std::min(n, (c + 1) * grain));
+    }
+    return;
+  }
+
+  std::atomic<size_t> next{0};
+  std::atomic<bool> failed{false};
+  std::mutex error_mtx;
+  std::exception_ptr error;
+
+  auto run = [&]() {
+    for (size_t c; (c = next++) < num_chunks;) {
+      if (failed.load(std::memory_order_relaxed)) {
+        break;
+      }
+      try {
+        body(c, c * grain, std::min(n, (c + 1) * grain));
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mtx);
+        if (!error) {
+          error = std::current_exception();
+        }
+        failed = true;
+      }
+    }
+  };
+
+  const auto num_helpers = std::min(pool.size(), num_chunks - 1);
+  std::atomic<size_t> running{num_helpers};
+  for (size_t k = 0; k != num_helpers; ++k) {
+    pool.submit([&run, &running]() {
+      run();
+      running.fetch_sub(1, std::memory_order_release);
+    });
+  }
+  run();
+  while (running.load(std::memory_order_acquire) != 0) {
+    if (!pool.try_run_one()) {
+      std::this_thread::yield();
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace detail
+
+/**
+ * @brief Call `fn(r[i])` for every i in [0, r.size()), in parallel
+ *
+ * The calls must be independent; their order is unspecified.
+ *
+ * @tparam Range anything with size() and operator[]
+ * @tparam Fn
+ * @param[in] pool
+ * @param[in] r
+ * @param[in] fn
+ * @param[in] grain indices per chunk (0: pick one from the pool size)
+ */
+template <typename Range, typename Fn>
+void parallel_for(thread_pool &pool, const Range &r, Fn &&fn,
+                  size_t grain = 0) {
+  auto body = [&r, &fn](size_t /* chunk */, size_t first, size_t last) {
+    for (auto i = first; i != last; ++i) {
+      fn(r[i]);
+    }
+  };
+  detail::parallel_chunks(pool, static_cast<size_t>(r.size()), grain, body);
+}
+
+/**
+ * @brief parallel_for on the shared thread_pool::instance()
+ *
+ * @tparam Range anything with size() and operator[]
+ * @tparam Fn
+ * @param[in] r
+ * @param[in] fn
+ * @param[in] grain indices per chunk (0: pick one from the pool size)
+ */
+template <typename Range, typename Fn>
+void parallel_for(const Range &r, Fn &&fn, size_t grain = 0) {
+  parallel_for(thread_pool::instance(), r, std::forward<Fn>(fn), grain);
+}
+
+/**
+ * @brief Reduce `map_fn(r[i])` over [0, r.size()) with `reduce_fn`, in
+ * parallel
+ *
+ * Each chunk folds its elements starting from `identity`, and the
+ * partial results are then combined in chunk order, so for a given grain
+ * the result does not depend on scheduling (floating-point sums are
+ * reproducible).
+ *
+ * @tparam Range anything with size() and operator[]
+ * @tparam T
+ * @tparam MapFn
+ * @tparam ReduceFn
+ * @param[in] pool
+ * @param[in] r
+ * @param[in] identity identity element of `reduce_fn` (e.g. 0 for plus)
+ * @param[in] map_fn
+ * @param[in] reduce_fn associative `T(T, T)`
+ * @param[in] grain indices per chunk (0: pick one from the pool size)
+ * @return T
+ */
+template <typename Range, typename T, typename MapFn, typename ReduceFn>
+auto parallel_reduce(thread_pool &pool, const Range &r, T identity,
+                     MapFn &&map_fn, ReduceFn &&reduce_fn, size_t grain = 0)
+    -> T {
+  struct Partial {
+    T value;
+  };
+  const auto n = static_cast<size_t>(r.size());
+  if (grain == 0) {
+    grain = std::max<size_t>(1, n / (8 * (pool.size() + 1)));
+  }
+  auto partials = std::vector<Partial>(n == 0 ? 0 : (n + grain - 1) / grain,
+                                      Partial{identity});
+  auto body = [&](size_t chunk, size_t first, size_t last) {
+    auto acc = identity;
+    for (auto i = first; i != last; ++i) {
+      acc = reduce_fn(std::move(acc), map_fn(r[i]));
+    }
+    partials[chunk].value = std::move(acc);
+  };
+  detail::parallel_chunks(pool, n, grain, body);
+  auto res = std::move(identity);
+  for (auto &p : partials) {
+    res = reduce_fn(std::move(res), std::move(p.value));
+  }
+  return res;
+}
+
+/**
+ * @brief parallel_reduce on the shared thread_pool::instance()
+ *
+ * @tparam Range anything with size() and operator[]
+ * @tparam T
+ * @tparam MapFn
+ * @tparam ReduceFn
+ * @param[in] r
+ * @param[in] identity identity element of `reduce_fn` (e.g. 0 for plus)
+ * @param[in] map_fn
+ * @param[in] reduce_fn associative `T(T, T)`
+ * @param[in] grain indices per chunk (0: pick one from the pool size)
+ * @return T
+ */
+template <typename Range, typename T, typename MapFn, typename ReduceFn>
+auto parallel_reduce(const Range &r, T identity, MapFn &&map_fn,
+                     ReduceFn &&reduce_fn, size_t grain = 0) -> T {
+  return parallel_reduce(thread_pool::instance(), r, std::move(identity),
+                         std::forward<MapFn>(map_fn),
+                         std::forward<ReduceFn>(reduce_fn), grain);
+}
+
+} // namespace py
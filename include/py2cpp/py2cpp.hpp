@@ -1,6 +1,26 @@
 #pragma once
 
+#include "arena.hpp"
+#include "chunks.hpp"
+#include "concurrent_dict.hpp"
 #include "dict.hpp"
 #include "enumerate.hpp"
+#include "flat_dict.hpp"
+#include "flat_set.hpp"
+#include "frozen_dict.hpp"
+#include "frozen_set.hpp"
+#include "generator.hpp"
+#include "hash.hpp"
+#include "itertools.hpp"
+#include "ordered_dict.hpp"
+#include "parallel.hpp"
 #include "range.hpp"
+#include "reversed.hpp"
 #include "set.hpp"
+#include "small_dict.hpp"
+#include "small_set.hpp"
+#include "sorted_dict.hpp"
+#include "sorted_set.hpp"
+#include "static_dict.hpp"
+#include "static_set.hpp"
+#include "zip.hpp"
@@ -1,7 +1,10 @@
 #pragma once
 
 #include <cstddef>
+#include <iterator>
+#include <stdexcept>
 #include <type_traits>
+#include <utility>
 
 #if __cpp_constexpr >= 201304
 #define CONSTEXPR14 constexpr
@@ -13,28 +16,131 @@ namespace py {
 
 namespace detail {
 
-template <typename T> struct RangeIterator {
-  using value_type = T; // luk:
-  using key_type = T;   // luk:
+/**
+ * @brief The difference (and step) type of a range over T: ptrdiff_t for
+ * pointers, the signed promotion for integers (int for char)
+ *
+ * @tparam T
+ */
+template <typename T, bool = std::is_integral<T>::value> struct RangeDiff {
+  using type = decltype(std::declval<T>() - std::declval<T>());
+};
 
-  T i;
-  constexpr auto operator!=(const RangeIterator &other) const -> bool {
-    return this->i != other.i;
+template <typename T> struct RangeDiff<T, true> {
+  using type = typename std::make_signed<decltype(std::declval<T>() -
+                                                  std::declval<T>())>::type;
+};
+
+template <typename T> using range_diff_t = typename RangeDiff<T>::type;
+
+/**
+ * @brief Random-access iterator operations of a range iterator
+ *
+ * Derived provides `advance(n)` and `distance_to(other)`; everything else
+ * (+=, -, [], <, ...) is spelled out here once. `reference` is T itself, so
+ * the iterator is a C++20 random_access_iterator and std::reverse_iterator
+ * never hands out a reference into a dead temporary.
+ *
+ * @tparam Derived
+ * @tparam T
+ */
+template <typename Derived, typename T> struct RangeIteratorBase {
+  using iterator_category = std::random_access_iterator_tag;
+#if defined(__cpp_lib_ranges)
+  using iterator_concept = std::random_access_iterator_tag;
+#endif
+  using value_type = T;
+  using key_type = T;
+  using difference_type = range_diff_t<T>;
+  using pointer = void;
+  using reference = T;
+
+  CONSTEXPR14 auto operator++() -> Derived & {
+    return this->self().advance(difference_type(1));
   }
-  constexpr auto operator==(const RangeIterator &other) const -> bool {
-    return this->i == other.i;
+  CONSTEXPR14 auto operator++(int) -> Derived {
+    auto temp = this->self();
+    ++*this;
+    return temp;
   }
-  CONSTEXPR14 auto operator*() const -> const T & { return this->i; }
-  CONSTEXPR14 auto operator*() -> T & { return this->i; }
-  CONSTEXPR14 auto operator++() -> RangeIterator & {
-    ++this->i;
-    return *this;
+  CONSTEXPR14 auto operator--() -> Derived & {
+    return this->self().advance(difference_type(-1));
   }
-  CONSTEXPR14 auto operator++(int) -> RangeIterator {
-    auto temp = *this;
-    ++*this;
+  CONSTEXPR14 auto operator--(int) -> Derived {
+    auto temp = this->self();
+    --*this;
     return temp;
   }
+  CONSTEXPR14 auto operator+=(difference_type n) -> Derived & {
+    return this->self().advance(n);
+  }
+  CONSTEXPR14 auto operator-=(difference_type n) -> Derived & {
+    return this->self().advance(difference_type(-n));
+  }
+  CONSTEXPR14 auto operator[](difference_type n) const -> T {
+    return *(this->self() + n);
+  }
+
+  friend CONSTEXPR14 auto operator+(Derived it, difference_type n) -> Derived {
+    return it += n;
+  }
+  friend CONSTEXPR14 auto operator+(difference_type n, Derived it) -> Derived {
+    return it += n;
+  }
+  friend CONSTEXPR14 auto operator-(Derived it, difference_type n) -> Derived {
+    return it -= n;
+  }
+  friend constexpr auto operator-(const Derived &a, const Derived &b)
+      -> difference_type {
+    return b.distance_to(a);
+  }
+  friend constexpr auto operator==(const Derived &a, const Derived &b)
+      -> bool {
+    return a.i == b.i;
+  }
+  friend constexpr auto operator!=(const Derived &a, const Derived &b)
+      -> bool {
+    return a.i != b.i;
+  }
+  friend constexpr auto operator<(const Derived &a, const Derived &b) -> bool {
+    return a.distance_to(b) > 0;
+  }
+  friend constexpr auto operator>(const Derived &a, const Derived &b) -> bool {
+    return b < a;
+  }
+  friend constexpr auto operator<=(const Derived &a, const Derived &b)
+      -> bool {
+    return !(b < a);
+  }
+  friend constexpr auto operator>=(const Derived &a, const Derived &b)
+      -> bool {
+    return !(a < b);
+  }
+
+private:
+  CONSTEXPR14 auto self() -> Derived & { return static_cast<Derived &>(*this); }
+  constexpr auto self() const -> const Derived & {
+    return static_cast<const Derived &>(*this);
+  }
+};
+
+template <typename T>
+struct RangeIterator : RangeIteratorBase<RangeIterator<T>, T> {
+  using D = range_diff_t<T>;
+
+  T i;
+
+  constexpr RangeIterator() : i{} {}
+  constexpr explicit RangeIterator(T i) : i{i} {}
+
+  constexpr auto operator*() const -> T { return this->i; }
+  CONSTEXPR14 auto advance(D n) -> RangeIterator & {
+    this->i = static_cast<T>(this->i + n);
+    return *this;
+  }
+  constexpr auto distance_to(const RangeIterator &other) const -> D {
+    return static_cast<D>(other.i - this->i);
+  }
 };
 
 template <typename T> struct RangeIterableWrapper {
@@ -42,6 +148,9 @@ public:
   using value_type = T;              // luk:
   using key_type = T;                // luk:
   using iterator = RangeIterator<T>; // luk
+  using const_iterator = iterator;
+  using difference_type = range_diff_t<T>;
+  using size_type = size_t;
 
   // static_assert(sizeof(value_type) >= 0, "make compiler happy");
   // static_assert(sizeof(key_type) >= 0, "make compiler happy");
@@ -62,6 +171,92 @@ public:
   }
 };
 
+/**
+ * @brief start + k * step, computed modulo 2^bits so that no intermediate
+ * result overflows (the true value must fit in T)
+ *
+ * @tparam T an integer type
+ */
+template <typename T>
+constexpr auto step_value(T start, range_diff_t<T> step, size_t k) -> T {
+  using U = typename std::make_unsigned<range_diff_t<T>>::type;
+  return static_cast<T>(U(start) + U(k) * U(step));
+}
+
+template <typename T>
+struct StepRangeIterator : RangeIteratorBase<StepRangeIterator<T>, T> {
+  using D = range_diff_t<T>;
+
+  T start;
+  D step;
+  size_t i; // index, so that end() needs no value past the last one
+
+  constexpr StepRangeIterator() : start{}, step{1}, i{0} {}
+  constexpr StepRangeIterator(T start, D step, size_t i)
+      : start{start}, step{step}, i{i} {}
+
+  constexpr auto operator*() const -> T {
+    return step_value(this->start, this->step, this->i);
+  }
+  CONSTEXPR14 auto advance(D n) -> StepRangeIterator & {
+    this->i += static_cast<size_t>(n);
+    return *this;
+  }
+  constexpr auto distance_to(const StepRangeIterator &other) const -> D {
+    return static_cast<D>(other.i - this->i);
+  }
+};
+
+/**
+ * @brief range(start, stop, step)
+ *
+ * Stores the number of elements rather than `stop`: size(), operator[]
+ * and contains() are O(1), and neither they nor iteration compute a value
+ * past the last element, which could overflow T.
+ *
+ * @tparam T an integer type
+ */
+template <typename T> struct StepRangeIterableWrapper {
+public:
+  using value_type = T;
+  using key_type = T;
+  using iterator = StepRangeIterator<T>;
+  using const_iterator = iterator;
+  using difference_type = range_diff_t<T>;
+  using size_type = size_t;
+  using D = range_diff_t<T>;
+  using U = typename std::make_unsigned<D>::type;
+
+  T start;
+  D step;
+  size_t n; // number of elements
+  constexpr auto begin() const -> iterator {
+    return iterator{this->start, this->step, 0};
+  }
+  constexpr auto end() const -> iterator {
+    return iterator{this->start, this->step, this->n};
+  }
+  constexpr auto empty() const -> bool { return this->n == 0; }
+  constexpr auto size() const -> size_t { return this->n; }
+  constexpr auto operator[](size_t k) const -> T {
+    return step_value(this->start, this->step, k);
+  } // no bounds checking
+  constexpr auto contains(T x) const -> bool {
+    return this->step > 0 ? !(x < this->start) &&
+                                this->on_grid(U(x) - U(this->start),
+                                              U(this->step))
+                          : !(this->start < x) &&
+                                this->on_grid(U(this->start) - U(x),
+                                              U(0) - U(this->step));
+  }
+
+private:
+  // the distance `d` from start is a multiple of |step| below n |step|
+  constexpr auto on_grid(U d, U abs_step) const -> bool {
+    return d % abs_step == 0 && d / abs_step < this->n;
+  }
+};
+
 } // namespace detail
 
 template <typename T>
@@ -77,4 +272,37 @@ CONSTEXPR14 auto range(T stop) -> detail::RangeIterableWrapper<T> {
   return range(T(0), stop);
 }
 
+/**
+ * @brief Python range(start, stop, step); `step` may be negative
+ *
+ *     for (auto i : py::range(10, 0, -3)) {} // 10, 7, 4, 1
+ *
+ * With an unsigned T only positive steps are meaningful.
+ *
+ * @tparam T
+ * @param[in] start
+ * @param[in] stop
+ * @param[in] step
+ * @return detail::StepRangeIterableWrapper<T>
+ * @exception std::invalid_argument if `step` is zero (Python ValueError)
+ */
+template <typename T>
+CONSTEXPR14 auto range(T start, T stop, detail::range_diff_t<T> step)
+    -> detail::StepRangeIterableWrapper<T> {
+  using D = detail::range_diff_t<T>;
+  if (step == 0) {
+    throw std::invalid_argument("range() arg 3 must not be zero");
+  }
+  // (|stop - start| - 1) / |step| + 1, in unsigned arithmetic
+  using U = typename std::make_unsigned<D>::type;
+  auto n = size_t(0);
+  if (step > 0 && start < stop) {
+    n = static_cast<size_t>((U(stop) - U(start) - 1U) / U(step) + 1U);
+  } else if (step < 0 && stop < start) {
+    n = static_cast<size_t>((U(start) - U(stop) - 1U) / (U(0) - U(step)) +
+                            1U);
+  }
+  return detail::StepRangeIterableWrapper<T>{start, step, n};
+}
+
 } // namespace py
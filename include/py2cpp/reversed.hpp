@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "bulk.hpp" // import detail::view_t
+
+namespace py {
+
+namespace detail {
+
+/**
+ * @brief
+ *
+ * @tparam T `X &` for an lvalue iterable, `X` for a moved-in rvalue
+ */
+template <typename T> struct ReversedIterableWrapper {
+  using iterator = std::reverse_iterator<view_iterator_t<T>>;
+  using const_iterator = iterator;
+
+  T iterable;
+
+  auto begin() const -> iterator {
+    view_t<T> r = this->iterable;
+    return iterator{std::end(r)};
+  }
+  auto end() const -> iterator {
+    view_t<T> r = this->iterable;
+    return iterator{std::begin(r)};
+  }
+
+  /// Available when the underlying iterable knows its size
+  template <typename U = T>
+  auto size() const -> decltype(std::declval<view_t<U>>().size()) {
+    return this->iterable.size();
+  }
+
+  /// Available when the underlying iterator is random access
+  auto operator[](size_t n) const -> typename iterator::reference {
+    return this->begin()[static_cast<typename iterator::difference_type>(n)];
+  }
+};
+
+} // namespace detail
+
+/**
+ * @brief Python reversed(sequence)
+ *
+ *     for (auto i : py::reversed(py::range(10))) {} // 9, 8, ..., 0
+ *
+ * Needs a bidirectional iterable; random access when the iterable is.
+ *
+ * @tparam T
+ * @param[in] iterable
+ * @return detail::ReversedIterableWrapper<T>
+ */
+template <typename T>
+inline auto reversed(T &&iterable) -> detail::ReversedIterableWrapper<T> {
+  return detail::ReversedIterableWrapper<T>{std::forward<T>(iterable)};
+}
+
+} // namespace py
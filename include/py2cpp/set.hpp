@@ -1,23 +1,259 @@
 #pragma once
 
 #include <cstddef> // import size_t
+#include <functional>
 #include <initializer_list>
+#include <memory>
 #include <type_traits>
 #include <unordered_set>
 #include <utility>
 
+#include "arena.hpp" // import arena_allocator, PY2CPP_HAS_PMR
+#include "bulk.hpp"  // import detail::reserve_for
+#include "hash.hpp"  // import detail::enable_transparent_t
+#include "stats.hpp" // import detail::TableStatsRecorder
+
 // template <typename T> using Value_type = typename T::value_type;
 
 namespace py {
 
+namespace detail {
+
+/**
+ * @brief Set-like types taking part in the |, &, -, ^ operators below
+ *
+ * Requires contains(), size(), insert(), erase(key), erase(iterator),
+ * clear(), reserve(), copy() and get_allocator().
+ *
+ * @tparam S
+ */
+template <typename S> struct is_set_algebra : std::false_type {};
+
+template <typename L, typename R>
+using set_op_t = typename std::enable_if<
+    is_set_algebra<typename std::decay<L>::type>::value &&
+        std::is_same<typename std::decay<L>::type,
+                     typename std::decay<R>::type>::value,
+    typename std::decay<L>::type>::type;
+
+template <typename S>
+using set_ref_t =
+    typename std::enable_if<is_set_algebra<S>::value, S &>::type;
+
+template <typename S> void union_update(S &a, const S &b) {
+  if (&a == &b) {
+    return;
+  }
+  a.reserve(a.size() + b.size());
+  for (const auto &key : b) {
+    a.insert(key);
+  }
+}
+
+template <typename S> void intersection_update(S &a, const S &b) {
+  if (&a == &b) {
+    return;
+  }
+  for (auto it = a.begin(); it != a.end();) {
+    if (b.contains(*it)) {
+      ++it;
+    } else {
+      it = a.erase(it);
+    }
+  }
+}
+
+template <typename S> void difference_update(S &a, const S &b) {
+  if (&a == &b) {
+    a.clear();
+    return;
+  }
+  if (b.size() < a.size()) {
+    for (const auto &key : b) {
+      a.erase(key);
+    }
+    return;
+  }
+  for (auto it = a.begin(); it != a.end();) {
+    if (b.contains(*it)) {
+      it = a.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+template <typename S> void symmetric_difference_update(S &a, const S &b) {
+  if (&a == &b) {
+    a.clear();
+    return;
+  }
+  for (const auto &key : b) {
+    if (a.erase(key) == 0) {
+      a.insert(key);
+    }
+  }
+}
+
+template <typename S> auto issubset(const S &a, const S &b) -> bool {
+  if (a.size() > b.size()) {
+    return false;
+  }
+  for (const auto &key : a) {
+    if (!b.contains(key)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename S> auto isdisjoint(const S &a, const S &b) -> bool {
+  const auto &small = a.size() < b.size() ? a : b;
+  const auto &big = a.size() < b.size() ? b : a;
+  for (const auto &key : small) {
+    if (big.contains(key)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** @name Binary set operations
+ *  The rvalue overloads update a moved-in operand in place and return it, so
+ *  chained expressions like `a | b | c` allocate only once.
+ */
+///@{
+
+template <typename S> auto set_union(const S &a, const S &b) -> S {
+  auto res = a.size() < b.size() ? b.copy() : a.copy();
+  union_update(res, a.size() < b.size() ? a : b);
+  return res;
+}
+
+template <typename S> auto set_union(S &&a, const S &b) -> S {
+  union_update(a, b);
+  return std::move(a);
+}
+
+template <typename S> auto set_union(const S &a, S &&b) -> S {
+  union_update(b, a);
+  return std::move(b);
+}
+
+template <typename S> auto set_union(S &&a, S &&b) -> S {
+  if (a.size() < b.size()) {
+    union_update(b, a);
+    return std::move(b);
+  }
+  union_update(a, b);
+  return std::move(a);
+}
+
+/**
+ * @brief Intersection, iterating over the smaller operand
+ */
+template <typename S> auto set_intersection(const S &a, const S &b) -> S {
+  const auto &small = a.size() < b.size() ? a : b;
+  const auto &big = a.size() < b.size() ? b : a;
+  auto res = S(a.get_allocator());
+  res.reserve(small.size());
+  for (const auto &key : small) {
+    if (big.contains(key)) {
+      res.insert(key);
+    }
+  }
+  return res;
+}
+
+template <typename S> auto set_intersection(S &&a, const S &b) -> S {
+  intersection_update(a, b);
+  return std::move(a);
+}
+
+template <typename S> auto set_intersection(const S &a, S &&b) -> S {
+  intersection_update(b, a);
+  return std::move(b);
+}
+
+template <typename S> auto set_intersection(S &&a, S &&b) -> S {
+  if (b.size() < a.size()) {
+    intersection_update(b, a);
+    return std::move(b);
+  }
+  intersection_update(a, b);
+  return std::move(a);
+}
+
+template <typename S> auto set_difference(const S &a, const S &b) -> S {
+  auto res = S(a.get_allocator());
+  res.reserve(a.size());
+  for (const auto &key : a) {
+    if (!b.contains(key)) {
+      res.insert(key);
+    }
+  }
+  return res;
+}
+
+template <typename S> auto set_difference(S &&a, const S &b) -> S {
+  difference_update(a, b);
+  return std::move(a);
+}
+
+template <typename S> auto set_difference(const S &a, S &&b) -> S {
+  return set_difference<S>(a, static_cast<const S &>(b));
+}
+
+template <typename S> auto set_difference(S &&a, S &&b) -> S {
+  difference_update(a, b);
+  return std::move(a);
+}
+
+template <typename S>
+auto set_symmetric_difference(const S &a, const S &b) -> S {
+  auto res = a.size() < b.size() ? b.copy() : a.copy();
+  symmetric_difference_update(res, a.size() < b.size() ? a : b);
+  return res;
+}
+
+template <typename S> auto set_symmetric_difference(S &&a, const S &b) -> S {
+  symmetric_difference_update(a, b);
+  return std::move(a);
+}
+
+template <typename S> auto set_symmetric_difference(const S &a, S &&b) -> S {
+  symmetric_difference_update(b, a);
+  return std::move(b);
+}
+
+template <typename S> auto set_symmetric_difference(S &&a, S &&b) -> S {
+  if (a.size() < b.size()) {
+    symmetric_difference_update(b, a);
+    return std::move(b);
+  }
+  symmetric_difference_update(a, b);
+  return std::move(a);
+}
+
+///@}
+
+} // namespace detail
+
 /**
  * @brief
  *
  * @tparam Key
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @tparam Allocator
  */
-template <typename Key> class set : public std::unordered_set<Key> {
-  using Self = set<Key>;
-  using Base = std::unordered_set<Key>;
+template <typename Key, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>,
+          typename Allocator = std::allocator<Key>>
+class set : public std::unordered_set<Key, Hash, KeyEqual, Allocator>,
+            private detail::TableStatsRecorder {
+  using Self = set<Key, Hash, KeyEqual, Allocator>;
+  using Base = std::unordered_set<Key, Hash, KeyEqual, Allocator>;
 
 public:
   /**
@@ -29,9 +265,43 @@ public:
   /**
    * @brief Construct a new set object
    *
+   * @param[in] alloc
+   */
+  explicit set(const Allocator &alloc) : Base(alloc) {}
+
+  /**
+   * @brief Construct a new set object
+   *
+   * Reserves up front for forward iterators.
+   *
+   * @param[in] start
+   * @param[in] stop
+   * @param[in] alloc
    */
   template <typename FwdIter>
-  set(const FwdIter &start, const FwdIter &stop) : Base(start, stop) {}
+  set(const FwdIter &start, const FwdIter &stop,
+      const Allocator &alloc = Allocator())
+      : Base(alloc) {
+    detail::reserve_for(*this, start, stop);
+    this->insert(start, stop);
+  }
+
+  /**
+   * @brief Construct a new set object from an iterable, e.g.
+   * `py::set<int>(py::range(10))`
+   *
+   * @param[in] iterable
+   * @param[in] alloc
+   */
+  template <typename Iterable,
+            typename = detail::enable_iterable_t<Iterable, Self, Allocator>>
+  explicit set(const Iterable &iterable, const Allocator &alloc = Allocator())
+      : Base(alloc) {
+    detail::reserve_for_range(*this, iterable);
+    for (const auto &key : iterable) {
+      this->insert(key);
+    }
+  }
 
   /**
    * @brief Construct a new set object
@@ -40,6 +310,15 @@ public:
    */
   set(std::initializer_list<Key> init) : Base{init} {}
 
+  /**
+   * @brief Construct a new set object
+   *
+   * @param[in] init
+   * @param[in] alloc
+   */
+  set(std::initializer_list<Key> init, const Allocator &alloc)
+      : Base(init, 0, Hash(), KeyEqual(), alloc) {}
+
   /**
    * @brief
    *
@@ -48,7 +327,27 @@ public:
    * @return false
    */
   auto contains(const Key &key) const -> bool {
+    this->record_node_lookup(static_cast<const Base &>(*this), key);
+    return this->find(key) != this->end();
+  }
+
+  /**
+   * @brief Heterogeneous contains (transparent Hash and KeyEqual only)
+   *
+   * Allocation-free with C++20; before that `key` is converted to Key.
+   *
+   * @param[in] key
+   * @return true
+   * @return false
+   */
+  template <typename K, typename H = Hash,
+            typename = detail::enable_transparent_t<H, KeyEqual>>
+  auto contains(const K &key) const -> bool {
+#if defined(PY2CPP_HAS_GENERIC_UNORDERED_LOOKUP)
     return this->find(key) != this->end();
+#else
+    return this->find(Key(key)) != this->end();
+#endif
   }
 
   /**
@@ -58,6 +357,60 @@ public:
    */
   auto copy() const -> set { return *this; }
 
+#if defined(PY2CPP_STATS)
+  /**
+   * @brief Counters of this set (PY2CPP_STATS only)
+   *
+   * Counts the lookups made through contains; the probe length is the
+   * bucket chain walked. Node allocations and rehashes are inferred from
+   * size() and bucket_count().
+   *
+   * @return table_stats
+   */
+  auto stats() const -> table_stats {
+    this->record_node_table(Base::size(), Base::bucket_count());
+    return this->stats_snapshot();
+  }
+
+  /**
+   * @brief Zero the counters (PY2CPP_STATS only)
+   */
+  void reset_stats() { this->stats_reset(); }
+#endif
+
+  /**
+   * @brief Test whether every element is in `other`
+   *
+   * @param[in] other
+   * @return true
+   * @return false
+   */
+  auto issubset(const Self &other) const -> bool {
+    return detail::issubset(*this, other);
+  }
+
+  /**
+   * @brief Test whether every element of `other` is in this set
+   *
+   * @param[in] other
+   * @return true
+   * @return false
+   */
+  auto issuperset(const Self &other) const -> bool {
+    return detail::issubset(other, *this);
+  }
+
+  /**
+   * @brief Test whether the two sets have no element in common
+   *
+   * @param[in] other
+   * @return true
+   * @return false
+   */
+  auto isdisjoint(const Self &other) const -> bool {
+    return detail::isdisjoint(*this, other);
+  }
+
   /**
    * @brief
    *
@@ -76,7 +429,7 @@ public:
    * @brief Move Constructor (default)
    *
    */
-  set(set<Key> &&) noexcept = default;
+  set(Self &&) noexcept = default;
 
   // private:
   /**
@@ -84,20 +437,24 @@ public:
    *
    * Copy through explicitly the public copy() function!!!
    */
-  set(const set<Key> &) = default;
+  set(const Self &) = default;
 };
 
 /**
  * @brief
  *
  * @tparam Key
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @tparam Allocator
  * @param[in] key
  * @param[in] m
  * @return true
  * @return false
  */
-template <typename Key>
-inline auto operator<(const Key &key, const set<Key> &m) -> bool {
+template <typename Key, typename Hash, typename KeyEqual, typename Allocator>
+inline auto operator<(const Key &key,
+                      const set<Key, Hash, KeyEqual, Allocator> &m) -> bool {
   return m.contains(key);
 }
 
@@ -105,13 +462,146 @@ inline auto operator<(const Key &key, const set<Key> &m) -> bool {
  * @brief
  *
  * @tparam Key
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @tparam Allocator
  * @param[in] m
  * @return size_t
  */
-template <typename Key> inline auto len(const set<Key> &m) -> size_t {
+template <typename Key, typename Hash, typename KeyEqual, typename Allocator>
+inline auto len(const set<Key, Hash, KeyEqual, Allocator> &m) -> size_t {
   return m.size();
 }
 
+namespace detail {
+
+template <typename Key, typename Hash, typename KeyEqual, typename Allocator>
+struct is_set_algebra<set<Key, Hash, KeyEqual, Allocator>> : std::true_type {
+};
+
+} // namespace detail
+
+/**
+ * @brief Union (Python `a | b`)
+ *
+ * @param[in] lhs
+ * @param[in] rhs
+ */
+template <typename L, typename R>
+inline auto operator|(L &&lhs, R &&rhs) -> detail::set_op_t<L, R> {
+  return detail::set_union<typename std::decay<L>::type>(
+      std::forward<L>(lhs), std::forward<R>(rhs));
+}
+
+/**
+ * @brief Intersection (Python `a & b`)
+ *
+ * @param[in] lhs
+ * @param[in] rhs
+ */
+template <typename L, typename R>
+inline auto operator&(L &&lhs, R &&rhs) -> detail::set_op_t<L, R> {
+  return detail::set_intersection<typename std::decay<L>::type>(
+      std::forward<L>(lhs), std::forward<R>(rhs));
+}
+
+/**
+ * @brief Difference (Python `a - b`)
+ *
+ * @param[in] lhs
+ * @param[in] rhs
+ */
+template <typename L, typename R>
+inline auto operator-(L &&lhs, R &&rhs) -> detail::set_op_t<L, R> {
+  return detail::set_difference<typename std::decay<L>::type>(
+      std::forward<L>(lhs), std::forward<R>(rhs));
+}
+
+/**
+ * @brief Symmetric difference (Python `a ^ b`)
+ *
+ * @param[in] lhs
+ * @param[in] rhs
+ */
+template <typename L, typename R>
+inline auto operator^(L &&lhs, R &&rhs) -> detail::set_op_t<L, R> {
+  return detail::set_symmetric_difference<typename std::decay<L>::type>(
+      std::forward<L>(lhs), std::forward<R>(rhs));
+}
+
+/**
+ * @brief In-place union (Python `a |= b`)
+ *
+ * @param[in,out] lhs
+ * @param[in] rhs
+ */
+template <typename S>
+inline auto operator|=(S &lhs, const S &rhs) -> detail::set_ref_t<S> {
+  detail::union_update(lhs, rhs);
+  return lhs;
+}
+
+/**
+ * @brief In-place intersection (Python `a &= b`), no temporary
+ *
+ * @param[in,out] lhs
+ * @param[in] rhs
+ */
+template <typename S>
+inline auto operator&=(S &lhs, const S &rhs) -> detail::set_ref_t<S> {
+  detail::intersection_update(lhs, rhs);
+  return lhs;
+}
+
+/**
+ * @brief In-place difference (Python `a -= b`), no temporary
+ *
+ * @param[in,out] lhs
+ * @param[in] rhs
+ */
+template <typename S>
+inline auto operator-=(S &lhs, const S &rhs) -> detail::set_ref_t<S> {
+  detail::difference_update(lhs, rhs);
+  return lhs;
+}
+
+/**
+ * @brief In-place symmetric difference (Python `a ^= b`), no temporary
+ *
+ * @param[in,out] lhs
+ * @param[in] rhs
+ */
+template <typename S>
+inline auto operator^=(S &lhs, const S &rhs) -> detail::set_ref_t<S> {
+  detail::symmetric_difference_update(lhs, rhs);
+  return lhs;
+}
+
+/**
+ * @brief set whose nodes are carved out of a py::arena
+ *
+ * @tparam Key
+ */
+template <typename Key, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+using arena_set = set<Key, Hash, KeyEqual, arena_allocator<Key>>;
+
+#if defined(PY2CPP_HAS_PMR)
+namespace pmr {
+
+/**
+ * @brief set using a std::pmr::polymorphic_allocator
+ *
+ * @tparam Key
+ */
+template <typename Key, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+using set =
+    py::set<Key, Hash, KeyEqual, std::pmr::polymorphic_allocator<Key>>;
+
+} // namespace pmr
+#endif
+
 /**
  * @brief Template Deduction Guide
  *
@@ -0,0 +1,565 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "arena.hpp"       // import PY2CPP_HAS_PMR
+#include "dict.hpp"        // import key_iterator
+#include "small_table.hpp" // import detail::SmallTable
+
+namespace py {
+
+/**
+ * @brief Dict that keeps up to `N` items inline before spilling
+ *
+ * Same surface as py::flat_dict. The first `N` (key, value) pairs live in
+ * the object itself and are found with a linear scan, so a small dict
+ * costs no allocation at all; the (N + 1)-th insertion moves them into an
+ * open-addressing table. Pick `N` to cover the common size: the object is
+ * always at least `N * sizeof(std::pair<const Key, T>)` bytes.
+ *
+ * References and iterators are invalidated by any insertion or erasure.
+ *
+ * @tparam Key
+ * @tparam T
+ * @tparam N inline capacity
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @tparam Allocator
+ */
+template <typename Key, typename T, size_t N = 8,
+          typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>,
+          typename Allocator = std::allocator<std::pair<const Key, T>>>
+class small_dict : public detail::SmallTable<detail::FlatMapPolicy<Key, T>, N,
+                                             Hash, KeyEqual, Allocator> {
+  using Self = small_dict<Key, T, N, Hash, KeyEqual, Allocator>;
+  using Base = detail::SmallTable<detail::FlatMapPolicy<Key, T>, N, Hash,
+                                  KeyEqual, Allocator>;
+
+public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const Key, T>;
+
+  /**
+   * @brief Construct a new small_dict object
+   *
+   */
+  small_dict() : Base{} {}
+
+  /**
+   * @brief Construct a new small_dict object
+   *
+   * @param[in] alloc
+   */
+  explicit small_dict(const Allocator &alloc) : Base(alloc) {}
+
+  /**
+   * @brief Construct a new small_dict object
+   *
+   * @param[in] init
+   */
+  small_dict(std::initializer_list<value_type> init) : Base{init} {}
+
+  /**
+   * @brief Construct a new small_dict object
+   *
+   * @param[in] init
+   * @param[in] alloc
+   */
+  small_dict(std::initializer_list<value_type> init, const Allocator &alloc)
+      : Base(init, alloc) {}
+
+  /**
+   * @brief Construct a new small_dict object from (key, value) pairs
+   *
+   * Reserves up front for forward iterators; later duplicates win, as in
+   * Python.
+   *
+   * @param[in] first
+   * @param[in] last
+   * @param[in] alloc
+   */
+  template <typename InputIt>
+  small_dict(InputIt first, InputIt last, const Allocator &alloc = Allocator())
+      : Base(alloc) {
+    this->update(first, last);
+  }
+
+  /**
+   * @brief Construct a new small_dict object from an iterable of
+   * (key, value) pairs, e.g. `py::small_dict<size_t, T>(py::enumerate(v))`
+   *
+   * @param[in] pairs
+   * @param[in] alloc
+   */
+  template <typename Iterable,
+            typename = detail::enable_iterable_t<Iterable, Self, Allocator>>
+  explicit small_dict(const Iterable &pairs,
+                     const Allocator &alloc = Allocator())
+      : Base(alloc) {
+    detail::reserve_for_range(*this, pairs);
+    for (const auto &kv : pairs) {
+      this->insert_or_assign_(kv.first, kv.second);
+    }
+  }
+
+  /**
+   * @brief New small_dict mapping every key of `keys` to `value`
+   *
+   * @param[in] keys
+   * @param[in] value
+   * @return Self
+   */
+  template <typename Iterable>
+  static auto fromkeys(const Iterable &keys, const T &value = T()) -> Self {
+    auto res = Self{};
+    detail::reserve_for_range(res, keys);
+    for (const auto &key : keys) {
+      res.try_emplace(key, value);
+    }
+    return res;
+  }
+
+  /**
+   * @brief
+   *
+   * @param[in] key
+   * @return true
+   * @return false
+   */
+  auto contains(const Key &key) const -> bool {
+    return Base::count(key) != 0;
+  }
+
+  /**
+   * @brief Heterogeneous contains (transparent Hash and KeyEqual only)
+   *
+   * @param[in] key
+   * @return true
+   * @return false
+   */
+  template <typename K, typename H = Hash,
+            typename = detail::enable_transparent_t<H, KeyEqual>>
+  auto contains(const K &key) const -> bool {
+    return Base::count(key) != 0;
+  }
+
+  /**
+   * @brief Look up `key`
+   *
+   * @param[in] key
+   * @return T* pointer to the value, or nullptr (Python None)
+   */
+  auto get(const Key &key) -> T * {
+    auto it = Base::find(key);
+    return it == Base::end() ? nullptr : &it->second;
+  }
+
+  /**
+   * @brief Look up `key`
+   *
+   * @param[in] key
+   * @return const T* pointer to the value, or nullptr (Python None)
+   */
+  auto get(const Key &key) const -> const T * {
+    auto it = Base::find(key);
+    return it == Base::end() ? nullptr : &it->second;
+  }
+
+  /**
+   * @brief Look up `key` (no copy)
+   *
+   * Like std::max, the result may refer to `default_value`: do not bind it
+   * to a reference that outlives a temporary default.
+   *
+   * @param[in] key
+   * @param[in] default_value
+   * @return const T&
+   */
+  auto get(const Key &key, const T &default_value) const -> const T & {
+    auto it = Base::find(key);
+    return it == Base::end() ? default_value : it->second;
+  }
+
+  /**
+   * @brief Heterogeneous get (transparent Hash and KeyEqual only)
+   *
+   * @param[in] key
+   * @param[in] default_value
+   * @return const T&
+   */
+  template <typename K, typename H = Hash,
+            typename = detail::enable_transparent_t<H, KeyEqual>>
+  auto get(const K &key, const T &default_value) const -> const T & {
+    auto it = this->find(key);
+    return it == Base::end() ? default_value : it->second;
+  }
+
+  /**
+   * @brief Insert `key` with `default_value` unless present
+   *
+   * @param[in] key
+   * @param[in] default_value
+   * @return T& the stored value
+   */
+  auto setdefault(const Key &key, const T &default_value = T()) -> T & {
+    return this->try_emplace(key, default_value).first->second;
+  }
+
+  /**
+   * @brief Remove `key` and move its value out
+   *
+   * @param[in] key
+   * @return T
+   * @exception std::out_of_range if `key` is absent (Python KeyError)
+   */
+  auto pop(const Key &key) -> T {
+    auto it = Base::find(key);
+    if (it == Base::end()) {
+      throw std::out_of_range("small_dict::pop");
+    }
+    auto value = std::move(it->second);
+    Base::erase(it);
+    return value;
+  }
+
+  /**
+   * @brief Remove `key` and move its value out, or return `default_value`
+   *
+   * @param[in] key
+   * @param[in] default_value
+   * @return T
+   */
+  auto pop(const Key &key, T default_value) -> T {
+    auto it = Base::find(key);
+    if (it == Base::end()) {
+      return default_value;
+    }
+    auto value = std::move(it->second);
+    Base::erase(it);
+    return value;
+  }
+
+  /**
+   * @brief Remove and return an arbitrary (key, value) pair
+   *
+   * @return std::pair<Key, T>
+   * @exception std::out_of_range if the dict is empty (Python KeyError)
+   */
+  auto popitem() -> std::pair<Key, T> {
+    if (this->empty()) {
+      throw std::out_of_range("small_dict::popitem");
+    }
+    auto it = Base::last();
+    auto item = std::pair<Key, T>{it->first, std::move(it->second)};
+    Base::discard(it);
+    return item;
+  }
+
+  /**
+   * @brief Insert or overwrite every item of `other`
+   *
+   * @param[in] other
+   */
+  void update(const Self &other) {
+    if (this == &other) {
+      return;
+    }
+    this->reserve(this->size() + other.size());
+    for (const auto &kv : other.items()) {
+      this->insert_or_assign_(kv.first, kv.second);
+    }
+  }
+
+  /**
+   * @brief Insert or overwrite every item of `other`, moving the values
+   *
+   * @param[in] other
+   */
+  void update(Self &&other) {
+    if (this == &other) {
+      return;
+    }
+    this->reserve(this->size() + other.size());
+    for (auto &kv : other.items()) {
+      this->insert_or_assign_(kv.first, std::move(kv.second));
+    }
+  }
+
+  /**
+   * @brief Insert or overwrite the (key, value) pairs of [first, last)
+   *
+   * Reserves up front for forward iterators.
+   *
+   * @param[in] first
+   * @param[in] last
+   */
+  template <typename InputIt> void update(InputIt first, InputIt last) {
+    detail::reserve_for(*this, first, last);
+    for (; first != last; ++first) {
+      const auto &kv = *first;
+      this->insert_or_assign_(kv.first, kv.second);
+    }
+  }
+
+  /**
+   * @brief Insert or overwrite the given (key, value) pairs
+   *
+   * @param[in] init
+   */
+  void update(std::initializer_list<value_type> init) {
+    this->update(init.begin(), init.end());
+  }
+
+  /**
+   * @brief
+   *
+   * @return auto
+   */
+  auto begin() const -> key_iterator<typename Base::const_iterator> {
+    return key_iterator<typename Base::const_iterator>{Base::begin()};
+  }
+
+  /**
+   * @brief
+   *
+   * @return auto
+   */
+  auto end() const -> key_iterator<typename Base::const_iterator> {
+    return key_iterator<typename Base::const_iterator>{Base::end()};
+  }
+
+  /**
+   * @brief
+   *
+   * @return Base&
+   */
+  auto items() -> Base & { return *this; }
+
+  /**
+   * @brief
+   *
+   * @return const Base&
+   */
+  auto items() const -> const Base & { return *this; }
+
+  /**
+   * @brief
+   *
+   * @return Self
+   */
+  auto copy() const -> Self { return *this; }
+
+  /**
+   * @brief Same items, in any order (Python dict equality)
+   *
+   * @param[in] lhs
+   * @param[in] rhs
+   * @return true
+   * @return false
+   */
+  friend auto operator==(const Self &lhs, const Self &rhs) -> bool {
+    if (lhs.size() != rhs.size()) {
+      return false;
+    }
+    for (const auto &kv : lhs.items()) {
+      const auto *v = rhs.get(kv.first);
+      if (v == nullptr || !(*v == kv.second)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  friend auto operator!=(const Self &lhs, const Self &rhs) -> bool {
+    return !(lhs == rhs);
+  }
+
+  /**
+   * @brief
+   *
+   * @param[in] k
+   * @return const T&
+   */
+  auto at(const Key &k) const -> const T & {
+    auto it = this->find(k);
+    if (it == Base::end()) {
+      throw std::out_of_range("small_dict::at");
+    }
+    return it->second;
+  }
+
+  /**
+   * @brief
+   *
+   * @param[in] k
+   * @return T&
+   */
+  auto at(const Key &k) -> T & {
+    return const_cast<T &>(static_cast<const Self &>(*this).at(k));
+  }
+
+  /**
+   * @brief
+   *
+   * @param[in] k
+   * @return const T&
+   */
+  auto operator[](const Key &k) const -> const T & { return this->at(k); }
+
+  /**
+   * @brief
+   *
+   * @param[in] k
+   * @return T&
+   */
+  auto operator[](const Key &k) -> T & {
+    return this->try_emplace(k).first->second;
+  }
+
+  /**
+   * @brief
+   *
+   * @param[in] k
+   * @return T&
+   */
+  auto operator[](Key &&k) -> T & {
+    return this->try_emplace(std::move(k)).first->second;
+  }
+
+  /**
+   * @brief Heterogeneous lookup (transparent Hash and KeyEqual only)
+   *
+   * @param[in] k
+   * @return const T&
+   */
+  template <typename K, typename H = Hash,
+            typename = detail::enable_transparent_t<H, KeyEqual>>
+  auto operator[](const K &k) const -> const T & {
+    auto it = this->find(k);
+    if (it == Base::end()) {
+      throw std::out_of_range("small_dict::operator[]");
+    }
+    return it->second;
+  }
+
+  /**
+   * @brief Heterogeneous upsert; a Key is built only on insertion
+   *
+   * @param[in] k
+   * @return T&
+   */
+  template <typename K, typename H = Hash,
+            typename = detail::enable_transparent_t<H, KeyEqual>>
+  auto operator[](const K &k) -> T & {
+    return this->try_emplace(k).first->second;
+  }
+
+  /**
+   * @brief
+   *
+   * @return Self&
+   */
+  auto operator=(const Self &) -> Self & = delete;
+
+  /**
+   * @brief
+   *
+   * @return Self&
+   */
+  auto operator=(Self &&) -> Self & = default;
+
+  /**
+   * @brief Move Constructor (default)
+   *
+   */
+  small_dict(Self &&) = default;
+
+  ~small_dict() = default;
+
+  // private:
+  /**
+   * @brief Construct a new small_dict object
+   *
+   * Copy through explicitly the public copy() function!!!
+   */
+  small_dict(const Self &) = default;
+
+private:
+  template <typename V> void insert_or_assign_(const Key &key, V &&value) {
+    auto res = this->try_emplace(key, std::forward<V>(value));
+    if (!res.second) {
+      res.first->second = std::forward<V>(value);
+    }
+  }
+};
+
+/**
+ * @brief
+ *
+ * @tparam Key
+ * @tparam T
+ * @tparam N
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @tparam Allocator
+ * @param[in] key
+ * @param[in] m
+ * @return true
+ * @return false
+ */
+template <typename Key, typename T, size_t N, typename Hash,
+          typename KeyEqual, typename Allocator>
+inline auto operator<(const Key &key,
+                      const small_dict<Key, T, N, Hash, KeyEqual, Allocator> &m)
+    -> bool {
+  return m.contains(key);
+}
+
+/**
+ * @brief
+ *
+ * @tparam Key
+ * @tparam T
+ * @tparam N
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @tparam Allocator
+ * @param[in] m
+ * @return size_t
+ */
+template <typename Key, typename T, size_t N, typename Hash,
+          typename KeyEqual, typename Allocator>
+inline auto len(const small_dict<Key, T, N, Hash, KeyEqual, Allocator> &m)
+    -> size_t {
+  return m.size();
+}
+
+#if defined(PY2CPP_HAS_PMR)
+namespace pmr {
+
+/**
+ * @brief small_dict whose spilled table uses a
+ * std::pmr::polymorphic_allocator
+ *
+ * @tparam Key
+ * @tparam T
+ * @tparam N
+ */
+template <typename Key, typename T, size_t N = 8,
+          typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+using small_dict =
+    py::small_dict<Key, T, N, Hash, KeyEqual,
+                   std::pmr::polymorphic_allocator<std::pair<const Key, T>>>;
+
+} // namespace pmr
+#endif
+
+} // namespace py
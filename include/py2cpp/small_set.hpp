@@ -0,0 +1,276 @@
+#pragma once
+
+#include <cstddef> // import size_t
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+
+#include "arena.hpp"       // import PY2CPP_HAS_PMR
+#include "set.hpp"         // import set operators
+#include "small_table.hpp" // import detail::SmallTable
+
+namespace py {
+
+/**
+ * @brief Set that keeps up to `N` keys inline before spilling
+ *
+ * For the many sets that stay tiny: `py::small_set<int>` holds 8 keys in
+ * the object itself, finds them with a linear scan and never allocates.
+ * The ninth insertion moves the keys into an open-addressing table and the
+ * set then behaves like py::flat_set.
+ *
+ * @tparam Key
+ * @tparam N inline capacity
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @tparam Allocator
+ */
+template <typename Key, size_t N = 8, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>,
+          typename Allocator = std::allocator<Key>>
+class small_set : public detail::SmallTable<detail::FlatSetPolicy<Key>, N,
+                                            Hash, KeyEqual, Allocator> {
+  using Self = small_set<Key, N, Hash, KeyEqual, Allocator>;
+  using Base = detail::SmallTable<detail::FlatSetPolicy<Key>, N, Hash,
+                                  KeyEqual, Allocator>;
+
+public:
+  /**
+   * @brief Construct a new small_set object
+   *
+   */
+  small_set() : Base{} {}
+
+  /**
+   * @brief Construct a new small_set object
+   *
+   * @param[in] alloc
+   */
+  explicit small_set(const Allocator &alloc) : Base(alloc) {}
+
+  /**
+   * @brief Construct a new small_set object
+   *
+   * Reserves up front for forward iterators.
+   *
+   * @param[in] start
+   * @param[in] stop
+   * @param[in] alloc
+   */
+  template <typename FwdIter>
+  small_set(const FwdIter &start, const FwdIter &stop,
+            const Allocator &alloc = Allocator())
+      : Base(alloc) {
+    this->insert(start, stop);
+  }
+
+  /**
+   * @brief Construct a new small_set object from an iterable, e.g.
+   * `py::small_set<int>(py::range(4))`
+   *
+   * @param[in] iterable
+   * @param[in] alloc
+   */
+  template <typename Iterable,
+            typename = detail::enable_iterable_t<Iterable, Self, Allocator>>
+  explicit small_set(const Iterable &iterable,
+                     const Allocator &alloc = Allocator())
+      : Base(alloc) {
+    detail::reserve_for_range(*this, iterable);
+    for (const auto &key : iterable) {
+      this->insert(key);
+    }
+  }
+
+  /**
+   * @brief Construct a new small_set object
+   *
+   * @param[in] init
+   */
+  small_set(std::initializer_list<Key> init) : Base{init} {}
+
+  /**
+   * @brief Construct a new small_set object
+   *
+   * @param[in] init
+   * @param[in] alloc
+   */
+  small_set(std::initializer_list<Key> init, const Allocator &alloc)
+      : Base(init, alloc) {}
+
+  /**
+   * @brief
+   *
+   * @param[in] key
+   * @return true
+   * @return false
+   */
+  auto contains(const Key &key) const -> bool {
+    return Base::count(key) != 0;
+  }
+
+  /**
+   * @brief Heterogeneous contains (transparent Hash and KeyEqual only)
+   *
+   * @param[in] key
+   * @return true
+   * @return false
+   */
+  template <typename K, typename H = Hash,
+            typename = detail::enable_transparent_t<H, KeyEqual>>
+  auto contains(const K &key) const -> bool {
+    return Base::count(key) != 0;
+  }
+
+  /**
+   * @brief
+   *
+   * @return Self
+   */
+  auto copy() const -> Self { return *this; }
+
+  /**
+   * @brief Test whether every element is in `other`
+   *
+   * @param[in] other
+   * @return true
+   * @return false
+   */
+  auto issubset(const Self &other) const -> bool {
+    return detail::issubset(*this, other);
+  }
+
+  /**
+   * @brief Test whether every element of `other` is in this set
+   *
+   * @param[in] other
+   * @return true
+   * @return false
+   */
+  auto issuperset(const Self &other) const -> bool {
+    return detail::issubset(other, *this);
+  }
+
+  /**
+   * @brief Test whether the two sets have no element in common
+   *
+   * @param[in] other
+   * @return true
+   * @return false
+   */
+  auto isdisjoint(const Self &other) const -> bool {
+    return detail::isdisjoint(*this, other);
+  }
+
+  /**
+   * @brief Same elements (Python set equality)
+   *
+   * @param[in] lhs
+   * @param[in] rhs
+   * @return true
+   * @return false
+   */
+  friend auto operator==(const Self &lhs, const Self &rhs) -> bool {
+    return lhs.size() == rhs.size() && detail::issubset(lhs, rhs);
+  }
+
+  friend auto operator!=(const Self &lhs, const Self &rhs) -> bool {
+    return !(lhs == rhs);
+  }
+
+  /**
+   * @brief
+   *
+   * @return Self&
+   */
+  auto operator=(const Self &) -> Self & = delete;
+
+  /**
+   * @brief
+   *
+   * @return Self&
+   */
+  auto operator=(Self &&) -> Self & = default;
+
+  /**
+   * @brief Move Constructor (default)
+   *
+   */
+  small_set(Self &&) = default;
+
+  // private:
+  /**
+   * @brief Copy Constructor
+   *
+   * Copy through explicitly the public copy() function!!!
+   */
+  small_set(const Self &) = default;
+};
+
+namespace detail {
+
+template <typename Key, size_t N, typename Hash, typename KeyEqual,
+          typename Allocator>
+struct is_set_algebra<small_set<Key, N, Hash, KeyEqual, Allocator>>
+    : std::true_type {};
+
+} // namespace detail
+
+/**
+ * @brief
+ *
+ * @tparam Key
+ * @tparam N
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @tparam Allocator
+ * @param[in] key
+ * @param[in] m
+ * @return true
+ * @return false
+ */
+template <typename Key, size_t N, typename Hash, typename KeyEqual,
+          typename Allocator>
+inline auto operator<(const Key &key,
+                      const small_set<Key, N, Hash, KeyEqual, Allocator> &m)
+    -> bool {
+  return m.contains(key);
+}
+
+/**
+ * @brief
+ *
+ * @tparam Key
+ * @tparam N
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @tparam Allocator
+ * @param[in] m
+ * @return size_t
+ */
+template <typename Key, size_t N, typename Hash, typename KeyEqual,
+          typename Allocator>
+inline auto len(const small_set<Key, N, Hash, KeyEqual, Allocator> &m)
+    -> size_t {
+  return m.size();
+}
+
+#if defined(PY2CPP_HAS_PMR)
+namespace pmr {
+
+/**
+ * @brief small_set whose spilled table uses a std::pmr::polymorphic_allocator
+ *
+ * @tparam Key
+ * @tparam N
+ */
+template <typename Key, size_t N = 8, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+using small_set = py::small_set<Key, N, Hash, KeyEqual,
+                                std::pmr::polymorphic_allocator<Key>>;
+
+} // namespace pmr
+#endif
+
+} // namespace py
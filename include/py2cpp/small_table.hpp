@@ -0,0 +1,586 @@
+#pragma once
+
+/** @file include/py2cpp/small_table.hpp
+ *  Small-buffer hash table shared by the small containers.
+ *
+ *  Up to `N` elements live inline in the object itself, unordered, and
+ *  nothing is allocated. Next to them sits one tag byte per element (7
+ *  bits of the hash, as in FlatTable's control bytes), so a lookup hashes
+ *  once, matches the tags a group at a time and compares keys only on a
+ *  tag hit. Inserting element N + 1 moves everything into a
+ *  detail::FlatTable member, and from then on the container behaves
+ *  exactly like the flat one (until clear(), which goes back to the
+ *  inline buffer and frees the table).
+ */
+
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "bulk.hpp"       // import detail::reserve_for
+#include "flat_table.hpp" // import detail::FlatTable
+#include "hash.hpp"       // import detail::enable_transparent_t
+
+namespace py {
+
+namespace detail {
+
+/**
+ * @brief Iterator over either the inline buffer or the spilled table
+ *
+ * @tparam Value value_type (const-qualified for const_iterator)
+ * @tparam FlatIt the matching FlatTable iterator
+ */
+template <typename Value, typename FlatIt> class SmallTableIterator {
+  template <typename, typename> friend class SmallTableIterator;
+  template <typename, size_t, typename, typename, typename>
+  friend class SmallTable;
+
+  Value *_ptr{nullptr}; // null while iterating the spilled table
+  FlatIt _it{};
+
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = typename std::remove_const<Value>::type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = Value *;
+  using reference = Value &;
+
+  SmallTableIterator() = default;
+  explicit SmallTableIterator(Value *ptr) : _ptr{ptr} {}
+  explicit SmallTableIterator(FlatIt it) : _it{it} {}
+
+  /**
+   * @brief iterator -> const_iterator conversion
+   */
+  template <typename Other, typename OtherIt,
+            typename = typename std::enable_if<
+                std::is_same<const Other, Value>::value &&
+                !std::is_same<Other, Value>::value>::type>
+  SmallTableIterator(const SmallTableIterator<Other, OtherIt> &other)
+      : _ptr{other._ptr}, _it{other._it} {}
+
+  auto operator*() const -> reference {
+    return this->_ptr != nullptr ? *this->_ptr : *this->_it;
+  }
+  auto operator->() const -> pointer { return &**this; }
+
+  auto operator++() -> SmallTableIterator & {
+    if (this->_ptr != nullptr) {
+      ++this->_ptr;
+    } else {
+      ++this->_it;
+    }
+    return *this;
+  }
+
+  auto operator++(int) -> SmallTableIterator {
+    auto old = *this;
+    ++*this;
+    return old;
+  }
+
+  auto operator==(const SmallTableIterator &other) const -> bool {
+    return this->_ptr == other._ptr && this->_it == other._it;
+  }
+
+  auto operator!=(const SmallTableIterator &other) const -> bool {
+    return !(*this == other);
+  }
+};
+
+/**
+ * @brief Hash table storing up to `N` elements inline
+ *
+ * Same interface as FlatTable (find, insert, try_emplace, erase, ...).
+ * Erasing an inline element moves the last one into its place, so, as
+ * with FlatTable, any insertion or erasure invalidates references.
+ *
+ * @tparam Policy FlatMapPolicy or FlatSetPolicy
+ * @tparam N inline capacity
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @tparam Allocator used once the table spills
+ */
+template <typename Policy, size_t N, typename Hash, typename KeyEqual,
+          typename Allocator = std::allocator<typename Policy::value_type>>
+class SmallTable {
+  static_assert(N > 0, "the inline capacity must be positive");
+
+  using Flat = FlatTable<Policy, Hash, KeyEqual, Allocator>;
+
+public:
+  using key_type = typename Policy::key_type;
+  using value_type = typename Policy::value_type;
+  using size_type = size_t;
+  using difference_type = std::ptrdiff_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using allocator_type = Allocator;
+  using reference = value_type &;
+  using const_reference = const value_type &;
+  using const_iterator =
+      SmallTableIterator<const value_type, typename Flat::const_iterator>;
+  using iterator = typename std::conditional<
+      Policy::constant_iterators, const_iterator,
+      SmallTableIterator<value_type, typename Flat::iterator>>::type;
+
+  /// Number of elements stored without allocating
+  static constexpr size_t inline_capacity = N;
+
+private:
+  // whole groups, so that matching never reads past the tags
+  static constexpr size_t kTags =
+      (N + Group::kWidth - 1) / Group::kWidth * Group::kWidth;
+
+  alignas(value_type) unsigned char _buf[N * sizeof(value_type)];
+  ctrl_t _tags[kTags]; // h2 of the inline keys, kEmpty from _n on
+  size_t _n{0};
+  bool _spilled{false};
+  Hash _hash{};
+  KeyEqual _eq{};
+  Flat _big;
+
+public:
+  /**
+   * @brief Construct a new empty table (no allocation)
+   *
+   */
+  SmallTable() : _big{} { this->reset_tags(); }
+
+  /**
+   * @brief Construct a new empty table using `alloc` once it spills
+   *
+   * @param[in] alloc
+   */
+  explicit SmallTable(const allocator_type &alloc) : _big(alloc) {
+    this->reset_tags();
+  }
+
+  /**
+   * @brief Construct a new table from an initializer list
+   *
+   * @param[in] init
+   * @param[in] alloc
+   */
+  SmallTable(std::initializer_list<value_type> init,
+             const allocator_type &alloc = allocator_type())
+      : _big(alloc) {
+    this->reset_tags();
+    this->insert(init.begin(), init.end());
+  }
+
+  SmallTable(const SmallTable &other)
+      : _n{0}, _spilled{other._spilled}, _hash{other._hash}, _eq{other._eq},
+        _big(other._big) {
+    this->reset_tags();
+    for (size_t i = 0; i != other._n; ++i) {
+      this->construct_at(i, other.data()[i]);
+      this->_tags[i] = other._tags[i];
+      ++this->_n;
+    }
+  }
+
+  SmallTable(SmallTable &&other) noexcept(
+      std::is_nothrow_move_constructible<value_type>::value)
+      : _n{0}, _spilled{other._spilled}, _hash{std::move(other._hash)},
+        _eq{std::move(other._eq)}, _big(std::move(other._big)) {
+    this->reset_tags();
+    for (size_t i = 0; i != other._n; ++i) {
+      this->construct_at(i, std::move(other.data()[i]));
+      this->_tags[i] = other._tags[i];
+      ++this->_n;
+    }
+    other.clear();
+  }
+
+  auto operator=(const SmallTable &other) -> SmallTable & {
+    if (this != &other) {
+      this->destroy_inline();
+      this->_big = other._big;
+      this->_spilled = other._spilled;
+      this->_hash = other._hash;
+      this->_eq = other._eq;
+      for (size_t i = 0; i != other._n; ++i) {
+        this->construct_at(i, other.data()[i]);
+        this->_tags[i] = other._tags[i];
+        ++this->_n;
+      }
+    }
+    return *this;
+  }
+
+  auto operator=(SmallTable &&other) noexcept(
+      std::is_nothrow_move_constructible<value_type>::value &&
+      std::is_nothrow_move_assignable<Flat>::value) -> SmallTable & {
+    if (this != &other) {
+      this->destroy_inline();
+      this->_big = std::move(other._big);
+      this->_spilled = other._spilled;
+      this->_hash = std::move(other._hash);
+      this->_eq = std::move(other._eq);
+      for (size_t i = 0; i != other._n; ++i) {
+        this->construct_at(i, std::move(other.data()[i]));
+        this->_tags[i] = other._tags[i];
+        ++this->_n;
+      }
+      other.clear();
+    }
+    return *this;
+  }
+
+  ~SmallTable() { this->destroy_inline(); }
+
+  /// Whether the elements are still stored inline
+  auto is_small() const -> bool { return !this->_spilled; }
+
+  auto get_allocator() const -> allocator_type {
+    return this->_big.get_allocator();
+  }
+
+  auto begin() -> iterator {
+    return this->_spilled ? iterator(this->_big.begin())
+                          : iterator(this->data());
+  }
+  auto end() -> iterator {
+    return this->_spilled ? iterator(this->_big.end())
+                          : iterator(this->data() + this->_n);
+  }
+  auto begin() const -> const_iterator {
+    return const_cast<SmallTable *>(this)->begin();
+  }
+  auto end() const -> const_iterator {
+    return const_cast<SmallTable *>(this)->end();
+  }
+  auto cbegin() const -> const_iterator { return this->begin(); }
+  auto cend() const -> const_iterator { return this->end(); }
+
+  auto size() const -> size_t {
+    return this->_spilled ? this->_big.size() : this->_n;
+  }
+  auto empty() const -> bool { return this->size() == 0; }
+  auto hash_function() const -> hasher { return this->_big.hash_function(); }
+  auto key_eq() const -> key_equal { return this->_eq; }
+
+  /**
+   * @brief Destroy all elements and return to the inline buffer
+   *
+   */
+  void clear() {
+    this->destroy_inline();
+    if (this->_spilled) {
+      auto empty = Flat(this->_big.get_allocator());
+      this->_big.swap(empty);
+      this->_spilled = false;
+    }
+  }
+
+  /**
+   * @brief Make room for `n` elements: spills if `n` exceeds N
+   *
+   * @param[in] n
+   */
+  void reserve(size_t n) {
+    if (n > N && !this->_spilled) {
+      this->spill(n);
+    }
+    if (this->_spilled) {
+      this->_big.reserve(n);
+    }
+  }
+
+  auto find(const key_type &key) -> iterator { return this->find_as(key); }
+
+  auto find(const key_type &key) const -> const_iterator {
+    return const_cast<SmallTable *>(this)->find(key);
+  }
+
+  /**
+   * @brief Heterogeneous lookup (transparent Hash and KeyEqual only)
+   *
+   * @param[in] key any type the hash and the equality accept
+   */
+  template <typename K, typename H = Hash,
+            typename = enable_transparent_t<H, KeyEqual>>
+  auto find(const K &key) -> iterator {
+    return this->find_as(key);
+  }
+
+  template <typename K, typename H = Hash,
+            typename = enable_transparent_t<H, KeyEqual>>
+  auto find(const K &key) const -> const_iterator {
+    return const_cast<SmallTable *>(this)->find(key);
+  }
+
+  auto count(const key_type &key) const -> size_t {
+    return this->count_as(key);
+  }
+
+  template <typename K, typename H = Hash,
+            typename = enable_transparent_t<H, KeyEqual>>
+  auto count(const K &key) const -> size_t {
+    return this->count_as(key);
+  }
+
+  auto insert(const value_type &value) -> std::pair<iterator, bool> {
+    return this->emplace_key(
+        Policy::key(value), [&]() { return this->_big.insert(value); },
+        value);
+  }
+
+  auto insert(value_type &&value) -> std::pair<iterator, bool> {
+    const auto &key = Policy::key(value);
+    return this->emplace_key(
+        key, [&]() { return this->_big.insert(std::move(value)); },
+        std::move(value));
+  }
+
+  template <typename InputIt> void insert(InputIt first, InputIt last) {
+    reserve_for(*this, first, last);
+    for (; first != last; ++first) {
+      this->insert(*first);
+    }
+  }
+
+  void insert(std::initializer_list<value_type> init) {
+    this->insert(init.begin(), init.end());
+  }
+
+  /**
+   * @brief Construct an element in place if its key is not present
+   *
+   * The element is built on the stack first to learn its key, so prefer
+   * try_emplace() for maps.
+   */
+  template <typename... Args>
+  auto emplace(Args &&...args) -> std::pair<iterator, bool> {
+    value_type value(std::forward<Args>(args)...);
+    return this->insert(std::move(value));
+  }
+
+  /**
+   * @brief Insert `{key, T(args...)}` if `key` is not present (maps only)
+   *
+   * Nothing is constructed when the key already exists.
+   */
+  template <typename... Args>
+  auto try_emplace(const key_type &key, Args &&...args)
+      -> std::pair<iterator, bool> {
+    return this->emplace_key(
+        key,
+        [&]() {
+          return this->_big.try_emplace(key, std::forward<Args>(args)...);
+        },
+        std::piecewise_construct, std::forward_as_tuple(key),
+        std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  /**
+   * @brief try_emplace() with a heterogeneous key
+   *
+   * The stored key is only constructed from `key` when it is absent.
+   */
+  template <typename K, typename... Args, typename H = Hash,
+            typename = enable_transparent_t<H, KeyEqual>,
+            typename = typename std::enable_if<
+                !std::is_same<typename std::decay<K>::type,
+                              key_type>::value>::type>
+  auto try_emplace(const K &key, Args &&...args) -> std::pair<iterator, bool> {
+    return this->emplace_key(
+        key,
+        [&]() {
+          return this->_big.try_emplace(key, std::forward<Args>(args)...);
+        },
+        std::piecewise_construct, std::forward_as_tuple(key),
+        std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  template <typename... Args>
+  auto try_emplace(key_type &&key, Args &&...args)
+      -> std::pair<iterator, bool> {
+    return this->emplace_key(
+        key,
+        [&]() {
+          return this->_big.try_emplace(std::move(key),
+                                        std::forward<Args>(args)...);
+        },
+        std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+        std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  /**
+   * @brief Erase the element at `pos`
+   *
+   * @param[in] pos
+   * @return iterator following the removed element
+   */
+  auto erase(const_iterator pos) -> iterator {
+    if (this->_spilled) {
+      return iterator(this->_big.erase(pos._it));
+    }
+    const auto i = static_cast<size_t>(pos._ptr - this->data());
+    this->erase_inline(i);
+    return iterator(this->data() + i);
+  }
+
+  auto erase(const key_type &key) -> size_t {
+    if (this->_spilled) {
+      return this->_big.erase(key);
+    }
+    const auto i = this->find_index(key, this->hash_of(key));
+    if (i == this->_n) {
+      return 0;
+    }
+    this->erase_inline(i);
+    return 1;
+  }
+
+  /**
+   * @brief Erase the element at `pos`, without looking for the next one
+   *
+   * @param[in] pos
+   */
+  void discard(const_iterator pos) {
+    if (this->_spilled) {
+      this->_big.discard(pos._it);
+    } else {
+      this->erase_inline(static_cast<size_t>(pos._ptr - this->data()));
+    }
+  }
+
+  /**
+   * @brief The last element (see FlatTable::last()), or end() if empty
+   *
+   * @return iterator
+   */
+  auto last() -> iterator {
+    if (this->_spilled) {
+      return iterator(this->_big.last());
+    }
+    return this->_n == 0 ? this->end() : iterator(this->data() + this->_n - 1);
+  }
+
+private:
+  auto data() -> value_type * {
+    return reinterpret_cast<value_type *>(&this->_buf[0]);
+  }
+  auto data() const -> const value_type * {
+    return reinterpret_cast<const value_type *>(&this->_buf[0]);
+  }
+
+  template <typename... Args> void construct_at(size_t i, Args &&...args) {
+    ::new (static_cast<void *>(this->data() + i))
+        value_type(std::forward<Args>(args)...);
+  }
+
+  void destroy_inline() {
+    for (size_t i = 0; i != this->_n; ++i) {
+      this->data()[i].~value_type();
+    }
+    this->_n = 0;
+    this->reset_tags();
+  }
+
+  void reset_tags() {
+    std::memset(this->_tags, static_cast<unsigned char>(kEmpty), kTags);
+  }
+
+  template <typename K> auto hash_of(const K &key) const -> size_t {
+    return flat_hash_mix(this->_hash(key));
+  }
+
+  /// Position of `key` in the inline buffer, or _n
+  template <typename K>
+  auto find_index(const K &key, size_t hash) const -> size_t {
+    const auto *p = this->data();
+    const auto tag = h2(hash);
+    // kEmpty never matches, so every hit is below _n
+    for (auto i : Group(this->_tags).match(tag)) {
+      if (this->_eq(Policy::key(p[i]), key)) {
+        return i;
+      }
+    }
+    for (size_t g = Group::kWidth; g < this->_n; g += Group::kWidth) {
+      for (auto i : Group(this->_tags + g).match(tag)) {
+        if (this->_eq(Policy::key(p[g + i]), key)) {
+          return g + i;
+        }
+      }
+    }
+    return this->_n;
+  }
+
+  template <typename K> auto find_as(const K &key) -> iterator {
+    if (this->_spilled) {
+      return iterator(this->_big.find(key));
+    }
+    return iterator(this->data() + this->find_index(key, this->hash_of(key)));
+  }
+
+  // no iterators to build and compare
+  template <typename K> auto count_as(const K &key) const -> size_t {
+    if (this->_spilled) {
+      return this->_big.count(key);
+    }
+    return this->find_index(key, this->hash_of(key)) != this->_n ? 1U : 0U;
+  }
+
+  /// Move the inline elements into the table
+  void spill(size_t n) {
+    this->_big.reserve(n);
+    for (size_t i = 0; i != this->_n; ++i) {
+      this->_big.insert(std::move(this->data()[i]));
+    }
+    this->destroy_inline();
+    this->_spilled = true;
+  }
+
+  /**
+   * @brief Construct `value_type(args...)` inline unless `key` is found;
+   * past N elements, spill and let `big_insert` do it
+   */
+  template <typename K, typename BigInsert, typename... Args>
+  auto emplace_key(const K &key, BigInsert &&big_insert, Args &&...args)
+      -> std::pair<iterator, bool> {
+    if (!this->_spilled) {
+      const auto hash = this->hash_of(key);
+      const auto i = this->find_index(key, hash);
+      if (i != this->_n) {
+        return {iterator(this->data() + i), false};
+      }
+      if (this->_n != N) {
+        this->construct_at(i, std::forward<Args>(args)...);
+        this->_tags[i] = static_cast<ctrl_t>(h2(hash));
+        ++this->_n;
+        return {iterator(this->data() + i), true};
+      }
+      this->spill(2 * N);
+    }
+    auto res = big_insert();
+    return {iterator(res.first), res.second};
+  }
+
+  void erase_inline(size_t i) {
+    auto *p = this->data();
+    const auto last = this->_n - 1;
+    p[i].~value_type();
+    if (i != last) {
+      // the keys may be const (map slots): rebuild rather than assign
+      this->construct_at(i, std::move(p[last]));
+      p[last].~value_type();
+      this->_tags[i] = this->_tags[last];
+    }
+    this->_tags[last] = kEmpty;
+    --this->_n;
+  }
+};
+
+} // namespace detail
+
+} // namespace py
@@ -0,0 +1,506 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include "arena.hpp"        // import PY2CPP_HAS_PMR
+#include "bulk.hpp"         // import detail::enable_iterable_t
+#include "dict.hpp"         // import key_iterator
+#include "sorted_table.hpp" // import detail::SortedTable
+
+namespace py {
+
+/**
+ * @brief Dict stored as a vector sorted by key, for read-mostly tables
+ *
+ * Same surface as py::dict, iterating in key order. Construct or update()
+ * in bulk: the input is sorted once (later duplicates win, as in Python)
+ * and merged in linear time, whereas inserting a single new key through
+ * operator[] or setdefault() shifts the vector. Pass py::eytzinger_layout
+ * for branch-free lookups in large tables.
+ *
+ * The items are read-only through items() and iteration; values are
+ * updated through operator[], get() or setdefault().
+ *
+ * @tparam Key
+ * @tparam T
+ * @tparam Compare
+ * @tparam Layout sorted_layout or eytzinger_layout
+ * @tparam Allocator
+ */
+template <typename Key, typename T, typename Compare = std::less<Key>,
+          typename Layout = sorted_layout,
+          typename Allocator = std::allocator<std::pair<const Key, T>>>
+class sorted_dict
+    : public detail::SortedTable<detail::SortedMapPolicy<Key, T>, Compare,
+                                 Layout, Allocator> {
+  using Self = sorted_dict<Key, T, Compare, Layout, Allocator>;
+  using Base = detail::SortedTable<detail::SortedMapPolicy<Key, T>, Compare,
+                                   Layout, Allocator>;
+  using typename Base::Slots;
+  using Entry = std::pair<Key, T>;
+
+public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = Entry;
+  using const_iterator = typename Base::const_iterator;
+
+  /**
+   * @brief Construct a new sorted_dict object
+   *
+   */
+  sorted_dict() : Base{} {}
+
+  /**
+   * @brief Construct a new sorted_dict object
+   *
+   * @param[in] alloc
+   */
+  explicit sorted_dict(const Allocator &alloc) : Base(alloc) {}
+
+  /**
+   * @brief Construct a new sorted_dict object
+   *
+   * @param[in] init
+   * @param[in] alloc
+   */
+  sorted_dict(std::initializer_list<std::pair<const Key, T>> init,
+              const Allocator &alloc = Allocator())
+      : Base(alloc) {
+    this->insert_range(init.begin(), init.end());
+  }
+
+  /**
+   * @brief Construct a new sorted_dict object from (key, value) pairs
+   * (sort + unique; later duplicates win, as in Python)
+   *
+   * @param[in] first
+   * @param[in] last
+   * @param[in] alloc
+   */
+  template <typename InputIt>
+  sorted_dict(InputIt first, InputIt last,
+              const Allocator &alloc = Allocator())
+      : Base(alloc) {
+    this->insert_range(first, last);
+  }
+
+  /**
+   * @brief Construct a new sorted_dict object from an iterable of
+   * (key, value) pairs, e.g. `py::sorted_dict<size_t, T>(py::enumerate(v))`
+   *
+   * @param[in] pairs
+   * @param[in] alloc
+   */
+  template <typename Iterable,
+            typename = detail::enable_iterable_t<Iterable, Self, Allocator>>
+  explicit sorted_dict(const Iterable &pairs,
+                       const Allocator &alloc = Allocator())
+      : Base(alloc) {
+    auto v = Slots(this->_slots.get_allocator());
+    for (const auto &kv : pairs) {
+      v.emplace_back(kv.first, kv.second);
+    }
+    this->sort_unique(v);
+    this->assign_sorted(std::move(v));
+  }
+
+  /**
+   * @brief New sorted_dict mapping every key of `keys` to `value`
+   *
+   * @param[in] keys
+   * @param[in] value
+   * @return Self
+   */
+  template <typename Iterable>
+  static auto fromkeys(const Iterable &keys, const T &value = T()) -> Self {
+    auto res = Self{};
+    auto v = Slots{};
+    for (const auto &key : keys) {
+      v.emplace_back(key, value);
+    }
+    res.sort_unique(v);
+    res.assign_sorted(std::move(v));
+    return res;
+  }
+
+  /**
+   * @brief
+   *
+   * @param[in] key
+   * @return true
+   * @return false
+   */
+  auto contains(const Key &key) const -> bool {
+    return this->find_index(key) != Base::npos;
+  }
+
+  /**
+   * @brief Heterogeneous contains (transparent Compare only)
+   *
+   * @param[in] key
+   * @return true
+   * @return false
+   */
+  template <typename K, typename C = Compare,
+            typename = detail::enable_transparent_compare_t<C>>
+  auto contains(const K &key) const -> bool {
+    return this->find_index(key) != Base::npos;
+  }
+
+  /**
+   * @brief Look up `key` (one binary search)
+   *
+   * @param[in] key
+   * @return T* pointer to the value, or nullptr (Python None)
+   */
+  auto get(const Key &key) -> T * {
+    const auto i = this->find_index(key);
+    return i == Base::npos ? nullptr : &this->_slots[i].second;
+  }
+
+  /**
+   * @brief Look up `key` (one binary search)
+   *
+   * @param[in] key
+   * @return const T* pointer to the value, or nullptr (Python None)
+   */
+  auto get(const Key &key) const -> const T * {
+    const auto i = this->find_index(key);
+    return i == Base::npos ? nullptr : &this->_slots[i].second;
+  }
+
+  /**
+   * @brief Look up `key` (no copy)
+   *
+   * Like std::max, the result may refer to `default_value`: do not bind it
+   * to a reference that outlives a temporary default.
+   *
+   * @param[in] key
+   * @param[in] default_value
+   * @return const T&
+   */
+  auto get(const Key &key, const T &default_value) const -> const T & {
+    const auto i = this->find_index(key);
+    return i == Base::npos ? default_value : this->_slots[i].second;
+  }
+
+  /**
+   * @brief Heterogeneous get (transparent Compare only)
+   *
+   * @param[in] key
+   * @param[in] default_value
+   * @return const T&
+   */
+  template <typename K, typename C = Compare,
+            typename = detail::enable_transparent_compare_t<C>>
+  auto get(const K &key, const T &default_value) const -> const T & {
+    const auto i = this->find_index(key);
+    return i == Base::npos ? default_value : this->_slots[i].second;
+  }
+
+  /**
+   * @brief Insert `key` with `default_value` unless present
+   *
+   * @param[in] key
+   * @param[in] default_value
+   * @return T& the stored value
+   */
+  auto setdefault(const Key &key, const T &default_value = T()) -> T & {
+    this->emplace_key(key, key, default_value);
+    return this->_slots[this->find_index(key)].second;
+  }
+
+  /**
+   * @brief Remove `key` and move its value out
+   *
+   * @param[in] key
+   * @return T
+   * @exception std::out_of_range if `key` is absent (Python KeyError)
+   */
+  auto pop(const Key &key) -> T {
+    const auto i = this->find_index(key);
+    if (i == Base::npos) {
+      throw std::out_of_range("sorted_dict::pop");
+    }
+    auto value = std::move(this->_slots[i].second);
+    this->erase(key);
+    return value;
+  }
+
+  /**
+   * @brief Remove `key` and move its value out, or return `default_value`
+   *
+   * @param[in] key
+   * @param[in] default_value
+   * @return T
+   */
+  auto pop(const Key &key, T default_value) -> T {
+    const auto i = this->find_index(key);
+    if (i == Base::npos) {
+      return default_value;
+    }
+    auto value = std::move(this->_slots[i].second);
+    this->erase(key);
+    return value;
+  }
+
+  /**
+   * @brief Remove and return the item with the largest key
+   *
+   * @return std::pair<Key, T>
+   * @exception std::out_of_range if the dict is empty (Python KeyError)
+   */
+  auto popitem() -> std::pair<Key, T> {
+    if (this->empty()) {
+      throw std::out_of_range("sorted_dict::popitem");
+    }
+    auto sorted = this->take_sorted();
+    auto item = std::move(sorted.back());
+    sorted.pop_back();
+    this->assign_sorted(std::move(sorted));
+    return item;
+  }
+
+  /**
+   * @brief Insert or overwrite every item of `other` (linear merge)
+   *
+   * @param[in] other
+   */
+  void update(const Self &other) {
+    if (this == &other) {
+      return;
+    }
+    this->merge_sorted(other.sorted_copy());
+  }
+
+  /**
+   * @brief Insert or overwrite every item of `other`, moving the values
+   *
+   * @param[in] other
+   */
+  void update(Self &&other) {
+    if (this == &other) {
+      return;
+    }
+    this->merge_sorted(other.take_sorted());
+  }
+
+  /**
+   * @brief Insert or overwrite the (key, value) pairs of [first, last)
+   *
+   * Sorts the input once, then merges it in linear time.
+   *
+   * @param[in] first
+   * @param[in] last
+   */
+  template <typename InputIt> void update(InputIt first, InputIt last) {
+    this->insert_range(first, last);
+  }
+
+  /**
+   * @brief Insert or overwrite the given (key, value) pairs
+   *
+   * @param[in] init
+   */
+  void update(std::initializer_list<std::pair<const Key, T>> init) {
+    this->insert_range(init.begin(), init.end());
+  }
+
+  /**
+   * @brief The keys, in order
+   *
+   * @return auto
+   */
+  auto begin() const -> key_iterator<const_iterator> {
+    return key_iterator<const_iterator>{Base::begin()};
+  }
+
+  /**
+   * @brief
+   *
+   * @return auto
+   */
+  auto end() const -> key_iterator<const_iterator> {
+    return key_iterator<const_iterator>{Base::end()};
+  }
+
+  /**
+   * @brief The (key, value) pairs, in key order
+   *
+   * @return const Base&
+   */
+  auto items() const -> const Base & { return *this; }
+
+  /**
+   * @brief
+   *
+   * @return Self
+   */
+  auto copy() const -> Self { return *this; }
+
+  /**
+   * @brief
+   *
+   * @param[in] k
+   * @return const T&
+   */
+  auto at(const Key &k) const -> const T & {
+    const auto i = this->find_index(k);
+    if (i == Base::npos) {
+      throw std::out_of_range("sorted_dict::at");
+    }
+    return this->_slots[i].second;
+  }
+
+  /**
+   * @brief
+   *
+   * @param[in] k
+   * @return T&
+   */
+  auto at(const Key &k) -> T & {
+    return const_cast<T &>(static_cast<const Self &>(*this).at(k));
+  }
+
+  /**
+   * @brief
+   *
+   * @param[in] k
+   * @return const T&
+   */
+  auto operator[](const Key &k) const -> const T & { return this->at(k); }
+
+  /**
+   * @brief Upsert (a new key is O(n))
+   *
+   * @param[in] k
+   * @return T&
+   */
+  auto operator[](const Key &k) -> T & {
+    auto i = this->find_index(k);
+    if (i == Base::npos) {
+      this->emplace_key(k, std::piecewise_construct, std::forward_as_tuple(k),
+                        std::forward_as_tuple());
+      i = this->find_index(k);
+    }
+    return this->_slots[i].second;
+  }
+
+  /**
+   * @brief Same items (keys equivalent and values equal)
+   *
+   * @param[in] a
+   * @param[in] b
+   * @return true
+   * @return false
+   */
+  friend auto operator==(const Self &a, const Self &b) -> bool {
+    return a.size() == b.size() &&
+           std::equal(a.items().begin(), a.items().end(), b.items().begin(),
+                      [&a](const Entry &x, const Entry &y) {
+                        return a.equiv(x.first, y.first) &&
+                               x.second == y.second;
+                      });
+  }
+
+  friend auto operator!=(const Self &a, const Self &b) -> bool {
+    return !(a == b);
+  }
+
+  /**
+   * @brief
+   *
+   * @return Self&
+   */
+  auto operator=(const Self &) -> Self & = delete;
+
+  /**
+   * @brief
+   *
+   * @return Self&
+   */
+  auto operator=(Self &&) noexcept -> Self & = default;
+
+  /**
+   * @brief Move Constructor (default)
+   *
+   */
+  sorted_dict(Self &&) noexcept = default;
+
+  ~sorted_dict() = default;
+
+  // private:
+  /**
+   * @brief Construct a new sorted_dict object
+   *
+   * Copy through explicitly the public copy() function!!!
+   */
+  sorted_dict(const Self &) = default;
+};
+
+/**
+ * @brief
+ *
+ * @tparam Key
+ * @tparam T
+ * @tparam Compare
+ * @tparam Layout
+ * @tparam Allocator
+ * @param[in] key
+ * @param[in] m
+ * @return true
+ * @return false
+ */
+template <typename Key, typename T, typename Compare, typename Layout,
+          typename Allocator>
+inline auto operator<(const Key &key,
+                      const sorted_dict<Key, T, Compare, Layout, Allocator> &m)
+    -> bool {
+  return m.contains(key);
+}
+
+/**
+ * @brief
+ *
+ * @tparam Key
+ * @tparam T
+ * @tparam Compare
+ * @tparam Layout
+ * @tparam Allocator
+ * @param[in] m
+ * @return size_t
+ */
+template <typename Key, typename T, typename Compare, typename Layout,
+          typename Allocator>
+inline auto len(const sorted_dict<Key, T, Compare, Layout, Allocator> &m)
+    -> size_t {
+  return m.size();
+}
+
+#if defined(PY2CPP_HAS_PMR)
+namespace pmr {
+
+/**
+ * @brief sorted_dict using a std::pmr::polymorphic_allocator
+ *
+ * @tparam Key
+ * @tparam T
+ */
+template <typename Key, typename T, typename Compare = std::less<Key>,
+          typename Layout = sorted_layout>
+using sorted_dict =
+    py::sorted_dict<Key, T, Compare, Layout,
+                    std::pmr::polymorphic_allocator<std::pair<const Key, T>>>;
+
+} // namespace pmr
+#endif
+
+} // namespace py
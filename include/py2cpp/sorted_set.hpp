@@ -0,0 +1,366 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef> // import size_t
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "arena.hpp"        // import PY2CPP_HAS_PMR
+#include "bulk.hpp"         // import detail::enable_iterable_t
+#include "sorted_table.hpp" // import detail::SortedTable
+
+namespace py {
+
+/**
+ * @brief Set stored as a sorted vector, for build-once, query-often data
+ *
+ * Same surface as py::set, iterating in key order. Constructors and
+ * insert(first, last) sort the input once; the set operators merge the
+ * two sorted operands in linear time. Pass py::eytzinger_layout to store
+ * the keys in breadth-first order for branch-free lookups:
+ *
+ *     const auto S = py::sorted_set<int, std::less<>, py::eytzinger_layout>(
+ *         keys.begin(), keys.end());
+ *
+ * @tparam Key
+ * @tparam Compare
+ * @tparam Layout sorted_layout or eytzinger_layout
+ * @tparam Allocator
+ */
+template <typename Key, typename Compare = std::less<Key>,
+          typename Layout = sorted_layout,
+          typename Allocator = std::allocator<Key>>
+class sorted_set : public detail::SortedTable<detail::SortedSetPolicy<Key>,
+                                              Compare, Layout, Allocator> {
+  using Self = sorted_set<Key, Compare, Layout, Allocator>;
+  using Base = detail::SortedTable<detail::SortedSetPolicy<Key>, Compare,
+                                   Layout, Allocator>;
+  using typename Base::Slots;
+
+public:
+  using key_type = Key;
+  using value_type = Key;
+
+  /**
+   * @brief Construct a new sorted_set object
+   *
+   */
+  sorted_set() : Base{} {}
+
+  /**
+   * @brief Construct a new sorted_set object
+   *
+   * @param[in] alloc
+   */
+  explicit sorted_set(const Allocator &alloc) : Base(alloc) {}
+
+  /**
+   * @brief Construct a new sorted_set object (sort + unique)
+   *
+   * @param[in] start
+   * @param[in] stop
+   * @param[in] alloc
+   */
+  template <typename FwdIter>
+  sorted_set(const FwdIter &start, const FwdIter &stop,
+             const Allocator &alloc = Allocator())
+      : Base(alloc) {
+    this->insert_range(start, stop);
+  }
+
+  /**
+   * @brief Construct a new sorted_set object from an iterable, e.g.
+   * `py::sorted_set<int>(py::range(10))`
+   *
+   * @param[in] iterable
+   * @param[in] alloc
+   */
+  template <typename Iterable,
+            typename = detail::enable_iterable_t<Iterable, Self, Allocator>>
+  explicit sorted_set(const Iterable &iterable,
+                      const Allocator &alloc = Allocator())
+      : Base(alloc) {
+    this->insert_range(std::begin(iterable), std::end(iterable));
+  }
+
+  /**
+   * @brief Construct a new sorted_set object
+   *
+   * @param[in] init
+   * @param[in] alloc
+   */
+  sorted_set(std::initializer_list<Key> init,
+             const Allocator &alloc = Allocator())
+      : Base(alloc) {
+    this->insert_range(init.begin(), init.end());
+  }
+
+  /**
+   * @brief Insert `key` (O(n): prefer the bulk insert)
+   *
+   * @param[in] key
+   * @return std::pair<const_iterator, bool> the element and whether it was
+   *         inserted
+   */
+  auto insert(const Key &key)
+      -> std::pair<typename Base::const_iterator, bool> {
+    const auto inserted = this->emplace_key(key, key);
+    return {this->find(key), inserted};
+  }
+
+  /**
+   * @brief Insert the keys of [first, last) (sort + one linear merge)
+   *
+   * @param[in] first
+   * @param[in] last
+   */
+  template <typename InputIt> void insert(InputIt first, InputIt last) {
+    this->insert_range(first, last);
+  }
+
+  /**
+   * @brief
+   *
+   * @param[in] init
+   */
+  void insert(std::initializer_list<Key> init) {
+    this->insert_range(init.begin(), init.end());
+  }
+
+  /**
+   * @brief
+   *
+   * @param[in] key
+   * @return true
+   * @return false
+   */
+  auto contains(const Key &key) const -> bool {
+    return this->find_index(key) != Base::npos;
+  }
+
+  /**
+   * @brief Heterogeneous contains (transparent Compare only)
+   *
+   * @param[in] key
+   * @return true
+   * @return false
+   */
+  template <typename K, typename C = Compare,
+            typename = detail::enable_transparent_compare_t<C>>
+  auto contains(const K &key) const -> bool {
+    return this->find_index(key) != Base::npos;
+  }
+
+  /**
+   * @brief
+   *
+   * @return Self
+   */
+  auto copy() const -> Self { return *this; }
+
+  /**
+   * @brief Test whether every element is in `other` (linear merge)
+   *
+   * @param[in] other
+   * @return true
+   * @return false
+   */
+  auto issubset(const Self &other) const -> bool {
+    return this->size() <= other.size() &&
+           std::includes(other.begin(), other.end(), this->begin(),
+                         this->end(), this->_comp);
+  }
+
+  /**
+   * @brief Test whether every element of `other` is in this set
+   *
+   * @param[in] other
+   * @return true
+   * @return false
+   */
+  auto issuperset(const Self &other) const -> bool {
+    return other.issubset(*this);
+  }
+
+  /**
+   * @brief Test whether the two sets have no element in common
+   *
+   * @param[in] other
+   * @return true
+   * @return false
+   */
+  auto isdisjoint(const Self &other) const -> bool {
+    auto a = this->begin();
+    auto b = other.begin();
+    while (a != this->end() && b != other.end()) {
+      if (this->_comp(*a, *b)) {
+        ++a;
+      } else if (this->_comp(*b, *a)) {
+        ++b;
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /** @name Set operators
+   *  Linear merges of the two sorted operands.
+   */
+  ///@{
+
+  friend auto operator|(const Self &a, const Self &b) -> Self {
+    return combine(a, b, [](const Self &x, const Self &y, Slots &out) {
+      std::set_union(x.begin(), x.end(), y.begin(), y.end(),
+                     std::back_inserter(out), x._comp);
+    });
+  }
+
+  friend auto operator&(const Self &a, const Self &b) -> Self {
+    return combine(a, b, [](const Self &x, const Self &y, Slots &out) {
+      std::set_intersection(x.begin(), x.end(), y.begin(), y.end(),
+                            std::back_inserter(out), x._comp);
+    });
+  }
+
+  friend auto operator-(const Self &a, const Self &b) -> Self {
+    return combine(a, b, [](const Self &x, const Self &y, Slots &out) {
+      std::set_difference(x.begin(), x.end(), y.begin(), y.end(),
+                          std::back_inserter(out), x._comp);
+    });
+  }
+
+  friend auto operator^(const Self &a, const Self &b) -> Self {
+    return combine(a, b, [](const Self &x, const Self &y, Slots &out) {
+      std::set_symmetric_difference(x.begin(), x.end(), y.begin(), y.end(),
+                                    std::back_inserter(out), x._comp);
+    });
+  }
+
+  friend auto operator|=(Self &a, const Self &b) -> Self & {
+    if (&a != &b) {
+      a.merge_sorted(b.sorted_copy());
+    }
+    return a;
+  }
+
+  friend auto operator&=(Self &a, const Self &b) -> Self & {
+    return a = a & b;
+  }
+
+  friend auto operator-=(Self &a, const Self &b) -> Self & {
+    return a = a - b;
+  }
+
+  friend auto operator^=(Self &a, const Self &b) -> Self & {
+    return a = a ^ b;
+  }
+
+  friend auto operator==(const Self &a, const Self &b) -> bool {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(),
+                      [&a](const Key &x, const Key &y) {
+                        return !a._comp(x, y) && !a._comp(y, x);
+                      });
+  }
+
+  friend auto operator!=(const Self &a, const Self &b) -> bool {
+    return !(a == b);
+  }
+
+  ///@}
+
+  /**
+   * @brief
+   *
+   * @return Self&
+   */
+  auto operator=(const Self &) -> Self & = delete;
+
+  /**
+   * @brief
+   *
+   * @return Self&
+   */
+  auto operator=(Self &&) noexcept -> Self & = default;
+
+  /**
+   * @brief Move Constructor (default)
+   *
+   */
+  sorted_set(Self &&) noexcept = default;
+
+  // private:
+  /**
+   * @brief Copy Constructor
+   *
+   * Copy through explicitly the public copy() function!!!
+   */
+  sorted_set(const Self &) = default;
+
+private:
+  template <typename Op>
+  static auto combine(const Self &a, const Self &b, Op op) -> Self {
+    auto out = Slots(a._slots.get_allocator());
+    op(a, b, out);
+    auto res = Self(a.get_allocator());
+    res.assign_sorted(std::move(out));
+    return res;
+  }
+};
+
+/**
+ * @brief
+ *
+ * @tparam Key
+ * @tparam Compare
+ * @tparam Layout
+ * @tparam Allocator
+ * @param[in] key
+ * @param[in] m
+ * @return true
+ * @return false
+ */
+template <typename Key, typename Compare, typename Layout, typename Allocator>
+inline auto operator<(const Key &key,
+                      const sorted_set<Key, Compare, Layout, Allocator> &m)
+    -> bool {
+  return m.contains(key);
+}
+
+/**
+ * @brief
+ *
+ * @tparam Key
+ * @tparam Compare
+ * @tparam Layout
+ * @tparam Allocator
+ * @param[in] m
+ * @return size_t
+ */
+template <typename Key, typename Compare, typename Layout, typename Allocator>
+inline auto len(const sorted_set<Key, Compare, Layout, Allocator> &m)
+    -> size_t {
+  return m.size();
+}
+
+#if defined(PY2CPP_HAS_PMR)
+namespace pmr {
+
+/**
+ * @brief sorted_set using a std::pmr::polymorphic_allocator
+ *
+ * @tparam Key
+ */
+template <typename Key, typename Compare = std::less<Key>,
+          typename Layout = sorted_layout>
+using sorted_set = py::sorted_set<Key, Compare, Layout,
+                                  std::pmr::polymorphic_allocator<Key>>;
+
+} // namespace pmr
+#endif
+
+} // namespace py
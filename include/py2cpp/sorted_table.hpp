@@ -0,0 +1,450 @@
+#pragma once
+
+/** @file include/py2cpp/sorted_table.hpp
+ *  Sorted contiguous table shared by sorted_set and sorted_dict.
+ *
+ *  The elements live in one vector, unique by key, and are looked up by
+ *  binary search. Two layouts are available:
+ *
+ *   - py::sorted_layout (default): the vector is in key order, so
+ *     iteration is a linear scan and a lookup is std::lower_bound;
+ *   - py::eytzinger_layout: the vector holds the implicit binary search
+ *     tree in breadth-first order (element k has children 2k and 2k + 1,
+ *     1-based). The lookup loop is branch-free and its first levels share
+ *     a few cache lines, which pays off for large, read-mostly tables;
+ *     iteration follows the in-order successor instead.
+ *
+ *  Lookups are O(log n); a single insertion or erasure is O(n), so build
+ *  in bulk (constructors, update(), insert(first, last)): the input is
+ *  sorted once and merged with the existing elements in linear time.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "flat_table.hpp" // import detail::countr_zero64
+#include "hash.hpp"       // import detail::has_is_transparent
+
+namespace py {
+
+/**
+ * @brief Elements in key order (binary search, linear iteration)
+ */
+struct sorted_layout {
+  static constexpr bool is_sorted = true;
+
+  static auto begin_index(size_t /* n */) -> size_t { return 0; }
+  static auto end_index(size_t n) -> size_t { return n; }
+  static auto next(size_t k, size_t /* n */) -> size_t { return k + 1; }
+  static auto slot(size_t k) -> size_t { return k; }
+  static auto index(size_t slot) -> size_t { return slot; }
+};
+
+/**
+ * @brief Elements in Eytzinger (breadth-first) order
+ *
+ * Iteration indices are the 1-based tree positions; 0 is the end.
+ */
+struct eytzinger_layout {
+  static constexpr bool is_sorted = false;
+
+  /// The leftmost node
+  static auto begin_index(size_t n) -> size_t {
+    auto k = size_t(n == 0 ? 0 : 1);
+    while (k != 0 && 2 * k <= n) {
+      k *= 2;
+    }
+    return k;
+  }
+  static auto end_index(size_t /* n */) -> size_t { return 0; }
+
+  /// In-order successor: leftmost node of the right subtree, or the first
+  /// ancestor we are in the left subtree of
+  static auto next(size_t k, size_t n) -> size_t {
+    if (2 * k + 1 <= n) {
+      k = 2 * k + 1;
+      while (2 * k <= n) {
+        k *= 2;
+      }
+      return k;
+    }
+    while ((k & 1) != 0) {
+      k >>= 1;
+    }
+    return k >> 1;
+  }
+  static auto slot(size_t k) -> size_t { return k - 1; }
+  static auto index(size_t slot) -> size_t { return slot + 1; }
+};
+
+namespace detail {
+
+/**
+ * @brief Policy of a set-like sorted table: slots are the keys themselves
+ *
+ * @tparam Key
+ */
+template <typename Key> struct SortedSetPolicy {
+  using key_type = Key;
+  using value_type = Key;
+
+  static auto key(const value_type &v) -> const Key & { return v; }
+};
+
+/**
+ * @brief Policy of a map-like sorted table
+ *
+ * The key is not const so that the vector can be sorted and rearranged;
+ * the tables only hand out const references to whole slots.
+ *
+ * @tparam Key
+ * @tparam T
+ */
+template <typename Key, typename T> struct SortedMapPolicy {
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<Key, T>;
+
+  static auto key(const value_type &v) -> const Key & { return v.first; }
+};
+
+template <typename Compare>
+using enable_transparent_compare_t =
+    typename std::enable_if<has_is_transparent<Compare>::value>::type;
+
+/**
+ * @brief Iterator over a sorted table, in key order whatever the layout
+ *
+ * @tparam Value
+ * @tparam Layout
+ */
+template <typename Value, typename Layout> class SortedTableIterator {
+  const Value *_slots{nullptr};
+  size_t _n{0};
+  size_t _k{0};
+
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = Value;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const Value *;
+  using reference = const Value &;
+
+  SortedTableIterator() = default;
+  SortedTableIterator(const Value *slots, size_t n, size_t k)
+      : _slots{slots}, _n{n}, _k{k} {}
+
+  auto operator*() const -> reference {
+    return this->_slots[Layout::slot(this->_k)];
+  }
+  auto operator->() const -> pointer { return &**this; }
+
+  auto operator++() -> SortedTableIterator & {
+    this->_k = Layout::next(this->_k, this->_n);
+    return *this;
+  }
+
+  auto operator++(int) -> SortedTableIterator {
+    auto old = *this;
+    ++*this;
+    return old;
+  }
+
+  auto operator==(const SortedTableIterator &other) const -> bool {
+    return this->_k == other._k;
+  }
+
+  auto operator!=(const SortedTableIterator &other) const -> bool {
+    return this->_k != other._k;
+  }
+};
+
+/**
+ * @brief Vector of unique elements kept in `Layout` order
+ *
+ * @tparam Policy SortedSetPolicy or SortedMapPolicy
+ * @tparam Compare strict weak ordering of the keys
+ * @tparam Layout sorted_layout or eytzinger_layout
+ * @tparam Allocator
+ */
+template <typename Policy, typename Compare, typename Layout,
+          typename Allocator>
+class SortedTable {
+public:
+  using key_type = typename Policy::key_type;
+  using value_type = typename Policy::value_type;
+  using size_type = size_t;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+  using layout_type = Layout;
+  using const_iterator = SortedTableIterator<value_type, Layout>;
+  using iterator = const_iterator;
+
+protected:
+  using slot_alloc = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<value_type>;
+  using Slots = std::vector<value_type, slot_alloc>;
+
+  static constexpr size_t npos = ~size_t(0);
+
+  Slots _slots;
+  Compare _comp{};
+
+public:
+  SortedTable() = default;
+
+  explicit SortedTable(const allocator_type &alloc)
+      : _slots(slot_alloc(alloc)) {}
+
+  auto get_allocator() const -> allocator_type {
+    return allocator_type(this->_slots.get_allocator());
+  }
+
+  auto key_comp() const -> key_compare { return this->_comp; }
+
+  auto begin() const -> const_iterator {
+    const auto n = this->_slots.size();
+    return const_iterator{this->_slots.data(), n, Layout::begin_index(n)};
+  }
+  auto end() const -> const_iterator {
+    const auto n = this->_slots.size();
+    return const_iterator{this->_slots.data(), n, Layout::end_index(n)};
+  }
+  auto cbegin() const -> const_iterator { return this->begin(); }
+  auto cend() const -> const_iterator { return this->end(); }
+
+  auto size() const -> size_t { return this->_slots.size(); }
+  auto empty() const -> bool { return this->_slots.empty(); }
+  void clear() { this->_slots.clear(); }
+  void reserve(size_t n) { this->_slots.reserve(n); }
+
+  auto find(const key_type &key) const -> const_iterator {
+    return this->iterator_at(this->find_index(key));
+  }
+
+  /**
+   * @brief Heterogeneous lookup (transparent Compare only)
+   *
+   * @param[in] key any type the comparison accepts
+   */
+  template <typename K, typename C = Compare,
+            typename = enable_transparent_compare_t<C>>
+  auto find(const K &key) const -> const_iterator {
+    return this->iterator_at(this->find_index(key));
+  }
+
+  auto count(const key_type &key) const -> size_t {
+    return this->find_index(key) == npos ? 0U : 1U;
+  }
+
+  template <typename K, typename C = Compare,
+            typename = enable_transparent_compare_t<C>>
+  auto count(const K &key) const -> size_t {
+    return this->find_index(key) == npos ? 0U : 1U;
+  }
+
+  /**
+   * @brief Remove `key`
+   *
+   * @param[in] key
+   * @return size_t the number of elements removed (0 or 1)
+   */
+  auto erase(const key_type &key) -> size_t {
+    if (this->find_index(key) == npos) {
+      return 0;
+    }
+    this->modify([&](Slots &v) {
+      v.erase(this->lower_bound_sorted(v, key));
+    });
+    return 1;
+  }
+
+protected:
+  auto iterator_at(size_t slot) const -> const_iterator {
+    return slot == npos ? this->end()
+                        : const_iterator{this->_slots.data(),
+                                         this->_slots.size(),
+                                         Layout::index(slot)};
+  }
+
+  template <typename A, typename B>
+  auto equiv(const A &a, const B &b) const -> bool {
+    return !this->_comp(a, b) && !this->_comp(b, a);
+  }
+
+  /// Position of `key` in the slot vector, or npos
+  template <typename K> auto find_index(const K &key) const -> size_t {
+    const auto *p = this->_slots.data();
+    const auto n = this->_slots.size();
+    if (Layout::is_sorted) {
+      const auto it = std::lower_bound(
+          p, p + n, key, [this](const value_type &v, const K &k) {
+            return this->_comp(Policy::key(v), k);
+          });
+      return it != p + n && !this->_comp(key, Policy::key(*it))
+                 ? static_cast<size_t>(it - p)
+                 : npos;
+    }
+    // branch-free descent; the answer is the last node where we went left
+    auto k = size_t(1);
+    while (k <= n) {
+      k = 2 * k + (this->_comp(Policy::key(p[k - 1]), key) ? 1U : 0U);
+    }
+    k >>= countr_zero64(~static_cast<uint64_t>(k)) + 1;
+    return k != 0 && !this->_comp(key, Policy::key(p[k - 1])) ? k - 1 : npos;
+  }
+
+  template <typename K>
+  auto lower_bound_sorted(Slots &v, const K &key) const ->
+      typename Slots::iterator {
+    return std::lower_bound(v.begin(), v.end(), key,
+                            [this](const value_type &x, const K &k) {
+                              return this->_comp(Policy::key(x), k);
+                            });
+  }
+
+  /// Apply `fn` to the elements in key order, then restore the layout
+  template <typename Fn> void modify(Fn &&fn) {
+    if (Layout::is_sorted) {
+      fn(this->_slots);
+      return;
+    }
+    auto sorted = this->take_sorted();
+    fn(sorted);
+    this->assign_sorted(std::move(sorted));
+  }
+
+  /// Move the elements out, in key order
+  auto take_sorted() -> Slots {
+    if (Layout::is_sorted) {
+      auto res = Slots(this->_slots.get_allocator());
+      res.swap(this->_slots);
+      return res;
+    }
+    auto res = Slots(this->_slots.get_allocator());
+    res.reserve(this->_slots.size());
+    const auto n = this->_slots.size();
+    for (auto k = Layout::begin_index(n); k != Layout::end_index(n);
+         k = Layout::next(k, n)) {
+      res.push_back(std::move(this->_slots[Layout::slot(k)]));
+    }
+    this->_slots.clear();
+    return res;
+  }
+
+  /// The elements in key order (a copy for the Eytzinger layout)
+  auto sorted_copy() const -> Slots {
+    return Slots(this->begin(), this->end(), this->_slots.get_allocator());
+  }
+
+  /// Take over `sorted` (unique, in key order) and lay it out
+  void assign_sorted(Slots &&sorted) {
+    if (Layout::is_sorted) {
+      this->_slots = std::move(sorted);
+      return;
+    }
+    const auto n = sorted.size();
+    // rank[tree slot] = index in key order
+    auto rank = std::vector<size_t>(n);
+    auto i = size_t(0);
+    for (auto k = Layout::begin_index(n); k != Layout::end_index(n);
+         k = Layout::next(k, n)) {
+      rank[Layout::slot(k)] = i++;
+    }
+    auto res = Slots(sorted.get_allocator());
+    res.reserve(n);
+    for (const auto r : rank) {
+      res.push_back(std::move(sorted[r]));
+    }
+    this->_slots = std::move(res);
+  }
+
+  /// Sort `v` by key and drop duplicates, keeping the last of each run
+  /// (later values win, as in Python)
+  void sort_unique(Slots &v) const {
+    std::stable_sort(v.begin(), v.end(),
+                     [this](const value_type &a, const value_type &b) {
+                       return this->_comp(Policy::key(a), Policy::key(b));
+                     });
+    auto j = size_t(0);
+    for (size_t i = 0; i != v.size(); ++i) {
+      if (j != 0 && this->equiv(Policy::key(v[j - 1]), Policy::key(v[i]))) {
+        v[j - 1] = std::move(v[i]);
+      } else {
+        if (i != j) {
+          v[j] = std::move(v[i]);
+        }
+        ++j;
+      }
+    }
+    v.erase(v.begin() + static_cast<std::ptrdiff_t>(j), v.end());
+  }
+
+  /// Merge `incoming` (unique, in key order): on equal keys the incoming
+  /// element replaces the existing one
+  void merge_sorted(Slots &&incoming) {
+    if (incoming.empty()) {
+      return;
+    }
+    if (this->empty()) {
+      this->assign_sorted(std::move(incoming));
+      return;
+    }
+    auto old = this->take_sorted();
+    auto res = Slots(old.get_allocator());
+    res.reserve(old.size() + incoming.size());
+    auto a = old.begin();
+    auto b = incoming.begin();
+    while (a != old.end() && b != incoming.end()) {
+      if (this->_comp(Policy::key(*a), Policy::key(*b))) {
+        res.push_back(std::move(*a++));
+      } else if (this->_comp(Policy::key(*b), Policy::key(*a))) {
+        res.push_back(std::move(*b++));
+      } else {
+        res.push_back(std::move(*b++));
+        ++a;
+      }
+    }
+    std::move(a, old.end(), std::back_inserter(res));
+    std::move(b, incoming.end(), std::back_inserter(res));
+    this->assign_sorted(std::move(res));
+  }
+
+  /// Bulk-insert [first, last): sort + unique, then one linear merge
+  template <typename InputIt> void insert_range(InputIt first, InputIt last) {
+    auto v = Slots(this->_slots.get_allocator());
+    for (; first != last; ++first) {
+      v.emplace_back(*first);
+    }
+    this->sort_unique(v);
+    this->merge_sorted(std::move(v));
+  }
+
+  /**
+   * @brief Insert `value_type(args...)` at the position of `key`
+   *
+   * @return true if inserted, false if `key` was already present
+   */
+  template <typename K, typename... Args>
+  auto emplace_key(const K &key, Args &&...args) -> bool {
+    if (this->find_index(key) != npos) {
+      return false;
+    }
+    this->modify([&](Slots &v) {
+      v.emplace(this->lower_bound_sorted(v, key), std::forward<Args>(args)...);
+    });
+    return true;
+  }
+};
+
+} // namespace detail
+
+} // namespace py
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <cstddef> // import size_t
+#include <stdexcept>
+#include <utility>
+
+#include "range.hpp"        // import CONSTEXPR14
+#include "static_table.hpp" // import detail::StaticTable
+
+namespace py {
+
+/**
+ * @brief Constant dict behind a perfect hash built at compile time
+ *
+ *     constexpr auto opcodes = py::make_static_dict<const char *, int>(
+ *         {{"add", 1}, {"sub", 2}, {"mul", 3}});
+ *     static_assert(opcodes["sub"] == 2, "");
+ *
+ * Iterates over keys in the given order; items() yields (first, second)
+ * entries.
+ *
+ * @tparam Key
+ * @tparam T
+ * @tparam N number of entries
+ * @tparam Hash seeded hash, see py::static_hash
+ * @tparam KeyEqual
+ */
+template <typename Key, typename T, size_t N,
+          typename Hash = static_hash<Key>,
+          typename KeyEqual = static_equal_to<Key>>
+class static_dict
+    : public detail::StaticTable<detail::StaticMapPolicy<Key, T>, N, Hash,
+                                 KeyEqual> {
+  using Base = detail::StaticTable<detail::StaticMapPolicy<Key, T>, N, Hash,
+                                   KeyEqual>;
+  using Entry = detail::StaticEntry<Key, T>;
+
+public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = Entry;
+
+  /**
+   * @brief Construct a new static_dict object; throws
+   * std::invalid_argument (a compile error when constexpr) on duplicates
+   *
+   * @param[in] items
+   */
+  constexpr explicit static_dict(const std::pair<Key, T> (&items)[N])
+      : Base(items) {}
+
+  /**
+   * @brief
+   *
+   * @param[in] key
+   * @return true
+   * @return false
+   */
+  CONSTEXPR14 auto contains(const Key &key) const -> bool {
+    return this->find_index(key) != Base::npos;
+  }
+
+  /**
+   * @brief
+   *
+   * @param[in] key
+   * @return const T* the value, or nullptr if `key` is absent
+   */
+  CONSTEXPR14 auto get(const Key &key) const -> const T * {
+    const auto i = this->find_index(key);
+    if (i == Base::npos) {
+      return nullptr;
+    }
+    return &this->_entries[i].second;
+  }
+
+  /**
+   * @brief
+   *
+   * @param[in] key
+   * @param[in] default_value
+   * @return const T&
+   */
+  CONSTEXPR14 auto get(const Key &key, const T &default_value) const
+      -> const T & {
+    const auto *v = this->get(key);
+    return v != nullptr ? *v : default_value;
+  }
+
+  /**
+   * @brief
+   *
+   * @return detail::StaticKeyIterator<Entry>
+   */
+  constexpr auto begin() const -> detail::StaticKeyIterator<Entry> {
+    return detail::StaticKeyIterator<Entry>{Base::begin()};
+  }
+
+  /**
+   * @brief
+   *
+   * @return detail::StaticKeyIterator<Entry>
+   */
+  constexpr auto end() const -> detail::StaticKeyIterator<Entry> {
+    return detail::StaticKeyIterator<Entry>{Base::end()};
+  }
+
+  /**
+   * @brief
+   *
+   * @return const Base& iterable of (first, second) entries
+   */
+  constexpr auto items() const -> const Base & { return *this; }
+
+  /**
+   * @brief
+   *
+   * @param[in] k
+   * @return const T&
+   */
+  CONSTEXPR14 auto at(const Key &k) const -> const T & {
+    const auto *v = this->get(k);
+    if (v == nullptr) {
+      throw std::out_of_range("static_dict::at");
+    }
+    return *v;
+  }
+
+  /**
+   * @brief
+   *
+   * @param[in] k
+   * @return const T&
+   */
+  CONSTEXPR14 auto operator[](const Key &k) const -> const T & {
+    return this->at(k);
+  }
+};
+
+/**
+ * @brief Build a static_dict from a braced list of pairs, deducing its size
+ *
+ * @tparam Key
+ * @tparam T
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @tparam N
+ * @param[in] items
+ * @return static_dict<Key, T, N, Hash, KeyEqual>
+ */
+template <typename Key, typename T, typename Hash = static_hash<Key>,
+          typename KeyEqual = static_equal_to<Key>, size_t N>
+constexpr auto make_static_dict(const std::pair<Key, T> (&items)[N])
+    -> static_dict<Key, T, N, Hash, KeyEqual> {
+  return static_dict<Key, T, N, Hash, KeyEqual>(items);
+}
+
+/**
+ * @brief
+ *
+ * @tparam Key
+ * @tparam T
+ * @tparam N
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @param[in] key
+ * @param[in] m
+ * @return true
+ * @return false
+ */
+template <typename Key, typename T, size_t N, typename Hash,
+          typename KeyEqual>
+CONSTEXPR14 auto operator<(const Key &key,
+                           const static_dict<Key, T, N, Hash, KeyEqual> &m)
+    -> bool {
+  return m.contains(key);
+}
+
+/**
+ * @brief
+ *
+ * @tparam Key
+ * @tparam T
+ * @tparam N
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @param[in] m
+ * @return size_t
+ */
+template <typename Key, typename T, size_t N, typename Hash,
+          typename KeyEqual>
+constexpr auto len(const static_dict<Key, T, N, Hash, KeyEqual> &m)
+    -> size_t {
+  return m.size();
+}
+
+} // namespace py
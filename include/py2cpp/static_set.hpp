@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef> // import size_t
+
+#include "range.hpp"        // import CONSTEXPR14
+#include "static_table.hpp" // import detail::StaticTable
+
+namespace py {
+
+/**
+ * @brief Constant set behind a perfect hash built at compile time
+ *
+ * For the literal keyword and opcode tables of ported code: declared
+ * `constexpr`, the table costs nothing at startup and sits in read-only
+ * data, and a lookup is two hashes and one key comparison.
+ *
+ *     constexpr auto keywords =
+ *         py::make_static_set<const char *>({"if", "elif", "else"});
+ *     static_assert(keywords.contains("elif"), "");
+ *
+ * @tparam Key
+ * @tparam N number of keys
+ * @tparam Hash seeded hash, see py::static_hash
+ * @tparam KeyEqual
+ */
+template <typename Key, size_t N, typename Hash = static_hash<Key>,
+          typename KeyEqual = static_equal_to<Key>>
+class static_set
+    : public detail::StaticTable<detail::StaticSetPolicy<Key>, N, Hash,
+                                 KeyEqual> {
+  using Base =
+      detail::StaticTable<detail::StaticSetPolicy<Key>, N, Hash, KeyEqual>;
+
+public:
+  using key_type = Key;
+  using value_type = Key;
+
+  /**
+   * @brief Construct a new static_set object; throws
+   * std::invalid_argument (a compile error when constexpr) on duplicates
+   *
+   * @param[in] keys
+   */
+  constexpr explicit static_set(const Key (&keys)[N]) : Base(keys) {}
+
+  /**
+   * @brief
+   *
+   * @param[in] key
+   * @return true
+   * @return false
+   */
+  CONSTEXPR14 auto contains(const Key &key) const -> bool {
+    return this->find_index(key) != Base::npos;
+  }
+};
+
+/**
+ * @brief Build a static_set from a braced list, deducing its size
+ *
+ * @tparam Key
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @tparam N
+ * @param[in] keys
+ * @return static_set<Key, N, Hash, KeyEqual>
+ */
+template <typename Key, typename Hash = static_hash<Key>,
+          typename KeyEqual = static_equal_to<Key>, size_t N>
+constexpr auto make_static_set(const Key (&keys)[N])
+    -> static_set<Key, N, Hash, KeyEqual> {
+  return static_set<Key, N, Hash, KeyEqual>(keys);
+}
+
+/**
+ * @brief
+ *
+ * @tparam Key
+ * @tparam N
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @param[in] key
+ * @param[in] m
+ * @return true
+ * @return false
+ */
+template <typename Key, size_t N, typename Hash, typename KeyEqual>
+CONSTEXPR14 auto operator<(const Key &key,
+                           const static_set<Key, N, Hash, KeyEqual> &m)
+    -> bool {
+  return m.contains(key);
+}
+
+/**
+ * @brief
+ *
+ * @tparam Key
+ * @tparam N
+ * @tparam Hash
+ * @tparam KeyEqual
+ * @param[in] m
+ * @return size_t
+ */
+template <typename Key, size_t N, typename Hash, typename KeyEqual>
+constexpr auto len(const static_set<Key, N, Hash, KeyEqual> &m) -> size_t {
+  return m.size();
+}
+
+} // namespace py
@@ -0,0 +1,396 @@
+#pragma once
+
+/** @file include/py2cpp/static_table.hpp
+ *  Compile-time perfect hash table shared by static_set and static_dict.
+ *
+ *  The N entries are kept in their original order; a perfect hash maps
+ *  every key to its entry index ("hash and displace"):
+ *
+ *   1. the keys are split into M buckets (M = N rounded up to a power of
+ *      two) by hashing them with a fixed seed;
+ *   2. buckets are placed largest first: for a bucket of several keys we
+ *      try displacement seeds d = 1, 2, ... until hashing the bucket's keys
+ *      with d hits M free, distinct slots; a singleton bucket simply takes
+ *      the next free slot and stores it directly (as -(slot + 1));
+ *   3. a lookup hashes the key twice (bucket, then slot), follows the slot
+ *      to its entry and compares one key.
+ *
+ *  All of it is CONSTEXPR14, so a table declared `constexpr` is built by
+ *  the compiler and lives in read-only data; duplicate keys are rejected
+ *  (a compile error in a constant expression).
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "hash.hpp"  // import PY2CPP_HAS_STRING_VIEW
+#include "range.hpp" // import CONSTEXPR14
+
+namespace py {
+
+namespace detail {
+
+/// splitmix64 finalizer
+CONSTEXPR14 auto static_mix(uint64_t x) -> uint64_t {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+CONSTEXPR14 auto static_hash_chars(const char *s, size_t n, uint64_t seed)
+    -> uint64_t {
+  uint64_t h = 0xcbf29ce484222325ULL ^ seed; // FNV-1a
+  for (size_t i = 0; i != n; ++i) {
+    h ^= static_cast<unsigned char>(s[i]);
+    h *= 0x100000001b3ULL;
+  }
+  return static_mix(h);
+}
+
+CONSTEXPR14 auto static_strlen(const char *s) -> size_t {
+  size_t n = 0;
+  while (s[n] != '\0') {
+    ++n;
+  }
+  return n;
+}
+
+} // namespace detail
+
+/**
+ * @brief Seeded constexpr hash for static tables
+ *
+ * Defined for integers, enums, `const char *` (the characters, not the
+ * pointer) and std::string_view; specialize it for other key types.
+ *
+ * @tparam Key
+ */
+template <typename Key, typename = void> struct static_hash;
+
+template <typename Key>
+struct static_hash<
+    Key, typename std::enable_if<std::is_integral<Key>::value ||
+                                 std::is_enum<Key>::value>::type> {
+  CONSTEXPR14 auto operator()(const Key &key, uint64_t seed) const
+      -> uint64_t {
+    return detail::static_mix(static_cast<uint64_t>(key) +
+                              seed * 0x9e3779b97f4a7c15ULL);
+  }
+};
+
+template <> struct static_hash<const char *> {
+  CONSTEXPR14 auto operator()(const char *key, uint64_t seed) const
+      -> uint64_t {
+    return detail::static_hash_chars(key, detail::static_strlen(key), seed);
+  }
+};
+
+#if defined(PY2CPP_HAS_STRING_VIEW)
+template <> struct static_hash<std::string_view> {
+  constexpr auto operator()(std::string_view key, uint64_t seed) const
+      -> uint64_t {
+    return detail::static_hash_chars(key.data(), key.size(), seed);
+  }
+};
+#endif
+
+/**
+ * @brief constexpr key equality; `const char *` keys compare characters
+ *
+ * @tparam Key
+ */
+template <typename Key> struct static_equal_to {
+  constexpr auto operator()(const Key &a, const Key &b) const -> bool {
+    return a == b;
+  }
+};
+
+template <> struct static_equal_to<const char *> {
+  CONSTEXPR14 auto operator()(const char *a, const char *b) const -> bool {
+    while (*a != '\0' && *a == *b) {
+      ++a;
+      ++b;
+    }
+    return *a == *b;
+  }
+};
+
+namespace detail {
+
+/**
+ * @brief (key, value) entry of a static_dict
+ *
+ * @tparam Key
+ * @tparam T
+ */
+template <typename Key, typename T> struct StaticEntry {
+  Key first;
+  T second;
+};
+
+/**
+ * @brief Policy of a static set: entries are the keys themselves
+ *
+ * @tparam Key
+ */
+template <typename Key> struct StaticSetPolicy {
+  using key_type = Key;
+  using value_type = Key;
+  using source_type = Key;
+
+  static constexpr auto key(const value_type &v) -> const Key & { return v; }
+  static constexpr auto make(const source_type &k) -> value_type { return k; }
+};
+
+/**
+ * @brief Policy of a static dict
+ *
+ * @tparam Key
+ * @tparam T
+ */
+template <typename Key, typename T> struct StaticMapPolicy {
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = StaticEntry<Key, T>;
+  using source_type = std::pair<Key, T>;
+
+  static constexpr auto key(const value_type &v) -> const Key & {
+    return v.first;
+  }
+  static constexpr auto make(const source_type &kv) -> value_type {
+    return value_type{kv.first, kv.second};
+  }
+};
+
+constexpr auto static_buckets(size_t n) -> size_t {
+  return n <= 1 ? 1 : 2 * static_buckets((n + 1) / 2);
+}
+
+/**
+ * @brief Displacements and slots of a perfect hash over N keys
+ *
+ * @tparam N
+ */
+template <size_t N> struct StaticLayout {
+  static constexpr size_t M = static_buckets(N);
+  static constexpr uint64_t seed = 0x243f6a8885a308d3ULL;
+
+  int64_t disp[M]{}; // seed of a bucket, or -(slot + 1) for a singleton
+  size_t slot[M]{};  // entry index of a slot
+};
+
+/**
+ * @brief Build the perfect hash of `entries`
+ *
+ * Throws std::invalid_argument on duplicate keys.
+ */
+template <typename Policy, typename Hash, typename KeyEqual, size_t N>
+CONSTEXPR14 auto build_static_layout(
+    const typename Policy::value_type (&entries)[N], const Hash &hash,
+    const KeyEqual &eq) -> StaticLayout<N> {
+  constexpr size_t M = StaticLayout<N>::M;
+  auto layout = StaticLayout<N>{};
+
+  // counting sort of the entry indices by bucket
+  size_t bucket_of[N]{};
+  size_t start[M + 1]{};
+  for (size_t i = 0; i != N; ++i) {
+    bucket_of[i] = static_cast<size_t>(hash(Policy::key(entries[i]),
+                                            StaticLayout<N>::seed)) &
+                   (M - 1);
+    ++start[bucket_of[i] + 1];
+  }
+  size_t largest = 0;
+  for (size_t b = 0; b != M; ++b) {
+    largest = start[b + 1] > largest ? start[b + 1] : largest;
+    start[b + 1] += start[b];
+  }
+  size_t order[N]{};
+  size_t fill[M]{};
+  for (size_t i = 0; i != N; ++i) {
+    const auto b = bucket_of[i];
+    order[start[b] + fill[b]++] = i;
+  }
+
+  bool taken[M]{};
+  size_t pos[N]{};
+  for (auto size = largest; size >= 2; --size) {
+    for (size_t b = 0; b != M; ++b) {
+      if (start[b + 1] - start[b] != size) {
+        continue;
+      }
+      const auto *members = order + start[b];
+      for (size_t j = 0; j != size; ++j) {
+        for (size_t k = 0; k != j; ++k) {
+          if (eq(Policy::key(entries[members[j]]),
+                 Policy::key(entries[members[k]]))) {
+            throw std::invalid_argument("static table: duplicate key");
+          }
+        }
+      }
+      for (uint64_t d = 1;; ++d) {
+        auto ok = true;
+        for (size_t j = 0; ok && j != size; ++j) {
+          pos[j] = static_cast<size_t>(
+                       hash(Policy::key(entries[members[j]]), d)) &
+                   (M - 1);
+          ok = !taken[pos[j]];
+          for (size_t k = 0; ok && k != j; ++k) {
+            ok = pos[k] != pos[j];
+          }
+        }
+        if (ok) {
+          for (size_t j = 0; j != size; ++j) {
+            taken[pos[j]] = true;
+            layout.slot[pos[j]] = members[j];
+          }
+          layout.disp[b] = static_cast<int64_t>(d);
+          break;
+        }
+      }
+    }
+  }
+
+  size_t free_slot = 0;
+  for (size_t b = 0; b != M; ++b) {
+    if (start[b + 1] - start[b] != 1) {
+      continue;
+    }
+    while (taken[free_slot]) {
+      ++free_slot;
+    }
+    taken[free_slot] = true;
+    layout.slot[free_slot] = order[start[b]];
+    layout.disp[b] = -static_cast<int64_t>(free_slot) - 1;
+  }
+  return layout;
+}
+
+/**
+ * @brief Iterator over the keys of a static_dict
+ *
+ * @tparam Entry
+ */
+template <typename Entry> class StaticKeyIterator {
+  const Entry *_p{nullptr};
+
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = decltype(Entry::first);
+  using difference_type = std::ptrdiff_t;
+  using pointer = const value_type *;
+  using reference = const value_type &;
+
+  constexpr StaticKeyIterator() = default;
+  constexpr explicit StaticKeyIterator(const Entry *p) : _p{p} {}
+
+  constexpr auto operator*() const -> reference { return this->_p->first; }
+  constexpr auto operator->() const -> pointer { return &this->_p->first; }
+
+  CONSTEXPR14 auto operator++() -> StaticKeyIterator & {
+    ++this->_p;
+    return *this;
+  }
+
+  CONSTEXPR14 auto operator++(int) -> StaticKeyIterator {
+    auto old = *this;
+    ++this->_p;
+    return old;
+  }
+
+  constexpr auto operator==(const StaticKeyIterator &other) const -> bool {
+    return this->_p == other._p;
+  }
+
+  constexpr auto operator!=(const StaticKeyIterator &other) const -> bool {
+    return this->_p != other._p;
+  }
+};
+
+/**
+ * @brief N entries behind a compile-time perfect hash
+ *
+ * Iterates the entries in their original order.
+ *
+ * @tparam Policy StaticSetPolicy or StaticMapPolicy
+ * @tparam N
+ * @tparam Hash
+ * @tparam KeyEqual
+ */
+template <typename Policy, size_t N, typename Hash, typename KeyEqual>
+class StaticTable {
+  static_assert(N > 0, "static tables need at least one entry");
+
+public:
+  using key_type = typename Policy::key_type;
+  using value_type = typename Policy::value_type;
+  using size_type = size_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using const_iterator = const value_type *;
+  using iterator = const_iterator;
+
+protected:
+  static constexpr size_t npos = ~size_t(0);
+
+  value_type _entries[N];
+  StaticLayout<N> _layout;
+  Hash _hash{};
+  KeyEqual _eq{};
+
+public:
+  constexpr auto size() const -> size_t { return N; }
+  constexpr auto empty() const -> bool { return false; }
+
+  constexpr auto begin() const -> const_iterator { return this->_entries; }
+  constexpr auto end() const -> const_iterator { return this->_entries + N; }
+
+  CONSTEXPR14 auto find(const key_type &key) const -> const_iterator {
+    const auto i = this->find_index(key);
+    return i == npos ? this->end() : this->_entries + i;
+  }
+
+  CONSTEXPR14 auto count(const key_type &key) const -> size_t {
+    return this->find_index(key) == npos ? 0 : 1;
+  }
+
+protected:
+  template <size_t... I>
+  constexpr StaticTable(const typename Policy::source_type (&src)[N],
+                        std::index_sequence<I...> /* unused */)
+      : _entries{Policy::make(src[I])...},
+        _layout{build_static_layout<Policy>(this->_entries, Hash{},
+                                            KeyEqual{})} {}
+
+  constexpr explicit StaticTable(
+      const typename Policy::source_type (&src)[N])
+      : StaticTable(src, std::make_index_sequence<N>{}) {}
+
+  CONSTEXPR14 auto find_index(const key_type &key) const -> size_t {
+    constexpr size_t M = StaticLayout<N>::M;
+    const auto b =
+        static_cast<size_t>(this->_hash(key, StaticLayout<N>::seed)) & (M - 1);
+    const auto d = this->_layout.disp[b];
+    auto s = static_cast<size_t>(-(d + 1));
+    if (d >= 0) {
+      s = static_cast<size_t>(this->_hash(key, static_cast<uint64_t>(d))) &
+          (M - 1);
+    }
+    const auto i = this->_layout.slot[s];
+    if (this->_eq(Policy::key(this->_entries[i]), key)) {
+      return i;
+    }
+    return npos;
+  }
+};
+
+} // namespace detail
+
+} // namespace py
@@ -0,0 +1,329 @@
+#pragma once
+
+/** @file include/py2cpp/stats.hpp
+ *  Opt-in instrumentation counters.
+ *
+ *  Define PY2CPP_STATS (before including any py2cpp header, and the same
+ *  way in every translation unit) to make the hash tables and Fraction
+ *  count what they do:
+ *
+ *      py::flat_dict<int, int> d = ...;
+ *      std::cout << d.stats() << '\n';
+ *      // lookups=1000 probes=1012 max_probe=2 rehashes=7 allocations=16
+ *      d.stats().for_each([](const char *name, uint64_t n) {
+ *        metrics.gauge(std::string("dict.") + name, n);
+ *      });
+ *
+ *      std::cout << fun::Fraction<int>::stats() << '\n';
+ *      // gcd_calls=2048 normalize_calls=1024
+ *
+ *  Table counters belong to one container instance; a copy or a moved-to
+ *  container starts from zero. Fraction counters are per instantiation
+ *  (one set for each Fraction<Z, Policy>). Counters are relaxed atomics,
+ *  so concurrent const lookups stay race-free.
+ *
+ *  Without PY2CPP_STATS nothing is counted, the containers keep their
+ *  size and the stats() accessors do not exist.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+
+namespace py {
+
+/**
+ * @brief Whether the library was built with PY2CPP_STATS
+ */
+#if defined(PY2CPP_STATS)
+constexpr bool stats_enabled = true;
+#else
+constexpr bool stats_enabled = false;
+#endif
+
+/**
+ * @brief Snapshot of the counters of one hash table
+ */
+struct table_stats {
+  uint64_t lookups{0};     ///< find, contains, get, [] ... and inserts
+  uint64_t probes{0};      ///< probe length summed over all lookups
+  uint64_t max_probe{0};   ///< longest single probe
+  uint64_t rehashes{0};    ///< times the slot or bucket array was rebuilt
+  uint64_t allocations{0}; ///< allocator calls: arrays and nodes
+
+  /**
+   * @brief Average probe length per lookup (1.0 is ideal)
+   *
+   * @return double
+   */
+  auto mean_probe() const -> double {
+    return this->lookups == 0 ? 0.0
+                              : static_cast<double>(this->probes) /
+                                    static_cast<double>(this->lookups);
+  }
+
+  /**
+   * @brief Call `f(name, value)` for every counter, e.g. to export them
+   *
+   * @param[in] f
+   */
+  template <typename F> void for_each(F &&f) const {
+    f("lookups", this->lookups);
+    f("probes", this->probes);
+    f("max_probe", this->max_probe);
+    f("rehashes", this->rehashes);
+    f("allocations", this->allocations);
+  }
+};
+
+/**
+ * @brief Snapshot of the counters of one Fraction instantiation
+ */
+struct fraction_stats {
+  uint64_t gcd_calls{0};       ///< gcds run by the arithmetic
+  uint64_t normalize_calls{0}; ///< reductions to lowest terms
+
+  /**
+   * @brief Call `f(name, value)` for every counter, e.g. to export them
+   *
+   * @param[in] f
+   */
+  template <typename F> void for_each(F &&f) const {
+    f("gcd_calls", this->gcd_calls);
+    f("normalize_calls", this->normalize_calls);
+  }
+};
+
+/**
+ * @brief Print the counters as `name=value` pairs
+ *
+ * @tparam Stats table_stats or fraction_stats
+ * @param[in] os
+ * @param[in] s
+ * @return std::ostream&
+ */
+template <typename Stats,
+          typename = typename std::enable_if<
+              std::is_same<Stats, table_stats>::value ||
+              std::is_same<Stats, fraction_stats>::value>::type>
+inline auto operator<<(std::ostream &os, const Stats &s) -> std::ostream & {
+  auto first = true;
+  s.for_each([&](const char *name, uint64_t n) {
+    os << (first ? "" : " ") << name << '=' << n;
+    first = false;
+  });
+  return os;
+}
+
+namespace detail {
+
+/**
+ * @brief Relaxed atomic counter; a copy starts from zero
+ */
+class StatCounter {
+  std::atomic<uint64_t> _n{0};
+
+public:
+  StatCounter() = default;
+  StatCounter(const StatCounter & /* other */) noexcept {}
+  auto operator=(const StatCounter & /* other */) noexcept -> StatCounter & {
+    return *this;
+  }
+
+  void add(uint64_t k = 1) { this->_n.fetch_add(k, std::memory_order_relaxed); }
+
+  void store(uint64_t k) { this->_n.store(k, std::memory_order_relaxed); }
+
+  void max(uint64_t k) {
+    auto cur = this->_n.load(std::memory_order_relaxed);
+    while (k > cur &&
+           !this->_n.compare_exchange_weak(cur, k, std::memory_order_relaxed)) {
+    }
+  }
+
+  auto load() const -> uint64_t {
+    return this->_n.load(std::memory_order_relaxed);
+  }
+};
+
+template <typename K, typename V>
+auto node_key(const std::pair<const K, V> &kv) -> const K & {
+  return kv.first;
+}
+
+template <typename K> auto node_key(const K &key) -> const K & { return key; }
+
+/**
+ * @brief Counters of one table, or nothing without PY2CPP_STATS
+ *
+ * Tables inherit it privately so that the empty base costs no space and
+ * the record_*() calls compile away when stats are off.
+ */
+class TableStatsRecorder {
+#if defined(PY2CPP_STATS)
+  mutable StatCounter _lookups;
+  mutable StatCounter _probes;
+  mutable StatCounter _max_probe;
+  mutable StatCounter _rehashes;
+  mutable StatCounter _allocations;
+  mutable StatCounter _seen_size;
+  mutable StatCounter _seen_buckets;
+#endif
+
+protected:
+  void record_lookup(size_t probes) const {
+#if defined(PY2CPP_STATS)
+    this->_lookups.add();
+    this->_probes.add(probes);
+    this->_max_probe.max(probes);
+#else
+    (void)probes;
+#endif
+  }
+
+  void record_rehash() const {
+#if defined(PY2CPP_STATS)
+    this->_rehashes.add();
+#endif
+  }
+
+  void record_allocation(size_t n = 1) const {
+#if defined(PY2CPP_STATS)
+    this->_allocations.add(n);
+#else
+    (void)n;
+#endif
+  }
+
+  /**
+   * @brief Infer node allocations and rehashes of a node-based table
+   *
+   * std::unordered_* does not report them, so compare its size and bucket
+   * count with the values seen at the previous call.
+   */
+  void record_node_table(size_t size, size_t buckets) const {
+#if defined(PY2CPP_STATS)
+    const auto seen = this->_seen_size.load();
+    if (size > seen) {
+      this->_allocations.add(size - seen);
+    }
+    this->_seen_size.store(size);
+    const auto seen_buckets = this->_seen_buckets.load();
+    if (buckets != seen_buckets) {
+      this->_seen_buckets.store(buckets);
+      if (seen_buckets != 0) {
+        this->_rehashes.add();
+      }
+      if (buckets > 1) { // libstdc++ keeps a lone bucket inline
+        this->_allocations.add();
+      }
+    }
+#else
+    (void)size;
+    (void)buckets;
+#endif
+  }
+
+  /**
+   * @brief Count a lookup of `key` in a node-based table
+   *
+   * The probe length is the number of chain nodes compared (at least 1).
+   */
+  template <typename Table, typename Key>
+  void record_node_lookup(const Table &table, const Key &key) const {
+#if defined(PY2CPP_STATS)
+    this->record_node_table(table.size(), table.bucket_count());
+    size_t probes = 1;
+    if (table.bucket_count() != 0) {
+      const auto b = table.bucket(key);
+      const auto eq = table.key_eq();
+      size_t n = 0;
+      for (auto it = table.begin(b); it != table.end(b); ++it) {
+        ++n;
+        if (eq(node_key(*it), key)) {
+          break;
+        }
+      }
+      probes = n > probes ? n : probes;
+    }
+    this->record_lookup(probes);
+#else
+    (void)table;
+    (void)key;
+#endif
+  }
+
+#if defined(PY2CPP_STATS)
+  auto stats_snapshot() const -> table_stats {
+    auto s = table_stats{};
+    s.lookups = this->_lookups.load();
+    s.probes = this->_probes.load();
+    s.max_probe = this->_max_probe.load();
+    s.rehashes = this->_rehashes.load();
+    s.allocations = this->_allocations.load();
+    return s;
+  }
+
+  void stats_reset() const {
+    this->_lookups.store(0);
+    this->_probes.store(0);
+    this->_max_probe.store(0);
+    this->_rehashes.store(0);
+    this->_allocations.store(0);
+  }
+#endif
+};
+
+#if defined(PY2CPP_STATS)
+/**
+ * @brief Counters shared by all the objects of one Fraction instantiation
+ */
+struct FractionStatsRecorder {
+  StatCounter gcd_calls;
+  StatCounter normalize_calls;
+
+  auto snapshot() const -> fraction_stats {
+    auto s = fraction_stats{};
+    s.gcd_calls = this->gcd_calls.load();
+    s.normalize_calls = this->normalize_calls.load();
+    return s;
+  }
+
+  void reset() {
+    this->gcd_calls.store(0);
+    this->normalize_calls.store(0);
+  }
+};
+
+/**
+ * @brief The recorder of instantiation `Tag`
+ *
+ * @tparam Tag
+ */
+template <typename Tag> auto fraction_recorder() -> FractionStatsRecorder & {
+  static FractionStatsRecorder recorder;
+  return recorder;
+}
+
+/**
+ * @brief True while evaluating a constant expression
+ *
+ * Used to skip the counters, which are not constexpr. Compilers without
+ * the builtin cannot count inside constexpr Fraction code.
+ */
+constexpr auto stats_constant_evaluated() -> bool {
+#if defined(__GNUC__) || defined(__clang__) ||                                \
+    (defined(_MSC_VER) && _MSC_VER >= 1925)
+  return __builtin_is_constant_evaluated();
+#else
+  return false;
+#endif
+}
+#endif
+
+} // namespace detail
+
+} // namespace py
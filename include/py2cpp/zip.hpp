@@ -0,0 +1,221 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "bulk.hpp" // import detail::view_t, detail::capped_category_t
+
+namespace py {
+
+namespace detail {
+
+template <typename... Iters> struct ZipIterator {
+  using iterator_category =
+      typename std::common_type<capped_category_t<Iters>...>::type;
+#if defined(__cpp_lib_ranges)
+  using iterator_concept = iterator_category;
+#endif
+  using value_type = std::tuple<decltype(*std::declval<Iters &>())...>;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = value_type;
+
+  std::tuple<Iters...> iters{};
+
+  ZipIterator() = default;
+  explicit ZipIterator(std::tuple<Iters...> iters) : iters{std::move(iters)} {}
+
+  auto operator*() const -> reference {
+    return this->deref(std::index_sequence_for<Iters...>{});
+  }
+
+  auto operator++() -> ZipIterator & {
+    this->each(std::index_sequence_for<Iters...>{}, [](auto &it) { ++it; });
+    return *this;
+  }
+  auto operator++(int) -> ZipIterator {
+    auto temp = *this;
+    ++*this;
+    return temp;
+  }
+  auto operator--() -> ZipIterator & {
+    this->each(std::index_sequence_for<Iters...>{}, [](auto &it) { --it; });
+    return *this;
+  }
+  auto operator--(int) -> ZipIterator {
+    auto temp = *this;
+    --*this;
+    return temp;
+  }
+
+  // random access, when every Iter has it
+  auto operator+=(difference_type n) -> ZipIterator & {
+    this->each(std::index_sequence_for<Iters...>{},
+               [n](auto &it) {
+                 using It = typename std::decay<decltype(it)>::type;
+                 it += static_cast<iterator_difference_t<It>>(n);
+               });
+    return *this;
+  }
+  auto operator-=(difference_type n) -> ZipIterator & { return *this += -n; }
+  auto operator[](difference_type n) const -> reference {
+    return *(*this + n);
+  }
+  friend auto operator+(ZipIterator it, difference_type n) -> ZipIterator {
+    return it += n;
+  }
+  friend auto operator+(difference_type n, ZipIterator it) -> ZipIterator {
+    return it += n;
+  }
+  friend auto operator-(ZipIterator it, difference_type n) -> ZipIterator {
+    return it -= n;
+  }
+  /// The shortest distance, so that end() - begin() is the zipped length
+  friend auto operator-(const ZipIterator &a, const ZipIterator &b)
+      -> difference_type {
+    return a.distance_from(b, std::index_sequence_for<Iters...>{});
+  }
+
+  /// Equal as soon as any component is: iteration stops at the shortest
+  friend auto operator==(const ZipIterator &a, const ZipIterator &b) -> bool {
+    return a.any_equal(b, std::index_sequence_for<Iters...>{});
+  }
+  friend auto operator!=(const ZipIterator &a, const ZipIterator &b) -> bool {
+    return !(a == b);
+  }
+  friend auto operator<(const ZipIterator &a, const ZipIterator &b) -> bool {
+    return b - a > 0;
+  }
+  friend auto operator>(const ZipIterator &a, const ZipIterator &b) -> bool {
+    return b < a;
+  }
+  friend auto operator<=(const ZipIterator &a, const ZipIterator &b) -> bool {
+    return !(b < a);
+  }
+  friend auto operator>=(const ZipIterator &a, const ZipIterator &b) -> bool {
+    return !(a < b);
+  }
+
+private:
+  template <size_t... I>
+  auto deref(std::index_sequence<I...>) const -> reference {
+    return reference{*std::get<I>(this->iters)...};
+  }
+
+  template <size_t... I, typename Fn>
+  void each(std::index_sequence<I...>, Fn fn) {
+    using swallow = int[];
+    (void)swallow{0, (fn(std::get<I>(this->iters)), 0)...};
+  }
+
+  template <size_t... I>
+  auto any_equal(const ZipIterator &other, std::index_sequence<I...>) const
+      -> bool {
+    const bool eq[] = {false,
+                       std::get<I>(this->iters) == std::get<I>(other.iters)...};
+    return std::any_of(std::begin(eq), std::end(eq), [](bool b) { return b; });
+  }
+
+  template <size_t... I>
+  auto distance_from(const ZipIterator &other, std::index_sequence<I...>) const
+      -> difference_type {
+    return std::min({static_cast<difference_type>(
+        std::get<I>(this->iters) - std::get<I>(other.iters))...});
+  }
+};
+
+template <bool...> struct BoolPack;
+
+template <typename Tuple> struct all_sized;
+
+template <typename... Ts>
+struct all_sized<std::tuple<Ts...>>
+    : std::is_same<BoolPack<true, has_size<Ts>::value...>,
+                   BoolPack<has_size<Ts>::value..., true>> {};
+
+/**
+ * @brief
+ *
+ * @tparam Ts `X &` for an lvalue iterable, `X` for a moved-in rvalue
+ */
+template <typename... Ts> struct ZipIterableWrapper {
+  using iterator = ZipIterator<view_iterator_t<Ts>...>;
+  using const_iterator = iterator;
+
+  std::tuple<Ts...> iterables;
+
+  auto begin() const -> iterator {
+    return this->begin_(std::index_sequence_for<Ts...>{});
+  }
+  auto end() const -> iterator {
+    return this->end_(std::index_sequence_for<Ts...>{},
+                      std::is_same<typename iterator::iterator_category,
+                                   std::random_access_iterator_tag>{});
+  }
+
+  /// The shortest length; available when every iterable knows its size
+  template <typename U = std::tuple<Ts...>>
+  auto size() const ->
+      typename std::enable_if<all_sized<U>::value, size_t>::type {
+    return this->size_(std::index_sequence_for<Ts...>{});
+  }
+
+  /// Available when every underlying iterator is random access
+  auto operator[](size_t n) const -> typename iterator::reference {
+    return this->begin()[static_cast<std::ptrdiff_t>(n)];
+  }
+
+private:
+  template <size_t... I>
+  auto size_(std::index_sequence<I...>) const -> size_t {
+    return std::min(
+        {static_cast<size_t>(std::get<I>(this->iterables).size())...});
+  }
+
+  template <size_t... I>
+  auto begin_(std::index_sequence<I...>) const -> iterator {
+    return iterator{std::tuple<view_iterator_t<Ts>...>{
+        std::begin(static_cast<view_t<Ts>>(std::get<I>(this->iterables)))...}};
+  }
+
+  // random access: begin() + the shortest length, so end() - 1 is valid
+  template <size_t... I>
+  auto end_(std::index_sequence<I...> seq, std::true_type) const -> iterator {
+    const auto first = this->begin_(seq);
+    const auto last = iterator{std::tuple<view_iterator_t<Ts>...>{
+        std::end(static_cast<view_t<Ts>>(std::get<I>(this->iterables)))...}};
+    return first + (last - first);
+  }
+
+  template <size_t... I>
+  auto end_(std::index_sequence<I...>, std::false_type) const -> iterator {
+    return iterator{std::tuple<view_iterator_t<Ts>...>{
+        std::end(static_cast<view_t<Ts>>(std::get<I>(this->iterables)))...}};
+  }
+};
+
+} // namespace detail
+
+/**
+ * @brief Python zip(*iterables): stops at the shortest
+ *
+ *     for (auto &&t : py::zip(xs, ys)) { std::get<0>(t) += std::get<1>(t); }
+ *
+ * Yields a std::tuple of references, so C++17 structured bindings work.
+ * Random access (with size() and operator[]) when every iterable is.
+ *
+ * @tparam Ts
+ * @param[in] iterables
+ * @return detail::ZipIterableWrapper<Ts...>
+ */
+template <typename... Ts>
+inline auto zip(Ts &&...iterables) -> detail::ZipIterableWrapper<Ts...> {
+  return detail::ZipIterableWrapper<Ts...>{
+      std::tuple<Ts...>{std::forward<Ts>(iterables)...}};
+}
+
+} // namespace py
@@ -0,0 +1,130 @@
+/*
+ *  Built into the test_py2cpp_stats binary, with PY2CPP_STATS defined for
+ *  every translation unit.
+ */
+#include <doctest/doctest.h> // for ResultBuilder, TestCase, CHECK, TEST_CASE
+
+#include <py2cpp/dict.hpp>      // for dict
+#include <py2cpp/flat_dict.hpp> // for flat_dict
+#include <py2cpp/flat_set.hpp>  // for flat_set
+#include <py2cpp/fractions.hpp> // for Fraction
+#include <py2cpp/set.hpp>       // for set
+#include <py2cpp/stats.hpp>     // for table_stats, fraction_stats
+#include <sstream>              // for ostringstream
+#include <string>               // for string
+#include <thread>               // for thread
+#include <vector>               // for vector
+
+static_assert(py::stats_enabled, "build this file with PY2CPP_STATS");
+
+TEST_CASE("stats: flat_dict") {
+  auto d = py::flat_dict<int, int>{};
+  CHECK(d.stats().allocations == 0);
+  d.reserve(100);
+  CHECK(d.stats().allocations == 2);
+  for (auto i = 0; i != 100; ++i) {
+    d[i] = i;
+  }
+  auto s = d.stats();
+  CHECK(s.lookups == 100);
+  CHECK(s.rehashes == 0);
+  for (auto i = 0; i != 200; ++i) {
+    CHECK(d.contains(i) == (i < 100));
+  }
+  s = d.stats();
+  CHECK(s.lookups == 300);
+  CHECK(s.probes >= s.lookups);
+  CHECK(s.max_probe >= 1);
+  CHECK(s.mean_probe() >= 1.0);
+
+  for (auto i = 100; i != 2000; ++i) {
+    d[i] = i;
+  }
+  s = d.stats();
+  CHECK(s.rehashes > 0);
+  CHECK(s.allocations == 2 * (s.rehashes + 1));
+
+  const auto c = d.copy();
+  CHECK(c.stats().lookups == 0);
+  d.reset_stats();
+  CHECK(d.stats().lookups == 0);
+  CHECK(d.stats().rehashes == 0);
+}
+
+TEST_CASE("stats: concurrent const lookups") {
+  auto s = py::flat_set<int>{};
+  for (auto i = 0; i != 1000; ++i) {
+    s.insert(i);
+  }
+  s.reset_stats();
+  const auto &cs = s;
+  auto workers = std::vector<std::thread>{};
+  for (auto t = 0; t != 4; ++t) {
+    workers.emplace_back([&cs]() {
+      for (auto i = 0; i != 1000; ++i) {
+        CHECK(cs.contains(i));
+      }
+    });
+  }
+  for (auto &w : workers) {
+    w.join();
+  }
+  CHECK(s.stats().lookups == 4000);
+}
+
+TEST_CASE("stats: dict and set") {
+  auto d = py::dict<int, int>{};
+  for (auto i = 0; i != 100; ++i) {
+    d[i] = i;
+  }
+  CHECK(d.get(5, -1) == 5);
+  CHECK(!d.contains(500));
+  auto s = d.stats();
+  CHECK(s.lookups == 102);
+  CHECK(s.probes >= s.lookups);
+  CHECK(s.rehashes > 0);
+  CHECK(s.allocations >= 100);
+
+  auto S = py::set<int>{};
+  for (auto i = 0; i != 10; ++i) {
+    S.insert(i);
+  }
+  CHECK(S.contains(3));
+  CHECK(S.stats().lookups == 1);
+  S.reset_stats();
+  CHECK(S.stats().lookups == 0);
+}
+
+TEST_CASE("stats: Fraction") {
+  using F = fun::Fraction<int>;
+  F::reset_stats();
+  const auto a = F(2, 4);
+  CHECK(F::stats().normalize_calls == 1);
+  CHECK(F::stats().gcd_calls == 1);
+  const auto b = a + F(1, 3);
+  CHECK(b == F(5, 6));
+  CHECK(F::stats().gcd_calls > 1);
+
+  using L = fun::Fraction<int, fun::LazyNormalize>;
+  L::reset_stats();
+  const auto l = L(2, 4);
+  CHECK(l == L(1, 2));
+  CHECK(L::stats().gcd_calls == 0);
+
+  constexpr auto c = F(3, 6); // still a constant expression
+  static_assert(c._den == 2, "reduced at compile time");
+}
+
+TEST_CASE("stats: dump") {
+  auto os = std::ostringstream{};
+  auto s = py::table_stats{};
+  s.lookups = 3;
+  s.probes = 4;
+  os << s;
+  CHECK(os.str() == "lookups=3 probes=4 max_probe=0 rehashes=0 allocations=0");
+
+  auto names = std::string{};
+  py::fraction_stats{}.for_each(
+      [&names](const char *name, uint64_t) { names += name; });
+  CHECK(names == "gcd_callsnormalize_calls");
+}
@@ -0,0 +1,63 @@
+#include <doctest/doctest.h> // for ResultBuilder, TestCase, CHECK, TEST_CASE
+
+#include <py2cpp/arena.hpp>     // for arena, arena_allocator
+#include <py2cpp/dict.hpp>      // for arena_dict
+#include <py2cpp/flat_dict.hpp> // for flat_dict
+#include <py2cpp/flat_set.hpp>  // for flat_set
+#include <py2cpp/set.hpp>       // for arena_set
+#include <utility>              // for pair
+
+TEST_CASE("Test arena") {
+  char buffer[256];
+  py::arena a{buffer, sizeof buffer};
+  auto *p = a.allocate(10, 8);
+  auto *q = a.allocate(100, 16);
+  CHECK(p == buffer);
+  CHECK(reinterpret_cast<uintptr_t>(q) % 16 == 0);
+  auto *r = a.allocate(1000); // spills to the heap
+  CHECK(r != nullptr);
+  a.release();
+  CHECK(a.allocate(10, 8) == buffer);
+
+  py::arena z(0); // the first block is sized by the request
+  auto *s = z.allocate(16, 8);
+  CHECK(reinterpret_cast<uintptr_t>(s) % 8 == 0);
+  CHECK(z.allocate(4096) != nullptr);
+}
+
+TEST_CASE("Test arena_dict and arena_set") {
+  py::arena a{};
+  {
+    using Alloc = py::arena_allocator<std::pair<const int, int>>;
+    auto D = py::arena_dict<int, int>(Alloc(a));
+    for (auto i = 0; i != 100; ++i) {
+      D[i] = 2 * i;
+    }
+    CHECK(py::len(D) == 100);
+    CHECK(42 < D);
+
+    auto S = py::arena_set<int>({1, 2, 3}, py::arena_allocator<int>(a));
+    CHECK(py::len(S) == 3);
+    CHECK(S.get_allocator().resource() == &a);
+
+    auto F = py::flat_dict<int, int, std::hash<int>, std::equal_to<int>,
+                           Alloc>(Alloc(a));
+    F[1] = 1;
+    auto G = std::move(F);
+    CHECK(G.contains(1));
+  }
+  a.release();
+}
+
+#if defined(PY2CPP_HAS_PMR)
+TEST_CASE("Test pmr dict and set") {
+  py::arena a{};
+  auto D = py::pmr::dict<int, int>(&a);
+  D[1] = 10;
+  auto E = py::pmr::dict<int, int>(&a);
+  E = std::move(D);
+  CHECK(E.contains(1));
+  auto S = py::pmr::flat_set<int>({4, 5, 6}, &a);
+  CHECK(5 < S);
+}
+#endif
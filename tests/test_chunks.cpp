@@ -0,0 +1,70 @@
+#include <doctest/doctest.h> // for ResultBuilder, CHECK, TestCase, TEST...
+
+#include <atomic>               // for atomic
+#include <cstddef>              // for size_t
+#include <limits>               // for numeric_limits
+#include <py2cpp/chunks.hpp>    // for chunks, slice
+#include <py2cpp/enumerate.hpp> // for enumerate
+#include <py2cpp/parallel.hpp>  // for parallel_for
+#include <py2cpp/range.hpp>     // for range
+#include <vector>               // for vector
+
+TEST_CASE("Test chunks") {
+  const auto V = std::vector<int>{0, 1, 2, 3, 4, 5, 6};
+  const auto C = py::chunks(V, 3);
+  CHECK(C.size() == 3);
+  CHECK(C[0].size() == 3);
+  CHECK(C[2].size() == 1);
+  CHECK(C[2][0] == 6);
+  const auto W = py::chunks(V, std::numeric_limits<size_t>::max());
+  CHECK(W.size() == 1);
+  CHECK(W[0].size() == 7);
+  CHECK(py::chunks(std::vector<int>{}, 3).empty());
+
+  auto total = 0;
+  for (auto chunk : py::chunks(py::range(10), 4)) {
+    for (auto i : chunk) {
+      total += i;
+    }
+  }
+  CHECK(total == 45);
+  CHECK_THROWS(py::chunks(V, 0));
+
+  const auto S = py::slice(V, 2, 100);
+  CHECK(S.size() == 5);
+  CHECK(S[0] == 2);
+}
+
+TEST_CASE("Test enumerate (chunks and slice)") {
+  auto V = std::vector<int>(10, 0);
+  auto seen = 0U;
+  for (auto chunk : py::enumerate(V).chunks(4)) {
+    for (auto p : chunk) {
+      p.second = static_cast<int>(p.first); // global index
+      ++seen;
+    }
+  }
+  CHECK(seen == 10);
+  CHECK(V[9] == 9);
+
+  const auto E = py::enumerate(V, 100);
+  const auto S = E.slice(3, 5);
+  CHECK(S.size() == 2);
+  CHECK(S[0].first == 103);
+  CHECK(S[1].second == 4);
+}
+
+TEST_CASE("Test enumerate (parallel chunks)") {
+  py::thread_pool pool{2};
+  auto V = std::vector<size_t>(1000, 0);
+  std::atomic<size_t> count{0};
+  const auto C = py::enumerate(V).chunks(64);
+  py::parallel_for(pool, C, [&count](decltype(C[0]) chunk) {
+    for (auto p : chunk) {
+      p.second = p.first;
+      ++count;
+    }
+  });
+  CHECK(count == 1000);
+  CHECK(V[999] == 999);
+}
@@ -0,0 +1,97 @@
+#include <doctest/doctest.h> // for ResultBuilder, TestCase, CHECK, TEST_CASE
+
+#include <algorithm>                  // for sort
+#include <py2cpp/concurrent_dict.hpp> // for concurrent_dict, len
+#include <py2cpp/dict.hpp>            // for dict
+#include <py2cpp/range.hpp>           // for range
+#include <string>                     // for string
+#include <thread>                     // for thread
+#include <utility>                    // for pair
+#include <vector>                     // for vector
+
+TEST_CASE("Test concurrent_dict (Python-like surface)") {
+  py::concurrent_dict<std::string, int> D{3};
+  CHECK(D.num_shards() == 4);
+  CHECK(D.empty());
+  D.set("a", 1);
+  D.set("b", 2);
+  D.upsert("a", [](int &v) { v += 10; });
+  D.upsert("c", [](int &v) { v += 5; }); // starts from int{}
+  CHECK(D.contains("a"));
+  CHECK(!D.contains("z"));
+  CHECK(D.get("a", 0) == 11);
+  CHECK(D.get("z", -1) == -1);
+  auto out = 0;
+  CHECK(D.try_get("c", out));
+  CHECK(out == 5);
+  CHECK(!D.try_get("z", out));
+  CHECK(D.setdefault("b", 7) == 2);
+  CHECK(D.setdefault("d", 7) == 7);
+  CHECK(py::len(D) == 4);
+  CHECK(D.pop("d", 0) == 7);
+  CHECK(D.pop("d", 0) == 0);
+  CHECK(D.erase("c"));
+  CHECK(!D.erase("c"));
+
+  auto items = D.items();
+  std::sort(items.begin(), items.end());
+  CHECK(items == std::vector<std::pair<std::string, int>>{{"a", 11}, {"b", 2}});
+  CHECK(D.snapshot() == py::dict<std::string, int>{{"a", 11}, {"b", 2}});
+
+  D.update(py::dict<std::string, int>{{"b", 20}, {"e", 5}});
+  CHECK(D.get("b", 0) == 20);
+  CHECK(D.get("e", 0) == 5);
+  D.clear();
+  CHECK(py::len(D) == 0);
+}
+
+TEST_CASE("Test concurrent_dict (merge another concurrent_dict)") {
+  py::concurrent_dict<std::string, long> a{4};
+  py::concurrent_dict<std::string, long> b{4};
+  for (auto i : py::range(100)) {
+    a.set("key" + std::to_string(i), i);
+  }
+  b.set("key1", 1000);
+  b.set("other", 7);
+  b.merge(a, [](long &acc, long v) { acc += v; });
+  CHECK(py::len(b) == 101);
+  CHECK(b.get("key1", 0) == 1001);
+  CHECK(b.get("key99", 0) == 99);
+  CHECK(b.get("other", 0) == 7);
+
+  b.update(a);
+  CHECK(b.get("key1", 0) == 1);
+  CHECK(py::len(b) == 101);
+}
+
+TEST_CASE("Test concurrent_dict (threads)") {
+  constexpr int num_threads = 4;
+  constexpr int num_keys = 100;
+  constexpr int rounds = 500;
+  py::concurrent_dict<int, long> shared{};
+  py::concurrent_dict<int, long> merged{};
+
+  auto workers = std::vector<std::thread>{};
+  for (auto t : py::range(num_threads)) {
+    workers.emplace_back([&shared, &merged, t]() {
+      auto local = py::dict<int, long>{};
+      for (auto i : py::range(rounds)) {
+        const auto key = (i * 7 + t) % num_keys;
+        shared.upsert(key, [](long &v) { ++v; });
+        ++local[key];
+      }
+      merged.merge(local, [](long &acc, long v) { acc += v; });
+    });
+  }
+  for (auto &w : workers) {
+    w.join();
+  }
+
+  CHECK(py::len(shared) == num_keys);
+  auto total = 0L;
+  for (const auto &kv : shared.items()) {
+    total += kv.second;
+  }
+  CHECK(total == num_threads * rounds);
+  CHECK(merged.snapshot() == shared.snapshot());
+}
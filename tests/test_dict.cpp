@@ -1,8 +1,13 @@
 #include <doctest/doctest.h> // for ResultBuilder, TestCase, CHECK, TEST_CASE
 
-#include <py2cpp/dict.hpp> // for dict, key_iterator
-#include <unordered_map>   // for operator!=, __hash_map_const_iterator
-#include <utility>         // for pair
+#include <py2cpp/dict.hpp>      // for dict, key_iterator
+#include <py2cpp/enumerate.hpp> // for const_enumerate
+#include <py2cpp/hash.hpp>      // for string_hash
+#include <py2cpp/range.hpp>     // for range
+#include <string>               // for string
+#include <unordered_map>        // for operator!=, __hash_map_const_iterator
+#include <utility>              // for pair
+#include <vector>               // for vector
 
 TEST_CASE("Test set") {
   using E = std::pair<double, int>;
@@ -14,3 +19,76 @@ TEST_CASE("Test set") {
   }
   CHECK(count == 3);
 }
+
+TEST_CASE("Test dict (heterogeneous lookup)") {
+  using Dict = py::dict<std::string, int, py::string_hash, std::equal_to<>>;
+  auto D = Dict{{"one", 1}, {"two", 2}};
+  const char *key = "two";
+  CHECK(D.contains(key));
+  CHECK(D.contains("one"));
+  CHECK(!D.contains("three"));
+  CHECK(D.get("two", 0) == 2);
+  CHECK(D.get("three", 0) == 0);
+  D["three"] = 3;
+  CHECK(py::len(D) == 3);
+  const auto &C = D;
+  CHECK(C["three"] == 3);
+}
+
+TEST_CASE("Test dict (get, setdefault, pop, update)") {
+  auto D = py::dict<std::string, std::string>{{"a", "x"}, {"b", "y"}};
+  const auto fallback = std::string("none");
+  CHECK(D.get("a", fallback) == "x");
+  CHECK(&D.get("c", fallback) == &fallback);
+  REQUIRE(D.get("b") != nullptr);
+  *D.get("b") += "y";
+  CHECK(D["b"] == "yy");
+  CHECK(D.get("c") == nullptr);
+
+  D.setdefault("c", "z") += "z";
+  CHECK(D.setdefault("c", "w") == "zz");
+
+  CHECK(D.pop("a") == "x");
+  CHECK(!D.contains("a"));
+  CHECK(D.pop("a", "gone") == "gone");
+  CHECK_THROWS(D.pop("a"));
+
+  D.update({{"b", "B"}, {"d", "D"}});
+  CHECK(D["b"] == "B");
+  CHECK(py::len(D) == 3);
+
+  auto count = 0;
+  while (!D.empty()) {
+    auto item = D.popitem();
+    CHECK(!D.contains(item.first));
+    ++count;
+  }
+  CHECK(count == 3);
+  CHECK_THROWS(D.popitem());
+}
+
+TEST_CASE("Test dict (bulk construction)") {
+  const auto V = std::vector<std::pair<int, int>>{{1, 1}, {2, 4}, {1, 9}};
+  const auto D = py::dict<int, int>(V.begin(), V.end());
+  CHECK(py::len(D) == 2);
+  CHECK(D[1] == 9); // later duplicates win
+
+  const auto W = std::vector<double>{0.5, 1.5, 2.5};
+  const auto E = py::dict<size_t, double>(py::const_enumerate(W));
+  CHECK(py::len(E) == 3);
+  CHECK(E[2] == 2.5);
+
+  const auto F = py::dict<int, bool>::fromkeys(py::range(5), true);
+  CHECK(py::len(F) == 5);
+  CHECK(F[4]);
+
+  const auto C = py::counter(std::string("abracadabra"));
+  CHECK(C['a'] == 5);
+  CHECK(C['r'] == 2);
+  CHECK(!C.contains('z'));
+}
+
+TEST_CASE("Test dict (no overhead without PY2CPP_STATS)") {
+  CHECK(!py::stats_enabled);
+  CHECK(sizeof(py::dict<int, int>) == sizeof(std::unordered_map<int, int>));
+}
@@ -1,16 +1,61 @@
 #include <doctest/doctest.h> // for ResultBuilder, CHECK, TestCase, TEST...
 
-// #include <py2cpp/enumerate.hpp> // for enumerate, iterable_wrapper
-// #include <py2cpp/range.hpp>     // for range, iterable_wrapper
-// #include <utility>              // for pair
-//
-// TEST_CASE("Test enumerate") {
-//   const auto R = py::range(10);
-//   auto count = 0;
-//   for (const auto &p : py::enumerate(R)) {
-//     static_assert(sizeof p.first >= 0, "make comipler happy");
-//     CHECK(p.first == count);
-//     ++count;
-//   }
-//   CHECK(count == R.size());
-// }
+#include <algorithm>            // for find_if
+#include <py2cpp/enumerate.hpp> // for enumerate, const_enumerate
+#include <py2cpp/parallel.hpp>  // for parallel_for
+#include <py2cpp/range.hpp>     // for range
+#include <vector>               // for vector
+
+TEST_CASE("Test enumerate") {
+  const auto R = py::range(10);
+  auto count = 0;
+  for (const auto &p : py::enumerate(R)) {
+    CHECK(p.first == static_cast<size_t>(count));
+    CHECK(p.second == count);
+    ++count;
+  }
+  CHECK(count == R.size());
+}
+
+TEST_CASE("Test enumerate (write through, start)") {
+  auto V = std::vector<int>(5, 0);
+  for (auto p : py::enumerate(V, 10)) {
+    p.second = static_cast<int>(p.first);
+  }
+  CHECK(V[0] == 10);
+  CHECK(V[4] == 14);
+
+  // an rvalue range is moved into the adaptor
+  auto total = size_t(0);
+  for (auto p : py::enumerate(py::range(1, 4))) {
+    total += p.first * static_cast<size_t>(p.second);
+  }
+  CHECK(total == 0 * 1 + 1 * 2 + 2 * 3);
+}
+
+TEST_CASE("Test enumerate (random access)") {
+  const auto V = std::vector<double>{0.5, 1.5, 2.5, 3.5};
+  const auto E = py::const_enumerate(V);
+  CHECK(E.size() == 4);
+  CHECK(E.end() - E.begin() == 4);
+  CHECK(E[2].first == 2);
+  CHECK(E[2].second == 2.5);
+  CHECK((*(E.end() - 1)).first == 3);
+  auto it = std::find_if(E.begin(), E.end(),
+                         [](decltype(E[0]) p) { return p.second > 2.0; });
+  CHECK((*it).first == 2);
+
+  auto out = std::vector<double>(4, 0.0);
+  py::parallel_for(E, [&out](decltype(E[0]) p) { out[p.first] = p.second; });
+  CHECK(out == V);
+}
+
+#if __cplusplus >= 201703L
+TEST_CASE("Test enumerate (structured binding)") {
+  auto V = std::vector<int>{5, 6, 7};
+  for (auto [i, x] : py::enumerate(V)) {
+    x += static_cast<int>(i);
+  }
+  CHECK(V == std::vector<int>{5, 7, 9});
+}
+#endif
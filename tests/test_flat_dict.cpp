@@ -0,0 +1,149 @@
+#include <doctest/doctest.h> // for ResultBuilder, TestCase, CHECK, TEST_CASE
+
+#include <py2cpp/enumerate.hpp> // for const_enumerate
+#include <py2cpp/flat_dict.hpp> // for flat_dict
+#include <py2cpp/hash.hpp>      // for string_hash
+#include <py2cpp/range.hpp>     // for range
+#include <stdexcept>            // for out_of_range
+#include <string>               // for string
+#include <utility>              // for pair
+#include <vector>               // for vector
+
+TEST_CASE("Test flat_dict") {
+  using E = std::pair<double, int>;
+  const auto S = py::flat_dict<double, int>{E{0.1, 1}, E{0.3, 3}, E{0.4, 4}};
+  auto count = 0;
+  for (const auto &p : S) {
+    static_assert(sizeof(p) >= 0, "make compiler happy");
+    ++count;
+  }
+  CHECK(count == 3);
+  CHECK(py::len(S) == 3);
+  CHECK(0.3 < S);
+  CHECK(!(0.2 < S));
+  CHECK(S[0.4] == 4);
+}
+
+TEST_CASE("Test flat_dict (grow and erase)") {
+  auto S = py::flat_dict<int, int>{};
+  for (auto i = 0; i != 1000; ++i) {
+    S[i] = i * i;
+  }
+  CHECK(py::len(S) == 1000);
+  CHECK(S.get(30, -1) == 900);
+  CHECK(S.get(1000, -1) == -1);
+  for (auto i = 0; i != 1000; i += 2) {
+    CHECK(S.erase(i) == 1);
+  }
+  CHECK(py::len(S) == 500);
+  CHECK(!S.contains(10));
+  CHECK(S.contains(11));
+
+  auto sum = 0;
+  for (const auto &kv : S.items()) {
+    sum += kv.second - kv.first * kv.first;
+  }
+  CHECK(sum == 0);
+
+  const auto T = S.copy();
+  CHECK(py::len(T) == 500);
+  CHECK(T.contains(999));
+}
+
+TEST_CASE("Test flat_dict (string key)") {
+  auto S = py::flat_dict<std::string, int>{{"one", 1}, {"two", 2}};
+  S["three"] = 3;
+  CHECK(py::len(S) == 3);
+  CHECK(S.at("two") == 2);
+  CHECK(std::string("three") < S);
+}
+
+TEST_CASE("Test flat_dict (heterogeneous lookup)") {
+  using Dict =
+      py::flat_dict<std::string, int, py::string_hash, std::equal_to<>>;
+  auto D = Dict{{"one", 1}, {"two", 2}};
+  const char *key = "two";
+  CHECK(D.contains(key));
+  CHECK(!D.contains("three"));
+  CHECK(D.get("one", 0) == 1);
+  D["three"] = 3;
+  D["three"] += 1;
+  CHECK(D.at("three") == 4);
+  CHECK(py::len(D) == 3);
+#if defined(PY2CPP_HAS_STRING_VIEW)
+  CHECK(D.contains(std::string_view("one")));
+#endif
+}
+
+TEST_CASE("Test flat_dict (get, setdefault, pop, update)") {
+  auto D = py::flat_dict<int, std::string>{{1, "x"}, {2, "y"}};
+  const auto fallback = std::string("none");
+  CHECK(D.get(1, fallback) == "x");
+  CHECK(&D.get(3, fallback) == &fallback);
+  REQUIRE(D.get(2) != nullptr);
+  CHECK(*D.get(2) == "y");
+  CHECK(D.get(3) == nullptr);
+
+  D.setdefault(3, "z") += "z";
+  CHECK(D.setdefault(3, "w") == "zz");
+
+  CHECK(D.pop(1) == "x");
+  CHECK(D.pop(1, "gone") == "gone");
+  CHECK_THROWS(D.pop(1));
+
+  auto E = py::flat_dict<int, std::string>{{2, "Y"}, {4, "W"}};
+  D.update(std::move(E));
+  CHECK(D[2] == "Y");
+  CHECK(py::len(D) == 3);
+
+  auto item = D.popitem();
+  CHECK(!D.contains(item.first));
+  CHECK(py::len(D) == 2);
+}
+
+TEST_CASE("Test flat_dict (popitem drain)") {
+  auto D = py::flat_dict<int, int>{};
+  for (auto i : py::range(100000)) {
+    D[i] = -i;
+  }
+  auto total = 0L;
+  for (auto i = 0; i != 50000; ++i) {
+    const auto item = D.popitem();
+    CHECK(item.second == -item.first);
+    total += item.first;
+  }
+  D[-1] = 1; // an insert between pops is still found
+  while (!D.empty()) {
+    total += D.popitem().first;
+  }
+  CHECK(total == 99999L * 100000 / 2 - 1);
+  CHECK_THROWS_AS(D.popitem(), std::out_of_range);
+}
+
+TEST_CASE("Test flat_dict (bulk construction)") {
+  const auto W = std::vector<int>{10, 20, 30};
+  const auto D = py::flat_dict<size_t, int>(py::const_enumerate(W));
+  CHECK(py::len(D) == 3);
+  CHECK(D[1] == 20);
+  const auto F = py::flat_dict<int, int>::fromkeys(py::range(100), 7);
+  CHECK(py::len(F) == 100);
+  CHECK(F[99] == 7);
+}
+
+TEST_CASE("Test flat_dict (equality)") {
+  auto A = py::flat_dict<int, int>{};
+  auto B = py::flat_dict<int, int>{};
+  for (auto i = 0; i != 100; ++i) {
+    A[i] = i * i;
+    B[99 - i] = (99 - i) * (99 - i);
+  }
+  CHECK(A == B);
+  CHECK(!(A != B));
+  B[7] = 0;
+  CHECK(A != B);
+  B.erase(7);
+  CHECK(A != B);
+  B[100] = 49;
+  CHECK(A != B);
+  CHECK(py::flat_dict<int, int>{} == py::flat_dict<int, int>{});
+}
@@ -0,0 +1,96 @@
+#include <doctest/doctest.h> // for ResultBuilder, TestCase, CHECK, TEST_CASE
+
+#include <py2cpp/flat_set.hpp> // for flat_set
+#include <py2cpp/hash.hpp>     // for string_hash
+#include <py2cpp/range.hpp>    // for range
+#include <string>              // for string
+#include <vector>              // for vector
+
+TEST_CASE("Test flat_set") {
+  const auto S = py::flat_set<int>{1, 3, 4, 5, 1};
+  auto count = 0;
+  for (const auto &_ : S) {
+    static_assert(sizeof(_) >= 0, "make compiler happy");
+    ++count;
+  }
+  CHECK(count == 4);
+  CHECK(py::len(S) == 4);
+  CHECK(3 < S);
+  CHECK(!(2 < S));
+}
+
+TEST_CASE("Test flat_set (many keys)") {
+  auto V = std::vector<int>{};
+  for (auto i = 0; i != 10000; ++i) {
+    V.push_back(i * 7);
+  }
+  auto S = py::flat_set<int>(V.begin(), V.end());
+  CHECK(py::len(S) == 10000);
+  auto hits = 0;
+  for (auto i = 0; i != 70000; ++i) {
+    hits += S.contains(i) ? 1 : 0;
+  }
+  CHECK(hits == 10000);
+
+  for (auto i = 0; i != 70000; i += 14) {
+    S.erase(i);
+  }
+  CHECK(py::len(S) == 5000);
+  CHECK(!S.contains(0));
+  CHECK(S.contains(7));
+
+  const auto T = S.copy();
+  CHECK(py::len(T) == 5000);
+}
+
+TEST_CASE("Test flat_set algebra") {
+  const auto A = py::flat_set<int>{1, 2, 3, 4};
+  const auto B = py::flat_set<int>{3, 4, 5};
+
+  CHECK(py::len(A | B) == 5);
+  CHECK(py::len(A & B) == 2);
+  CHECK((A - B).issubset(py::flat_set<int>{1, 2}));
+  CHECK(py::len(A ^ B) == 3);
+  CHECK((A ^ B).isdisjoint(A & B));
+
+  auto C = A.copy();
+  C ^= B;
+  CHECK(1 < C);
+  CHECK(5 < C);
+  CHECK(!(3 < C));
+  C &= B;
+  CHECK(py::len(C) == 1);
+}
+
+TEST_CASE("Test flat_set (heterogeneous lookup)") {
+  const auto S = py::flat_set<std::string, py::string_hash, std::equal_to<>>{
+      "alpha", "beta"};
+  CHECK(S.contains("alpha"));
+  CHECK(!S.contains("gamma"));
+  CHECK(S.count("beta") == 1);
+}
+
+TEST_CASE("Test flat_set (bulk construction)") {
+  const auto R = py::flat_set<int>(py::range(1000));
+  CHECK(py::len(R) == 1000);
+  CHECK(R.capacity() >= 1000);
+  CHECK(R.contains(999));
+  const auto S = py::flat_set<int>(R.begin(), R.end());
+  CHECK(py::len(S) == 1000);
+}
+
+TEST_CASE("Test flat_set (equality)") {
+  auto A = py::flat_set<int>{};
+  auto B = py::flat_set<int>{};
+  for (auto i = 0; i != 100; ++i) {
+    A.insert(i);
+    B.insert(99 - i);
+  }
+  CHECK(A == B);
+  CHECK(!(A != B));
+  B.erase(7);
+  CHECK(A != B);
+  B.insert(100);
+  CHECK(A != B);
+  CHECK(py::flat_set<int>{} == py::flat_set<int>{});
+}
@@ -3,8 +3,17 @@
  */
 #include <doctest/doctest.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
 #include <ostream>
+#include <py2cpp/dict.hpp>
 #include <py2cpp/fractions.hpp>
+#include <py2cpp/set.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
 
 using namespace fun;
 
@@ -57,3 +66,284 @@ TEST_CASE("Fraction Special Cases") {
   CHECK(inf - p == inf);
   CHECK(-inf + p == -inf);
 }
+
+TEST_CASE("gcd (builtin vs generic Euclid)") {
+  auto ok = true;
+  for (auto m = -60; m <= 60; ++m) {
+    for (auto n = -60; n <= 60; ++n) {
+      const auto expected = (m == 0) ? fun::abs(n) : gcd_recur(m, n);
+      ok = ok && gcd(m, n) == expected;
+      const auto k = 1LL << 33;
+      ok = ok && gcd(m * k, n * k) == expected * k;
+      ok = ok && gcd(static_cast<short>(m), static_cast<short>(n)) ==
+                     static_cast<short>(expected);
+    }
+  }
+  CHECK(ok);
+  CHECK(gcd(0U, 0U) == 0U);
+  CHECK(gcd(48U, 180U) == 12U);
+  CHECK(gcd(static_cast<signed char>(-128), static_cast<signed char>(64)) ==
+        64);
+  static_assert(fun::detail::is_builtin_integer<int>::value, "unsigned path");
+  static_assert(!fun::detail::is_builtin_integer<bool>::value, "generic path");
+  static_assert(!fun::detail::use_binary_gcd<unsigned>::value, "Euclid");
+  // Stein's algorithm stays available (and correct) as an opt-in
+  CHECK(fun::detail::gcd_binary(48U, 180U) == 12U);
+  CHECK(fun::detail::gcd_binary(uint64_t{1} << 63, uint64_t{3} << 40) ==
+        uint64_t{1} << 40);
+  CHECK(fun::detail::gcd_binary(0U, 7U) == 7U);
+#if defined(PY2CPP_HAS_INT128)
+  using u128 = unsigned __int128;
+  CHECK(fun::detail::countr_zero(u128{1} << 100) == 100);
+  CHECK(fun::detail::countr_zero((u128{1} << 100) | 8U) == 3);
+  CHECK(fun::detail::gcd_binary(u128{3} << 90, u128{6} << 70) ==
+        u128{3} << 71);
+#endif
+#if __cpp_constexpr >= 201304
+  static_assert(gcd(12, 18) == 6, "constexpr");
+#endif
+}
+
+TEST_CASE("checked integer arithmetic") {
+  auto res = 0;
+  CHECK(checked_add(2, 3, res));
+  CHECK(res == 5);
+  CHECK(!checked_add(std::numeric_limits<int>::max(), 1, res));
+  CHECK(!checked_sub(std::numeric_limits<int>::min(), 1, res));
+  CHECK(checked_mul(-46340, 46340, res));
+  CHECK(res == -46340 * 46340);
+  CHECK(!checked_mul(65536, 65536, res));
+  CHECK(!checked_div(std::numeric_limits<int>::min(), -1, res));
+  CHECK(!checked_div(1, 0, res));
+  CHECK(checked_div(-7, 2, res));
+  CHECK(res == -3);
+}
+
+TEST_CASE("Fraction arithmetic does not overflow in intermediates") {
+  // coprime denominators: the exact sum does not fit in int32_t
+  const auto d1 = 65521;
+  const auto d2 = 65519;
+  const auto p = Fraction<int>{1, d1};
+  const auto q = Fraction<int>{1, d2};
+  CHECK_THROWS_AS(p + q, std::overflow_error);
+
+  // lcm(d1, d2) = 2^20 * 45 * 47 overflows int32_t, the reduced sum fits
+  const auto big = 1 << 20;
+  CHECK(Fraction<int>{691613, big * 45} + Fraction<int>{1, big * 47} ==
+        Fraction<int>{31, 2115});
+  CHECK(Fraction<int>{691613, big * 45} - Fraction<int>{-1, big * 47} ==
+        Fraction<int>{31, 2115});
+
+  const auto m = std::numeric_limits<int64_t>::max();
+  const auto u = Fraction<int64_t>{m - 1, m};
+  const auto v = Fraction<int64_t>{1, m};
+  CHECK(u + v == Fraction<int64_t>(1));
+  CHECK(u - (-v) == Fraction<int64_t>(1));
+  CHECK(Fraction<int64_t>{m, 2} - Fraction<int64_t>{m - 2, 2} ==
+        Fraction<int64_t>(1));
+  CHECK_THROWS_AS(Fraction<int64_t>(m) + Fraction<int64_t>(1),
+                  std::overflow_error);
+  CHECK_THROWS_AS(Fraction<int64_t>(m) * Fraction<int64_t>(2),
+                  std::overflow_error);
+
+  // min() is out of range too: it could not be negated afterwards
+  const auto imax = std::numeric_limits<int32_t>::max();
+  CHECK_THROWS_AS(Fraction<int32_t>(-imax) - 1, std::overflow_error);
+  CHECK(Fraction<int32_t>(-imax, 2) - Fraction<int32_t>(1, 2) ==
+        Fraction<int32_t>(-(1 << 30)));
+  CHECK_THROWS_AS(Fraction<int64_t>(-m) - int64_t(1), std::overflow_error);
+  CHECK_THROWS_AS(Fraction<int64_t>(-m) + Fraction<int64_t>(-1),
+                  std::overflow_error);
+  CHECK_THROWS_AS(Fraction<int64_t>(m / 2 + 1) * Fraction<int64_t>(-2),
+                  std::overflow_error);
+  CHECK_THROWS_AS(LazyFraction<int64_t>(-m) - LazyFraction<int64_t>(1),
+                  std::overflow_error);
+  CHECK(Fraction<int64_t>(-m, 2) - Fraction<int64_t>(1, 2) ==
+        Fraction<int64_t>(-m / 2 - 1));
+
+  auto w = Fraction<int64_t>{5, 7};
+  w += int64_t(3);
+  CHECK(w == Fraction<int64_t>{26, 7});
+  w -= Fraction<int64_t>{5, 7};
+  CHECK(w == Fraction<int64_t>(3));
+}
+
+TEST_CASE("LazyFraction") {
+  using L = LazyFraction<int>;
+  auto a = L{2, 4};
+  CHECK(a.num() == 2); // not reduced
+  CHECK(a.den() == 4);
+  CHECK(a == L(1, 2));
+  CHECK(L(1, -2).den() == 2);
+  CHECK(L(3, 6) < L(2, 3));
+  auto os = std::ostringstream{};
+  os << a;
+  CHECK(os.str() == "(1/2)");
+
+  auto h = L{};
+  auto e = Fraction<int>{};
+  for (auto k = 1; k <= 12; ++k) {
+    h += L(1, k);
+    e += Fraction<int>(1, k);
+  }
+  CHECK(h == L(e.num(), e.den()));
+  h.normalize();
+  CHECK(h.num() == e.num());
+  CHECK(h.den() == e.den());
+
+  auto f = L{6, 4};
+  f *= L(2, 3);
+  CHECK(f == L(1));
+  f /= f;
+  CHECK(f == L(1));
+  f -= int(3);
+  CHECK(f == L(-2));
+  CHECK(f * 2 == L(-4));
+  CHECK(L(1, 0) + L(1, 2) == L(1, 0));
+  CHECK(L(1, 0) - L(1, 0) == L(0, 0));
+
+  auto u = LazyFraction<unsigned>{2U, 4U};
+  u /= u;
+  CHECK(u == LazyFraction<unsigned>(1U));
+  CHECK((LazyFraction<unsigned>{1U, 2U} + LazyFraction<unsigned>{1U, 3U})
+            .den() == 6U);
+
+  // products past int64_t are reduced instead of throwing
+  const auto m = std::numeric_limits<int64_t>::max();
+  auto g = LazyFraction<int64_t>{m - 1, m};
+  g *= LazyFraction<int64_t>{m, m - 1};
+  CHECK(g == LazyFraction<int64_t>(1));
+  auto s = LazyFraction<int64_t>{1, m - 1} + LazyFraction<int64_t>{1, m - 1};
+  s += LazyFraction<int64_t>{1, (m - 1) / 2};
+  CHECK(s == LazyFraction<int64_t>(4, m - 1));
+  CHECK_THROWS_AS(LazyFraction<int64_t>(1, m) + LazyFraction<int64_t>(1, 2),
+                  std::overflow_error);
+}
+
+TEST_CASE("Fraction hash matches Python") {
+  using F = Fraction<int64_t>;
+  CHECK(py_hash(F(1, 3)) == 1537228672809129301);
+  CHECK(py_hash(F(-1, 2)) == -1152921504606846976);
+  CHECK(py_hash(F(22, 7)) == 1976436865040309104);
+  CHECK(py_hash(F(2, 1)) == 2);
+  CHECK(py_hash(F(4, 2)) == 2);
+  CHECK(py_hash(F(-1)) == -2);
+  CHECK(py_hash(F(-(int64_t(1) << 62), 3)) == -768614336404564651);
+  CHECK(py_hash(F(5, (int64_t(1) << 61) - 1)) == 314159);
+  CHECK(py_hash(F(1, int64_t(1) << 62)) == 1152921504606846976);
+  CHECK(py_hash(LazyFraction<int64_t>(2, 6)) == py_hash(F(1, 3)));
+  CHECK(std::hash<Fraction<int>>{}(Fraction<int>(6, 4)) ==
+        std::hash<Fraction<int>>{}(Fraction<int>(3, 2)));
+
+  auto s = py::set<Fraction<int>>{};
+  s.insert(Fraction<int>(1, 2));
+  s.insert(Fraction<int>(2, 4));
+  s.insert(Fraction<int>(1, 3));
+  CHECK(s.size() == 2);
+  auto d = py::dict<Fraction<int>, int>{};
+  d[Fraction<int>(3, 6)] = 1;
+  CHECK(d.contains(Fraction<int>(1, 2)));
+}
+
+TEST_CASE("Fraction == compares reduced forms directly") {
+  CHECK(Fraction<int>(2, 4) == Fraction<int>(1, 2));
+  CHECK(Fraction<int>(2, 4) != Fraction<int>(1, 3));
+  CHECK(Fraction<int>(4, 2) == 2);
+  CHECK(!(Fraction<int>(1, 2) == 0));
+  CHECK(!(Fraction<int>(5, 2) == 2));
+  CHECK(!(Fraction<int>(3, 2) == 2)); // 3 < 2 * 2 used to make this true
+  CHECK(LazyFraction<int>(4, 2) == 2);
+  CHECK(!(LazyFraction<int>(3, 2) == 2));
+}
+
+TEST_CASE("Fraction ordering without gcd") {
+  auto ok = true;
+  for (auto a = -6; a <= 6; ++a) {
+    for (auto b = 0; b <= 6; ++b) {
+      for (auto c = -6; c <= 6; ++c) {
+        for (auto d = 0; d <= 6; ++d) {
+          const auto p = Fraction<int>(a, b);
+          const auto q = Fraction<int>(c, d);
+          const auto pn = p.num() == 0 && p.den() == 0;
+          const auto qn = q.num() == 0 && q.den() == 0;
+          // both denominators are non-negative after normalization
+          const auto expected =
+              !pn && !qn && (p.den() == q.den()
+                                 ? p.num() < q.num()
+                                 : p.num() * q.den() < p.den() * q.num());
+          ok = ok && (p < q) == expected;
+          ok = ok && fun::detail::cf_less(a, b == 0 ? 1 : b, c,
+                                          d == 0 ? 1 : d) ==
+                         (a * (d == 0 ? 1 : d) < c * (b == 0 ? 1 : b));
+        }
+      }
+    }
+  }
+  CHECK(ok);
+
+  // the cross products overflow int64_t
+  const auto m = std::numeric_limits<int64_t>::max();
+  using F = Fraction<int64_t>;
+  CHECK(!(F(m - 1, m) < F(m - 2, m - 1)));
+  CHECK(F(m - 2, m - 1) < F(m - 1, m));
+  CHECK(fun::detail::cf_less(m - 2, m - 1, m - 1, m));
+  CHECK(!fun::detail::cf_less(m - 1, m, m - 2, m - 1));
+  CHECK(F(-m, 3) < F(-m + 1, 3));
+  CHECK(F(m, 2) < m);
+  CHECK(m / 2 < F(m, 2));
+  CHECK(!(F(m, 2) < m / 2));
+
+  auto v = std::vector<F>{F(1, 3), F(-2, 5), F(m - 1, m), F(7, 2), F(0),
+                          F(-m, m - 1)};
+  std::sort(v.begin(), v.end());
+  CHECK(std::is_sorted(v.begin(), v.end()));
+  CHECK(v.front() == F(-m, m - 1));
+  CHECK(*std::lower_bound(v.begin(), v.end(), F(1, 2)) == F(m - 1, m));
+}
+
+TEST_CASE("Fraction from_float, limit_denominator and to_double") {
+  using F = Fraction<int64_t>;
+  CHECK(F::from_float(0.5) == F(1, 2));
+  CHECK(F::from_float(-3.25) == F(-13, 4));
+  CHECK(F::from_float(0.0) == F(0));
+  CHECK(F::from_float(1e18) == F(1000000000000000000));
+  CHECK(F::from_float(0.1) == F(3602879701896397, int64_t(1) << 55));
+  CHECK(F::from_float(std::numeric_limits<double>::infinity()) == F(1, 0));
+  CHECK(F::from_float(-std::numeric_limits<double>::infinity()) == F(-1, 0));
+  CHECK(F::from_float(std::nan("")) == F(0, 0));
+  CHECK_THROWS_AS(F::from_float(1e300), std::overflow_error);
+  CHECK_THROWS_AS(F::from_float(1e-30), std::overflow_error);
+  CHECK_THROWS_AS(Fraction<int>::from_float(0.1), std::overflow_error);
+  CHECK(Fraction<int>::from_float(-0.375) == Fraction<int>(-3, 8));
+
+  // Python: Fraction('3.141592653589793').limit_denominator(1000) == 355/113
+  const auto pi = F::from_float(3.141592653589793);
+  CHECK(pi.limit_denominator(1000) == F(355, 113));
+  CHECK(pi.limit_denominator(100) == F(311, 99));
+  CHECK(pi.limit_denominator(10) == F(22, 7));
+  CHECK(pi.limit_denominator(1) == F(3));
+  CHECK((-pi).limit_denominator(1000) == F(-355, 113));
+  CHECK(F::from_float(0.1).limit_denominator(1000000) == F(1, 10));
+  CHECK(F(1, 3).limit_denominator(5) == F(1, 3));
+  CHECK(F(4321, 8765).limit_denominator(10000) == F(4321, 8765));
+  CHECK(F(4321, 8765).limit_denominator(100) == F(35, 71));
+  CHECK_THROWS_AS(pi.limit_denominator(0), std::invalid_argument);
+  CHECK(LazyFraction<int64_t>(2, 6).limit_denominator(3) ==
+        LazyFraction<int64_t>(1, 3));
+
+  CHECK(F(1, 3).to_double() == 1.0 / 3.0);
+  CHECK(F(7).to_double() == 7.0);
+  CHECK(F(-1, 4).to_double() == -0.25);
+  CHECK(pi.to_double() == 3.141592653589793);
+  CHECK(F::from_float(0.1).to_double() == 0.1);
+  CHECK(std::isinf(F(1, 0).to_double()));
+  CHECK(std::isnan(F(0, 0).to_double()));
+  // both parts above 2^53: a naive double(n) / double(d) is off by one ulp
+  const auto m = std::numeric_limits<int64_t>::max();
+  CHECK(F(m - 1, m).to_double() == 1.0);
+  CHECK(F(1, m).to_double() == std::ldexp(1.0, -63));
+  CHECK(F((int64_t(1) << 62) + 1, 3).to_double() ==
+        std::ldexp(1.0, 62) / 3.0);
+  CHECK(F(9007199254740993, 9007199254740992 / 2 + 1).to_double() ==
+        1.9999999999999998);
+}
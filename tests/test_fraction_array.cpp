@@ -0,0 +1,95 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <limits>
+#include <py2cpp/fraction_array.hpp>
+#include <stdexcept>
+#include <vector>
+
+using namespace fun;
+
+TEST_CASE("FractionArray storage") {
+  auto xs = FractionArray<int>{{2, 4}, {3, -9}};
+  CHECK(xs.size() == 2);
+  CHECK(xs._nums == std::vector<int>{1, -1});
+  CHECK(xs._dens == std::vector<int>{2, 3});
+  xs.push_back(6, 8);
+  CHECK(xs[2] == Fraction<int>(3, 4));
+  xs.set(0, Fraction<int>(5));
+  CHECK(xs[0] == Fraction<int>(5));
+  CHECK(FractionArray<int>(3)[1] == Fraction<int>(0));
+}
+
+TEST_CASE("FractionArray reductions") {
+  auto xs = FractionArray<int64_t>{};
+  auto expected = Fraction<int64_t>{};
+  for (auto k = int64_t{1}; k <= 40; ++k) {
+    xs.push_back(Fraction<int64_t>(1, k));
+    expected += Fraction<int64_t>(1, k);
+  }
+  CHECK(sum(xs) == expected);
+  // the unreduced accumulator leaves int long before the reduced one
+  auto hs = FractionArray<int>{};
+  auto h = Fraction<int>{};
+  for (auto k = 1; k <= 20; ++k) {
+    hs.push_back(Fraction<int>(1, k));
+    h += Fraction<int>(1, k);
+  }
+  CHECK(sum(hs) == h);
+
+#if defined(PY2CPP_HAS_INT128)
+  // shared denominator: the numerators are summed without any gcd
+  const auto m = std::numeric_limits<int64_t>::max();
+  auto ys = FractionArray<int64_t>{};
+  ys.push_back(Fraction<int64_t>(m - 1, m));
+  ys.push_back(Fraction<int64_t>(m - 1, m));
+  ys.push_back(Fraction<int64_t>(2 - m, m));
+  CHECK(sum(ys) == Fraction<int64_t>(1)); // partial sums exceed int64_t
+#endif
+  CHECK(sum(FractionArray<int64_t>{}) == Fraction<int64_t>(0));
+
+  const auto a = FractionArray<int>{{1, 2}, {2, 3}, {-3, 4}};
+  const auto b = FractionArray<int>{{2, 1}, {3, 5}, {4, 9}};
+  CHECK(dot(a, b) == Fraction<int>(1) + Fraction<int>(2, 5) -
+                         Fraction<int>(1, 3));
+  const auto c = FractionArray<int>{{1, 7}, {3, 7}, {-2, 7}};
+  const auto d = FractionArray<int>{{5, 3}, {1, 3}, {4, 3}};
+  CHECK(dot(c, d) == Fraction<int>(5 + 3 - 8, 21));
+
+  const auto inf = FractionArray<int>{{1, 2}, {1, 0}};
+  CHECK(sum(inf) == Fraction<int>(1, 0));
+  CHECK(sum(FractionArray<int>{{1, 0}, {-1, 0}}) == Fraction<int>(0, 0));
+
+  CHECK_THROWS_AS(dot(a, FractionArray<int>(2)), std::invalid_argument);
+}
+
+TEST_CASE("FractionArray elementwise kernels") {
+  const auto a = FractionArray<int>{{1, 2}, {2, 3}, {-3, 4}};
+  const auto b = FractionArray<int>{{1, 2}, {3, 5}, {4, 9}};
+
+  const auto s = add(a, b);
+  CHECK(s[0] == Fraction<int>(1));
+  CHECK(s[1] == Fraction<int>(19, 15));
+  CHECK(s[2] == Fraction<int>(-11, 36));
+
+  const auto p = mul(a, b);
+  CHECK(p[1] == Fraction<int>(2, 5));
+
+  const auto k = scale(a, Fraction<int>(4, 3));
+  CHECK(k[0] == Fraction<int>(2, 3));
+  CHECK(k[2] == Fraction<int>(-1));
+
+  auto y = b;
+  axpy(Fraction<int>(2), a, y);
+  CHECK(y[0] == Fraction<int>(3, 2));
+  CHECK(y[2] == Fraction<int>(-3, 2) + Fraction<int>(4, 9));
+
+  CHECK(compare(a, b) == std::vector<int>{0, 1, -1});
+  const auto big = FractionArray<unsigned>{{1U, 3U}, {2U, 3U}};
+  const auto small = FractionArray<unsigned>{{1U, 2U}, {1U, 2U}};
+  CHECK(compare(big, small) == std::vector<int>{-1, 1});
+  CHECK(sum(big) == Fraction<unsigned>(1U));
+}
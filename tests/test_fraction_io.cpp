@@ -0,0 +1,203 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <py2cpp/fraction_io.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace fun;
+
+namespace {
+
+template <typename Z, typename Policy>
+auto str(const Fraction<Z, Policy> &f) -> std::string {
+  char buf[fraction_chars_max<Z>()];
+  const auto res = to_chars(buf, buf + sizeof buf, f);
+  REQUIRE(res.ec == std::errc{});
+  return std::string(buf, res.ptr);
+}
+
+template <typename Z = int64_t>
+auto parse(const std::string &s, std::errc ec = std::errc{})
+    -> Fraction<Z> {
+  auto f = Fraction<Z>(-99);
+  const auto res = from_chars(s.data(), s.data() + s.size(), f);
+  CHECK(res.ec == ec);
+  if (ec == std::errc{}) {
+    CHECK(res.ptr == s.data() + s.size());
+  }
+  return f;
+}
+
+} // namespace
+
+TEST_CASE("Fraction to_chars") {
+  CHECK(str(Fraction<int>(3, 4)) == "3/4");
+  CHECK(str(Fraction<int>(6, -8)) == "-3/4");
+  CHECK(str(Fraction<int>(7)) == "7");
+  CHECK(str(Fraction<int>(0)) == "0");
+  CHECK(str(Fraction<int, LazyNormalize>(6, 8)) == "3/4");
+  CHECK(str(Fraction<uint32_t>(4294967295U, 2)) == "4294967295/2");
+
+  const auto m = std::numeric_limits<int64_t>::min();
+  const auto big = Fraction<int64_t>(m, std::numeric_limits<int64_t>::max());
+  CHECK(str(big) == "-9223372036854775808/9223372036854775807");
+  CHECK(str(big).size() < fraction_chars_max<int64_t>());
+
+  // infinities and nan print as they read back
+  CHECK(str(Fraction<int>(1, 0)) == "1/0");
+  CHECK(str(Fraction<int>(-5, 0)) == "-1/0");
+  CHECK(str(Fraction<int>(0, 0)) == "0/0");
+
+  char small[4];
+  const auto res = to_chars(small, small + 4, Fraction<int>(123, 45));
+  CHECK(res.ec == std::errc::value_too_large);
+  CHECK(res.ptr == small + 4);
+  CHECK(to_chars(small, small + 4, Fraction<int>(1, 100)).ptr == small + 4);
+  CHECK(to_chars(small, small, Fraction<int>(0)).ec ==
+        std::errc::value_too_large);
+}
+
+TEST_CASE("Fraction from_chars") {
+  CHECK(parse("3/4") == Fraction<int64_t>(3, 4));
+  CHECK(parse("-6/8") == Fraction<int64_t>(-3, 4));
+  CHECK(parse("+7") == Fraction<int64_t>(7));
+  CHECK(parse("(3/4)") == Fraction<int64_t>(3, 4));
+  CHECK(parse("1_000/3") == Fraction<int64_t>(1000, 3));
+
+  // decimals and exponents, as Python's Fraction(str)
+  CHECK(parse("1.5") == Fraction<int64_t>(3, 2));
+  CHECK(parse("-.5") == Fraction<int64_t>(-1, 2));
+  CHECK(parse("5.") == Fraction<int64_t>(5));
+  CHECK(parse("1e-3") == Fraction<int64_t>(1, 1000));
+  CHECK(parse("2.5E+2") == Fraction<int64_t>(250));
+  CHECK(parse("0.000") == Fraction<int64_t>(0));
+  CHECK(parse("0e999999") == Fraction<int64_t>(0));
+  // trailing zeros are scaled away, not accumulated
+  CHECK(parse("1.50000000000000000000000000") == Fraction<int64_t>(3, 2));
+  CHECK(parse("100000000000000000000e-20") == Fraction<int64_t>(1));
+
+  CHECK(parse("1/0") == Fraction<int64_t>(1, 0));
+  CHECK(parse("-1/0") == Fraction<int64_t>(-1, 0));
+
+  const auto min32 = std::numeric_limits<int32_t>::min();
+  CHECK(parse<int32_t>("-2147483648") == Fraction<int32_t>(min32));
+  CHECK(parse<int32_t>("-2147483648/1") == Fraction<int32_t>(min32));
+  CHECK(parse<uint32_t>("4294967295/2") == Fraction<uint32_t>(4294967295U, 2));
+  CHECK(parse<uint32_t>("-0") == Fraction<uint32_t>(0));
+
+  // prefix semantics: stop at the first character that is not part of it
+  const auto s = std::string("3/4, 5");
+  auto f = Fraction<int>{};
+  auto res = from_chars(s.data(), s.data() + s.size(), f);
+  CHECK(res.ec == std::errc{});
+  CHECK(res.ptr == s.data() + 3);
+  CHECK(f == Fraction<int>(3, 4));
+  const auto t = std::string("3/x");
+  res = from_chars(t.data(), t.data() + t.size(), f);
+  CHECK(res.ptr == t.data() + 1);
+  CHECK(f == Fraction<int>(3));
+}
+
+TEST_CASE("Fraction from_chars errors") {
+  CHECK(parse("", std::errc::invalid_argument) == Fraction<int64_t>(-99));
+  CHECK(parse(" 1", std::errc::invalid_argument) == Fraction<int64_t>(-99));
+  parse(".", std::errc::invalid_argument);
+  parse("-", std::errc::invalid_argument);
+  parse("/2", std::errc::invalid_argument);
+  parse("_1", std::errc::invalid_argument);
+  parse("(1/2", std::errc::invalid_argument);
+  parse("e5", std::errc::invalid_argument);
+
+  parse<int32_t>("2147483648", std::errc::result_out_of_range);
+  parse<int32_t>("-2147483649", std::errc::result_out_of_range);
+  parse<uint32_t>("-1", std::errc::result_out_of_range);
+  parse<uint32_t>("1/4294967296", std::errc::result_out_of_range);
+  parse("1e19", std::errc::result_out_of_range);
+  parse("1e-19", std::errc::result_out_of_range);
+  parse("99999999999999999999999", std::errc::result_out_of_range);
+  parse("1e99999999999999999999999", std::errc::result_out_of_range);
+
+  const auto s = std::string("3e10 ");
+  auto f = Fraction<int32_t>{};
+  const auto res = from_chars(s.data(), s.data() + s.size(), f);
+  CHECK(res.ec == std::errc::result_out_of_range);
+  CHECK(res.ptr == s.data() + 4);
+}
+
+TEST_CASE("parse_fraction") {
+  CHECK(parse_fraction<int>(" 3/4\n") == Fraction<int>(3, 4));
+  CHECK(parse_fraction<int>(" -1.5 ") == Fraction<int>(-3, 2));
+  CHECK(parse_fraction<int, LazyNormalize>("2/4") ==
+        Fraction<int, LazyNormalize>(1, 2));
+  CHECK_THROWS_AS(parse_fraction<int>("3/4x"), std::invalid_argument);
+  CHECK_THROWS_AS(parse_fraction<int>("   "), std::invalid_argument);
+  CHECK_THROWS_AS(parse_fraction<int>("3 / 4"), std::invalid_argument);
+  CHECK_THROWS_AS(parse_fraction<int>("1e10"), std::overflow_error);
+
+  // round trip, through both textual forms
+  for (const auto &f : {Fraction<int64_t>(-22, 7), Fraction<int64_t>(0),
+                        Fraction<int64_t>(1, 0), Fraction<int64_t>(12345)}) {
+    CHECK(parse_fraction<int64_t>(str(f)) == f);
+    auto os = std::ostringstream{};
+    os << f;
+    CHECK(parse_fraction<int64_t>(os.str()) == f);
+  }
+}
+
+TEST_CASE("FractionWriter and FractionReader") {
+  auto *file = std::tmpfile();
+  REQUIRE(file != nullptr);
+
+  auto xs = FractionArray<int64_t>{};
+  for (auto k = int64_t{1}; k <= 5000; ++k) {
+    xs.push_back(Fraction<int64_t>(k * (k % 2 == 0 ? 1 : -1), 3 * k + 1));
+  }
+  {
+    FractionWriter w(file, ',', 256); // forces many flushes
+    w.write_all(xs);
+    w.write(Fraction<int, LazyNormalize>(2, 4));
+    w.write_all(std::vector<Fraction<int>>{Fraction<int>(7)});
+    w.flush();
+  }
+  std::fputs(" 1.25;\n\n-3/4", file);
+  std::rewind(file);
+
+  auto ys = FractionArray<int64_t>{};
+  FractionReader r(file, 256);
+  CHECK(r.read_all(ys) == 5004);
+  REQUIRE(ys.size() == 5004);
+  for (size_t i = 0; i != xs.size(); ++i) {
+    CHECK(ys[i] == xs[i]);
+  }
+  CHECK(ys[5000] == Fraction<int64_t>(1, 2));
+  CHECK(ys[5001] == Fraction<int64_t>(7));
+  CHECK(ys[5002] == Fraction<int64_t>(5, 4));
+  CHECK(ys[5003] == Fraction<int64_t>(-3, 4));
+  auto f = Fraction<int64_t>{};
+  CHECK(!r.read(f));
+  std::fclose(file);
+
+  // a token longer than the buffer, then a malformed and a too large one
+  file = std::tmpfile();
+  REQUIRE(file != nullptr);
+  const auto digits = "1" + std::string(400, '0') + "e-400";
+  std::fputs((digits + " 1/2x 3e10").c_str(), file);
+  std::rewind(file);
+  FractionReader reader(file, 16);
+  auto g = Fraction<int32_t>{};
+  CHECK(reader.read(g));
+  CHECK(g == Fraction<int32_t>(1));
+  CHECK_THROWS_AS(reader.read(g), std::invalid_argument);
+  CHECK_THROWS_AS(reader.read(g), std::overflow_error);
+  CHECK(!reader.read(g));
+  std::fclose(file);
+}
@@ -0,0 +1,84 @@
+#include <doctest/doctest.h> // for ResultBuilder, TestCase, CHECK, TEST_CASE
+
+#include <cstdint>               // for uint64_t, uint32_t
+#include <cstdio>                // for remove
+#include <cstring>               // for memcpy
+#include <py2cpp/dict.hpp>        // for dict
+#include <py2cpp/enumerate.hpp>   // for const_enumerate
+#include <py2cpp/frozen_dict.hpp> // for frozen_dict, len, operator<
+#include <py2cpp/frozen_set.hpp>  // for frozen_set
+#include <py2cpp/range.hpp>       // for range
+#include <stdexcept>              // for runtime_error, out_of_range
+#include <vector>                 // for vector
+
+TEST_CASE("Test frozen_dict") {
+  const auto D = py::frozen_dict<int, double>{{1, 0.5}, {2, 1.5}, {1, 2.5}};
+  CHECK(py::len(D) == 2);
+  CHECK(D[1] == 2.5); // later duplicate wins
+  CHECK(D.contains(2));
+  CHECK(2 < D);
+  CHECK(D.get(3) == nullptr);
+  CHECK(D.get(3, -1.0) == -1.0);
+  CHECK_THROWS_AS(D.at(3), std::out_of_range);
+
+  auto n = 0;
+  for (const auto &key : D) {
+    n += key;
+  }
+  CHECK(n == 3);
+  auto total = 0.0;
+  for (const auto &e : D.items()) {
+    total += e.second;
+  }
+  CHECK(total == 4.0);
+  CHECK(D == D.copy());
+  CHECK(D != py::frozen_dict<int, double>{{1, 2.5}, {2, 0.0}});
+
+  const auto W = std::vector<int>{10, 20, 30};
+  const auto E = py::frozen_dict<size_t, int>(py::const_enumerate(W));
+  CHECK(E[2] == 30);
+
+  const auto F = py::frozen_dict<int, int>::fromkeys(py::range(5), 7);
+  CHECK(py::len(F) == 5);
+  CHECK(F[4] == 7);
+}
+
+TEST_CASE("Test frozen_dict (save and open)") {
+  auto src = py::dict<uint64_t, uint32_t>{};
+  for (uint32_t i = 0; i != 20000; ++i) {
+    src[uint64_t(i) * 7919] = i;
+  }
+  const auto D = py::frozen_dict<uint64_t, uint32_t>(src.items());
+  CHECK(py::len(D) == 20000);
+
+  const char *path = "test_frozen_dict.bin";
+  D.save(path);
+  {
+    const auto M = py::frozen_dict<uint64_t, uint32_t>::open(path);
+    CHECK(py::len(M) == 20000);
+    auto hits = 0;
+    for (const auto &kv : src.items()) {
+      const auto *v = M.get(kv.first);
+      hits += v != nullptr && *v == kv.second ? 1 : 0;
+    }
+    CHECK(hits == 20000);
+    CHECK(M.get(1) == nullptr);
+    CHECK(M == D);
+
+    // wrong value type
+    CHECK_THROWS_AS((py::frozen_dict<uint64_t, uint64_t>::open(path)),
+                    std::runtime_error);
+    // a frozen_set image is not a frozen_dict image
+    CHECK_THROWS_AS(py::frozen_set<uint64_t>::open(path), std::runtime_error);
+  }
+  std::remove(path);
+
+  // corrupted magic
+  auto bytes = std::vector<unsigned char>(D.nbytes() + 64);
+  auto *p = bytes.data() + 64; // keep the copy suitably aligned
+  std::memcpy(p, D.data(), D.nbytes());
+  CHECK(py::frozen_dict<uint64_t, uint32_t>::view(p, D.nbytes())[7919] == 1);
+  p[0] = 'x';
+  CHECK_THROWS_AS((py::frozen_dict<uint64_t, uint32_t>::view(p, D.nbytes())),
+                  std::runtime_error);
+}
@@ -0,0 +1,66 @@
+#include <doctest/doctest.h> // for ResultBuilder, TestCase, CHECK, TEST_CASE
+
+#include <cstdint>              // for uint64_t, uint32_t
+#include <cstdio>               // for remove
+#include <py2cpp/frozen_set.hpp> // for frozen_set, len, operator<
+#include <py2cpp/range.hpp>      // for range
+#include <stdexcept>             // for runtime_error
+#include <vector>                // for vector
+
+TEST_CASE("Test frozen_set") {
+  const auto S = py::frozen_set<int>{1, 3, 5, 3, 1};
+  CHECK(py::len(S) == 3);
+  CHECK(S.contains(3));
+  CHECK(!S.contains(2));
+  CHECK(5 < S);
+  CHECK(S.count(1) == 1);
+  CHECK(S.find(4) == S.end());
+
+  auto n = 0;
+  for (const auto &key : S) {
+    n += key;
+  }
+  CHECK(n == 9);
+
+  const auto T = py::frozen_set<int>(py::range(10));
+  CHECK(S.issubset(T));
+  CHECK(T.issuperset(S));
+  CHECK(!S.isdisjoint(T));
+  CHECK(S == S.copy());
+  CHECK(S != T);
+  CHECK(py::frozen_set<int>{}.empty());
+}
+
+TEST_CASE("Test frozen_set (save and open)") {
+  auto keys = std::vector<uint64_t>{};
+  for (uint64_t i = 0; i != 10000; ++i) {
+    keys.push_back(i * 0x9e3779b97f4a7c15ULL);
+  }
+  const auto S = py::frozen_set<uint64_t>(keys.begin(), keys.end());
+  CHECK(py::len(S) == 10000);
+
+  const char *path = "test_frozen_set.bin";
+  S.save(path);
+  {
+    const auto M = py::frozen_set<uint64_t>::open(path);
+    CHECK(py::len(M) == 10000);
+    auto hits = 0;
+    for (const auto &key : keys) {
+      hits += M.contains(key) ? 1 : 0;
+    }
+    CHECK(hits == 10000);
+    CHECK(!M.contains(1));
+    CHECK(M == S);
+
+    // wrong key type
+    CHECK_THROWS_AS(py::frozen_set<uint32_t>::open(path), std::runtime_error);
+  }
+  std::remove(path);
+  CHECK_THROWS_AS(py::frozen_set<uint64_t>::open(path), std::runtime_error);
+
+  // in-memory image, e.g. embedded in a larger mapping
+  const auto V = py::frozen_set<uint64_t>::view(S.data(), S.nbytes());
+  CHECK(V.contains(keys[123]));
+  CHECK_THROWS_AS(py::frozen_set<uint64_t>::view(S.data(), 16),
+                  std::runtime_error);
+}
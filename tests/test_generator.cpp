@@ -0,0 +1,83 @@
+#include <doctest/doctest.h> // for ResultBuilder, CHECK, TestCase, TEST...
+
+#include <py2cpp/generator.hpp> // for generator, PY2CPP_HAS_COROUTINE
+#include <py2cpp/itertools.hpp> // for islice, map, sum
+
+#if defined(PY2CPP_HAS_COROUTINE)
+
+#include <stdexcept> // for runtime_error
+#include <utility>   // for exchange
+#include <vector>    // for vector
+
+namespace {
+
+auto fib() -> py::generator<long> {
+  auto a = 0L;
+  auto b = 1L;
+  while (true) {
+    co_yield a;
+    a = std::exchange(b, a + b);
+  }
+}
+
+auto count_to(int n, int &resumed) -> py::generator<int> {
+  for (auto i = 0; i != n; ++i) {
+    ++resumed;
+    co_yield i;
+  }
+}
+
+auto failing() -> py::generator<int> {
+  co_yield 1;
+  throw std::runtime_error("boom");
+}
+
+} // namespace
+
+TEST_CASE("Test generator") {
+  auto out = std::vector<long>{};
+  for (auto x : py::islice(fib(), 10)) {
+    out.push_back(x);
+  }
+  CHECK(out == std::vector<long>{0, 1, 1, 2, 3, 5, 8, 13, 21, 34});
+  CHECK(py::sum(py::islice(fib(), 10)) == 88);
+  CHECK(py::sum(py::map([](long x) { return x * 2; }, py::islice(fib(), 5))) ==
+        14);
+}
+
+TEST_CASE("Test generator (lazy, single pass)") {
+  auto resumed = 0;
+  auto g = count_to(5, resumed);
+  CHECK(resumed == 0); // nothing runs before iteration
+  for (auto x : g) {
+    if (x == 1) {
+      break;
+    }
+  }
+  CHECK(resumed == 2);
+  auto rest = std::vector<int>{};
+  for (auto x : g) {
+    rest.push_back(x);
+  }
+  CHECK(rest == std::vector<int>{2, 3, 4}); // continues, like Python
+  CHECK(g.begin() == g.end());
+
+  resumed = 0;
+  CHECK(py::sum(py::islice(count_to(100, resumed), 3)) == 3);
+  CHECK(resumed == 3); // islice does not pull a fourth element
+}
+
+TEST_CASE("Test generator (exceptions and frames)") {
+  auto g = failing();
+  auto it = g.begin();
+  CHECK(*it == 1);
+  CHECK_THROWS_AS(++it, std::runtime_error);
+
+  auto total = 0L;
+  for (auto i = 0; i != 1000; ++i) { // frames are recycled from the pool
+    total += py::sum(py::islice(fib(), 3));
+  }
+  CHECK(total == 2000);
+}
+
+#endif
@@ -0,0 +1,148 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <limits>
+#include <py2cpp/fractions.hpp>
+#include <py2cpp/hybrid_int.hpp>
+#include <stdexcept>
+
+#if defined(PY2CPP_HAS_INT128)
+
+__extension__ typedef __int128 int128;
+using Z = fun::hybrid_int<int128>;
+
+TEST_CASE("hybrid_int promotes and demotes") {
+  const auto m = std::numeric_limits<int64_t>::max();
+  auto a = Z{m};
+  CHECK(a.is_small());
+  auto b = a + 1;
+  CHECK(!b.is_small());
+  CHECK(b.to_big() == int128(m) + 1);
+  CHECK(b > a);
+  CHECK(b != a);
+  b -= 1;
+  CHECK(b.is_small());
+  CHECK(b == a);
+
+  const auto sq = a * a;
+  CHECK(!sq.is_small());
+  CHECK(sq / a == a);
+  CHECK((sq / a).is_small());
+  CHECK(sq % a == 0);
+  CHECK(sq % (a - 1) == Z{1});
+
+  const auto lo = Z{std::numeric_limits<int64_t>::min()};
+  CHECK(!(-lo).is_small());
+  CHECK(-(-lo) == lo);
+  CHECK(lo / Z{-1} == -lo);
+  CHECK(lo % Z{-1} == 0);
+  CHECK(gcd(lo, Z{0}) == -lo);
+  CHECK(gcd(Z{12}, Z{-18}) == 6);
+  CHECK(gcd(sq, a * 6) == a);
+  CHECK_THROWS_AS(a / 0, std::domain_error);
+
+  auto c = a;
+  c = sq;
+  CHECK(c == sq);
+  c = Z{3};
+  CHECK(c.is_small());
+  CHECK(c == 3);
+}
+
+TEST_CASE("Fraction<hybrid_int>") {
+  using F = fun::Fraction<Z>;
+  const auto p = F{Z{3}, Z{4}};
+  const auto q = F{Z{5}, Z{6}};
+  CHECK(p + q == F(Z{19}, Z{12}));
+  CHECK((p - q) + q == p);
+  CHECK(p * q == F(Z{5}, Z{8}));
+  CHECK(p / q == F(Z{9}, Z{10}));
+  CHECK(p < q);
+  CHECK(q > p);
+  CHECK(p.cross(q) == Z{-2});
+
+  // square a fraction with a 62-bit numerator: promotes, then divides back
+  auto f = F{Z{int64_t{1} << 61}, Z{3}};
+  auto g = f;
+  g *= f;
+  CHECK(!g.num().is_small());
+  CHECK(g.den() == 9);
+  g /= f;
+  CHECK(g == f);
+  CHECK(g.num().is_small());
+  g += Z{1};
+  g -= f;
+  CHECK(g == F{Z{1}});
+  CHECK(g + f > f);
+}
+
+#endif
+
+// GCC reports false maybe-uninitialized warnings inside cpp_int's limbs
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#if defined(__has_include)
+#if __has_include(<boost/multiprecision/cpp_int.hpp>)
+#include <boost/multiprecision/cpp_int.hpp>
+#define PY2CPP_TEST_HAS_CPP_INT 1
+#endif
+#endif
+
+#if defined(PY2CPP_TEST_HAS_CPP_INT)
+
+using cpp_int = boost::multiprecision::cpp_int;
+using B = fun::hybrid_int<cpp_int>;
+
+TEST_CASE("hybrid_int<cpp_int> beyond 128 bits") {
+  const auto m = std::numeric_limits<int64_t>::max();
+  auto a = B{m};
+  auto big = a * a * a * a; // ~2^252: only a true bignum holds it
+  CHECK(!big.is_small());
+  CHECK(big.to_big() == cpp_int(m) * m * m * m);
+  CHECK(big / (a * a) == a * a);
+  CHECK((big / (a * a * a)).is_small());
+  CHECK(big % a == 0);
+  CHECK(gcd(big, a * a * 6) == a * a);
+  CHECK(gcd(-big, B{0}) == big);
+  CHECK(gcd(B{12}, B{-18}) == 6);
+  CHECK(-(-big) == big);
+}
+
+TEST_CASE("Fraction<hybrid_int<cpp_int>>") {
+  using F = fun::Fraction<B>;
+  const auto p = F{B{3}, B{4}};
+  const auto q = F{B{5}, B{6}};
+  CHECK(p + q == F(B{19}, B{12}));
+  CHECK(p - q == F(B{-1}, B{12}));
+  CHECK(p * q == F(B{5}, B{8}));
+  CHECK(p / q == F(B{9}, B{10}));
+  CHECK(p < q);
+
+  // (2/3)^64 has 102-bit terms, (2/3)^128 has 203-bit ones
+  auto f = F{B{2}, B{3}};
+  for (auto i = 0; i != 7; ++i) {
+    f *= f;
+  }
+  CHECK(!f.num().is_small());
+  CHECK(f.num().to_big() == cpp_int(1) << 128);
+  auto g = f;
+  g += F{B{1}};
+  CHECK(g > f);
+  g -= f;
+  CHECK(g == F{B{1}});
+  CHECK(g.num().is_small());
+  CHECK(f / f == F{B{1}});
+  CHECK((f * F{B{3}, B{2}}) / f == F{B{3}, B{2}});
+}
+
+#endif
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
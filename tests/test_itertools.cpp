@@ -0,0 +1,114 @@
+#include <doctest/doctest.h> // for ResultBuilder, CHECK, TestCase, TEST...
+
+#include <forward_list>         // for forward_list
+#include <py2cpp/enumerate.hpp> // for enumerate
+#include <py2cpp/fractions.hpp> // for Fraction
+#include <py2cpp/itertools.hpp> // for map, filter, islice, chain, sum
+#include <py2cpp/range.hpp>     // for range
+#include <stdexcept>            // for invalid_argument
+#include <string>               // for string
+#include <vector>               // for vector
+
+TEST_CASE("Test map and filter") {
+  const auto xs = std::vector<int>{1, 2, 3, 4, 5, 6};
+  const auto even = [](int x) { return x % 2 == 0; };
+  const auto square = [](int x) { return x * x; };
+  // sum(x * x for x in xs if x % 2 == 0)
+  CHECK(py::sum(py::map(square, py::filter(even, xs))) == 4 + 16 + 36);
+
+  auto calls = 0;
+  const auto counted = [&calls](int x) {
+    ++calls;
+    return x + 1;
+  };
+  auto out = std::vector<int>{};
+  for (auto y : py::map(counted, py::range(3))) {
+    out.push_back(y);
+  }
+  CHECK(out == std::vector<int>{1, 2, 3});
+  CHECK(calls == 3); // once per element, no temporary
+  CHECK(py::map(counted, xs).size() == 6);
+}
+
+TEST_CASE("Test filter (write through)") {
+  auto xs = std::vector<int>{1, 2, 3, 4};
+  for (auto &x : py::filter([](int x) { return x > 2; }, xs)) {
+    x = 0;
+  }
+  CHECK(xs == std::vector<int>{1, 2, 0, 0});
+  CHECK(py::sum(py::filter([](int) { return false; }, xs)) == 0);
+}
+
+TEST_CASE("Test islice") {
+  const auto s = std::string("ABCDEFG");
+  auto res = std::string{};
+  for (auto c : py::islice(s, 2)) {
+    res += c;
+  }
+  CHECK(res == "AB");
+  res.clear();
+  for (auto c : py::islice(s, 2, 4)) {
+    res += c;
+  }
+  CHECK(res == "CD");
+  res.clear();
+  for (auto c : py::islice(s, 0, 100, 2)) {
+    res += c;
+  }
+  CHECK(res == "ACEG");
+  CHECK(py::islice(s, 0, 100, 2).size() == 4);
+  CHECK(py::islice(s, 5, 3).size() == 0);
+  CHECK(py::sum(py::islice(py::range(1000000), 3, 6)) == 3 + 4 + 5);
+  CHECK_THROWS_AS(py::islice(s, 0, 5, 0), std::invalid_argument);
+}
+
+TEST_CASE("Test chain") {
+  auto xs = std::vector<int>{1, 2};
+  auto ys = std::vector<int>{};
+  auto zs = std::vector<int>{3};
+  auto count = 0;
+  for (auto &x : py::chain(xs, ys, zs)) {
+    x *= 10;
+    ++count;
+  }
+  CHECK(count == 3);
+  CHECK(xs == std::vector<int>{10, 20});
+  CHECK(zs == std::vector<int>{30});
+  CHECK(py::chain(xs, ys, zs).size() == 3);
+
+  // mixed iterables yield their common value type
+  const auto L = std::forward_list<int>{7, 8};
+  auto out = std::vector<int>{};
+  for (auto x : py::chain(py::range(2), L, ys)) {
+    out.push_back(x);
+  }
+  CHECK(out == std::vector<int>{0, 1, 7, 8});
+  CHECK(py::sum(py::chain(ys, ys)) == 0);
+}
+
+TEST_CASE("Test sum, any and all") {
+  const auto xs = std::vector<int>{3, -1, 4};
+  CHECK(py::sum(xs) == 6);
+  CHECK(py::sum(xs, 10) == 16);
+  CHECK(py::any(py::map([](int x) { return x < 0; }, xs)));
+  CHECK(!py::all(py::map([](int x) { return x < 0; }, xs)));
+  CHECK(py::all(std::vector<int>{}));
+  CHECK(!py::any(std::vector<int>{}));
+
+  using F = fun::Fraction<int>;
+  const auto halves = py::map([](int k) { return F(1, 2 * k); },
+                              py::range(1, 4));
+  CHECK(py::sum(halves, F(0)) == F(11, 12));
+}
+
+TEST_CASE("Test itertools (composed)") {
+  const auto words = std::vector<std::string>{"a", "bb", "ccc", "dddd"};
+  const auto len = [](const std::string &w) { return w.size(); };
+  const auto odd = [](size_t n) { return n % 2 == 1; };
+  CHECK(py::sum(py::islice(py::filter(odd, py::map(len, words)), 1)) == 1U);
+  auto total = size_t(0);
+  for (const auto &p : py::enumerate(py::map(len, words))) {
+    total += p.first * p.second;
+  }
+  CHECK(total == 0 * 1 + 1 * 2 + 2 * 3 + 3 * 4);
+}
@@ -0,0 +1,146 @@
+#include <doctest/doctest.h> // for ResultBuilder, TestCase, CHECK, TEST_CASE
+
+#include <py2cpp/enumerate.hpp>    // for const_enumerate
+#include <py2cpp/hash.hpp>         // for string_hash
+#include <py2cpp/ordered_dict.hpp> // for ordered_dict
+#include <py2cpp/range.hpp>        // for range
+#include <string>                  // for string
+#include <utility>                 // for pair
+#include <vector>                  // for vector
+
+template <typename Dict> static auto keys_of(const Dict &D) {
+  auto res = std::vector<typename Dict::key_type>{};
+  for (const auto &k : D) {
+    res.push_back(k);
+  }
+  return res;
+}
+
+TEST_CASE("Test ordered_dict (insertion order)") {
+  auto D = py::ordered_dict<std::string, int>{{"b", 1}, {"a", 2}, {"c", 3}};
+  CHECK(keys_of(D) == std::vector<std::string>{"b", "a", "c"});
+  D["a"] = 20; // overwriting keeps the position
+  D["d"] = 4;
+  CHECK(keys_of(D) == std::vector<std::string>{"b", "a", "c", "d"});
+  CHECK(D.erase("b") == 1);
+  CHECK(D.erase("b") == 0);
+  D["b"] = 10; // re-inserting moves to the end
+  CHECK(keys_of(D) == std::vector<std::string>{"a", "c", "d", "b"});
+  CHECK(py::len(D) == 4);
+  CHECK(std::string("c") < D);
+
+  auto values = std::vector<int>{};
+  for (const auto &kv : D.items()) {
+    values.push_back(kv.second);
+  }
+  CHECK(values == std::vector<int>{20, 3, 4, 10});
+
+  // popitem() is LIFO
+  CHECK(D.popitem() == std::pair<std::string, int>{"b", 10});
+  CHECK(D.popitem() == std::pair<std::string, int>{"d", 4});
+  CHECK(keys_of(D) == std::vector<std::string>{"a", "c"});
+
+  // equality ignores the order, as in Python
+  const auto E = py::ordered_dict<std::string, int>{{"c", 3}, {"a", 20}};
+  CHECK(D == E);
+  CHECK(keys_of(D) != keys_of(E));
+  D["a"] = 1;
+  CHECK(D != E);
+}
+
+TEST_CASE("Test ordered_dict (grow and erase)") {
+  auto D = py::ordered_dict<int, int>{};
+  for (auto i = 0; i != 100000; ++i) {
+    D[i] = i * 2;
+  }
+  CHECK(py::len(D) == 100000);
+  CHECK(D.get(300, -1) == 600);
+  for (auto i = 0; i != 100000; ++i) {
+    if (i % 3 != 0) {
+      D.erase(i);
+    }
+  }
+  CHECK(py::len(D) == 33334);
+  CHECK(!D.contains(10));
+  CHECK(D.contains(99999));
+
+  auto prev = -1;
+  auto ordered = true;
+  auto count = 0;
+  for (const auto &kv : D.items()) {
+    ordered = ordered && kv.first > prev && kv.first % 3 == 0 &&
+              kv.second == 2 * kv.first;
+    prev = kv.first;
+    ++count;
+  }
+  CHECK(ordered);
+  CHECK(count == 33334);
+
+  // backwards, as reversed(d) in Python
+  const auto items = D.items();
+  auto it = items.end();
+  --it;
+  CHECK(it->first == 99999);
+  --it;
+  CHECK(it->first == 99996);
+
+  const auto C = D.copy();
+  CHECK(C == D);
+  D.clear();
+  CHECK(D.empty());
+  CHECK(D.items().begin() == D.items().end());
+  D[5] = 5;
+  CHECK(keys_of(D) == std::vector<int>{5});
+}
+
+TEST_CASE("Test ordered_dict (heterogeneous lookup)") {
+  using Dict =
+      py::ordered_dict<std::string, int, py::string_hash, std::equal_to<>>;
+  auto D = Dict{{"one", 1}, {"two", 2}};
+  const char *key = "two";
+  CHECK(D.contains(key));
+  CHECK(!D.contains("three"));
+  CHECK(D.get("one", 0) == 1);
+  D["three"] = 3;
+  D["three"] += 1;
+  CHECK(D.at("three") == 4);
+  CHECK(py::len(D) == 3);
+}
+
+TEST_CASE("Test ordered_dict (get, setdefault, pop, update)") {
+  auto D = py::ordered_dict<int, std::string>{{1, "x"}, {2, "y"}};
+  const auto fallback = std::string("none");
+  CHECK(D.get(1, fallback) == "x");
+  CHECK(&D.get(3, fallback) == &fallback);
+  REQUIRE(D.get(2) != nullptr);
+  CHECK(*D.get(2) == "y");
+  CHECK(D.get(3) == nullptr);
+
+  D.setdefault(3, "z") += "z";
+  CHECK(D.setdefault(3, "w") == "zz");
+
+  CHECK(D.pop(1) == "x");
+  CHECK(D.pop(1, "gone") == "gone");
+  CHECK_THROWS(D.pop(1));
+
+  auto E = py::ordered_dict<int, std::string>{{4, "W"}, {2, "Y"}};
+  D.update(std::move(E));
+  CHECK(D[2] == "Y");
+  CHECK(keys_of(D) == std::vector<int>{2, 3, 4});
+
+  while (!D.empty()) {
+    D.popitem();
+  }
+  CHECK_THROWS(D.popitem());
+}
+
+TEST_CASE("Test ordered_dict (bulk construction)") {
+  const auto W = std::vector<int>{10, 20, 30};
+  const auto D = py::ordered_dict<size_t, int>(py::const_enumerate(W));
+  CHECK(keys_of(D) == std::vector<size_t>{0, 1, 2});
+  CHECK(D[1] == 20);
+  const auto F = py::ordered_dict<int, int>::fromkeys(py::range(100), 7);
+  CHECK(py::len(F) == 100);
+  CHECK(F[99] == 7);
+  CHECK(*F.begin() == 0);
+}
@@ -0,0 +1,61 @@
+#include <doctest/doctest.h> // for ResultBuilder, TestCase, CHECK, TEST_CASE
+
+#include <atomic>              // for atomic
+#include <functional>          // for plus
+#include <py2cpp/parallel.hpp> // for parallel_for, parallel_reduce
+#include <py2cpp/range.hpp>    // for range
+#include <stdexcept>           // for runtime_error
+#include <vector>              // for vector
+
+TEST_CASE("Test parallel_for") {
+  py::thread_pool pool{3};
+  auto out = std::vector<int>(10000, 0);
+  py::parallel_for(pool, py::range(10000),
+                   [&out](int i) { out[static_cast<size_t>(i)] = 2 * i; });
+  auto ok = true;
+  for (auto i : py::range(10000)) {
+    ok = ok && out[static_cast<size_t>(i)] == 2 * i;
+  }
+  CHECK(ok);
+
+  // the shared pool, with a stepped range and an explicit grain
+  std::atomic<int> count{0};
+  py::parallel_for(py::range(0, 1000, 7), [&count](int) { ++count; }, 5);
+  CHECK(count == 143);
+}
+
+TEST_CASE("Test parallel_reduce") {
+  py::thread_pool pool{3};
+  const auto total = py::parallel_reduce(
+      pool, py::range(1, 100001), 0LL,
+      [](int i) { return static_cast<long long>(i); },
+      [](long long a, long long b) { return a + b; });
+  CHECK(total == 5000050000LL);
+
+  const auto V = std::vector<double>(1000, 0.5);
+  CHECK(py::parallel_reduce(
+            V, 0.0, [](double x) { return x; }, std::plus<double>{}) == 500.0);
+  CHECK(py::parallel_reduce(
+            py::range(0), 7, [](int i) { return i; }, std::plus<int>{}) == 7);
+}
+
+TEST_CASE("Test parallel_for (nested and exceptions)") {
+  py::thread_pool pool{2};
+  std::atomic<int> count{0};
+  py::parallel_for(
+      pool, py::range(8),
+      [&](int) {
+        py::parallel_for(pool, py::range(100), [&count](int) { ++count; }, 10);
+      },
+      1);
+  CHECK(count == 800);
+
+  CHECK_THROWS(py::parallel_for(
+      pool, py::range(1000),
+      [](int i) {
+        if (i == 500) {
+          throw std::runtime_error("boom");
+        }
+      },
+      10));
+}
@@ -1,7 +1,17 @@
 #include <doctest/doctest.h>
 
-#include <array>
+#include <algorithm>  // for lower_bound, reverse, equal
+#include <array>      // for array
+#include <cstdint>    // for uint8_t
+#include <functional> // for greater
+#include <iterator>   // for distance, prev, make_reverse_iterator
+#include <limits>     // for numeric_limits
 #include <py2cpp/range.hpp>
+#include <type_traits> // for is_same
+#include <vector>      // for vector
+#if defined(__cpp_lib_ranges)
+#include <ranges> // for random_access_range, sized_range
+#endif
 // #include <range/v3/view/all.hpp>
 // #include <range/v3/view/remove_if.hpp>
 // #include <transranger_view.hpp>
@@ -77,3 +87,112 @@ TEST_CASE("Test Range (pointer)") {
   }
   CHECK(count == R.size());
 }
+
+TEST_CASE("Test Range (step)") {
+  const auto R = py::range(1, 10, 3); // 1, 4, 7
+  CHECK(R.size() == 3);
+  CHECK(R[2] == 7);
+  CHECK(R.contains(4));
+  CHECK(!R.contains(5));
+  CHECK(!R.contains(10));
+
+  auto total = 0;
+  for (auto a : R) {
+    total += a;
+  }
+  CHECK(total == 12);
+  CHECK(py::range(0, 9, 3).size() == 3);
+  CHECK(py::range(5, 1, 2).empty());
+  CHECK_THROWS(py::range(0, 1, 0));
+  static_assert(py::range(0, 10, 2).size() == 5, "O(1) constexpr size");
+}
+
+TEST_CASE("Test Range (negative step)") {
+  const auto R = py::range(10, 0, -3); // 10, 7, 4, 1
+  CHECK(R.size() == 4);
+  CHECK(R[3] == 1);
+  CHECK(R.contains(7));
+  CHECK(!R.contains(0));
+  CHECK(!R.contains(11));
+
+  auto count = 0U;
+  auto last = 0;
+  for (auto a : R) {
+    last = a;
+    ++count;
+  }
+  CHECK(count == R.size());
+  CHECK(last == 1);
+
+  const auto C = py::range('z', 'a', -5);
+  CHECK(C[1] == 'u');
+  CHECK(C.size() == 5);
+}
+
+TEST_CASE("Test Range (random access)") {
+  const auto R = py::range(0, 100);
+  CHECK(std::distance(R.begin(), R.end()) == 100);
+  CHECK(*std::lower_bound(R.begin(), R.end(), 42) == 42);
+  CHECK(R.end() - R.begin() == 100);
+  CHECK(R.begin()[7] == 7);
+  CHECK(R.begin() < R.end());
+  CHECK(*(R.end() - 1) == 99);
+
+  const auto S = py::range(20, 0, -2); // 20, 18, ..., 2
+  CHECK(std::distance(S.begin(), S.end()) == 10);
+  CHECK(*std::lower_bound(S.begin(), S.end(), 7, std::greater<int>{}) == 6);
+  CHECK(*std::prev(S.end()) == 2);
+  auto rev = std::vector<int>(S.begin(), S.end());
+  std::reverse(rev.begin(), rev.end());
+  CHECK(std::equal(rev.begin(), rev.end(),
+                   std::make_reverse_iterator(S.end())));
+
+  using It = decltype(R.begin());
+  static_assert(std::is_same<std::iterator_traits<It>::iterator_category,
+                             std::random_access_iterator_tag>::value,
+                "random access");
+#if defined(__cpp_lib_ranges)
+  static_assert(std::ranges::random_access_range<decltype(R)>, "");
+  static_assert(std::ranges::sized_range<decltype(S)>, "");
+#endif
+}
+
+TEST_CASE("Test Range (step near the limits of T)") {
+  const auto imax = std::numeric_limits<int>::max();
+  const auto R = py::range(0, imax, 2); // 0, 2, ..., imax - 1
+  CHECK(R.size() == size_t(imax / 2) + 1);
+  CHECK(R[R.size() - 1] == imax - 1);
+  CHECK(*std::prev(R.end()) == imax - 1);
+  CHECK(R.end() - R.begin() == imax / 2 + 1);
+  CHECK(R.contains(imax - 1));
+  CHECK(!R.contains(imax));
+
+  const auto N = py::range(imax, std::numeric_limits<int>::min(), -imax);
+  CHECK(std::vector<int>(N.begin(), N.end()) ==
+        std::vector<int>{imax, 0, -imax});
+  CHECK(N.contains(-imax));
+  CHECK(!N.contains(std::numeric_limits<int>::min()));
+
+  const auto B = py::range(uint8_t{250}, uint8_t{255}, 3); // 250, 253
+  CHECK(B.size() == 2);
+  CHECK(B.contains(uint8_t{253}));
+  CHECK(!B.contains(uint8_t{254}));
+  CHECK(std::vector<uint8_t>(B.begin(), B.end()) ==
+        std::vector<uint8_t>{250, 253});
+  CHECK(py::range(uint8_t{0}, uint8_t{255}, 1).size() == 255);
+
+  const auto C = py::range(static_cast<signed char>(120),
+                           static_cast<signed char>(127), 5); // 120, 125
+  CHECK(C.size() == 2);
+  CHECK(C[1] == 125);
+  CHECK(C.contains(static_cast<signed char>(125)));
+  CHECK(std::distance(C.begin(), C.end()) == 2);
+
+  const auto S = py::range(short{32760}, short{32767}, 4); // 32760, 32764
+  CHECK(S.size() == 2);
+  CHECK(S.contains(short{32764}));
+  CHECK(!S.contains(short{32766}));
+  const auto T = py::range(short{-32760}, short{-32768}, -4);
+  CHECK(std::vector<short>(T.begin(), T.end()) ==
+        std::vector<short>{-32760, -32764});
+}
@@ -0,0 +1,29 @@
+#include <doctest/doctest.h> // for ResultBuilder, CHECK, TestCase, TEST...
+
+#include <list>                // for list
+#include <py2cpp/range.hpp>    // for range
+#include <py2cpp/reversed.hpp> // for reversed
+#include <vector>              // for vector
+
+TEST_CASE("Test reversed") {
+  auto out = std::vector<int>{};
+  for (auto i : py::reversed(py::range(5))) {
+    out.push_back(i);
+  }
+  CHECK(out == std::vector<int>{4, 3, 2, 1, 0});
+
+  const auto R = py::reversed(py::range(0, 10, 3)); // 9, 6, 3, 0
+  CHECK(R.size() == 4);
+  CHECK(R[0] == 9);
+  CHECK(R[3] == 0);
+}
+
+TEST_CASE("Test reversed (write through)") {
+  auto L = std::list<int>{1, 2, 3};
+  auto k = 0;
+  for (auto &x : py::reversed(L)) {
+    x += 10 * ++k;
+  }
+  CHECK(L.front() == 31);
+  CHECK(L.back() == 13);
+}
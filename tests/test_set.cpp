@@ -1,6 +1,8 @@
 #include <doctest/doctest.h> // for ResultBuilder, TestCase, CHECK, TEST_CASE
 
-#include <py2cpp/set.hpp> // for set
+#include <py2cpp/range.hpp> // for range
+#include <py2cpp/set.hpp>   // for set
+#include <vector>           // for vector
 
 TEST_CASE("Test set") {
   const auto S = py::set<int>{1, 3, 4, 5, 1};
@@ -11,3 +13,46 @@ TEST_CASE("Test set") {
   }
   CHECK(count == 4);
 }
+
+TEST_CASE("Test set algebra") {
+  const auto A = py::set<int>{1, 2, 3, 4};
+  const auto B = py::set<int>{3, 4, 5};
+
+  CHECK((A | B) == py::set<int>{1, 2, 3, 4, 5});
+  CHECK((A & B) == py::set<int>{3, 4});
+  CHECK((A - B) == py::set<int>{1, 2});
+  CHECK((B - A) == py::set<int>{5});
+  CHECK((A ^ B) == py::set<int>{1, 2, 5});
+
+  CHECK((A & B).issubset(A));
+  CHECK(A.issuperset(A & B));
+  CHECK(!A.issubset(B));
+  CHECK((A - B).isdisjoint(B));
+  CHECK(!A.isdisjoint(B));
+
+  auto C = A.copy();
+  C |= B;
+  CHECK(py::len(C) == 5);
+  C &= A;
+  CHECK(C == A);
+  C -= B;
+  CHECK(C == py::set<int>{1, 2});
+  C ^= B;
+  CHECK(C == py::set<int>{1, 2, 3, 4, 5});
+  C -= C;
+  CHECK(C.empty());
+
+  // rvalue operands are updated in place
+  auto D = (A.copy() | B) & py::set<int>{1, 5, 7};
+  CHECK(D == py::set<int>{1, 5});
+}
+
+TEST_CASE("Test set (bulk construction)") {
+  const auto V = std::vector<int>{3, 1, 4, 1, 5};
+  const auto S = py::set<int>(V.begin(), V.end());
+  CHECK(py::len(S) == 4);
+  const auto R = py::set<int>(py::range(10));
+  CHECK(py::len(R) == 10);
+  CHECK(R.contains(9));
+  CHECK(!R.contains(10));
+}
@@ -0,0 +1,154 @@
+#include <doctest/doctest.h> // for ResultBuilder, TestCase, CHECK, TEST_CASE
+
+#include <iterator>              // for next
+#include <py2cpp/enumerate.hpp>  // for const_enumerate
+#include <py2cpp/hash.hpp>       // for string_hash
+#include <py2cpp/range.hpp>      // for range
+#include <py2cpp/small_dict.hpp> // for small_dict
+#include <stdexcept>             // for out_of_range
+#include <string>                // for string
+#include <utility>               // for pair
+#include <vector>                // for vector
+
+TEST_CASE("Test small_dict") {
+  using E = std::pair<double, int>;
+  const auto S = py::small_dict<double, int>{E{0.1, 1}, E{0.3, 3}, E{0.4, 4}};
+  auto count = 0;
+  for (const auto &p : S) {
+    static_assert(sizeof(p) >= 0, "make compiler happy");
+    ++count;
+  }
+  CHECK(count == 3);
+  CHECK(S.is_small());
+  CHECK(py::len(S) == 3);
+  CHECK(0.3 < S);
+  CHECK(!(0.2 < S));
+  CHECK(S[0.4] == 4);
+}
+
+TEST_CASE("Test small_dict (grow and erase)") {
+  auto S = py::small_dict<int, int, 4>{};
+  for (auto i = 0; i != 1000; ++i) {
+    S[i] = i * i;
+    CHECK(S.is_small() == (i < 4));
+  }
+  CHECK(py::len(S) == 1000);
+  CHECK(S.get(30, -1) == 900);
+  CHECK(S.get(1000, -1) == -1);
+  for (auto i = 0; i != 1000; i += 2) {
+    CHECK(S.erase(i) == 1);
+  }
+  CHECK(py::len(S) == 500);
+  CHECK(!S.contains(10));
+  CHECK(S.contains(11));
+
+  auto sum = 0;
+  for (auto &kv : S.items()) {
+    kv.second -= kv.first * kv.first;
+    sum += kv.second;
+  }
+  CHECK(sum == 0);
+  CHECK(S[11] == 0);
+}
+
+TEST_CASE("Test small_dict (inline erase)") {
+  auto S = py::small_dict<std::string, std::string>{
+      {"a", "x"}, {"b", "y"}, {"c", "z"}};
+  for (auto it = S.items().begin(); it != S.items().end();) {
+    it = it->second == "y" ? S.items().erase(it) : std::next(it);
+  }
+  CHECK(py::len(S) == 2);
+  CHECK(S.at("c") == "z");
+  CHECK(S.is_small());
+  const auto T = S.copy();
+  CHECK(T.at("a") == "x");
+}
+
+TEST_CASE("Test small_dict (heterogeneous lookup)") {
+  using Dict =
+      py::small_dict<std::string, int, 8, py::string_hash, std::equal_to<>>;
+  auto D = Dict{{"one", 1}, {"two", 2}};
+  const char *key = "two";
+  CHECK(D.contains(key));
+  CHECK(!D.contains("three"));
+  CHECK(D.get("one", 0) == 1);
+  D["three"] = 3;
+  D["three"] += 1;
+  CHECK(D.at("three") == 4);
+  CHECK(py::len(D) == 3);
+}
+
+TEST_CASE("Test small_dict (get, setdefault, pop, update)") {
+  auto D = py::small_dict<int, std::string, 2>{{1, "x"}, {2, "y"}};
+  const auto fallback = std::string("none");
+  CHECK(D.get(1, fallback) == "x");
+  CHECK(&D.get(3, fallback) == &fallback);
+  REQUIRE(D.get(2) != nullptr);
+  CHECK(*D.get(2) == "y");
+  CHECK(D.get(3) == nullptr);
+
+  D.setdefault(3, "z") += "z"; // spills
+  CHECK(D.setdefault(3, "w") == "zz");
+  CHECK(!D.is_small());
+
+  CHECK(D.pop(1) == "x");
+  CHECK(D.pop(1, "gone") == "gone");
+  CHECK_THROWS(D.pop(1));
+
+  auto E = py::small_dict<int, std::string, 2>{{2, "Y"}, {4, "W"}};
+  D.update(std::move(E));
+  CHECK(D[2] == "Y");
+  CHECK(py::len(D) == 3);
+
+  auto item = D.popitem();
+  CHECK(!D.contains(item.first));
+  CHECK(py::len(D) == 2);
+}
+
+TEST_CASE("Test small_dict (popitem drain)") {
+  auto D = py::small_dict<int, int>{};
+  for (auto i : py::range(100000)) {
+    D[i] = -i;
+  }
+  auto total = 0L;
+  while (!D.empty()) {
+    const auto item = D.popitem();
+    CHECK(item.second == -item.first);
+    total += item.first;
+  }
+  CHECK(total == 99999L * 100000 / 2);
+
+  auto E = py::small_dict<int, int>{{1, 1}, {2, 2}};
+  CHECK(E.is_small());
+  CHECK(E.popitem().first + E.popitem().first == 3);
+  CHECK_THROWS_AS(E.popitem(), std::out_of_range);
+}
+
+TEST_CASE("Test small_dict (bulk construction)") {
+  const auto W = std::vector<int>{10, 20, 30};
+  const auto D = py::small_dict<size_t, int>(py::const_enumerate(W));
+  CHECK(py::len(D) == 3);
+  CHECK(D[1] == 20);
+  const auto F = py::small_dict<int, int>::fromkeys(py::range(100), 7);
+  CHECK(py::len(F) == 100);
+  CHECK(F[99] == 7);
+}
+
+TEST_CASE("Test small_dict (equality)") {
+  using E = std::pair<int, int>;
+  const auto A = py::small_dict<int, int, 4>{E{1, 1}, E{2, 4}, E{3, 9}};
+  auto B = py::small_dict<int, int, 4>{};
+  for (auto i = 10; i != 0; --i) {
+    B[i] = i * i; // spills
+  }
+  for (auto i = 4; i <= 10; ++i) {
+    B.erase(i);
+  }
+  CHECK(A == B);
+  CHECK(!(A != B));
+  B[2] = 5;
+  CHECK(A != B);
+  B.erase(2);
+  B[4] = 4;
+  CHECK(A != B);
+}
@@ -0,0 +1,127 @@
+#include <doctest/doctest.h> // for ResultBuilder, TestCase, CHECK, TEST_CASE
+
+#include <py2cpp/hash.hpp>      // for string_hash
+#include <py2cpp/range.hpp>     // for range
+#include <py2cpp/small_set.hpp> // for small_set
+#include <string>               // for string
+#include <utility>              // for move
+#include <vector>               // for vector
+
+TEST_CASE("Test small_set") {
+  const auto S = py::small_set<int>{1, 3, 4, 5, 1};
+  auto count = 0;
+  for (const auto &_ : S) {
+    static_assert(sizeof(_) >= 0, "make compiler happy");
+    ++count;
+  }
+  CHECK(count == 4);
+  CHECK(S.is_small());
+  CHECK(py::len(S) == 4);
+  CHECK(3 < S);
+  CHECK(!(2 < S));
+}
+
+TEST_CASE("Test small_set (spill and clear)") {
+  auto S = py::small_set<std::string, 4>{};
+  for (auto i = 0; i != 4; ++i) {
+    S.insert(std::to_string(i));
+  }
+  CHECK(S.is_small());
+  CHECK(!S.insert("2").second);
+  S.erase("1"); // the last key moves into the hole
+  CHECK(py::len(S) == 3);
+  CHECK(S.contains("3"));
+  S.insert("1");
+  S.insert("4");
+  CHECK(!S.is_small());
+  CHECK(py::len(S) == 5);
+  for (auto i = 0; i != 5; ++i) {
+    CHECK(S.contains(std::to_string(i)));
+  }
+
+  auto T = std::move(S);
+  CHECK(py::len(T) == 5);
+  CHECK(S.empty());
+  CHECK(S.is_small());
+  T.clear();
+  CHECK(T.is_small());
+  T.insert("x");
+  CHECK(py::len(T) == 1);
+}
+
+TEST_CASE("Test small_set (many keys)") {
+  auto S = py::small_set<int>(py::range(0, 70000, 7));
+  CHECK(py::len(S) == 10000);
+  auto hits = 0;
+  for (auto i = 0; i != 70000; ++i) {
+    hits += S.contains(i) ? 1 : 0;
+  }
+  CHECK(hits == 10000);
+  const auto T = S.copy();
+  CHECK(py::len(T) == 10000);
+}
+
+TEST_CASE("Test small_set algebra") {
+  const auto A = py::small_set<int>{1, 2, 3, 4};
+  const auto B = py::small_set<int>{3, 4, 5};
+
+  CHECK(py::len(A | B) == 5);
+  CHECK(py::len(A & B) == 2);
+  CHECK((A - B).issubset(py::small_set<int>{1, 2}));
+  CHECK(py::len(A ^ B) == 3);
+  CHECK((A ^ B).isdisjoint(A & B));
+
+  auto C = A.copy();
+  C ^= B;
+  CHECK(1 < C);
+  CHECK(5 < C);
+  CHECK(!(3 < C));
+  C &= B;
+  CHECK(py::len(C) == 1);
+  CHECK(C.is_small());
+}
+
+TEST_CASE("Test small_set (heterogeneous lookup)") {
+  const auto S =
+      py::small_set<std::string, 8, py::string_hash, std::equal_to<>>{
+          "alpha", "beta"};
+  CHECK(S.contains("alpha"));
+  CHECK(!S.contains("gamma"));
+  CHECK(S.count("beta") == 1);
+}
+
+TEST_CASE("Test small_set (equality)") {
+  const auto A = py::small_set<int, 4>{1, 2, 3};
+  auto B = py::small_set<int, 4>{};
+  for (auto i = 10; i != 0; --i) {
+    B.insert(i); // spills
+  }
+  for (auto i = 4; i <= 10; ++i) {
+    B.erase(i);
+  }
+  CHECK(A == B);
+  CHECK(!(A != B));
+  B.erase(2);
+  CHECK(A != B);
+  B.insert(4);
+  CHECK(A != B);
+}
+
+TEST_CASE("Test small_set (inline capacity above one group)") {
+  auto S = py::small_set<int, 40>{};
+  for (auto i = 0; i != 40; ++i) {
+    S.insert(i * 3);
+  }
+  CHECK(S.is_small());
+  for (auto i = 0; i != 40; i += 2) {
+    CHECK(S.erase(i * 3) == 1);
+  }
+  auto found = 0;
+  for (auto i = 0; i != 120; ++i) {
+    found += S.contains(i) ? 1 : 0;
+  }
+  CHECK(found == 20);
+  CHECK(!S.contains(0));
+  CHECK(S.contains(117));
+  CHECK(S.is_small());
+}
@@ -0,0 +1,99 @@
+#include <doctest/doctest.h> // for ResultBuilder, TestCase, CHECK, TEST_CASE
+
+#include <functional>             // for less
+#include <py2cpp/enumerate.hpp>   // for const_enumerate
+#include <py2cpp/range.hpp>       // for range
+#include <py2cpp/sorted_dict.hpp> // for sorted_dict, eytzinger_layout
+#include <string>                 // for string
+#include <utility>                // for pair
+#include <vector>                 // for vector
+
+template <typename Dict> static auto keys_of(const Dict &D) {
+  return std::vector<typename Dict::key_type>(D.begin(), D.end());
+}
+
+template <typename Layout> static void check_sorted_dict() {
+  using Dict = py::sorted_dict<std::string, int, std::less<>, Layout>;
+  auto D = Dict{{"c", 3}, {"a", 1}, {"b", 2}, {"a", 10}}; // later wins
+  CHECK(keys_of(D) == std::vector<std::string>{"a", "b", "c"});
+  CHECK(D["a"] == 10);
+  CHECK(py::len(D) == 3);
+  CHECK(std::string("b") < D);
+  CHECK(D.contains("c")); // transparent std::less<>
+  CHECK(D.get("z", -1) == -1);
+
+  D["d"] = 4;
+  D["0"] += 5;
+  CHECK(keys_of(D) == std::vector<std::string>{"0", "a", "b", "c", "d"});
+  CHECK(D.erase("b") == 1);
+  CHECK(D.setdefault("b", 20) == 20);
+  CHECK(D.setdefault("b", 30) == 20);
+
+  auto values = std::vector<int>{};
+  for (const auto &kv : D.items()) {
+    values.push_back(kv.second);
+  }
+  CHECK(values == std::vector<int>{5, 10, 20, 3, 4});
+
+  D.update(Dict{{"a", 100}, {"e", 5}});
+  CHECK(D.at("a") == 100);
+  CHECK(D.popitem() == std::pair<std::string, int>{"e", 5});
+  CHECK(D.pop("0") == 5);
+  CHECK(D.pop("0", -1) == -1);
+  CHECK_THROWS(D.pop("0"));
+  CHECK(D == Dict{{"d", 4}, {"c", 3}, {"b", 20}, {"a", 100}});
+  CHECK(D != Dict{{"d", 4}});
+}
+
+TEST_CASE("Test sorted_dict") {
+  check_sorted_dict<py::sorted_layout>();
+  check_sorted_dict<py::eytzinger_layout>();
+}
+
+template <typename Layout> static void check_sorted_dict_bulk() {
+  using Dict = py::sorted_dict<int, int, std::less<int>, Layout>;
+  auto V = std::vector<std::pair<int, int>>{};
+  for (auto i = 4999; i >= 0; --i) {
+    V.emplace_back(i * 3, i);
+  }
+  auto D = Dict(V.begin(), V.end());
+  CHECK(py::len(D) == 5000);
+  auto hits = 0;
+  for (auto i = 0; i != 15000; ++i) {
+    const auto *v = D.get(i);
+    hits += v != nullptr && *v * 3 == i ? 1 : 0;
+  }
+  CHECK(hits == 5000);
+
+  // one linear merge: overwrite every other key, add new ones
+  auto W = std::vector<std::pair<int, int>>{};
+  for (auto i = 0; i != 10000; ++i) {
+    W.emplace_back(i * 3 + (i % 2), -1);
+  }
+  D.update(W.begin(), W.end());
+  CHECK(py::len(D) == 12500);
+  CHECK(D[0] == -1);
+  CHECK(D[3] == 1);
+  CHECK(D[4] == -1);
+
+  const auto F = Dict::fromkeys(py::range(100), 7);
+  CHECK(py::len(F) == 100);
+  CHECK(F[99] == 7);
+  CHECK(keys_of(F) == std::vector<int>(py::range(100).begin(),
+                                       py::range(100).end()));
+}
+
+TEST_CASE("Test sorted_dict (bulk construction and update)") {
+  check_sorted_dict_bulk<py::sorted_layout>();
+  check_sorted_dict_bulk<py::eytzinger_layout>();
+}
+
+TEST_CASE("Test sorted_dict (iterable)") {
+  const auto W = std::vector<int>{10, 20, 30};
+  const auto D = py::sorted_dict<size_t, int>(py::const_enumerate(W));
+  CHECK(py::len(D) == 3);
+  CHECK(D[1] == 20);
+  REQUIRE(D.get(2) != nullptr);
+  CHECK(*D.get(2) == 30);
+  CHECK(D.get(3) == nullptr);
+}
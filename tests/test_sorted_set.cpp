@@ -0,0 +1,117 @@
+#include <doctest/doctest.h> // for ResultBuilder, TestCase, CHECK, TEST_CASE
+
+#include <functional>            // for less
+#include <py2cpp/range.hpp>      // for range
+#include <py2cpp/sorted_set.hpp> // for sorted_set, eytzinger_layout
+#include <string>                // for string
+#include <vector>                // for vector
+
+template <typename Layout> static void check_sorted_set() {
+  using Set = py::sorted_set<int, std::less<int>, Layout>;
+  const auto S = Set{5, 1, 4, 3, 1};
+  CHECK(std::vector<int>(S.begin(), S.end()) == std::vector<int>{1, 3, 4, 5});
+  CHECK(py::len(S) == 4);
+  CHECK(3 < S);
+  CHECK(!(2 < S));
+  CHECK(*S.find(4) == 4);
+  CHECK(S.find(2) == S.end());
+
+  auto T = S.copy();
+  CHECK(T.insert(2).second);
+  CHECK(!T.insert(2).second);
+  CHECK(*T.insert(0).first == 0);
+  CHECK(T.erase(4) == 1);
+  CHECK(T.erase(4) == 0);
+  CHECK(std::vector<int>(T.begin(), T.end()) ==
+        std::vector<int>{0, 1, 2, 3, 5});
+}
+
+TEST_CASE("Test sorted_set") {
+  check_sorted_set<py::sorted_layout>();
+  check_sorted_set<py::eytzinger_layout>();
+}
+
+template <typename Layout> static void check_sorted_set_many_keys() {
+  using Set = py::sorted_set<int, std::less<int>, Layout>;
+  auto V = std::vector<int>{};
+  for (auto i = 9999; i >= 0; --i) {
+    V.push_back(i * 7);
+    V.push_back(i * 7); // duplicates
+  }
+  auto S = Set(V.begin(), V.end());
+  CHECK(py::len(S) == 10000);
+  auto hits = 0;
+  for (auto i = -1; i != 70001; ++i) {
+    hits += S.contains(i) ? 1 : 0;
+  }
+  CHECK(hits == 10000);
+
+  auto prev = -1;
+  auto ordered = true;
+  for (const auto &k : S) {
+    ordered = ordered && prev < k;
+    prev = k;
+  }
+  CHECK(ordered);
+
+  S.insert(V.begin(), V.begin() + 10); // already present
+  S.insert({1, 2, 3});
+  CHECK(py::len(S) == 10003);
+}
+
+TEST_CASE("Test sorted_set (many keys)") {
+  check_sorted_set_many_keys<py::sorted_layout>();
+  check_sorted_set_many_keys<py::eytzinger_layout>();
+}
+
+template <typename Layout> static void check_sorted_set_algebra() {
+  using Set = py::sorted_set<int, std::less<int>, Layout>;
+  const auto A = Set{1, 2, 3, 4};
+  const auto B = Set{3, 4, 5};
+
+  CHECK((A | B) == Set{1, 2, 3, 4, 5});
+  CHECK((A & B) == Set{3, 4});
+  CHECK((A - B) == Set{1, 2});
+  CHECK((A ^ B) == Set{1, 2, 5});
+  CHECK((A - B).issubset(A));
+  CHECK(A.issuperset(A & B));
+  CHECK((A ^ B).isdisjoint(A & B));
+  CHECK(!A.isdisjoint(B));
+
+  auto C = A.copy();
+  C ^= B;
+  CHECK(1 < C);
+  CHECK(5 < C);
+  CHECK(!(3 < C));
+  C &= B;
+  CHECK(C == Set{5});
+  C |= A;
+  CHECK(py::len(C) == 5);
+  C -= B;
+  CHECK(C == Set{1, 2});
+}
+
+TEST_CASE("Test sorted_set algebra") {
+  check_sorted_set_algebra<py::sorted_layout>();
+  check_sorted_set_algebra<py::eytzinger_layout>();
+}
+
+TEST_CASE("Test sorted_set (heterogeneous lookup)") {
+  const auto S = py::sorted_set<std::string, std::less<>>{"beta", "alpha"};
+  CHECK(S.contains("alpha"));
+  CHECK(!S.contains("gamma"));
+  CHECK(S.count("beta") == 1);
+  CHECK(*S.begin() == "alpha");
+}
+
+TEST_CASE("Test sorted_set (bulk construction)") {
+  const auto R = py::sorted_set<int>(py::range(1000));
+  CHECK(py::len(R) == 1000);
+  CHECK(R.contains(999));
+  const auto S =
+      py::sorted_set<int, std::less<int>, py::eytzinger_layout>(R.begin(),
+                                                                R.end());
+  CHECK(py::len(S) == 1000);
+  CHECK(std::vector<int>(S.begin(), S.end()) ==
+        std::vector<int>(R.begin(), R.end()));
+}
@@ -0,0 +1,62 @@
+#include <doctest/doctest.h> // for ResultBuilder, TestCase, CHECK, TEST_CASE
+
+#include <cstddef>                // for size_t
+#include <py2cpp/static_dict.hpp> // for make_static_dict, static_dict, len
+#include <stdexcept>              // for out_of_range, invalid_argument
+#include <string>                 // for string
+#include <utility>                // for pair
+
+namespace {
+
+enum class Op { add, sub, mul, div };
+
+constexpr auto opcodes = py::make_static_dict<const char *, Op>(
+    {{"add", Op::add}, {"sub", Op::sub}, {"mul", Op::mul}, {"div", Op::div}});
+
+static_assert(py::len(opcodes) == 4, "constexpr len");
+static_assert(opcodes["mul"] == Op::mul, "built at compile time");
+static_assert(opcodes.get("mod") == nullptr, "built at compile time");
+
+constexpr auto names = py::make_static_dict<Op, const char *>(
+    {{Op::add, "+"}, {Op::sub, "-"}, {Op::mul, "*"}, {Op::div, "/"}});
+
+} // namespace
+
+TEST_CASE("Test static_dict") {
+  CHECK(opcodes.contains("div"));
+  CHECK(static_cast<const char *>("sub") < opcodes);
+  CHECK(opcodes.get("add") != nullptr);
+  CHECK(*opcodes.get("add") == Op::add);
+  CHECK(opcodes.get("mod", Op::div) == Op::div);
+  CHECK_THROWS_AS(opcodes.at("mod"), std::out_of_range);
+  CHECK(names[Op::mul] == std::string("*"));
+
+  auto keys = std::string{};
+  for (const auto *key : opcodes) {
+    keys += key;
+  }
+  CHECK(keys == "addsubmuldiv"); // original order
+  auto total = 0;
+  for (const auto &e : opcodes.items()) {
+    total += static_cast<int>(e.second);
+  }
+  CHECK(total == 6);
+
+  CHECK_THROWS_AS((py::make_static_dict<int, int>({{1, 2}, {1, 3}})),
+                  std::invalid_argument);
+}
+
+TEST_CASE("Test static_dict (many keys)") {
+  std::pair<unsigned, unsigned> items[300] = {};
+  for (auto i = 0U; i != 300; ++i) {
+    items[i] = {i * i, i};
+  }
+  const auto D = py::static_dict<unsigned, unsigned, 300>(items);
+  auto ok = 0;
+  for (auto i = 0U; i != 300; ++i) {
+    const auto *v = D.get(i * i);
+    ok += v != nullptr && *v == i ? 1 : 0;
+  }
+  CHECK(ok == 300);
+  CHECK(!D.contains(2));
+}
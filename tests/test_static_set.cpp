@@ -0,0 +1,75 @@
+#include <doctest/doctest.h> // for ResultBuilder, TestCase, CHECK, TEST_CASE
+
+#include <cstddef>               // for size_t
+#include <py2cpp/static_set.hpp> // for make_static_set, static_set, len
+#include <stdexcept>             // for invalid_argument
+#include <string>                // for string
+#if defined(PY2CPP_HAS_STRING_VIEW)
+#include <string_view> // for string_view, operator""sv
+#endif
+
+namespace {
+
+constexpr auto keywords = py::make_static_set<const char *>(
+    {"False", "None",   "True",  "and",    "as",       "assert", "async",
+     "await", "break",  "class", "continue", "def",    "del",    "elif",
+     "else",  "except", "finally", "for",  "from",     "global", "if",
+     "import", "in",    "is",    "lambda", "nonlocal", "not",    "or",
+     "pass",  "raise",  "return", "try",   "while",    "with",   "yield"});
+
+static_assert(py::len(keywords) == 35, "constexpr len");
+static_assert(keywords.contains("lambda"), "built at compile time");
+static_assert(!keywords.contains("print"), "built at compile time");
+
+} // namespace
+
+TEST_CASE("Test static_set") {
+  CHECK(keywords.contains("yield"));
+  CHECK(keywords.contains(std::string("class").c_str())); // compares chars
+  CHECK(!keywords.contains("Class"));
+  CHECK(!keywords.contains(""));
+  CHECK(keywords.count("def") == 1);
+  CHECK(keywords.find("nope") == keywords.end());
+
+  auto n = 0;
+  for (const auto *key : keywords) {
+    n += keywords.contains(key) ? 1 : 0;
+  }
+  CHECK(n == 35);
+  CHECK(*keywords.begin() == std::string("False")); // original order
+
+  constexpr auto S = py::make_static_set<int>({3, -1, 40, 7});
+  static_assert(-1 < S, "");
+  CHECK(py::len(S) == 4);
+  CHECK(S.contains(40));
+  CHECK(!S.contains(0));
+
+  const auto one = py::make_static_set<int>({0});
+  CHECK(one.contains(0));
+  CHECK(!one.contains(1));
+
+  CHECK_THROWS_AS(py::make_static_set<int>({1, 2, 1}), std::invalid_argument);
+}
+
+TEST_CASE("Test static_set (many keys)") {
+  int keys[500] = {};
+  for (auto i = 0; i != 500; ++i) {
+    keys[i] = i * 7919 - 1000;
+  }
+  const auto S = py::static_set<int, 500>(keys);
+  auto hits = 0;
+  for (auto i = -2000; i != 500 * 7919; ++i) {
+    hits += S.contains(i) ? 1 : 0;
+  }
+  CHECK(hits == 500);
+}
+
+#if defined(PY2CPP_HAS_STRING_VIEW)
+TEST_CASE("Test static_set (string_view)") {
+  using namespace std::literals;
+  constexpr auto S = py::make_static_set<std::string_view>({"ab"sv, "cd"sv});
+  static_assert(S.contains("cd"), "");
+  CHECK(S.contains(std::string("ab")));
+  CHECK(!S.contains("abc"));
+}
+#endif
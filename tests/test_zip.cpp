@@ -0,0 +1,39 @@
+#include <doctest/doctest.h> // for ResultBuilder, CHECK, TestCase, TEST...
+
+#include <list>             // for list
+#include <py2cpp/range.hpp> // for range
+#include <py2cpp/zip.hpp>   // for zip
+#include <string>           // for string
+#include <tuple>            // for get
+#include <vector>           // for vector
+
+TEST_CASE("Test zip") {
+  auto xs = std::vector<int>{1, 2, 3, 4};
+  const auto ys = std::vector<int>{10, 20, 30};
+  auto count = 0;
+  for (auto t : py::zip(xs, ys)) {
+    std::get<0>(t) += std::get<1>(t);
+    ++count;
+  }
+  CHECK(count == 3); // stops at the shortest
+  CHECK(xs[2] == 33);
+  CHECK(xs[3] == 4);
+}
+
+TEST_CASE("Test zip (random access)") {
+  const auto names = std::vector<std::string>{"a", "b", "c"};
+  const auto Z = py::zip(py::range(10), names);
+  CHECK(Z.size() == 3);
+  CHECK(Z.end() - Z.begin() == 3);
+  CHECK(std::get<0>(Z[2]) == 2);
+  CHECK(std::get<1>(*(Z.end() - 1)) == "c");
+}
+
+TEST_CASE("Test zip (forward only)") {
+  const auto L = std::list<int>{1, 2, 3};
+  auto total = 0;
+  for (auto t : py::zip(L, py::range(100, 0, -1))) {
+    total += std::get<0>(t) * std::get<1>(t);
+  }
+  CHECK(total == 1 * 100 + 2 * 99 + 3 * 98);
+}
@@ -1,6 +1,17 @@
 add_rules("mode.debug", "mode.release", "mode.coverage")
 add_requires("doctest", {alias = "doctest"})
 
+option("bench")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Build the bench_py2cpp micro-benchmarks (Google Benchmark)")
+option_end()
+
+if has_config("bench") then
+    add_requires("benchmark")
+    add_requires("boost", {optional = true}) -- boost::rational baseline
+end
+
 set_languages("c++14")
 
 if is_mode("coverage") then
@@ -17,6 +28,31 @@ target("test_py2cpp")
     add_includedirs("include", {public = true})
     add_files("tests/*.cpp")
     add_packages("doctest")
+    if is_plat("linux") then
+        add_syslinks("pthread")
+    end
+
+-- tests/stats/ need PY2CPP_STATS in every translation unit: own binary
+target("test_py2cpp_stats")
+    set_kind("binary")
+    add_includedirs("include")
+    add_defines("PY2CPP_STATS")
+    add_files("tests/test_main.cpp", "tests/stats/*.cpp")
+    add_packages("doctest")
+    if is_plat("linux") then
+        add_syslinks("pthread")
+    end
+
+if has_config("bench") then
+    target("bench_py2cpp")
+        set_kind("binary")
+        add_includedirs("include")
+        add_files("bench/*.cpp")
+        add_packages("benchmark", "boost")
+        if is_plat("linux") then
+            add_syslinks("pthread")
+        end
+end
 
 --
 -- If you want to known more usage about xmake, please see https://xmake.io